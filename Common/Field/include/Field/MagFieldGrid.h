@@ -0,0 +1,76 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file MagFieldGrid.h
+/// \brief Definition of the precomputed magnetic field grid MagFieldGrid
+
+#ifndef ALICEO2_FIELD_MAGFIELDGRID_H_
+#define ALICEO2_FIELD_MAGFIELDGRID_H_
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+class TVirtualMagField;
+
+namespace o2
+{
+namespace field
+{
+// Magnetic field sampled once on a regular 3D grid covering a box, and
+// trilinearly interpolated between the nodes. Meant to replace the exact field
+// in the inner loop of the track extrapolation (e.g. the Runge-Kutta of the
+// muon spectrometer), where the field is evaluated millions of times in a
+// region which does not change.
+// The field is stored in float, with the nodes grouped in bricks of 4x4x4 so
+// that the 8 nodes surrounding a point are most of the time in the same few
+// cache lines.
+class MagFieldGrid
+{
+ public:
+  MagFieldGrid() = default;
+  ~MagFieldGrid() = default;
+
+  /// sample the field in the box [xyzMin, xyzMax] with nodes every step cm
+  void build(TVirtualMagField& field, const std::array<double, 3>& xyzMin, const std::array<double, 3>& xyzMax, double step);
+
+  /// interpolate the field at point xyz, return false if it is outside of the grid
+  bool Field(const double xyz[3], double bxyz[3]) const;
+
+  bool isInside(const double xyz[3]) const;
+  bool empty() const { return mB.empty(); }
+  double getStep() const { return mStep; }
+  /// memory used by the grid (bytes)
+  size_t getMemorySize() const { return mB.size() * sizeof(float); }
+
+ private:
+  static constexpr int kBrickBits = 2;
+  static constexpr int kBrickMask = (1 << kBrickBits) - 1;
+
+  /// position of the first component of the node (ix, iy, iz) in mB
+  size_t getIndex(int ix, int iy, int iz) const
+  {
+    size_t brick = (static_cast<size_t>(iz >> kBrickBits) * mNBricks[1] + (iy >> kBrickBits)) * mNBricks[0] + (ix >> kBrickBits);
+    size_t node = ((iz & kBrickMask) << (2 * kBrickBits)) | ((iy & kBrickMask) << kBrickBits) | (ix & kBrickMask);
+    return 3 * ((brick << (3 * kBrickBits)) | node);
+  }
+
+  std::array<double, 3> mMin{};  // position of the first node
+  std::array<double, 3> mMax{};  // position of the last node
+  std::array<int, 3> mNNodes{};  // number of nodes along each axis
+  std::array<int, 3> mNBricks{}; // number of bricks along each axis
+  double mStep = 0.;             // distance between nodes
+  double mInvStep = 0.;          // 1 / mStep
+  std::vector<float> mB;         // Bx, By, Bz of each node, brick by brick
+};
+} // namespace field
+} // namespace o2
+
+#endif
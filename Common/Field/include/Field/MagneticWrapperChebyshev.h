@@ -21,6 +21,7 @@
 #include "MathUtils/Chebyshev3D.h"     // for Chebyshev3D
 #include "MathUtils/Chebyshev3DCalc.h" // for _INC_CREATION_Chebyshev3D_
 #include "Rtypes.h"                    // for Double_t, Int_t, Float_t, etc
+#include <vector>                      // for vector
 
 namespace o2
 {
@@ -209,6 +210,15 @@ class MagneticWrapperChebyshev : public TNamed
   /// it gets it at closest valid point
   virtual void Field(const Double_t* xyz, Double_t* b) const;
 
+  /// Computes field for n points, xyz and b being arrays of n triplets, with the same result as n calls
+  /// of the single point Field. The points are grouped by parameterization segment and the Chebyshev
+  /// series of each segment are evaluated for all its points at once.
+  void Field(int n, const Double_t* xyz, Double_t* b) const;
+
+  /// Builds the tables accelerating the search of the Z segment of the solenoid and dipole parameterizations
+  /// with nBins uniform bins (to be called once the parameterization is loaded)
+  void buildSegmentLookup(int nBins = 1000);
+
   /// Computes Bz for the point in cartesian coordinates. If point is outside of the parameterized region
   /// it gets it at closest valid point
   Double_t getBz(const Double_t* xyz) const;
@@ -316,6 +326,9 @@ class MagneticWrapperChebyshev : public TNamed
 #endif
 
  protected:
+  /// Finds the Z segment, i.e. the last segment starting below z, using the lookup table if available
+  static int findZSegment(Float_t z, int nSeg, const Float_t* segZ, const std::vector<int>& lookup, Float_t scale);
+
   /// Compute Solenoid field in Cylindircal coordinates
   /// note: if the point is outside the volume it gets the field in closest parameterized point
   void fieldCylindricalSolenoid(const Double_t* rphiz, Double_t* b) const;
@@ -413,6 +426,11 @@ class MagneticWrapperChebyshev : public TNamed
   Float_t mMaxDipoleZ;                ///< Max Z of Dipole parameterization
   TObjArray* mParameterizationDipole; ///< Parameterization pieces for Dipole field
 
+  std::vector<int> mZLookupSolenoid;   //! first Z segment of the solenoid for each bin of the lookup table
+  std::vector<int> mZLookupDipole;     //! first Z segment of the dipole for each bin of the lookup table
+  Float_t mZLookupScaleSolenoid = 0.f; //! number of lookup bins per cm for the solenoid
+  Float_t mZLookupScaleDipole = 0.f;   //! number of lookup bins per cm for the dipole
+
   ClassDefOverride(o2::field::MagneticWrapperChebyshev,
                    2) // Wrapper class for the set of Chebishev parameterizations of Alice mag.field
 };
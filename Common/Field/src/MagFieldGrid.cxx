@@ -0,0 +1,104 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file MagFieldGrid.cxx
+/// \brief Implementation of the precomputed magnetic field grid MagFieldGrid
+
+#include "Field/MagFieldGrid.h"
+#include <FairLogger.h>
+#include <TVirtualMagField.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace o2::field;
+
+//_______________________________________________________________________
+void MagFieldGrid::build(TVirtualMagField& field, const std::array<double, 3>& xyzMin, const std::array<double, 3>& xyzMax, double step)
+{
+  // sample the field in the box [xyzMin, xyzMax] with nodes every step cm.
+  // The box is extended if needed to contain an integer number of steps
+  if (step <= 0.) {
+    LOG(FATAL) << "Invalid step " << step << " for the field grid";
+  }
+  mStep = step;
+  mInvStep = 1. / step;
+  for (int i = 0; i < 3; i++) {
+    if (xyzMax[i] <= xyzMin[i]) {
+      LOG(FATAL) << "Invalid range [" << xyzMin[i] << ", " << xyzMax[i] << "] for the field grid";
+    }
+    mNNodes[i] = std::max(2, static_cast<int>(std::ceil((xyzMax[i] - xyzMin[i]) * mInvStep - 1.e-6)) + 1);
+    mNBricks[i] = (mNNodes[i] + kBrickMask) >> kBrickBits;
+    mMin[i] = xyzMin[i];
+    mMax[i] = xyzMin[i] + (mNNodes[i] - 1) * step;
+  }
+
+  // the last bricks along each axis may be incomplete, their unused nodes are left to 0
+  mB.assign(3 * (static_cast<size_t>(mNBricks[0] * mNBricks[1] * mNBricks[2]) << (3 * kBrickBits)), 0.f);
+
+  double xyz[3] = {0.}, b[3] = {0.};
+  for (int iz = 0; iz < mNNodes[2]; iz++) {
+    xyz[2] = mMin[2] + iz * step;
+    for (int iy = 0; iy < mNNodes[1]; iy++) {
+      xyz[1] = mMin[1] + iy * step;
+      for (int ix = 0; ix < mNNodes[0]; ix++) {
+        xyz[0] = mMin[0] + ix * step;
+        field.Field(xyz, b);
+        float* node = &mB[getIndex(ix, iy, iz)];
+        node[0] = b[0];
+        node[1] = b[1];
+        node[2] = b[2];
+      }
+    }
+  }
+
+  LOG(INFO) << "Field grid of " << mNNodes[0] << "x" << mNNodes[1] << "x" << mNNodes[2] << " nodes with a step of "
+            << step << " cm built in [" << mMin[0] << ", " << mMax[0] << "]x[" << mMin[1] << ", " << mMax[1] << "]x["
+            << mMin[2] << ", " << mMax[2] << "] (" << getMemorySize() / (1024 * 1024) << " MB)";
+}
+
+//_______________________________________________________________________
+bool MagFieldGrid::isInside(const double xyz[3]) const
+{
+  // written such that NaN coordinates are outside
+  for (int i = 0; i < 3; i++) {
+    if (!(xyz[i] >= mMin[i] && xyz[i] <= mMax[i])) {
+      return false;
+    }
+  }
+  return !mB.empty();
+}
+
+//_______________________________________________________________________
+bool MagFieldGrid::Field(const double xyz[3], double bxyz[3]) const
+{
+  // trilinear interpolation between the 8 nodes surrounding xyz
+  if (!isInside(xyz)) {
+    return false;
+  }
+
+  int i0[3];
+  double f[3];
+  for (int i = 0; i < 3; i++) {
+    double u = (xyz[i] - mMin[i]) * mInvStep;
+    i0[i] = std::min(static_cast<int>(u), mNNodes[i] - 2);
+    f[i] = u - i0[i];
+  }
+
+  bxyz[0] = bxyz[1] = bxyz[2] = 0.;
+  for (int corner = 0; corner < 8; corner++) {
+    int dx = corner & 1, dy = (corner >> 1) & 1, dz = corner >> 2;
+    double w = (dx ? f[0] : 1. - f[0]) * (dy ? f[1] : 1. - f[1]) * (dz ? f[2] : 1. - f[2]);
+    const float* node = &mB[getIndex(i0[0] + dx, i0[1] + dy, i0[2] + dz)];
+    bxyz[0] += w * node[0];
+    bxyz[1] += w * node[1];
+    bxyz[2] += w * node[2];
+  }
+  return true;
+}
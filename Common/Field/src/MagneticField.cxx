@@ -222,6 +222,7 @@ Bool_t MagneticField::loadParameterization()
     LOG(FATAL) << "MagneticField::loadParameterization: Did not find field " << getParameterName() << " in " << fname
                << "%s\n";
   }
+  mMeasuredMap->buildSegmentLookup();
   file->Close();
   delete file;
   return kTRUE;
@@ -17,6 +17,7 @@
 #include <TArrayI.h>    // for TArrayI
 #include <TSystem.h>    // for TSystem, gSystem
 #include <cstdio>       // for printf, fprintf, fclose, fopen, FILE
+#include <algorithm>    // for max
 #include <cstring>      // for memcpy
 #include "FairLogger.h" // for FairLogger
 #include "TMath.h"      // for BinarySearch, Sort
@@ -290,6 +291,9 @@ void MagneticWrapperChebyshev::copyFrom(const MagneticWrapperChebyshev& src)
       mParameterizationDipole->AddAtAndExpand(new Chebyshev3D(*src.getParameterDipole(i)), i);
     }
   }
+  if (!src.mZLookupSolenoid.empty() || !src.mZLookupDipole.empty()) {
+    buildSegmentLookup(std::max(src.mZLookupSolenoid.size(), src.mZLookupDipole.size()) - 1);
+  }
 }
 
 MagneticWrapperChebyshev& MagneticWrapperChebyshev::operator=(const MagneticWrapperChebyshev& rhs)
@@ -303,6 +307,8 @@ MagneticWrapperChebyshev& MagneticWrapperChebyshev::operator=(const MagneticWrap
 
 void MagneticWrapperChebyshev::Clear(const Option_t*)
 {
+  mZLookupSolenoid.clear();
+  mZLookupDipole.clear();
   if (mNumberOfParameterizationSolenoid) {
     mParameterizationSolenoid->SetOwner(kTRUE);
     delete mParameterizationSolenoid;
@@ -444,6 +450,123 @@ void MagneticWrapperChebyshev::Field(const Double_t* xyz, Double_t* b) const
   par->Eval(xyz, b);
 }
 
+void MagneticWrapperChebyshev::Field(int n, const Double_t* xyz, Double_t* b) const
+{
+  // segment of each point: -1 if the field is 0, the solenoid segments first then the dipole ones
+  std::vector<int> segID(n, -1);
+  std::vector<Double_t> arg(3 * n); // cylindrical coordinates for the solenoid, cartesian ones for the dipole
+  int nSeg = mNumberOfParameterizationSolenoid + mNumberOfParameterizationDipole;
+  std::vector<int> segStart(nSeg + 1, 0);
+  for (int ip = 0; ip < n; ip++) {
+    const Double_t* xyzP = xyz + 3 * ip;
+    Double_t* argP = &arg[3 * ip];
+    b[3 * ip] = b[3 * ip + 1] = b[3 * ip + 2] = 0;
+    int id = -1;
+    if (xyzP[2] > mMinZSolenoid) {
+      cartesianToCylindrical(xyzP, argP);
+      id = findSolenoidSegment(argP);
+#ifndef _BRING_TO_BOUNDARY_
+      if (id >= 0 && !getParameterSolenoid(id)->isInside(argP)) {
+        id = -1;
+      }
+#endif
+    } else {
+      argP[0] = xyzP[0];
+      argP[1] = xyzP[1];
+      argP[2] = xyzP[2];
+      id = findDipoleSegment(xyzP);
+#ifndef _BRING_TO_BOUNDARY_
+      if (id >= 0 && !getParameterDipole(id)->isInside(xyzP)) {
+        id = -1;
+      }
+#endif
+      if (id >= 0) {
+        id += mNumberOfParameterizationSolenoid;
+      }
+    }
+    segID[ip] = id;
+    if (id >= 0) {
+      segStart[id + 1]++;
+    }
+  }
+
+  // sort the points by segment
+  for (int is = 0; is < nSeg; is++) {
+    segStart[is + 1] += segStart[is];
+  }
+  std::vector<int> order(segStart[nSeg]);
+  std::vector<int> fill(segStart.begin(), segStart.end() - 1);
+  for (int ip = 0; ip < n; ip++) {
+    if (segID[ip] >= 0) {
+      order[fill[segID[ip]]++] = ip;
+    }
+  }
+
+  // evaluate each segment for all its points
+  std::vector<Double_t> argSeg, bSeg;
+  for (int is = 0; is < nSeg; is++) {
+    int np = segStart[is + 1] - segStart[is];
+    if (!np) {
+      continue;
+    }
+    const int* pnt = &order[segStart[is]];
+    argSeg.resize(3 * np);
+    bSeg.resize(3 * np);
+    for (int k = 0; k < np; k++) {
+      for (int i = 0; i < 3; i++) {
+        argSeg[3 * k + i] = arg[3 * pnt[k] + i];
+      }
+    }
+    bool isSolenoid = is < mNumberOfParameterizationSolenoid;
+    const Chebyshev3D* par = isSolenoid ? getParameterSolenoid(is) : getParameterDipole(is - mNumberOfParameterizationSolenoid);
+    par->Eval(np, argSeg.data(), bSeg.data());
+    for (int k = 0; k < np; k++) {
+      Double_t* bP = b + 3 * pnt[k];
+      if (isSolenoid) { // convert field to cartesian system
+        cylindricalToCartesianCylB(&argSeg[3 * k], &bSeg[3 * k], bP);
+      } else {
+        bP[0] = bSeg[3 * k];
+        bP[1] = bSeg[3 * k + 1];
+        bP[2] = bSeg[3 * k + 2];
+      }
+    }
+  }
+}
+
+int MagneticWrapperChebyshev::findZSegment(Float_t z, int nSeg, const Float_t* segZ, const std::vector<int>& lookup, Float_t scale)
+{
+  // equivalent to TMath::BinarySearch(nSeg, segZ, z), starting from the segment provided by the lookup table
+  Float_t u = (z - segZ[0]) * scale;
+  if (lookup.empty() || !(u >= 0.f && u < lookup.size())) {
+    return TMath::BinarySearch(nSeg, segZ, z);
+  }
+  int id = lookup[int(u)];
+  while (id >= 0 && segZ[id] > z) { // protection against the rounding of the bin boundaries
+    id--;
+  }
+  while (id + 1 < nSeg && segZ[id + 1] <= z) {
+    id++;
+  }
+  return id;
+}
+
+void MagneticWrapperChebyshev::buildSegmentLookup(int nBins)
+{
+  auto build = [nBins](int nSeg, const Float_t* segZ, std::vector<int>& lookup, Float_t& scale) {
+    lookup.clear();
+    if (nSeg < 2 || nBins < 1 || segZ[nSeg - 1] <= segZ[0]) {
+      return;
+    }
+    scale = nBins / (segZ[nSeg - 1] - segZ[0]);
+    lookup.resize(nBins + 1);
+    for (int bin = 0; bin <= nBins; bin++) {
+      lookup[bin] = TMath::BinarySearch(nSeg, segZ, Float_t(segZ[0] + bin / scale));
+    }
+  };
+  build(mNumberOfDistinctZSegmentsSolenoid, mCoordinatesSegmentsZSolenoid, mZLookupSolenoid, mZLookupScaleSolenoid);
+  build(mNumberOfDistinctZSegmentsDipole, mCoordinatesSegmentsZDipole, mZLookupDipole, mZLookupScaleDipole);
+}
+
 Double_t MagneticWrapperChebyshev::getBz(const Double_t* xyz) const
 {
   Double_t rphiz[3];
@@ -512,8 +635,8 @@ Int_t MagneticWrapperChebyshev::findDipoleSegment(const Double_t* xyz) const
   if (!mNumberOfParameterizationDipole) {
     return -1;
   }
-  int xid, yid, zid = TMath::BinarySearch(mNumberOfDistinctZSegmentsDipole, mCoordinatesSegmentsZDipole,
-                                          (Float_t)xyz[2]); // find zsegment
+  int xid, yid, zid = findZSegment((Float_t)xyz[2], mNumberOfDistinctZSegmentsDipole, mCoordinatesSegmentsZDipole,
+                                   mZLookupDipole, mZLookupScaleDipole); // find zsegment
 
   Bool_t reCheck = kFALSE;
   while (true) {
@@ -558,8 +681,8 @@ Int_t MagneticWrapperChebyshev::findSolenoidSegment(const Double_t* rpz) const
   if (!mNumberOfParameterizationSolenoid) {
     return -1;
   }
-  int rid, pid, zid = TMath::BinarySearch(mNumberOfDistinctZSegmentsSolenoid, mCoordinatesSegmentsZSolenoid,
-                                          (Float_t)rpz[2]); // find zsegment
+  int rid, pid, zid = findZSegment((Float_t)rpz[2], mNumberOfDistinctZSegmentsSolenoid, mCoordinatesSegmentsZSolenoid,
+                                   mZLookupSolenoid, mZLookupScaleSolenoid); // find zsegment
 
   Bool_t reCheck = kFALSE;
   while (true) {
@@ -0,0 +1,109 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test MagFieldGrid
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "Field/MagneticField.h"
+#include "Field/MagFieldGrid.h"
+#include <memory>
+#include "FairLogger.h" // for FairLogger
+#include <TStopwatch.h>
+#include <TRandom.h>
+
+using namespace o2::field;
+
+BOOST_AUTO_TEST_CASE(MagFieldGrid_test)
+{
+  // create magnetic field, with the dipole
+  std::unique_ptr<MagneticField> fld = std::make_unique<MagneticField>("Maps", "Maps", 1., 1., o2::field::MagFieldParam::k5kG);
+
+  // sample it in the muon spectrometer
+  const std::array<double, 3> xyzMin = {-300., -300., -1460.};
+  const std::array<double, 3> xyzMax = {300., 300., -490.};
+  MagFieldGrid grid;
+  TStopwatch swBuild;
+  swBuild.Start();
+  grid.build(*fld, xyzMin, xyzMax, 5.);
+  swBuild.Stop();
+  LOG(INFO) << "Grid built in " << swBuild.CpuTime() << " s";
+
+  const int ntst = 10000;
+  float rnd[3];
+  double xyz[ntst][3] = {}, bxyz[ntst][3] = {};
+  // fill input
+  for (int it = ntst; it--;) {
+    gRandom->RndmArray(3, rnd);
+    for (int i = 0; i < 3; i++) {
+      xyz[it][i] = xyzMin[i] + rnd[i] * (xyzMax[i] - xyzMin[i]);
+    }
+  }
+
+  const int repFactor = 50;
+  // timing: exact field
+  TStopwatch swExact;
+  swExact.Start();
+  for (int ii = repFactor; ii--;) {
+    for (int it = ntst; it--;) {
+      fld->Field(xyz[it], bxyz[it]);
+    }
+  }
+  swExact.Stop();
+
+  // timing: grid
+  TStopwatch swGrid;
+  swGrid.Start();
+  double bgrid[3];
+  bool inside = true;
+  for (int ii = repFactor; ii--;) {
+    for (int it = ntst; it--;) {
+      inside &= grid.Field(xyz[it], bgrid);
+    }
+  }
+  swGrid.Stop();
+  BOOST_CHECK(inside);
+  //
+  double sE = swExact.CpuTime() / (ntst * repFactor);
+  double sG = swGrid.CpuTime() / (ntst * repFactor);
+  double rat = sG > 0. ? sE / sG : -1;
+  LOG(INFO) << "Timing: Exact field: " << sE << " Grid: " << sG << "s/call -> factor " << rat;
+
+  // compare exact/grid precision, relative to the RMS of the field in the volume
+  double mean[3] = {0.}, rms[3] = {0.}, bRMS = 0.;
+  const char comp[] = "XYZ";
+  LOG(INFO) << "Relative precision of grid field wrt exact field";
+  for (int it = ntst; it--;) {
+    grid.Field(xyz[it], bgrid);
+    for (int i = 0; i < 3; i++) {
+      double df = bxyz[it][i] - bgrid[i];
+      mean[i] += df;
+      rms[i] += df * df;
+      bRMS += bxyz[it][i] * bxyz[it][i];
+    }
+  }
+  bRMS = TMath::Sqrt(bRMS / ntst);
+  BOOST_CHECK(bRMS > 1.);
+  for (int i = 0; i < 3; i++) {
+    mean[i] /= ntst;
+    rms[i] /= ntst;
+    rms[i] -= mean[i] * mean[i];
+    rms[i] = TMath::Sqrt(rms[i]);
+    LOG(INFO) << "deltaB" << comp[i] << ": "
+              << " mean=" << mean[i] << "(" << mean[i] / bRMS * 100. << "%)"
+              << " RMS =" << rms[i] << "(" << rms[i] / bRMS * 100. << "%)";
+    BOOST_CHECK(TMath::Abs(mean[i] / bRMS) < 1.e-3);
+    BOOST_CHECK(TMath::Abs(rms[i] / bRMS) < 1.e-2);
+  }
+
+  // outside of the grid the field is not provided
+  const double outside[3] = {0., 0., 0.};
+  BOOST_CHECK(!grid.Field(outside, bgrid));
+}
@@ -0,0 +1,82 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test MagneticWrapperChebyshev
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "Field/MagneticField.h"
+#include "Field/MagneticWrapperChebyshev.h"
+#include <memory>
+#include <vector>
+#include "FairLogger.h" // for FairLogger
+#include <TStopwatch.h>
+#include <TRandom.h>
+
+using namespace o2::field;
+
+BOOST_AUTO_TEST_CASE(MagneticWrapperChebyshev_batch)
+{
+  std::unique_ptr<MagneticField> fld = std::make_unique<MagneticField>("Maps", "Maps", 1., 1., o2::field::MagFieldParam::k5kG);
+  const MagneticWrapperChebyshev* map = fld->getMeasuredMap();
+  BOOST_REQUIRE(map);
+
+  // points in the solenoid and in the dipole regions
+  const int ntst = 100000;
+  std::vector<double> xyz(3 * ntst), bScalar(3 * ntst), bBatch(3 * ntst);
+  for (int it = 0; it < ntst; it++) {
+    double r = 400. * gRandom->Rndm(), phi = TMath::Pi() * 2 * gRandom->Rndm();
+    xyz[3 * it] = r * TMath::Cos(phi);
+    xyz[3 * it + 1] = r * TMath::Sin(phi);
+    xyz[3 * it + 2] = gRandom->Uniform(map->getMinZ(), map->getMaxZ());
+  }
+
+  const int repFactor = 5;
+  TStopwatch swScalar;
+  swScalar.Start();
+  for (int ii = repFactor; ii--;) {
+    for (int it = 0; it < ntst; it++) {
+      map->Field(&xyz[3 * it], &bScalar[3 * it]);
+    }
+  }
+  swScalar.Stop();
+
+  TStopwatch swBatch;
+  swBatch.Start();
+  for (int ii = repFactor; ii--;) {
+    map->Field(ntst, xyz.data(), bBatch.data());
+  }
+  swBatch.Stop();
+  double sS = swScalar.CpuTime() / (ntst * repFactor), sB = swBatch.CpuTime() / (ntst * repFactor);
+  LOG(INFO) << "Timing: scalar: " << sS << " batch: " << sB << " s/point -> factor " << (sB > 0. ? sS / sB : -1.);
+
+  // the batch evaluation differs from the scalar one only by the rounding
+  double maxDiff = 0.;
+  for (int it = 0; it < ntst; it++) {
+    double bMag = std::sqrt(bScalar[3 * it] * bScalar[3 * it] + bScalar[3 * it + 1] * bScalar[3 * it + 1] + bScalar[3 * it + 2] * bScalar[3 * it + 2]);
+    for (int i = 0; i < 3; i++) {
+      maxDiff = std::max(maxDiff, std::abs(bBatch[3 * it + i] - bScalar[3 * it + i]) / (bMag + 1.));
+    }
+  }
+  LOG(INFO) << "Max difference between batch and scalar field, relative to |B|+1kG: " << maxDiff;
+  BOOST_CHECK(maxDiff < 1e-5);
+
+  // the segment lookup tables give the same segments as the binary search
+  MagneticWrapperChebyshev mapNoLUT(*map);
+  mapNoLUT.buildSegmentLookup(0);
+  int nDiff = 0;
+  for (int it = 0; it < ntst; it++) {
+    double rphiz[3];
+    MagneticWrapperChebyshev::cartesianToCylindrical(&xyz[3 * it], rphiz);
+    nDiff += map->findSolenoidSegment(rphiz) != mapNoLUT.findSolenoidSegment(rphiz);
+    nDiff += map->findDipoleSegment(&xyz[3 * it]) != mapNoLUT.findDipoleSegment(&xyz[3 * it]);
+  }
+  BOOST_CHECK(nDiff == 0);
+}
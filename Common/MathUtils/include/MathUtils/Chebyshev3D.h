@@ -135,6 +135,13 @@ class Chebyshev3D : public TNamed
 
   Double_t Eval(const Double_t* par, int idim);
 
+  /// Evaluates the parameterization for n points, par being an array of n 3D arguments and res of n outputs.
+  /// The points are evaluated in batches, vectorizing the Chebyshev recursions across the points. Unlike the
+  /// single point Eval, these do not use the temporary buffers, hence may be called concurrently.
+  void Eval(int n, const Float_t* par, Float_t* res) const;
+
+  void Eval(int n, const Double_t* par, Double_t* res) const;
+
   void evaluateDerivative(int dimd, const Float_t* par, Float_t* res);
 
   void evaluateDerivative2(int dimd1, int dimd2, const Float_t* par, Float_t* res);
@@ -233,6 +240,9 @@ class Chebyshev3D : public TNamed
   } // map from [-1:1] to x
 
  private:
+  template <typename T>
+  void evalBatch(int n, const T* par, T* res) const;
+
   Int_t mOutputArrayDimension;       ///< dimension of the ouput array
   Float_t mPrecision;                ///< requested precision
   Float_t mMinBoundaries[3];         ///< min boundaries in each dimension
@@ -168,6 +168,15 @@ class Chebyshev3DCalc : public TNamed
 
   Double_t Eval(const Double_t* par) const;
 
+  /// max number of points evaluated at once by the batch Eval
+  static constexpr int kBatchSize = 16;
+
+  /// Evaluates Chebyshev parameterization for n <= kBatchSize points of 3D function, the k-th point being
+  /// (par0[k], par1[k], par2[k]). The recursion of each dimension is done for all points at once, so that it
+  /// can be vectorized across the points. Unlike the single point Eval, it does not use the temporary buffers.
+  /// VERY IMPORTANT: par must contain the function arguments ALREADY MAPPED to [-1:1] interval
+  void Eval(int n, const Float_t* par0, const Float_t* par1, const Float_t* par2, Float_t* res) const;
+
  private:
   Int_t mNumberOfCoefficients;    ///< total number of coeeficients
   Int_t mNumberOfRows;            ///< number of significant rows in the 3D coeffs matrix
@@ -287,6 +287,39 @@ Chebyshev3D& Chebyshev3D::operator=(const Chebyshev3D& rhs)
   return *this;
 }
 
+void Chebyshev3D::Eval(int n, const Float_t* par, Float_t* res) const
+{
+  evalBatch(n, par, res);
+}
+
+void Chebyshev3D::Eval(int n, const Double_t* par, Double_t* res) const
+{
+  evalBatch(n, par, res);
+}
+
+template <typename T>
+void Chebyshev3D::evalBatch(int n, const T* par, T* res) const
+{
+  constexpr int B = Chebyshev3DCalc::kBatchSize;
+  Float_t mapped[3][B], out[B];
+  for (int first = 0; first < n; first += B) {
+    int nb = TMath::Min(B, n - first);
+    const T* parB = par + 3 * first;
+    for (int k = 0; k < nb; k++) {
+      for (int i = 0; i < 3; i++) {
+        mapped[i][k] = mapToInternal(parB[3 * k + i], i);
+      }
+    }
+    T* resB = res + mOutputArrayDimension * first;
+    for (int i = 0; i < mOutputArrayDimension; i++) {
+      getChebyshevCalc(i)->Eval(nb, mapped[0], mapped[1], mapped[2], out);
+      for (int k = 0; k < nb; k++) {
+        resB[mOutputArrayDimension * k + i] = out[k];
+      }
+    }
+  }
+}
+
 void Chebyshev3D::Clear(const Option_t*)
 {
   // clear all dynamic structures
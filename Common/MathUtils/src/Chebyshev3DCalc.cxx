@@ -189,6 +189,55 @@ void Chebyshev3DCalc::Clear(const Option_t*)
   }
 }
 
+void Chebyshev3DCalc::Eval(int n, const Float_t* par0, const Float_t* par1, const Float_t* par2, Float_t* res) const
+{
+  // Same Clenshaw recursions as in the single point Eval, but instead of storing the 1D and 2D sums in
+  // the temporary arrays, the recursion over rows (columns) is advanced as soon as the sum over
+  // columns (coefficients) for the given row (column) is available. The loops over points run over the
+  // full batch (padded with 0s) to be vectorizable.
+  constexpr int B = kBatchSize;
+  Float_t x0[B], x1[B], x2[B], x0d[B], x1d[B], x2d[B];
+  for (int k = 0; k < B; k++) {
+    x0[k] = k < n ? par0[k] : 0.f;
+    x1[k] = k < n ? par1[k] : 0.f;
+    x2[k] = k < n ? par2[k] : 0.f;
+    x0d[k] = x0[k] + x0[k];
+    x1d[k] = x1[k] + x1[k];
+    x2d[k] = x2[k] + x2[k];
+  }
+  Float_t rb0[B] = {0.f}, rb1[B] = {0.f}, rb2[B];
+  for (int id0 = mNumberOfRows; id0--;) {
+    int nCLoc = mNumberOfColumnsAtRow[id0]; // number of significant coefs on this row
+    int col0 = mColumnAtRowBeginning[id0];  // beginning of local column in the 2D boundary matrix
+    Float_t cb0[B] = {0.f}, cb1[B] = {0.f}, cb2[B];
+    for (int id1 = nCLoc; id1--;) {
+      int id = id1 + col0;
+      const Float_t* cf = mCoefficients + mCoefficientBound2D1[id];
+      Float_t b0[B] = {0.f}, b1[B] = {0.f}, b2[B];
+      for (int ic = mCoefficientBound2D0[id]; ic--;) {
+        for (int k = 0; k < B; k++) {
+          b2[k] = b1[k];
+          b1[k] = b0[k];
+          b0[k] = cf[ic] + x2d[k] * b1[k] - b2[k];
+        }
+      }
+      for (int k = 0; k < B; k++) {
+        cb2[k] = cb1[k];
+        cb1[k] = cb0[k];
+        cb0[k] = (b0[k] - x2[k] * b1[k]) + x1d[k] * cb1[k] - cb2[k];
+      }
+    }
+    for (int k = 0; k < B; k++) {
+      rb2[k] = rb1[k];
+      rb1[k] = rb0[k];
+      rb0[k] = (cb0[k] - x1[k] * cb1[k]) + x0d[k] * rb1[k] - rb2[k];
+    }
+  }
+  for (int k = 0; k < n; k++) {
+    res[k] = rb0[k] - x0[k] * rb1[k];
+  }
+}
+
 void Chebyshev3DCalc::Print(const Option_t*) const
 {
   printf("Chebyshev parameterization data %s for 3D->1 function, precision: %e\n",
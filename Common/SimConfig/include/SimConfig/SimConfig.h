@@ -47,6 +47,9 @@ struct SimConfigData {
                                              // but will themselves be overridden by any values given in mKeyValueTokens.
   int mPrimaryChunkSize;                     // defining max granularity for input primaries of a sim job
   int mInternalChunkSize;                    //
+  float mChunkTargetTime = 0.;               // wanted processing time of a primary chunk (s), 0 for fixed chunks
+  int mGeneratorThreads = 1;                 // number of event generator instances in the primary server
+  int mGeneratorQueueSize = 2;               // number of events generated ahead by the primary server
   int mStartSeed;                            // base for random number seeds
   int mSimWorkers = 1;                       // number of parallel sim workers (when it applies)
   bool mFilterNoHitEvents = false;           // whether to filter out events not leaving any response
@@ -54,7 +57,7 @@ struct SimConfigData {
   long mTimestamp;                           // timestamp to anchor transport simulation to
   int mField;                                // L3 field setting in kGauss: +-2,+-5 and 0
 
-  ClassDefNV(SimConfigData, 3);
+  ClassDefNV(SimConfigData, 4);
 };
 
 // A singleton class which can be used
@@ -117,6 +120,9 @@ class SimConfig
   std::string getConfigFile() const { return mConfigData.mConfigFile; }
   int getPrimChunkSize() const { return mConfigData.mPrimaryChunkSize; }
   int getInternalChunkSize() const { return mConfigData.mInternalChunkSize; }
+  float getChunkTargetTime() const { return mConfigData.mChunkTargetTime; }
+  int getNGeneratorThreads() const { return mConfigData.mGeneratorThreads; }
+  int getGeneratorQueueSize() const { return mConfigData.mGeneratorQueueSize; }
   int getStartSeed() const { return mConfigData.mStartSeed; }
   int getNSimWorkers() const { return mConfigData.mSimWorkers; }
   bool isFilterOutNoHitEvents() const { return mConfigData.mFilterNoHitEvents; }
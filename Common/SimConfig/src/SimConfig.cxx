@@ -15,6 +15,7 @@
 #include <FairLogger.h>
 #include <thread>
 #include <cmath>
+#include <algorithm>
 
 using namespace o2::conf;
 namespace bpo = boost::program_options;
@@ -52,6 +53,9 @@ void SimConfig::initOptions(boost::program_options::options_description& options
     "configFile", bpo::value<std::string>()->default_value(""), "Path to an INI or JSON configuration file")(
     "chunkSize", bpo::value<unsigned int>()->default_value(500), "max size of primary chunk (subevent) distributed by server")(
     "chunkSizeI", bpo::value<int>()->default_value(-1), "internalChunkSize")(
+    "chunkTargetTime", bpo::value<float>()->default_value(0.), "adapt primary chunk sizes (up to chunkSize) to this processing time per chunk in s, based on the observed worker throughput (0: fixed chunks)")(
+    "genThreads", bpo::value<int>()->default_value(1), "number of event generator instances in the primary server, each in its own thread with its own gRandom, reseeded for each event (generators must not share other global state)")(
+    "genQueueSize", bpo::value<int>()->default_value(2), "number of events generated ahead by the primary server")(
     "seed", bpo::value<int>()->default_value(-1), "initial seed (default: -1 random)")(
     "field", bpo::value<int>()->default_value(-5), "L3 field rounded to kGauss, allowed values +-2,+-5 and 0")(
     "nworkers,j", bpo::value<int>()->default_value(nsimworkersdefault), "number of parallel simulation workers (only for parallel mode)")(
@@ -110,6 +114,9 @@ bool SimConfig::resetFromParsedMap(boost::program_options::variables_map const&
   mConfigData.mConfigFile = vm["configFile"].as<std::string>();
   mConfigData.mPrimaryChunkSize = vm["chunkSize"].as<unsigned int>();
   mConfigData.mInternalChunkSize = vm["chunkSizeI"].as<int>();
+  mConfigData.mChunkTargetTime = vm["chunkTargetTime"].as<float>();
+  mConfigData.mGeneratorThreads = std::max(1, vm["genThreads"].as<int>());
+  mConfigData.mGeneratorQueueSize = std::max(1, vm["genQueueSize"].as<int>());
   mConfigData.mStartSeed = vm["seed"].as<int>();
   mConfigData.mSimWorkers = vm["nworkers"].as<int>();
   mConfigData.mTimestamp = vm["timestamp"].as<long>();
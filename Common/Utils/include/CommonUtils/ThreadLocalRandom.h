@@ -0,0 +1,53 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef COMMON_UTILS_INCLUDE_COMMONUTILS_THREADLOCALRANDOM_H_
+#define COMMON_UTILS_INCLUDE_COMMONUTILS_THREADLOCALRANDOM_H_
+
+#include <TRandom.h>
+
+namespace o2
+{
+namespace utils
+{
+
+/// A TRandom drawing from a generator chosen by each thread.
+/// Installed as gRandom, it lets several threads use gRandom concurrently,
+/// each with its own (reproducible) sequence. The distributions (Gaus, Uniform, ...)
+/// are those of TRandom, built on Rndm() of the generator of the calling thread.
+class ThreadLocalRandom : public TRandom
+{
+ public:
+  /// @param fallback generator of the threads which did not set their own, e.g. the previous gRandom
+  explicit ThreadLocalRandom(TRandom* fallback) : mFallback(fallback) {}
+  ~ThreadLocalRandom() override = default;
+
+  /// Draw the random numbers of the calling thread from @a rng (not owned), nullptr for the fallback
+  static void setThreadGenerator(TRandom* rng) { sThreadGenerator = rng; }
+
+  TRandom* getFallback() const { return mFallback; }
+
+  Double_t Rndm() override { return generator()->Rndm(); }
+  void RndmArray(Int_t n, Float_t* array) override { generator()->RndmArray(n, array); }
+  void RndmArray(Int_t n, Double_t* array) override { generator()->RndmArray(n, array); }
+  void SetSeed(ULong_t seed = 0) override { generator()->SetSeed(seed); }
+  UInt_t GetSeed() const override { return generator()->GetSeed(); }
+
+ private:
+  TRandom* generator() const { return sThreadGenerator ? sThreadGenerator : mFallback; }
+
+  TRandom* mFallback = nullptr;
+  static inline thread_local TRandom* sThreadGenerator = nullptr;
+};
+
+} // namespace utils
+} // namespace o2
+
+#endif /* COMMON_UTILS_INCLUDE_COMMONUTILS_THREADLOCALRANDOM_H_ */
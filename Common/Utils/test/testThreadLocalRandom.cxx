@@ -0,0 +1,84 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test ThreadLocalRandom
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "CommonUtils/ThreadLocalRandom.h"
+#include <TRandom3.h>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace o2::utils;
+
+using Event = std::vector<double>;
+
+// an "event" drawn through gRandom, as the particle generators do
+Event generate(unsigned int seed)
+{
+  gRandom->SetSeed(seed);
+  Event event;
+  for (int i = 0; i < 1000; ++i) {
+    event.push_back(gRandom->Gaus(0., 1.));
+    event.push_back(gRandom->Uniform(-1., 1.));
+  }
+  return event;
+}
+
+// the events generated by nthreads threads, thread i producing the events i, i + nthreads, ...
+// with the seed 1000 + event, like the generator threads of the primary server
+std::vector<Event> generateEvents(int nevents, int nthreads)
+{
+  std::vector<Event> events(nevents);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nthreads; ++t) {
+    threads.emplace_back([&events, t, nevents, nthreads]() {
+      TRandom3 rng;
+      ThreadLocalRandom::setThreadGenerator(&rng);
+      for (int event = t; event < nevents; event += nthreads) {
+        events[event] = generate(1000 + event);
+      }
+      ThreadLocalRandom::setThreadGenerator(nullptr);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return events;
+}
+
+BOOST_AUTO_TEST_CASE(ThreadLocalRandom_events)
+{
+  TRandom3 fallback(42);
+  auto original = gRandom;
+  ThreadLocalRandom threadRandom(&fallback);
+  gRandom = &threadRandom;
+
+  const int nevents = 20;
+  auto serial = generateEvents(nevents, 1);
+  auto parallel = generateEvents(nevents, 2);
+  auto again = generateEvents(nevents, 2);
+
+  // reproducible, and independent of the number of threads
+  BOOST_CHECK(parallel == again);
+  BOOST_CHECK(parallel == serial);
+  // the events are distinct
+  std::set<Event> distinct(parallel.begin(), parallel.end());
+  BOOST_CHECK_EQUAL(distinct.size(), nevents);
+
+  // the threads without their own generator draw from the fallback
+  TRandom3 reference(42);
+  BOOST_CHECK_EQUAL(gRandom->Rndm(), reference.Rndm());
+  BOOST_CHECK_EQUAL(fallback.Rndm(), reference.Rndm());
+
+  gRandom = original;
+}
@@ -103,7 +103,8 @@ enum FitAlgorithm {
   Standard = 0,  ///< Standard raw fitter
   NeuralNet = 1, ///< Neural net raw fitter
   FastFit = 2,   ///< Fast raw fitter (Martin)
-  NONE = 3
+  Gamma2 = 3,    ///< Linearised Gamma-2 fit
+  NONE = 4
 };
 
 } // namespace emcal
@@ -0,0 +1,85 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef ALICEO2_DECAYVERTEX_H
+#define ALICEO2_DECAYVERTEX_H
+
+#include <Rtypes.h>
+#include <array>
+
+namespace o2
+{
+namespace dataformats
+{
+
+// Secondary vertex candidate (V0, 3-prong decay...) stored as a flat row: position of the
+// fitted PCA, total momentum of the prongs at the PCA and indices of the prong tracks
+// in the container they were taken from
+
+template <int NProngs>
+class DecayVertex
+{
+ public:
+  DecayVertex() = default;
+  ~DecayVertex() = default;
+  DecayVertex(const std::array<float, 3>& xyz, const std::array<float, 3>& pxyz, const std::array<int, NProngs>& prongs,
+              float chi2, float cosPA, float time)
+    : mXYZ(xyz), mPxPyPz(pxyz), mProngIDs(prongs), mChi2(chi2), mCosPA(cosPA), mTime(time)
+  {
+  }
+
+  static constexpr int getNProngs() { return NProngs; }
+
+  float getX() const { return mXYZ[0]; }
+  float getY() const { return mXYZ[1]; }
+  float getZ() const { return mXYZ[2]; }
+  const std::array<float, 3>& getXYZ() const { return mXYZ; }
+  void setXYZ(const std::array<float, 3>& xyz) { mXYZ = xyz; }
+
+  float getPx() const { return mPxPyPz[0]; }
+  float getPy() const { return mPxPyPz[1]; }
+  float getPz() const { return mPxPyPz[2]; }
+  const std::array<float, 3>& getPxPyPz() const { return mPxPyPz; }
+  void setPxPyPz(const std::array<float, 3>& pxyz) { mPxPyPz = pxyz; }
+
+  int getProngID(int i) const { return mProngIDs[i]; }
+  const std::array<int, NProngs>& getProngIDs() const { return mProngIDs; }
+  void setProngIDs(const std::array<int, NProngs>& ids) { mProngIDs = ids; }
+
+  ///< chi2 (or sum of squared DCAs, for the absolute DCA minimization) per prong at the PCA
+  float getChi2() const { return mChi2; }
+  void setChi2(float v) { mChi2 = v; }
+
+  ///< cosine of the pointing angle, wrt the nominal interaction point
+  float getCosPA() const { return mCosPA; }
+  void setCosPA(float v) { mCosPA = v; }
+
+  ///< time in \mus, as the mean time of the prongs
+  float getTime() const { return mTime; }
+  void setTime(float t) { mTime = t; }
+
+ private:
+  std::array<float, 3> mXYZ = {0.f, 0.f, 0.f};
+  std::array<float, 3> mPxPyPz = {0.f, 0.f, 0.f};
+  std::array<int, NProngs> mProngIDs{};
+  float mChi2 = 0.f;
+  float mCosPA = 0.f;
+  float mTime = 0.f;
+
+  ClassDefNV(DecayVertex, 1);
+};
+
+using V0 = DecayVertex<2>;
+using DecayVertex3Prong = DecayVertex<3>;
+
+} // namespace dataformats
+} // namespace o2
+
+#endif
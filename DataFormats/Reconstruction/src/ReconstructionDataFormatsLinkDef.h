@@ -34,4 +34,9 @@
 #pragma link C++ class o2::dataformats::Vertex < o2::dataformats::TimeStampWithError < double, double>> + ;
 #pragma link C++ class std::vector < o2::dataformats::Vertex < o2::dataformats::TimeStamp < int>>> + ;
 
+#pragma link C++ class o2::dataformats::DecayVertex < 2> + ;
+#pragma link C++ class o2::dataformats::DecayVertex < 3> + ;
+#pragma link C++ class std::vector < o2::dataformats::DecayVertex < 2>> + ;
+#pragma link C++ class std::vector < o2::dataformats::DecayVertex < 3>> + ;
+
 #endif
@@ -60,7 +60,18 @@ class MatLayerCylSet : public o2::gpu::FlatObject
   GPUd() int getNLayers() const { return get() ? get()->mNLayers : 0; }
   GPUd() const MatLayerCyl& getLayer(int i) const { return get()->mLayers[i]; }
 
+  /// State of the successive queries along the same track: the consecutive steps of a track
+  /// cross neighbouring radial intervals, so the intervals found for the previous step are used
+  /// as a starting point of a linear walk instead of redoing the binary search from scratch.
+  /// Must be reset (or a new one used) when switching to another track.
+  struct RayCursor {
+    int intervalMin = -1; ///< R2 interval of the min radius of the last ray, -1 if unknown
+    int intervalMax = -1; ///< R2 interval of the max radius of the last ray, -1 if unknown
+    GPUd() void reset() { intervalMin = intervalMax = -1; }
+  };
+
   GPUd() bool getLayersRange(const Ray& ray, short& lmin, short& lmax) const;
+  GPUd() bool getLayersRange(const Ray& ray, short& lmin, short& lmax, RayCursor& cursor) const;
   GPUd() float getRMin() const { return get()->mRMin; }
   GPUd() float getRMax() const { return get()->mRMax; }
   GPUd() float getZMax() const { return get()->mZMax; }
@@ -87,10 +98,17 @@ class MatLayerCylSet : public o2::gpu::FlatObject
     // get material budget traversed on the line between point0 and point1
     return getMatBudget(point0.X(), point0.Y(), point0.Z(), point1.X(), point1.Y(), point1.Z());
   }
+  MatBudget getMatBudget(RayCursor& cursor, const Point3D<float>& point0, const Point3D<float>& point1) const
+  {
+    // same as above, using and updating the cursor of the track
+    return getMatBudget(cursor, point0.X(), point0.Y(), point0.Z(), point1.X(), point1.Y(), point1.Z());
+  }
 #endif // !GPUCA_ALIGPUCODE
   GPUd() MatBudget getMatBudget(float x0, float y0, float z0, float x1, float y1, float z1) const;
+  GPUd() MatBudget getMatBudget(RayCursor& cursor, float x0, float y0, float z0, float x1, float y1, float z1) const;
 
   GPUd() int searchSegment(float val, int low = -1, int high = -1) const;
+  GPUd() int walkSegment(float val, int start, int low = -1, int high = -1) const;
 
 #ifndef GPUCA_GPUCODE
   //-----------------------------------------------------------
@@ -112,6 +130,9 @@ class MatLayerCylSet : public o2::gpu::FlatObject
   static constexpr size_t getBufferAlignmentBytes() { return 8; }
 #endif // !GPUCA_GPUCODE
 
+ private:
+  GPUd() MatBudget getMatBudget(Ray& ray, short lmin, short lmax) const;
+
   ClassDefNV(MatLayerCylSet, 1);
 };
 
@@ -15,7 +15,10 @@
 #ifndef ALICEO2_BASE_PROPAGATOR_
 #define ALICEO2_BASE_PROPAGATOR_
 
+#include <cstdint>
 #include <string>
+#include <vector>
+#include <gsl/span>
 #include "CommonConstants/PhysicsConstants.h"
 #include "ReconstructionDataFormats/Track.h"
 #include "ReconstructionDataFormats/TrackLTIntegral.h"
@@ -42,6 +45,14 @@ class Propagator
   static constexpr int USEMatCorrTGeo = 1; // flag to use TGeo for material queries
   static constexpr int USEMatCorrLUT = 2;  // flag to use LUT for material queries (user must provide a pointer
 
+  // per-track status of the batched propagation
+  enum BatchStatus : uint8_t {
+    BatchOK = 0,         // track propagated to the requested X
+    BatchPropFailed,     // failure of the track propagation step
+    BatchMaxSnpExceeded, // |snp| reached maxSnp
+    BatchMatCorrFailed   // failure of the material correction
+  };
+
   static Propagator* Instance()
   {
     static Propagator instance;
@@ -56,6 +67,19 @@ class Propagator
                     float maxSnp = 0.85, float maxStep = 2.0, int matCorr = 1,
                     o2::track::TrackLTIntegral* tofInfo = nullptr, int signCorr = 0) const;
 
+  // batched versions of the above, propagating all tracks to the same X: the steps of all the tracks are done
+  // together, with the field and material queries of a step grouped in a loop, and the tracks which failed or
+  // reached X dropped from the following steps. The result for each track is identical to the one of the scalar
+  // method, its status being filled in the status vector. The tracks which failed are left at the failure point.
+  // If provided, tofInfo must have an entry per track. Return the number of tracks successfully propagated.
+  int PropagateToXBxByBz(gsl::span<o2::track::TrackParCov> tracks, float x, std::vector<uint8_t>& status,
+                         float mass = o2::constants::physics::MassPionCharged, float maxSnp = 0.85, float maxStep = 2.0,
+                         int matCorr = 1, gsl::span<o2::track::TrackLTIntegral> tofInfo = {}, int signCorr = 0) const;
+
+  int propagateToX(gsl::span<o2::track::TrackParCov> tracks, float x, float bZ, std::vector<uint8_t>& status,
+                   float mass = o2::constants::physics::MassPionCharged, float maxSnp = 0.85, float maxStep = 2.0,
+                   int matCorr = 1, gsl::span<o2::track::TrackLTIntegral> tofInfo = {}, int signCorr = 0) const;
+
   bool propagateToDCA(const Point3D<float>& vtx, o2::track::TrackParCov& track, float bZ,
                       float mass = o2::constants::physics::MassPionCharged, float maxStep = 2.0, int matCorr = 1,
                       o2::track::TrackLTIntegral* tofInfo = nullptr, int signCorr = 0, float maxD = 999.f) const;
@@ -78,7 +102,9 @@ class Propagator
   Propagator();
   ~Propagator() = default;
 
-  MatBudget getMatBudget(int corrType, const Point3D<float>& p0, const Point3D<float>& p1) const;
+  MatBudget getMatBudget(int corrType, const Point3D<float>& p0, const Point3D<float>& p1, MatLayerCylSet::RayCursor& cursor) const;
+  int propagateToXBatch(gsl::span<o2::track::TrackParCov> tracks, float xToGo, bool useBxByBz, float bZ, std::vector<uint8_t>& status,
+                        float mass, float maxSnp, float maxStep, int matCorr, gsl::span<o2::track::TrackLTIntegral> tofInfo, int signCorr) const;
 
   const o2::field::MagFieldFast* mField = nullptr; ///< External fast field (barrel only for the moment)
   float mBz = 0;                                   // nominal field
@@ -242,12 +242,32 @@ std::size_t MatLayerCylSet::estimateFlatBufferSize() const
 GPUd() MatBudget MatLayerCylSet::getMatBudget(float x0, float y0, float z0, float x1, float y1, float z1) const
 {
   // get material budget traversed on the line between point0 and point1
-  MatBudget rval;
   Ray ray(x0, y0, z0, x1, y1, z1);
   short lmin, lmax; // get innermost and outermost relevant layer
   if (!getLayersRange(ray, lmin, lmax)) {
-    return rval;
+    return MatBudget();
+  }
+  return getMatBudget(ray, lmin, lmax);
+}
+
+//_________________________________________________________________________________________________
+GPUd() MatBudget MatLayerCylSet::getMatBudget(RayCursor& cursor, float x0, float y0, float z0, float x1, float y1, float z1) const
+{
+  // get material budget traversed on the line between point0 and point1, the layers range
+  // being looked for starting from the one of the previous query of the same track
+  Ray ray(x0, y0, z0, x1, y1, z1);
+  short lmin, lmax; // get innermost and outermost relevant layer
+  if (!getLayersRange(ray, lmin, lmax, cursor)) {
+    return MatBudget();
   }
+  return getMatBudget(ray, lmin, lmax);
+}
+
+//_________________________________________________________________________________________________
+GPUd() MatBudget MatLayerCylSet::getMatBudget(Ray& ray, short lmin, short lmax) const
+{
+  // account material of the layers lmin:lmax crossed by the ray
+  MatBudget rval;
   short lrID = lmax;
   while (lrID >= lmin) { // go from outside to inside
     const auto& lr = getLayer(lrID);
@@ -360,6 +380,15 @@ GPUd() bool MatLayerCylSet::getLayersRange(const Ray& ray, short& lmin, short& l
 {
   // get range of layers corresponding to rmin/rmax
   //
+  RayCursor cursor; // without previous ray, the R2 intervals are found by binary search
+  return getLayersRange(ray, lmin, lmax, cursor);
+}
+
+//_________________________________________________________________________________________________
+GPUd() bool MatLayerCylSet::getLayersRange(const Ray& ray, short& lmin, short& lmax, RayCursor& cursor) const
+{
+  // same as getLayersRange(ray, lmin, lmax), but the R2 intervals are found by walking from the
+  // ones of the previous ray of the cursor, which is updated
   lmin = lmax = -1;
   float rmin2, rmax2;
   ray.getMinMaxR2(rmin2, rmax2);
@@ -368,8 +397,10 @@ GPUd() bool MatLayerCylSet::getLayersRange(const Ray& ray, short& lmin, short& l
     return false;
   }
   int lmxInt, lmnInt;
-  lmxInt = rmax2 < getRMax2() ? searchSegment(rmax2, 0) : get()->mNRIntervals - 2;
-  lmnInt = rmin2 >= getRMin2() ? searchSegment(rmin2, 0, lmxInt + 1) : 0;
+  lmxInt = rmax2 < getRMax2() ? walkSegment(rmax2, cursor.intervalMax, 0) : get()->mNRIntervals - 2;
+  lmnInt = rmin2 >= getRMin2() ? walkSegment(rmin2, cursor.intervalMin, 0, lmxInt + 1) : 0;
+  cursor.intervalMax = lmxInt;
+  cursor.intervalMin = lmnInt;
   const auto* interval2LrID = get()->mInterval2LrID;
   lmax = interval2LrID[lmxInt];
   lmin = interval2LrID[lmnInt];
@@ -405,6 +436,30 @@ GPUd() int MatLayerCylSet::searchSegment(float val, int low, int high) const
   return mid;
 }
 
+GPUd() int MatLayerCylSet::walkSegment(float val, int start, int low, int high) const
+{
+  ///< search segment val belongs to, stepping from the segment start. Gives the same result as
+  ///< searchSegment, to which it falls back if start is not defined. The val MUST be within the boundaries
+  if (start < 0) {
+    return searchSegment(val, low, high);
+  }
+  if (low < 0) {
+    low = 0;
+  }
+  if (high < 0) {
+    high = get()->mNRIntervals;
+  }
+  int i = start < low ? low : (start >= high ? high - 1 : start);
+  const auto* r2Intervals = get()->mR2Intervals;
+  while (i > low && val < r2Intervals[i]) {
+    i--;
+  }
+  while (i + 1 < high && val >= r2Intervals[i + 1]) {
+    i++;
+  }
+  return i;
+}
+
 #ifndef GPUCA_ALIGPUCODE // this part is unvisible on GPU version
 
 void MatLayerCylSet::flatten()
@@ -17,6 +17,7 @@
 #include "Field/MagFieldFast.h"
 #include "Field/MagneticField.h"
 #include "MathUtils/Utils.h"
+#include <algorithm>
 
 using namespace o2::base;
 
@@ -74,6 +75,7 @@ bool Propagator::PropagateToXBxByBz(o2::track::TrackParCov& track, float xToGo,
   }
 
   std::array<float, 3> b;
+  MatLayerCylSet::RayCursor cursor;
   while (std::abs(dx) > Epsilon) {
     auto step = std::min(std::abs(dx), maxStep);
     if (dir < 0) {
@@ -91,7 +93,7 @@ bool Propagator::PropagateToXBxByBz(o2::track::TrackParCov& track, float xToGo,
     }
     if (matCorr != USEMatCorrNONE) {
       auto xyz1 = track.getXYZGlo();
-      auto mb = getMatBudget(matCorr, xyz0, xyz1);
+      auto mb = getMatBudget(matCorr, xyz0, xyz1, cursor);
       if (!track.correctForMaterial(mb.meanX2X0, ((signCorr < 0) ? -mb.length : mb.length) * mb.meanRho, mass)) {
         return false;
       }
@@ -133,6 +135,7 @@ bool Propagator::propagateToX(o2::track::TrackParCov& track, float xToGo, float
     signCorr = -dir; // sign of eloss correction is not imposed
   }
 
+  MatLayerCylSet::RayCursor cursor;
   while (std::abs(dx) > Epsilon) {
     auto step = std::min(std::abs(dx), maxStep);
     if (dir < 0) {
@@ -149,7 +152,7 @@ bool Propagator::propagateToX(o2::track::TrackParCov& track, float xToGo, float
     }
     if (matCorr != USEMatCorrNONE) {
       auto xyz1 = track.getXYZGlo();
-      auto mb = getMatBudget(matCorr, xyz0, xyz1);
+      auto mb = getMatBudget(matCorr, xyz0, xyz1, cursor);
       //
       if (!track.correctForMaterial(mb.meanX2X0, ((signCorr < 0) ? -mb.length : mb.length) * mb.meanRho, mass)) {
         return false;
@@ -169,6 +172,146 @@ bool Propagator::propagateToX(o2::track::TrackParCov& track, float xToGo, float
   return true;
 }
 
+//_______________________________________________________________________
+int Propagator::PropagateToXBxByBz(gsl::span<o2::track::TrackParCov> tracks, float xToGo, std::vector<uint8_t>& status,
+                                   float mass, float maxSnp, float maxStep, int matCorr,
+                                   gsl::span<o2::track::TrackLTIntegral> tofInfo, int signCorr) const
+{
+  // batched version of the PropagateToXBxByBz, see propagateToXBatch
+  return propagateToXBatch(tracks, xToGo, true, 0.f, status, mass, maxSnp, maxStep, matCorr, tofInfo, signCorr);
+}
+
+//_______________________________________________________________________
+int Propagator::propagateToX(gsl::span<o2::track::TrackParCov> tracks, float xToGo, float bZ, std::vector<uint8_t>& status,
+                             float mass, float maxSnp, float maxStep, int matCorr,
+                             gsl::span<o2::track::TrackLTIntegral> tofInfo, int signCorr) const
+{
+  // batched version of the propagateToX, see propagateToXBatch
+  return propagateToXBatch(tracks, xToGo, false, bZ, status, mass, maxSnp, maxStep, matCorr, tofInfo, signCorr);
+}
+
+//_______________________________________________________________________
+int Propagator::propagateToXBatch(gsl::span<o2::track::TrackParCov> tracks, float xToGo, bool useBxByBz, float bZ,
+                                  std::vector<uint8_t>& status, float mass, float maxSnp, float maxStep, int matCorr,
+                                  gsl::span<o2::track::TrackLTIntegral> tofInfo, int signCorr) const
+{
+  //----------------------------------------------------------------
+  //
+  // Propagates all tracks to the plane X=xToGo, step by step, doing the same operations
+  // as the scalar propagateToX (or PropagateToXBxByBz if useBxByBz is set) for every track.
+  // At each step the start/end points of the active tracks are stored in SoA buffers, so that
+  // the field and material queries of all tracks are done in dedicated loops, and the tracks
+  // which failed or reached xToGo are removed from the list of active ones.
+  //----------------------------------------------------------------
+  const float Epsilon = 0.00001;
+  int nTracks = tracks.size();
+  bool fillTOF = !tofInfo.empty();
+  if (fillTOF && int(tofInfo.size()) != nTracks) {
+    LOG(FATAL) << "TOF integrals provided for " << tofInfo.size() << " tracks out of " << nTracks;
+  }
+  status.assign(nTracks, BatchOK);
+
+  std::vector<int> active; // tracks still to be propagated
+  std::vector<int8_t> dir(nTracks), sign(nTracks);
+  active.reserve(nTracks);
+  for (int i = 0; i < nTracks; i++) {
+    auto dx = xToGo - tracks[i].getX();
+    dir[i] = dx > 0.f ? 1 : -1;
+    sign[i] = signCorr ? signCorr : -dir[i]; // sign of eloss correction is not imposed
+    if (std::abs(dx) > Epsilon) {
+      active.push_back(i);
+    }
+  }
+
+  std::vector<float> x0(nTracks), y0(nTracks), z0(nTracks), x1(nTracks), y1(nTracks), z1(nTracks);
+  std::vector<std::array<float, 3>> b(useBxByBz ? nTracks : 0);
+  std::vector<MatBudget> mb(matCorr != USEMatCorrNONE ? nTracks : 0);
+  std::vector<MatLayerCylSet::RayCursor> cursors(matCorr != USEMatCorrNONE ? nTracks : 0);
+  std::vector<bool> ok(nTracks);
+  while (!active.empty()) {
+    int nActive = active.size();
+    // start points of the step
+    for (int k = 0; k < nActive; k++) {
+      auto xyz = tracks[active[k]].getXYZGlo();
+      x0[k] = xyz.X();
+      y0[k] = xyz.Y();
+      z0[k] = xyz.Z();
+    }
+    if (useBxByBz) {
+      for (int k = 0; k < nActive; k++) {
+        mField->Field(Point3D<float>(x0[k], y0[k], z0[k]), b[k].data());
+      }
+    }
+    // propagation
+    for (int k = 0; k < nActive; k++) {
+      int i = active[k];
+      auto& track = tracks[i];
+      auto step = std::min(std::abs(xToGo - track.getX()), maxStep);
+      if (dir[i] < 0) {
+        step = -step;
+      }
+      auto x = track.getX() + step;
+      ok[k] = useBxByBz ? track.propagateTo(x, b[k]) : track.propagateTo(x, bZ);
+      if (!ok[k]) {
+        status[i] = BatchPropFailed;
+      } else if (maxSnp > 0 && std::abs(track.getSnp()) >= maxSnp) {
+        status[i] = BatchMaxSnpExceeded;
+        ok[k] = false;
+      }
+    }
+    // end points of the step, material
+    if (matCorr != USEMatCorrNONE || fillTOF) {
+      for (int k = 0; k < nActive; k++) {
+        if (ok[k]) {
+          auto xyz = tracks[active[k]].getXYZGlo();
+          x1[k] = xyz.X();
+          y1[k] = xyz.Y();
+          z1[k] = xyz.Z();
+        }
+      }
+    }
+    if (matCorr != USEMatCorrNONE) {
+      for (int k = 0; k < nActive; k++) {
+        if (ok[k]) {
+          mb[k] = getMatBudget(matCorr, Point3D<float>(x0[k], y0[k], z0[k]), Point3D<float>(x1[k], y1[k], z1[k]), cursors[active[k]]);
+        }
+      }
+      for (int k = 0; k < nActive; k++) {
+        int i = active[k];
+        if (!ok[k]) {
+          continue;
+        }
+        auto& track = tracks[i];
+        if (!track.correctForMaterial(mb[k].meanX2X0, ((sign[i] < 0) ? -mb[k].length : mb[k].length) * mb[k].meanRho, mass)) {
+          status[i] = BatchMatCorrFailed;
+          ok[k] = false;
+          continue;
+        }
+        if (fillTOF) {
+          tofInfo[i].addStep(mb[k].length, track); // fill L,ToF info using already calculated step length
+          tofInfo[i].addX2X0(mb[k].meanX2X0);
+        }
+      }
+    } else if (fillTOF) { // if tofInfo filling was requested w/o material correction, we need to calculate the step lenght
+      for (int k = 0; k < nActive; k++) {
+        if (ok[k]) {
+          Vector3D<float> stepV(x1[k] - x0[k], y1[k] - y0[k], z1[k] - z0[k]);
+          tofInfo[active[k]].addStep(stepV.R(), tracks[active[k]]);
+        }
+      }
+    }
+    // drop the tracks which failed or reached the requested X
+    int nKeep = 0;
+    for (int k = 0; k < nActive; k++) {
+      if (ok[k] && std::abs(xToGo - tracks[active[k]].getX()) > Epsilon) {
+        active[nKeep++] = active[k];
+      }
+    }
+    active.resize(nKeep);
+  }
+  return std::count(status.begin(), status.end(), BatchOK);
+}
+
 //_______________________________________________________________________
 bool Propagator::propagateToDCA(const Point3D<float>& vtx, o2::track::TrackParCov& track, float bZ,
                                 float mass, float maxStep, int matCorr,
@@ -253,7 +396,8 @@ int Propagator::initFieldFromGRP(const o2::parameters::GRPObject* grp, bool verb
 }
 
 //____________________________________________________________
-MatBudget Propagator::getMatBudget(int corrType, const Point3D<float>& p0, const Point3D<float>& p1) const
+MatBudget Propagator::getMatBudget(int corrType, const Point3D<float>& p0, const Point3D<float>& p1, MatLayerCylSet::RayCursor& cursor) const
 {
-  return (corrType == USEMatCorrTGeo) ? GeometryManager::meanMaterialBudget(p0, p1) : mMatLUT->getMatBudget(p0.X(), p0.Y(), p0.Z(), p1.X(), p1.Y(), p1.Z());
+  // the cursor keeps the LUT layers range of the previous step of the same track
+  return (corrType == USEMatCorrTGeo) ? GeometryManager::meanMaterialBudget(p0, p1) : mMatLUT->getMatBudget(cursor, p0.X(), p0.Y(), p0.Z(), p1.X(), p1.Y(), p1.Z());
 }
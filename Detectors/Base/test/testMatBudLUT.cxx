@@ -23,6 +23,7 @@ BOOST_AUTO_TEST_CASE(MatBudLUT)
 
   BOOST_CHECK(buildMatBudLUT(2, 20)); // generate LUT
   BOOST_CHECK(testMBLUT());           // test LUT manipulations
+  BOOST_CHECK(testMBLUTCursor());     // compare queries with and without ray cursor
 
 #endif //!GPUCA_ALIGPUCODE
 }
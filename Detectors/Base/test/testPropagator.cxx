@@ -0,0 +1,137 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test Propagator batched propagation
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "DetectorsBase/Propagator.h"
+#include "DetectorsBase/MatLayerCylSet.h"
+#include "Field/MagneticField.h"
+#include "FairLogger.h"
+#include <TGeoGlobalMagField.h>
+#include <TGeoManager.h>
+#include <TGeoMaterial.h>
+#include <TGeoMedium.h>
+#include <TGeoVolume.h>
+#include <TRandom.h>
+#include <TString.h>
+#include <TStopwatch.h>
+#include <cstring>
+#include <vector>
+
+namespace o2
+{
+namespace base
+{
+
+void createToyGeometry()
+{
+  /// beam pipe, thin silicon shells, an aluminium cylinder and a gas volume, enough to populate a material LUT
+  auto gm = new TGeoManager("test", "Toy geometry for the propagator test");
+  auto vac = new TGeoMedium("Vacuum", 1, new TGeoMaterial("Vacuum", 0, 0, 0));
+  auto be = new TGeoMedium("Be", 2, new TGeoMaterial("Be", 9.01, 4, 1.848));
+  auto si = new TGeoMedium("Si", 3, new TGeoMaterial("Si", 28.09, 14, 2.33));
+  auto al = new TGeoMedium("Al", 4, new TGeoMaterial("Al", 26.98, 13, 2.70));
+  auto ar = new TGeoMedium("Ar", 5, new TGeoMaterial("Ar", 39.95, 18, 1.66e-3));
+  auto top = gm->MakeBox("World", vac, 200., 200., 200.);
+  gm->SetTopVolume(top);
+  top->AddNode(gm->MakeTube("BeamPipe", be, 1.8, 1.88, 60.), 1);
+  int id = 0;
+  for (float r : {4.f, 12.f, 25.f}) {
+    top->AddNode(gm->MakeTube(Form("SiShell%d", id), si, r, r + 0.05, 60.), 1);
+    id++;
+  }
+  top->AddNode(gm->MakeTube("AlShell", al, 40., 40.5, 80.), 1);
+  top->AddNode(gm->MakeTube("GasVolume", ar, 60., 80., 100.), 1);
+  gm->CloseGeometry();
+}
+
+BOOST_AUTO_TEST_CASE(PropagatorBatch)
+{
+  // the propagator needs a geometry and a field, the material LUT is built from the geometry
+  if (!gGeoManager) {
+    createToyGeometry();
+  }
+  TGeoGlobalMagField::Instance()->SetField(o2::field::MagneticField::createFieldMap());
+  TGeoGlobalMagField::Instance()->Lock();
+  auto prop = Propagator::Instance();
+
+  MatLayerCylSet lut;
+  lut.addLayer(1.5, 2.5, 60., 5., 1.);
+  lut.addLayer(2.5, 30., 60., 5., 2.);
+  lut.addLayer(30., 50., 80., 10., 5.);
+  lut.addLayer(50., 85., 100., 10., 5.);
+  lut.populateFromTGeo(3);
+  lut.optimizePhiSlices();
+  lut.flatten();
+  prop->setMatLUT(&lut);
+
+  // random tracks from the ITS to be propagated to the TPC inner radius, some of them curling
+  const int nTracks = 20000;
+  const float xRef = 83.f;
+  std::vector<o2::track::TrackParCov> tracks;
+  std::array<float, 15> cov = {1e-4, 0., 1e-4, 0., 0., 1e-6, 0., 0., 0., 1e-6, 0., 0., 0., 0., 1e-4};
+  for (int i = 0; i < nTracks; i++) {
+    std::array<float, 5> par = {float(gRandom->Gaus(0., 1.)), float(gRandom->Gaus(0., 5.)), float(gRandom->Uniform(-0.5, 0.5)),
+                                float(gRandom->Uniform(-1., 1.)), float((i % 2 ? -1. : 1.) / gRandom->Uniform(0.15, 5.))};
+    tracks.emplace_back(gRandom->Uniform(2., 40.), gRandom->Uniform(-3.14, 3.14), par, cov);
+  }
+
+  // with the LUT every track keeps its own ray cursor in the batch, while the scalar loop runs one track at a
+  // time: since the tracks start at different radii and are stepped together, identical results show that the
+  // cursors are not mixed up between tracks
+  for (int matCorr : {Propagator::USEMatCorrNONE, Propagator::USEMatCorrLUT}) {
+    for (bool useBxByBz : {false, true}) {
+      auto tracksScalar = tracks, tracksBatch = tracks;
+      std::vector<o2::track::TrackLTIntegral> ltScalar(nTracks), ltBatch(nTracks);
+      std::vector<uint8_t> statusScalar(nTracks), status;
+      TStopwatch swScalar;
+      swScalar.Start();
+      int nOKScalar = 0;
+      for (int i = 0; i < nTracks; i++) {
+        bool res = useBxByBz ? prop->PropagateToXBxByBz(tracksScalar[i], xRef, o2::constants::physics::MassPionCharged, 0.85, 2., matCorr, &ltScalar[i])
+                             : prop->propagateToX(tracksScalar[i], xRef, prop->getNominalBz(), o2::constants::physics::MassPionCharged, 0.85, 2., matCorr, &ltScalar[i]);
+        nOKScalar += res;
+        statusScalar[i] = res;
+      }
+      swScalar.Stop();
+
+      TStopwatch swBatch;
+      swBatch.Start();
+      int nOKBatch = useBxByBz ? prop->PropagateToXBxByBz(tracksBatch, xRef, status, o2::constants::physics::MassPionCharged, 0.85, 2., matCorr, ltBatch)
+                               : prop->propagateToX(tracksBatch, xRef, prop->getNominalBz(), status, o2::constants::physics::MassPionCharged, 0.85, 2., matCorr, ltBatch);
+      swBatch.Stop();
+
+      LOG(INFO) << (useBxByBz ? "PropagateToXBxByBz" : "propagateToX") << " with matCorr " << matCorr << ": " << nOKBatch << " of " << nTracks << " tracks propagated, scalar loop: "
+                << swScalar.CpuTime() << " s, batched: " << swBatch.CpuTime() << " s";
+      BOOST_CHECK(nOKBatch == nOKScalar);
+      BOOST_CHECK(nOKBatch > 0 && nOKBatch < nTracks);
+      int nDiff = 0, nWithMaterial = 0;
+      for (int i = 0; i < nTracks; i++) {
+        bool same = (status[i] == Propagator::BatchOK) == bool(statusScalar[i]) &&
+                    tracksBatch[i].getX() == tracksScalar[i].getX() &&
+                    !std::memcmp(tracksBatch[i].getParams(), tracksScalar[i].getParams(), 5 * sizeof(float)) &&
+                    !std::memcmp(tracksBatch[i].getCov(), tracksScalar[i].getCov(), 15 * sizeof(float)) &&
+                    ltBatch[i].getL() == ltScalar[i].getL() && ltBatch[i].getX2X0() == ltScalar[i].getX2X0();
+        nDiff += !same;
+        nWithMaterial += ltScalar[i].getX2X0() > 0.f;
+      }
+      BOOST_CHECK(nDiff == 0);
+      if (matCorr == Propagator::USEMatCorrLUT) {
+        BOOST_CHECK(nWithMaterial > 0);
+      }
+    }
+  }
+  prop->setMatLUT(nullptr);
+}
+
+} // namespace base
+} // namespace o2
@@ -12,6 +12,8 @@
 /// \brief Definition of the CPV cluster finder
 #ifndef ALICEO2_CPV_CLUSTERER_H
 #define ALICEO2_CPV_CLUSTERER_H
+#include <memory>
+#include <vector>
 #include "DataFormatsCPV/Digit.h"
 #include "DataFormatsCPV/Cluster.h"
 #include "CPVReconstruction/FullCluster.h"
@@ -32,11 +34,17 @@ class Clusterer
   ~Clusterer() = default;
 
   void initialize();
+  /// Number of threads used to clusterize the trigger records of a TF in parallel
+  void setNThreads(int n) { mNThreads = n > 0 ? n : 1; }
+  int getNThreads() const { return mNThreads; }
+
   void process(gsl::span<const Digit> digits, gsl::span<const TriggerRecord> dtr,
                const o2::dataformats::MCTruthContainer<o2::MCCompLabel>* dmc,
                std::vector<Cluster>* clusters, std::vector<TriggerRecord>* rigRec,
                o2::dataformats::MCTruthContainer<o2::MCCompLabel>* cluMC);
 
+  /// Collect the digits of the event in clusters of neighbours. The digits are taken in increasing
+  /// absId order, so the clusters do not depend on the order of the input digits.
   void makeClusters(gsl::span<const Digit> digits);
   void evalCluProperties(gsl::span<const Digit> digits, std::vector<Cluster>* clusters,
                          const o2::dataformats::MCTruthContainer<o2::MCCompLabel>* dmc,
@@ -48,6 +56,11 @@ class Clusterer
   void unfoldOneCluster(FullCluster& iniClu, char nMax, gsl::span<int> digitId, gsl::span<const Digit> digits);
 
  protected:
+  /// Clusterize the digits from mFirstDigitInEvent to mLastDigitInEvent, appending to @a clusters and @a cluMC
+  void processEvent(gsl::span<const Digit> digits, const o2::dataformats::MCTruthContainer<o2::MCCompLabel>* dmc,
+                    std::vector<Cluster>* clusters, o2::dataformats::MCTruthContainer<o2::MCCompLabel>* cluMC);
+  void loadCalibration();
+
   //Calibrate Amplitude
   inline float calibrate(float amp, short absId) { return amp * mCalibParams->getGain(absId); }
   //Test Bad map
@@ -64,6 +77,15 @@ class Clusterer
   int mLastDigitInEvent;              ///< Range of digits from one event
   std::vector<Digit> mDigits;         ///< vector of trancient digits for cell processing
 
+  int mNThreads = 1;                                 ///< number of threads for trigger record parallelism
+  std::vector<int> mDigitOrder;                      //! digits of the event in increasing absId order, see makeClusters
+  std::vector<int> mAbsIdToDigit;                    //! occupancy map: first digit of the event with a given absId, -1 if none
+  std::vector<int> mNextDigitSameAbsId;              //! next digit of the event with the same absId, -1 if none
+  std::vector<float> mDigitEnergy;                   //! calibrated energies of the digits of the event, 0 for bad channels
+  std::vector<bool> mDigitUsed;                      //! digits of the event already assigned to a cluster
+  std::vector<int> mNeighbourDigits;                 //! transient list of neighbour digits to be added to a cluster
+  std::vector<std::unique_ptr<Clusterer>> mThreads; //! clusterers used by the extra threads
+
   std::vector<std::vector<float>> meInClusters = std::vector<std::vector<float>>(10, std::vector<float>(NLMMax));
   std::vector<std::vector<float>> mfij = std::vector<std::vector<float>>(10, std::vector<float>(NLMMax));
 };
@@ -23,6 +23,7 @@ void ClusterizerSpec::init(framework::InitContext& ctx)
 
   // Initialize clusterizer and link geometry
   mClusterizer.initialize();
+  mClusterizer.setNThreads(ctx.options().get<int>("nthreads"));
 }
 
 void ClusterizerSpec::run(framework::ProcessingContext& ctx)
@@ -76,5 +77,7 @@ o2::framework::DataProcessorSpec o2::cpv::reco_workflow::getClusterizerSpec(bool
   return o2::framework::DataProcessorSpec{"CPVClusterizerSpec",
                                           inputs,
                                           outputs,
-                                          o2::framework::adaptFromTask<o2::cpv::reco_workflow::ClusterizerSpec>(propagateMC)};
+                                          o2::framework::adaptFromTask<o2::cpv::reco_workflow::ClusterizerSpec>(propagateMC),
+                                          o2::framework::Options{
+                                            {"nthreads", o2::framework::VariantType::Int, 1, {"number of threads clusterizing trigger records in parallel"}}}};
 }
@@ -13,11 +13,13 @@
 #include <iosfwd>
 #include <array>
 #include <optional>
+#include <vector>
 #include <Rtypes.h>
 #include <gsl/span>
 #include "EMCALReconstruction/CaloFitResults.h"
 #include "DataFormatsEMCAL/Constants.h"
 #include "EMCALReconstruction/Bunch.h"
+#include "EMCALReconstruction/Channel.h"
 
 namespace o2
 {
@@ -43,7 +45,35 @@ class CaloRawFitter
   CaloRawFitter(const char* name, const char* nameshort);
 
   /// \brief Destructor
-  ~CaloRawFitter() = default;
+  virtual ~CaloRawFitter() = default;
+
+  /// \brief Evaluation Amplitude and TOF
+  ///
+  /// Selects the samples around the maximum and fits them with the fit
+  /// kernel of the concrete fitter (fitRaw). The maximum sample is used
+  /// instead if the fit is not possible (overflow, too few samples), fails,
+  /// or is too far from it.
+  /// return Container with the fit results (amp, time, chi2, ...)
+  CaloFitResults evaluate(const std::vector<Bunch>& bunchvector,
+                          std::optional<unsigned int> altrocfg1,
+                          std::optional<unsigned int> altrocfg2);
+
+  /// \brief Evaluation of all the channels of a payload in one go
+  ///
+  /// Same results as evaluate called for each channel. Fitters able to fit
+  /// several pulses at once override it, the default calls evaluate.
+  /// \param channels Channels as found by the AltroDecoder
+  /// \param results Fit results, one per channel, in the same order (cleared first)
+  virtual void evaluateChannels(const std::vector<Channel>& channels,
+                                std::optional<unsigned int> altrocfg1,
+                                std::optional<unsigned int> altrocfg2,
+                                std::vector<CaloFitResults>& results);
+
+  /// \brief Fits the raw signal time distribution, stored in mReversed
+  /// \param ampEstimate Amplitude of the maximum sample
+  /// \param timeEstimate Time bin of the maximum sample
+  /// \return the fit parameters: amplitude, time, chi2, fit status.
+  virtual std::tuple<float, float, float, bool> fitRaw(int firstTimeBin, int lastTimeBin, float ampEstimate, float timeEstimate) const = 0;
 
   /// \brief Method to do the selection of what should possibly be fitted.
   /// \return Size of the sub-selected sample,
@@ -128,6 +158,13 @@ class CaloRawFitter
                        double tau = 2.35) const;
 
  protected:
+  /// \brief Checks the fit results against the estimates from the maximum sample, falls back to them if needed
+  /// \param time Fitted time, in time bins
+  /// \param fitDone Whether the fit converged
+  /// \return Container with the fit results, in ns for the time, or empty if below the amplitude cut
+  CaloFitResults finalizeFitResults(float amp, float time, float chi2, int ndf, bool fitDone,
+                                    float ampEstimate, float timeEstimate, float pedEstimate);
+
   std::array<double, constants::EMCAL_MAXTIMEBINS> mReversed; ///< Reversed sequence of samples (pedestalsubtracted)
 
   int mMinTimeIndex; ///< The timebin of the max signal value must be between fMinTimeIndex and fMaxTimeIndex
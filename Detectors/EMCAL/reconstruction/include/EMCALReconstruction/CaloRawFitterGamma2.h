@@ -0,0 +1,134 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef EMCALRAWFITTERGAMMA2_H_
+#define EMCALRAWFITTERGAMMA2_H_
+
+#include <iosfwd>
+#include <array>
+#include <optional>
+#include <tuple>
+#include <vector>
+#include <Rtypes.h>
+#include "EMCALReconstruction/CaloFitResults.h"
+#include "DataFormatsEMCAL/Constants.h"
+#include "EMCALReconstruction/Bunch.h"
+#include "EMCALReconstruction/Channel.h"
+#include "EMCALReconstruction/CaloRawFitter.h"
+
+namespace o2
+{
+
+namespace emcal
+{
+
+/// \class CaloRawFitterGamma2
+/// \brief  Raw data fitting: Gamma-2 fit with a linearised least square method
+/// \ingroup EMCALreconstruction
+///
+/// Fits the same response function as CaloRawFitterStandard, with tau
+/// and the order fixed and no pedestal, but without TGraph / TF1. The
+/// amplitude and peak time are obtained with a few Gauss-Newton
+/// iterations, starting from the maximum sample, working directly on the
+/// reversed samples. Meant for the online reconstruction, where the
+/// Minuit based fit is far too slow.
+///
+/// evaluateChannels fits all the pulses of a payload together: the
+/// samples are stored time bin by time bin, and each Gauss-Newton
+/// iteration runs over the pulses in the innermost loop, without branches
+/// and with a single exponential per pulse, such that it can be
+/// vectorised. A single pulse (evaluate) goes through the same code.
+class CaloRawFitterGamma2 : public CaloRawFitter
+{
+
+ public:
+  /// \brief Constructor
+  CaloRawFitterGamma2();
+
+  /// \brief Destructor
+  ~CaloRawFitterGamma2() = default;
+
+  void setNiterationsMax(int n) { mNiterationsMax = n; }
+  void setTimeTolerance(double tol) { mTimeTolerance = tol; }
+
+  int getNiterationsMax() const { return mNiterationsMax; }
+  double getTimeTolerance() const { return mTimeTolerance; }
+
+  /// \brief Evaluation of all the channels of a payload, fitting them together
+  /// \param channels Channels as found by the AltroDecoder
+  /// \param results Fit results, one per channel, in the same order (cleared first)
+  void evaluateChannels(const std::vector<Channel>& channels,
+                        std::optional<unsigned int> altrocfg1,
+                        std::optional<unsigned int> altrocfg2,
+                        std::vector<CaloFitResults>& results) final;
+
+  /// \brief Fits the raw signal time distribution
+  /// \param ampEstimate Starting value for the amplitude
+  /// \param timeEstimate Starting value for the peak time (timebin)
+  /// \return the fit parameters: amplitude, time, chi2, fit status.
+  std::tuple<float, float, float, bool> fitRaw(int firstTimeBin, int lastTimeBin, float ampEstimate, float timeEstimate) const final;
+
+ private:
+  int mNiterationsMax = 10;    ///< Maximum number of Gauss-Newton iterations
+  double mTimeTolerance = 1e-3; ///< Convergence criterion on the time step (in timebins)
+
+  /// \struct FitBatch
+  /// \brief Pulses fitted together, one entry per pulse in each vector
+  struct FitBatch {
+    enum Status : char { kRunning, kConverged, kFailed };
+    static constexpr int kBlockSize = 8; ///< Number of pulses iterated together
+
+    /// \brief Empties the batch and makes room for capacity pulses, rounded up to a number of blocks
+    void reset(int capacity);
+    /// \brief Adds the samples [first, last] of a pulse, with the starting values of the fit
+    void add(const std::array<double, constants::EMCAL_MAXTIMEBINS>& reversed, int first, int last, float ampEstimate, float timeEstimate);
+
+    int size = 0;                     ///< Number of pulses
+    int stride = 0;                   ///< Maximum number of pulses
+    std::vector<double> samples;      ///< Samples, time bin x of pulse i at x * stride + i
+    std::vector<double> weights;      ///< 1 for the time bins in the fit range, 0 otherwise, as samples
+    std::vector<int> first;           ///< First time bin of the fit range
+    std::vector<int> last;            ///< Last time bin of the fit range
+    std::vector<double> ampEstimate;  ///< Starting value for the amplitude
+    std::vector<double> timeEstimate; ///< Starting value for the peak time (timebin)
+    std::vector<double> amp;          ///< Fitted amplitude
+    std::vector<double> time;         ///< Fitted peak time (timebin)
+    std::vector<double> chi2;         ///< Chi2 of the fit
+    std::vector<char> status;         ///< Status of the fit
+  };
+
+  /// \brief Gauss-Newton fit of all the pulses of mBatch
+  void fitBatch() const;
+
+  /// \brief Gauss-Newton fit of the pulses [start, start + N) of mBatch, iterated together
+  template <int N>
+  void fitBlock(int start) const;
+
+  /// \struct PendingChannel
+  /// \brief What evaluateChannels needs to finalize a channel once fitted
+  struct PendingChannel {
+    int index;          ///< Position of the channel in the payload
+    int timebinOffset;  ///< Offset of the time bins of the selected bunch
+    float ampEstimate;  ///< Maximum sample
+    float timeEstimate; ///< Time bin of the maximum sample
+    float pedEstimate;  ///< Pedestal
+    int ndf;            ///< Number of degrees of freedom of the fit
+  };
+
+  mutable FitBatch mBatch;                      //! Work space of fitBatch, reused to avoid allocations
+  std::vector<PendingChannel> mPendingChannels; //! Channels of the payload in mBatch
+
+  ClassDefNV(CaloRawFitterGamma2, 1);
+}; // End of CaloRawFitterGamma2
+
+} // namespace emcal
+
+} // namespace o2
+#endif
@@ -55,16 +55,13 @@ class CaloRawFitterStandard : public CaloRawFitter
   /// \return double with signal for a given time bin
   static double rawResponseFunction(double* x, double* par);
 
-  /// \brief Evaluation Amplitude and TOF
-  /// return Container with the fit results (amp, time, chi2, ...)
-  virtual CaloFitResults evaluate(const std::vector<Bunch>& bunchvector,
-                                  std::optional<unsigned int> altrocfg1,
-                                  std::optional<unsigned int> altrocfg2);
-
   /// \brief Fits the raw signal time distribution
   /// \return the fit parameters: amplitude, time, chi2, fit status.
   std::tuple<float, float, float, bool> fitRaw(int firstTimeBin, int lastTimeBin) const;
 
+  /// \brief Fit kernel for CaloRawFitter::evaluate, the estimates are not used
+  std::tuple<float, float, float, bool> fitRaw(int firstTimeBin, int lastTimeBin, float ampEstimate, float timeEstimate) const final;
+
  private:
   ClassDefNV(CaloRawFitterStandard, 1);
 }; // End of CaloRawFitterStandard
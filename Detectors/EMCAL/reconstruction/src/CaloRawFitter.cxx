@@ -12,6 +12,7 @@
 /// \author Hadi Hassan (hadi.hassan@cern.ch)
 
 #include "FairLogger.h"
+#include <random>
 #include <gsl/span>
 
 // ROOT sytem
@@ -19,6 +20,7 @@
 
 #include "EMCALReconstruction/Bunch.h"
 #include "EMCALReconstruction/CaloFitResults.h"
+#include "EMCALReconstruction/Channel.h"
 #include "DataFormatsEMCAL/Constants.h"
 
 #include "EMCALReconstruction/CaloRawFitter.h"
@@ -287,3 +289,69 @@ std::tuple<int, int, float, short, short, float, int, int> CaloRawFitter::preFit
 
   return std::make_tuple(nsamples, index, maxf, maxamp, maxrev, ped, first, last);
 }
+
+CaloFitResults CaloRawFitter::evaluate(const std::vector<Bunch>& bunchlist,
+                                       std::optional<unsigned int> altrocfg1, std::optional<unsigned int> altrocfg2)
+{
+
+  float time = 0;
+  float amp = 0;
+  float chi2 = 0;
+  int ndf = 0;
+  bool fitDone = kFALSE;
+
+  auto [nsamples, bunchIndex, ampEstimate,
+        maxADC, timeEstimate, pedEstimate, first, last] = preFitEvaluateSamples(bunchlist, altrocfg1, altrocfg2, mAmpCut);
+
+  if (ampEstimate >= mAmpCut) {
+    time = timeEstimate;
+    int timebinOffset = bunchlist.at(bunchIndex).getStartTime() - (bunchlist.at(bunchIndex).getBunchLength() - 1);
+    amp = ampEstimate;
+
+    if (nsamples > 1 && maxADC < constants::OVERFLOWCUT) {
+      std::tie(amp, time, chi2, fitDone) = fitRaw(first, last, ampEstimate, timeEstimate);
+      time += timebinOffset;
+      timeEstimate += timebinOffset;
+      ndf = nsamples - 2;
+    }
+  }
+  return finalizeFitResults(amp, time, chi2, ndf, fitDone, ampEstimate, timeEstimate, pedEstimate);
+}
+
+void CaloRawFitter::evaluateChannels(const std::vector<Channel>& channels,
+                                     std::optional<unsigned int> altrocfg1, std::optional<unsigned int> altrocfg2,
+                                     std::vector<CaloFitResults>& results)
+{
+  results.clear();
+  results.reserve(channels.size());
+  for (const auto& channel : channels) {
+    results.emplace_back(evaluate(channel.getBunches(), altrocfg1, altrocfg2));
+  }
+}
+
+CaloFitResults CaloRawFitter::finalizeFitResults(float amp, float time, float chi2, int ndf, bool fitDone,
+                                                 float ampEstimate, float timeEstimate, float pedEstimate)
+{
+  if (fitDone) {
+    float ampAsymm = (amp - ampEstimate) / (amp + ampEstimate);
+    float timeDiff = time - timeEstimate;
+
+    if ((TMath::Abs(ampAsymm) > 0.1) || (TMath::Abs(timeDiff) > 2)) {
+      amp = ampEstimate;
+      time = timeEstimate;
+      fitDone = kFALSE;
+    }
+  }
+  if (amp >= mAmpCut) {
+    if (!fitDone) {
+      std::default_random_engine generator;
+      std::uniform_real_distribution<float> distribution(0.0, 1.0);
+      amp += (0.5 - distribution(generator));
+    }
+    time = time * constants::EMCAL_TIMESAMPLE;
+    time -= mL1Phase;
+
+    return CaloFitResults(-99, pedEstimate, mAlgo, amp, time, (int)time, chi2, ndf);
+  }
+  return CaloFitResults(-1, -1);
+}
@@ -0,0 +1,243 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file CaloRawFitterGamma2.cxx
+
+#include "FairLogger.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+// ROOT sytem
+#include "TMath.h"
+
+#include "EMCALReconstruction/Bunch.h"
+#include "EMCALReconstruction/CaloFitResults.h"
+#include "EMCALReconstruction/Channel.h"
+#include "DataFormatsEMCAL/Constants.h"
+
+#include "EMCALReconstruction/CaloRawFitterGamma2.h"
+
+using namespace o2::emcal;
+
+CaloRawFitterGamma2::CaloRawFitterGamma2() : CaloRawFitter("Chi Square ( Gamma2 )", "Gamma2")
+{
+  mAlgo = FitAlgorithm::Gamma2;
+}
+
+void CaloRawFitterGamma2::evaluateChannels(const std::vector<Channel>& channels,
+                                           std::optional<unsigned int> altrocfg1, std::optional<unsigned int> altrocfg2,
+                                           std::vector<CaloFitResults>& results)
+{
+  results.clear();
+  results.resize(channels.size());
+  mBatch.reset(channels.size());
+  mPendingChannels.clear();
+
+  // select the samples of each channel, as in evaluate, and put aside those to be fitted
+  for (int ichan = 0; ichan < channels.size(); ichan++) {
+    const auto& bunchlist = channels[ichan].getBunches();
+    auto [nsamples, bunchIndex, ampEstimate,
+          maxADC, timeEstimate, pedEstimate, first, last] = preFitEvaluateSamples(bunchlist, altrocfg1, altrocfg2, mAmpCut);
+
+    float time = 0;
+    float amp = 0;
+    if (ampEstimate >= mAmpCut) {
+      time = timeEstimate;
+      int timebinOffset = bunchlist.at(bunchIndex).getStartTime() - (bunchlist.at(bunchIndex).getBunchLength() - 1);
+      amp = ampEstimate;
+
+      if (nsamples > 1 && maxADC < constants::OVERFLOWCUT) {
+        mBatch.add(mReversed, first, last, ampEstimate, timeEstimate);
+        mPendingChannels.push_back({ichan, timebinOffset, ampEstimate, float(timeEstimate), pedEstimate, nsamples - 2});
+        continue;
+      }
+    }
+    results[ichan] = finalizeFitResults(amp, time, 0, 0, false, ampEstimate, timeEstimate, pedEstimate);
+  }
+
+  fitBatch();
+
+  for (int ifit = 0; ifit < mPendingChannels.size(); ifit++) {
+    const auto& pending = mPendingChannels[ifit];
+    bool fitDone = mBatch.status[ifit] == FitBatch::kConverged;
+    float amp = fitDone ? mBatch.amp[ifit] : 0;
+    float time = fitDone ? mBatch.time[ifit] : 0;
+    float chi2 = fitDone ? mBatch.chi2[ifit] : 0;
+    results[pending.index] = finalizeFitResults(amp, time + pending.timebinOffset, chi2, pending.ndf, fitDone,
+                                                pending.ampEstimate, pending.timeEstimate + pending.timebinOffset, pending.pedEstimate);
+  }
+}
+
+std::tuple<float, float, float, bool> CaloRawFitterGamma2::fitRaw(int firstTimeBin, int lastTimeBin, float ampEstimate, float timeEstimate) const
+{
+  mBatch.reset(1);
+  mBatch.add(mReversed, firstTimeBin, lastTimeBin, ampEstimate, timeEstimate);
+  fitBatch();
+
+  if (mBatch.status[0] != FitBatch::kConverged)
+    return std::make_tuple(0.f, 0.f, 0.f, false);
+
+  return std::make_tuple(float(mBatch.amp[0]), float(mBatch.time[0]), float(mBatch.chi2[0]), true);
+}
+
+void CaloRawFitterGamma2::FitBatch::reset(int capacity)
+{
+  size = 0;
+  stride = (capacity + kBlockSize - 1) / kBlockSize * kBlockSize;
+  samples.resize(constants::EMCAL_MAXTIMEBINS * stride);
+  weights.assign(constants::EMCAL_MAXTIMEBINS * stride, 0.);
+  for (auto* v : {&ampEstimate, &timeEstimate, &amp, &time, &chi2}) {
+    v->resize(stride);
+  }
+  first.resize(stride);
+  last.resize(stride);
+  status.resize(stride);
+}
+
+void CaloRawFitterGamma2::FitBatch::add(const std::array<double, constants::EMCAL_MAXTIMEBINS>& reversed, int firstTimeBin, int lastTimeBin,
+                                        float ampStart, float timeStart)
+{
+  for (int x = 0; x < constants::EMCAL_MAXTIMEBINS; x++) {
+    bool inFit = x >= firstTimeBin && x <= lastTimeBin;
+    samples[x * stride + size] = inFit ? reversed[x] : 0.;
+    weights[x * stride + size] = inFit ? 1. : 0.;
+  }
+  first[size] = firstTimeBin;
+  last[size] = lastTimeBin;
+  ampEstimate[size] = ampStart;
+  timeEstimate[size] = timeStart;
+  size++;
+}
+
+namespace
+{
+// Response amp * g(xx), with g(xx) = xx^2 * exp(2 * (1 - xx)) and
+// xx = (x - time + tau) / tau, see CaloRawFitterStandard::rawResponseFunction.
+// exp(2 * (1 - xx)) = exp(2 * time / tau) * exp(-2 * x / tau): the first
+// factor is computed once per pulse, the second one is tabulated here.
+const std::array<double, constants::EMCAL_MAXTIMEBINS> expTimeBin = [] {
+  std::array<double, constants::EMCAL_MAXTIMEBINS> table;
+  for (int x = 0; x < constants::EMCAL_MAXTIMEBINS; x++) {
+    table[x] = TMath::Exp(-2. * x / constants::TAU);
+  }
+  return table;
+}();
+} // namespace
+
+void CaloRawFitterGamma2::fitBatch() const
+{
+  if (mBatch.size == 1) {
+    fitBlock<1>(0);
+  } else {
+    for (int start = 0; start < mBatch.size; start += FitBatch::kBlockSize) {
+      fitBlock<FitBatch::kBlockSize>(start);
+    }
+  }
+
+  // chi2 of the converged fits, as CaloRawFitter::calculateChi2
+  const double tau = constants::TAU;
+  auto& b = mBatch;
+  for (int i = 0; i < b.size; i++) {
+    b.chi2[i] = 0;
+    if (b.status[i] != FitBatch::kConverged) {
+      continue;
+    }
+    double expTime = TMath::Exp(2 * b.time[i] / tau);
+    for (int x = b.first[i]; x <= b.last[i]; x++) {
+      double xx = (x - b.time[i] + tau) / tau;
+      double f = xx > 0 ? b.amp[i] * xx * xx * expTime * expTimeBin[x] : 0.;
+      double dy = b.samples[x * b.stride + i] - f;
+      b.chi2[i] += dy * dy;
+    }
+  }
+}
+
+template <int N>
+void CaloRawFitterGamma2::fitBlock(int start) const
+{
+  // At each iteration the response is linearised in (amp, time) and the
+  // resulting 2x2 normal equations are solved exactly. The pulses of the
+  // block are in the innermost loop, which has no branches: outside of the
+  // fit range the weights are 0, and before the start of the pulse (xx <= 0)
+  // the response and its derivatives vanish. The pulses beyond the end of
+  // the batch have only null weights and are not fitted.
+  const double tau = constants::TAU;
+  auto& b = mBatch;
+  std::array<double, N> amp, time, expTime, saa, sat, stt, sra, srt;
+  std::array<char, N> status;
+  int nRunning = 0;
+  for (int k = 0; k < N; k++) {
+    int i = start + k;
+    bool inBatch = i < b.size;
+    amp[k] = inBatch ? b.ampEstimate[i] : 0.;
+    time[k] = inBatch ? b.timeEstimate[i] : 0.;
+    status[k] = (inBatch && b.last[i] - b.first[i] + 1 >= 3) ? FitBatch::kRunning : FitBatch::kFailed;
+    nRunning += (status[k] == FitBatch::kRunning);
+  }
+
+  for (int iter = 0; iter < mNiterationsMax && nRunning > 0; iter++) {
+    for (int k = 0; k < N; k++) {
+      expTime[k] = TMath::Exp(2 * time[k] / tau);
+      saa[k] = sat[k] = stt[k] = sra[k] = srt[k] = 0;
+    }
+    for (int x = 0; x < constants::EMCAL_MAXTIMEBINS; x++) {
+      const double* sample = &b.samples[x * b.stride + start];
+      const double* weight = &b.weights[x * b.stride + start];
+      for (int k = 0; k < N; k++) {
+        double xx = (x - time[k] + tau) / tau;
+        xx = 0.5 * (xx + std::abs(xx)); // max(xx, 0), exactly, without a branch
+        double e = weight[k] * expTime[k] * expTimeBin[x];
+        double ja = xx * xx * e;                         // d(response)/d(amp)
+        double jt = -amp[k] * 2 * xx * (1 - xx) * e / tau; // d(response)/d(time)
+        double r = sample[k] - amp[k] * ja;
+        saa[k] += ja * ja;
+        sat[k] += ja * jt;
+        stt[k] += jt * jt;
+        sra[k] += r * ja;
+        srt[k] += r * jt;
+      }
+    }
+
+    for (int k = 0; k < N; k++) {
+      if (status[k] != FitBatch::kRunning) {
+        continue;
+      }
+      double det = saa[k] * stt[k] - sat[k] * sat[k];
+      if (det <= 0) {
+        status[k] = FitBatch::kFailed;
+        nRunning--;
+        continue;
+      }
+      double dAmp = (stt[k] * sra[k] - sat[k] * srt[k]) / det;
+      double dTime = (saa[k] * srt[k] - sat[k] * sra[k]) / det;
+      // do not let a bad linearisation throw the time far off in one step
+      dTime = std::max(-1., std::min(1., dTime));
+      amp[k] += dAmp;
+      time[k] += dTime;
+
+      // same limits as the standard fit
+      int i = start + k;
+      if (amp[k] < 0.5 * b.ampEstimate[i] || amp[k] > 2 * b.ampEstimate[i] || TMath::Abs(time[k] - b.timeEstimate[i]) > 4) {
+        status[k] = FitBatch::kFailed;
+        nRunning--;
+      } else if (TMath::Abs(dTime) < mTimeTolerance) {
+        status[k] = FitBatch::kConverged;
+        nRunning--;
+      }
+    }
+  }
+
+  for (int k = 0; k < N && start + k < b.size; k++) {
+    b.amp[start + k] = amp[k];
+    b.time[start + k] = time[k];
+    b.status[start + k] = (status[k] == FitBatch::kConverged) ? FitBatch::kConverged : FitBatch::kFailed;
+  }
+}
@@ -12,7 +12,6 @@
 /// \author Hadi Hassan (hadi.hassan@cern.ch)
 
 #include "FairLogger.h"
-#include <random>
 
 // ROOT sytem
 #include "TMath.h"
@@ -48,55 +47,6 @@ double CaloRawFitterStandard::rawResponseFunction(double* x, double* par)
   return signal;
 }
 
-CaloFitResults CaloRawFitterStandard::evaluate(const std::vector<Bunch>& bunchlist,
-                                               std::optional<unsigned int> altrocfg1, std::optional<unsigned int> altrocfg2)
-{
-
-  float time = 0;
-  float amp = 0;
-  float chi2 = 0;
-  int ndf = 0;
-  bool fitDone = kFALSE;
-
-  auto [nsamples, bunchIndex, ampEstimate,
-        maxADC, timeEstimate, pedEstimate, first, last] = preFitEvaluateSamples(bunchlist, altrocfg1, altrocfg2, mAmpCut);
-
-  if (ampEstimate >= mAmpCut) {
-    time = timeEstimate;
-    int timebinOffset = bunchlist.at(bunchIndex).getStartTime() - (bunchlist.at(bunchIndex).getBunchLength() - 1);
-    amp = ampEstimate;
-
-    if (nsamples > 1 && maxADC < constants::OVERFLOWCUT) {
-      std::tie(amp, time, chi2, fitDone) = fitRaw(first, last);
-      time += timebinOffset;
-      timeEstimate += timebinOffset;
-      ndf = nsamples - 2;
-    }
-  }
-  if (fitDone) {
-    float ampAsymm = (amp - ampEstimate) / (amp + ampEstimate);
-    float timeDiff = time - timeEstimate;
-
-    if ((TMath::Abs(ampAsymm) > 0.1) || (TMath::Abs(timeDiff) > 2)) {
-      amp = ampEstimate;
-      time = timeEstimate;
-      fitDone = kFALSE;
-    }
-  }
-  if (amp >= mAmpCut) {
-    if (!fitDone) {
-      std::default_random_engine generator;
-      std::uniform_real_distribution<float> distribution(0.0, 1.0);
-      amp += (0.5 - distribution(generator));
-    }
-    time = time * constants::EMCAL_TIMESAMPLE;
-    time -= mL1Phase;
-
-    return CaloFitResults(-99, pedEstimate, mAlgo, amp, time, (int)time, chi2, ndf);
-  }
-  return CaloFitResults(-1, -1);
-}
-
 std::tuple<float, float, float, bool> CaloRawFitterStandard::fitRaw(int firstTimeBin, int lastTimeBin) const
 {
 
@@ -138,3 +88,9 @@ std::tuple<float, float, float, bool> CaloRawFitterStandard::fitRaw(int firstTim
 
   return std::make_tuple(amp, time, chi2, fitDone);
 }
+
+std::tuple<float, float, float, bool> CaloRawFitterStandard::fitRaw(int firstTimeBin, int lastTimeBin, float, float) const
+{
+  // The TMinuit fit starts from its own defaults
+  return fitRaw(firstTimeBin, lastTimeBin);
+}
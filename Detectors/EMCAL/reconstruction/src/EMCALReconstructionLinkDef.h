@@ -29,6 +29,7 @@
 #pragma link C++ class o2::emcal::CaloFitResults + ;
 #pragma link C++ class o2::emcal::CaloRawFitter + ;
 #pragma link C++ class o2::emcal::CaloRawFitterStandard + ;
+#pragma link C++ class o2::emcal::CaloRawFitterGamma2 + ;
 
 //#pragma link C++ namespace o2::emcal+;
 #pragma link C++ class o2::emcal::ClusterizerParameters + ;
@@ -0,0 +1,101 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file benchmark_CaloRawFitter.cxx
+/// \brief Channels per second of the standard and of the Gamma-2 raw fitters
+
+#include "benchmark/benchmark.h"
+#include "DataFormatsEMCAL/Constants.h"
+#include "EMCALReconstruction/Channel.h"
+#include "EMCALReconstruction/CaloFitResults.h"
+#include "EMCALReconstruction/CaloRawFitterGamma2.h"
+#include "EMCALReconstruction/CaloRawFitterStandard.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace o2::emcal;
+
+namespace
+{
+constexpr int NChannels = 1000;
+
+// zero suppressed channels with a single bunch each, containing a noisy
+// Gamma-2 pulse with random amplitude and peak time
+std::vector<Channel> createChannels()
+{
+  std::mt19937 gen(1234);
+  std::normal_distribution<double> noise(0., 1.);
+  std::uniform_real_distribution<double> amplitude(10., 900.), peak(4., 7.);
+  std::vector<Channel> channels;
+  const int length = constants::EMCAL_MAXTIMEBINS;
+  for (int ichan = 0; ichan < NChannels; ++ichan) {
+    auto& channel = channels.emplace_back(ichan, length);
+    auto& bunch = channel.createBunch(length, length - 1);
+    double amp = amplitude(gen), time = peak(gen);
+    for (int timebin = length - 1; timebin >= 0; --timebin) {
+      double xx = (timebin - time + constants::TAU) / constants::TAU;
+      double signal = xx > 0 ? amp * xx * xx * std::exp(2 * (1 - xx)) : 0.;
+      bunch.addADC(static_cast<uint16_t>(std::max(0., std::round(signal + noise(gen)))));
+    }
+  }
+  return channels;
+}
+} // namespace
+
+static void BM_CaloRawFitterStandard(benchmark::State& state)
+{
+  auto channels = createChannels();
+  CaloRawFitterStandard fitter;
+  fitter.setIsZeroSuppressed(true);
+  fitter.setAmpCut(3);
+  for (auto _ : state) {
+    for (const auto& channel : channels) {
+      benchmark::DoNotOptimize(fitter.evaluate(channel.getBunches(), 0, 0));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NChannels);
+}
+
+static void BM_CaloRawFitterGamma2(benchmark::State& state)
+{
+  auto channels = createChannels();
+  CaloRawFitterGamma2 fitter;
+  fitter.setIsZeroSuppressed(true);
+  fitter.setAmpCut(3);
+  for (auto _ : state) {
+    for (const auto& channel : channels) {
+      benchmark::DoNotOptimize(fitter.evaluate(channel.getBunches(), 0, 0));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NChannels);
+}
+
+static void BM_CaloRawFitterGamma2Channels(benchmark::State& state)
+{
+  auto channels = createChannels();
+  CaloRawFitterGamma2 fitter;
+  fitter.setIsZeroSuppressed(true);
+  fitter.setAmpCut(3);
+  std::vector<CaloFitResults> results;
+  for (auto _ : state) {
+    fitter.evaluateChannels(channels, 0, 0, results);
+    benchmark::DoNotOptimize(results.data());
+  }
+  state.SetItemsProcessed(state.iterations() * NChannels);
+}
+
+BENCHMARK(BM_CaloRawFitterStandard);
+BENCHMARK(BM_CaloRawFitterGamma2);
+BENCHMARK(BM_CaloRawFitterGamma2Channels);
+
+BENCHMARK_MAIN();
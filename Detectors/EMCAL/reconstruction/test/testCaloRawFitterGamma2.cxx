@@ -0,0 +1,149 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test EMCAL Reconstruction
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "DataFormatsEMCAL/Constants.h"
+#include "EMCALReconstruction/Bunch.h"
+#include "EMCALReconstruction/CaloFitResults.h"
+#include "EMCALReconstruction/Channel.h"
+#include "EMCALReconstruction/CaloRawFitterGamma2.h"
+#include "EMCALReconstruction/CaloRawFitterStandard.h"
+
+using namespace o2::emcal;
+
+namespace
+{
+/// A zero suppressed bunch with a Gamma-2 pulse of amplitude @a amp peaking
+/// at @a time (in time bins), plus gaussian noise, truncated to the ADC
+/// range. Like in the raw data, the samples are stored in reversed order and
+/// the bunch only covers the samples above the zero suppression threshold,
+/// with @a presamples before the first of them.
+Bunch makeBunch(double amp, double time, double noise, std::mt19937& rng, int threshold = 3, int presamples = 1)
+{
+  std::normal_distribution<double> gaus(0., noise);
+  const int length = constants::EMCAL_MAXTIMEBINS;
+  std::array<uint16_t, constants::EMCAL_MAXTIMEBINS> samples;
+  for (int i = 0; i < length; i++) {
+    double xx = (i - time + constants::TAU) / constants::TAU;
+    double signal = xx > 0 ? amp * xx * xx * std::exp(2 * (1 - xx)) : 0.;
+    samples[i] = static_cast<uint16_t>(std::clamp(std::round(signal + gaus(rng)), 0., 1023.));
+  }
+  int first = 0, last = length - 1;
+  while (first < length - 1 && samples[first] < threshold) {
+    first++;
+  }
+  while (last > first && samples[last] < threshold) {
+    last--;
+  }
+  first = std::max(0, first - presamples);
+  Bunch bunch(last - first + 1, last);
+  for (int i = last; i >= first; i--) {
+    bunch.addADC(samples[i]);
+  }
+  return bunch;
+}
+} // namespace
+
+/// \macro Test implementation of the linearised Gamma-2 raw fitter
+///
+/// Test coverage:
+/// - Amplitude and time of each pulse agree with the standard (TMinuit)
+///   fitter, since both minimise the same chi2
+/// - Overflowing pulses, which are not fitted, give the same results
+/// - Resolution not worse than the one of the standard fitter
+BOOST_AUTO_TEST_CASE(CaloRawFitterGamma2_test)
+{
+  CaloRawFitterGamma2 fitter;
+  fitter.setIsZeroSuppressed(true);
+  fitter.setAmpCut(3);
+  CaloRawFitterStandard standard;
+  standard.setIsZeroSuppressed(true);
+  standard.setAmpCut(3);
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> ampDist(50., 900.), timeDist(4., 7.);
+  double sumAmpGamma2 = 0, sumTimeGamma2 = 0, sumAmpStandard = 0, sumTimeStandard = 0;
+  const int ntrials = 500;
+  for (int i = 0; i < ntrials; i++) {
+    double amp = ampDist(rng), time = timeDist(rng);
+    std::vector<Bunch> bunches{makeBunch(amp, time, 1., rng)};
+
+    auto result = fitter.evaluate(bunches, 0, 0);
+    auto reference = standard.evaluate(bunches, 0, 0);
+    BOOST_CHECK_CLOSE_FRACTION(result.getAmp(), reference.getAmp(), 0.01);
+    BOOST_CHECK_SMALL(result.getTime() - reference.getTime(), 2.);
+    BOOST_CHECK_EQUAL(result.getNdf(), reference.getNdf());
+
+    BOOST_CHECK_SMALL((result.getAmp() - amp) / amp, 0.05);
+    BOOST_CHECK_SMALL(result.getTime() - time * constants::EMCAL_TIMESAMPLE, 20.);
+    sumAmpGamma2 += std::pow((result.getAmp() - amp) / amp, 2);
+    sumTimeGamma2 += std::pow(result.getTime() - time * constants::EMCAL_TIMESAMPLE, 2);
+    sumAmpStandard += std::pow((reference.getAmp() - amp) / amp, 2);
+    sumTimeStandard += std::pow(reference.getTime() - time * constants::EMCAL_TIMESAMPLE, 2);
+  }
+  BOOST_TEST_MESSAGE("Relative amplitude resolution: Gamma2 " << std::sqrt(sumAmpGamma2 / ntrials) << ", Standard " << std::sqrt(sumAmpStandard / ntrials));
+  BOOST_TEST_MESSAGE("Time resolution (ns): Gamma2 " << std::sqrt(sumTimeGamma2 / ntrials) << ", Standard " << std::sqrt(sumTimeStandard / ntrials));
+  BOOST_CHECK_LE(sumAmpGamma2, 1.05 * sumAmpStandard);
+  BOOST_CHECK_LE(sumTimeGamma2, 1.05 * sumTimeStandard);
+
+  // Overflow: no fit, both use the maximum sample
+  for (int i = 0; i < 10; i++) {
+    std::vector<Bunch> bunches{makeBunch(1000. + 100. * i, timeDist(rng), 1., rng)};
+    auto result = fitter.evaluate(bunches, 0, 0);
+    auto reference = standard.evaluate(bunches, 0, 0);
+    BOOST_CHECK_EQUAL(result.getNdf(), 0);
+    BOOST_CHECK_EQUAL(result.getAmp(), reference.getAmp());
+    BOOST_CHECK_EQUAL(result.getTime(), reference.getTime());
+  }
+}
+
+/// \macro Test of the fit of all the channels of a payload together
+///
+/// Test coverage:
+/// - evaluateChannels gives the same results as evaluate for each channel,
+///   for fitted, overflowing, below threshold and empty channels
+BOOST_AUTO_TEST_CASE(CaloRawFitterGamma2_channels_test)
+{
+  CaloRawFitterGamma2 fitter;
+  fitter.setIsZeroSuppressed(true);
+  fitter.setAmpCut(3);
+
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> ampDist(1., 1200.), timeDist(4., 7.);
+  std::vector<Channel> channels;
+  for (int ichan = 0; ichan < 300; ichan++) {
+    auto& channel = channels.emplace_back(ichan, constants::EMCAL_MAXTIMEBINS);
+    if (ichan % 50 != 0) {
+      channel.addBunch(makeBunch(ampDist(rng), timeDist(rng), 1., rng));
+    }
+  }
+
+  std::vector<CaloFitResults> results;
+  fitter.evaluateChannels(channels, 0, 0, results);
+  BOOST_REQUIRE_EQUAL(results.size(), channels.size());
+  int nfitted = 0;
+  for (int ichan = 0; ichan < channels.size(); ichan++) {
+    auto reference = fitter.evaluate(channels[ichan].getBunches(), 0, 0);
+    BOOST_CHECK_EQUAL(results[ichan].getMaxSig(), reference.getMaxSig());
+    BOOST_CHECK_EQUAL(results[ichan].getNdf(), reference.getNdf());
+    BOOST_CHECK_CLOSE_FRACTION(results[ichan].getAmp(), reference.getAmp(), 1e-6);
+    BOOST_CHECK_CLOSE_FRACTION(results[ichan].getTime(), reference.getTime(), 1e-6);
+    BOOST_CHECK_CLOSE_FRACTION(results[ichan].getChi2(), reference.getChi2(), 1e-6);
+    nfitted += (results[ichan].getNdf() > 0);
+  }
+  BOOST_CHECK_GT(nfitted, 0);
+}
@@ -145,8 +145,17 @@ class MatchTOF
   ///< get number of sigma used to do the matching
   float getSigmaTimeCut() const { return mSigmaTimeCut; }
 
+  ///< find the crossed strips by intersecting the tracks with the cached strip planes instead of stepping through the TOF volume
+  void setUseStripPlanes(bool v) { mUseStripPlanes = v; }
+  bool getUseStripPlanes() const { return mUseStripPlanes; }
+
+  ///< set number of threads used to match the sectors (<1: rely on openMP default)
+  void setNThreads(int n) { mNThreads = n; }
+  int getNThreads() const { return mNThreads; }
+
   enum DebugFlagTypes : UInt_t {
-    MatchTreeAll = 0x1 << 1, ///< produce matching candidates tree for all candidates
+    MatchTreeAll = 0x1 << 1,     ///< produce matching candidates tree for all candidates
+    CheckStripPlanes = 0x1 << 2, ///< compare the strips found from the strip planes with those found by stepping
   };
   ///< check if partucular flags are set
   bool isDebugFlag(UInt_t flags) const { return mDBGFlags & flags; }
@@ -202,8 +211,15 @@ class MatchTOF
   bool loadTracksNextChunk();
   bool loadTOFClustersNextChunk();
 
+  void doMatchingAllSectors();
   void doMatching(int sec);
   void selectBestMatches();
+  void initStripPlanes();
+  int findCrossedStrips(o2::track::TrackParCov& trc, o2::track::TrackLTIntegral& intLT, int detId[2][5], float deltaPos[2][3], o2::track::TrackLTIntegral trkLTInt[2]) const;
+  int findCrossedStripsStepping(o2::track::TrackParCov& trc, o2::track::TrackLTIntegral& intLT, int detId[2][5], float deltaPos[2][3], o2::track::TrackLTIntegral trkLTInt[2], int nStepsInsideSameStrip[2]);
+#ifdef _ALLOW_TOF_DEBUG_
+  void checkCrossedStrips(o2::track::TrackParCov trc, o2::track::TrackLTIntegral intLT, int nStrips, const int detId[2][5]);
+#endif
   bool propagateToRefX(o2::track::TrackParCov& trc, float xRef /*in cm*/, float stepInCm /*in cm*/, o2::track::TrackLTIntegral& intLT);
   bool propagateToRefXWithoutCov(o2::track::TrackParCov& trc, float xRef /*in cm*/, float stepInCm /*in cm*/, float bz);
 
@@ -268,6 +284,22 @@ class MatchTOF
 
   ///<array of track-TOFCluster pairs from the matching
   std::vector<o2::dataformats::MatchInfoTOF> mMatchedTracksPairs;
+  ///<per sector track-TOFCluster pairs, filled by doMatching (possibly in parallel) and moved one sector at a time to mMatchedTracksPairs
+  std::array<std::vector<o2::dataformats::MatchInfoTOF>, o2::constants::math::NSectors> mMatchedTracksPairsSec; //!
+
+  ///< plane of a TOF strip in the tracking frame of its sector
+  struct StripPlane {
+    int plate = -1;
+    int strip = -1;
+    float center[3] = {0.f, 0.f, 0.f};
+    float axisX[3] = {0.f, 0.f, 0.f}; // direction of increasing pad X index
+    float axisZ[3] = {0.f, 0.f, 0.f}; // direction of increasing pad Z index
+    float normal[3] = {0.f, 0.f, 0.f};
+    float zMin = 0.f; // Z extent of the strip
+    float zMax = 0.f;
+  };
+  ///< per sector planes of the strips, used for the analytic track-strip intersection
+  std::array<std::vector<StripPlane>, o2::constants::math::NSectors> mStripPlanes; //!
 
   ///<array of TOFChannel calibration info
   std::vector<o2::dataformats::CalibInfoTOF> mCalibInfoTOF;
@@ -305,9 +337,12 @@ class MatchTOF
 
   Bool_t mIsworkflowON = kFALSE;
 
+  bool mUseStripPlanes = false; ///< find the crossed strips analytically instead of stepping
+  int mNThreads = 1;            ///< number of threads used to match the sectors
+
   TStopwatch mTimerTot;
   TStopwatch mTimerDBG;
-  ClassDefNV(MatchTOF, 3);
+  ClassDefNV(MatchTOF, 4);
 };
 } // namespace globaltracking
 } // namespace o2
@@ -9,6 +9,8 @@
 // or submit itself to any jurisdiction.
 #include <TTree.h>
 #include <cassert>
+#include <cmath>
+#include <limits>
 
 #include "FairLogger.h"
 #include "Field/MagneticField.h"
@@ -29,6 +31,7 @@
 #include <Math/SVector.h>
 #include <TFile.h>
 #include <TGeoGlobalMagField.h>
+#include <TGeoManager.h>
 #include "DataFormatsParameters/GRPObject.h"
 #include "ReconstructionDataFormats/PID.h"
 #include "ReconstructionDataFormats/TrackLTIntegral.h"
@@ -36,6 +39,10 @@
 #include "GlobalTracking/MatchTOF.h"
 #include "GlobalTracking/MatchTPCITS.h"
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 using namespace o2::globaltracking;
 using timeEst = o2::dataformats::TimeStampWithError<float, float>;
 using evIdx = o2::dataformats::EvIndex<int, int>;
@@ -76,12 +83,7 @@ void MatchTOF::run()
     mTimerTot.Print();
     mTimerTot.Start();
 
-    for (int sec = o2::constants::math::NSectors; sec--;) {
-      LOG(INFO) << "Doing matching for sector " << sec << "...";
-      doMatching(sec);
-      LOG(INFO) << "...done. Now check the best matches";
-      selectBestMatches();
-    }
+    doMatchingAllSectors();
     if (0) { // enabling this creates very verbose output
       mTimerTot.Stop();
       printCandidatesTOF();
@@ -124,12 +126,7 @@ void MatchTOF::run()
     }
     */
 
-    for (int sec = o2::constants::math::NSectors; sec--;) {
-      LOG(INFO) << "Doing matching for sector " << sec << "...";
-      doMatching(sec);
-      LOG(INFO) << "...done. Now check the best matches";
-      selectBestMatches();
-    }
+    doMatchingAllSectors();
     if (0) { // enabling this creates very verbose output
       mTimerTot.Stop();
       printCandidatesTOF();
@@ -541,11 +538,391 @@ bool MatchTOF::loadTOFClustersNextChunk()
   --mCurrTOFClustersTreeEntry;
   return false;
 }
+//______________________________________________
+void MatchTOF::doMatchingAllSectors()
+{
+  ///< do the matching in all sectors, possibly in parallel; the best matches are then selected sector by sector
+  ///< in a fixed order, so that the result does not depend on the number of threads
+
+  if (mStripPlanes[0].empty()) {
+    initStripPlanes(); // this also initializes the TOF geometry before the threads use it
+  }
+
+  int nThreads = mNThreads;
+#ifdef WITH_OPENMP
+  if (nThreads < 1) {
+    nThreads = omp_get_max_threads();
+  }
+#ifdef _ALLOW_TOF_DEBUG_
+  if (mDBGFlags) {
+    nThreads = 1; // the debug streamer cannot be filled from several threads
+  }
+#endif
+  nThreads = std::min(nThreads, int(o2::constants::math::NSectors));
+  if (nThreads > 1 && gGeoManager->GetMaxThreads() < nThreads) {
+    gGeoManager->SetMaxThreads(nThreads); // the material queries of the propagation need a TGeo navigator per thread
+  }
+#else
+  nThreads = 1;
+#endif
+
+  int nTracks = 0;
+  for (const auto& cacheTrk : mTracksSectIndexCache) {
+    nTracks += cacheTrk.size();
+  }
+  int nMatchedBefore = mMatchedTracks.size();
+  TStopwatch timerMatch;
+  timerMatch.Start();
+
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(nThreads)
+#endif
+  for (int sec = 0; sec < o2::constants::math::NSectors; sec++) {
+    if (nThreads > 1 && !gGeoManager->GetCurrentNavigator()) {
+      gGeoManager->AddNavigator();
+    }
+    doMatching(sec);
+  }
+
+  for (int sec = o2::constants::math::NSectors; sec--;) {
+    LOG(INFO) << "Sector " << sec << ": " << mMatchedTracksPairsSec[sec].size() << " matching candidates. Now check the best matches";
+    mMatchedTracksPairs.swap(mMatchedTracksPairsSec[sec]);
+    selectBestMatches();
+  }
+
+  timerMatch.Stop();
+  int nMatched = mMatchedTracks.size() - nMatchedBefore;
+  double time = timerMatch.RealTime();
+  LOG(INFO) << "Matched " << nMatched << " out of " << nTracks << " tracks in " << time << " s with " << nThreads
+            << " thread(s), crossed strips from " << (mUseStripPlanes ? "strip planes" : "stepping") << ": "
+            << (time > 0. ? nTracks / time : 0.) << " tracks/s, " << (time > 0. ? nMatched / time : 0.) << " matches/s";
+}
+
+//______________________________________________
+void MatchTOF::initStripPlanes()
+{
+  ///< cache the planes of the TOF strips in the tracking frame of each sector, from the positions of the pads at their corners
+
+  int det[5];
+  float glo[3], loc[4][3];
+  for (int sec = 0; sec < o2::constants::math::NSectors; sec++) {
+    auto& planes = mStripPlanes[sec];
+    planes.clear();
+    float sn, cs;
+    o2::utils::sincosf(o2::utils::Sector2Angle(sec), sn, cs);
+    det[0] = sec;
+    for (int iplate = 0; iplate < Geo::NPLATES; iplate++) {
+      if (iplate == 2 && (sec == 13 || sec == 14 || sec == 15)) {
+        continue; // PHOS holes
+      }
+      int nstrips = iplate == 2 ? Geo::NSTRIPA : ((iplate == 1 || iplate == 3) ? Geo::NSTRIPB : Geo::NSTRIPC);
+      det[1] = iplate;
+      for (int istrip = 0; istrip < nstrips; istrip++) {
+        det[2] = istrip;
+        for (int icorner = 0; icorner < 4; icorner++) { // padX = 0 and NPADX - 1 for padZ = 0, then for padZ = 1
+          det[3] = icorner >> 1;
+          det[4] = (icorner & 1) ? Geo::NPADX - 1 : 0;
+          Geo::getPos(det, glo);
+          loc[icorner][0] = glo[0] * cs + glo[1] * sn;
+          loc[icorner][1] = -glo[0] * sn + glo[1] * cs;
+          loc[icorner][2] = glo[2];
+        }
+        auto& plane = planes.emplace_back();
+        plane.plate = iplate;
+        plane.strip = istrip;
+        float normX = 0., normZ = 0., proj = 0.;
+        for (int i = 0; i < 3; i++) {
+          plane.center[i] = 0.25f * (loc[0][i] + loc[1][i] + loc[2][i] + loc[3][i]);
+          plane.axisX[i] = loc[1][i] + loc[3][i] - loc[0][i] - loc[2][i];
+          plane.axisZ[i] = loc[2][i] + loc[3][i] - loc[0][i] - loc[1][i];
+          normX += plane.axisX[i] * plane.axisX[i];
+        }
+        normX = 1.f / std::sqrt(normX);
+        for (int i = 0; i < 3; i++) {
+          plane.axisX[i] *= normX;
+          proj += plane.axisX[i] * plane.axisZ[i];
+        }
+        for (int i = 0; i < 3; i++) { // make axisZ orthogonal to axisX
+          plane.axisZ[i] -= proj * plane.axisX[i];
+          normZ += plane.axisZ[i] * plane.axisZ[i];
+        }
+        normZ = 1.f / std::sqrt(normZ);
+        for (int i = 0; i < 3; i++) {
+          plane.axisZ[i] *= normZ;
+        }
+        plane.normal[0] = plane.axisX[1] * plane.axisZ[2] - plane.axisX[2] * plane.axisZ[1];
+        plane.normal[1] = plane.axisX[2] * plane.axisZ[0] - plane.axisX[0] * plane.axisZ[2];
+        plane.normal[2] = plane.axisX[0] * plane.axisZ[1] - plane.axisX[1] * plane.axisZ[0];
+        float halfZ = std::abs(plane.axisX[2]) * Geo::STRIPLENGTH * 0.5f + std::abs(plane.axisZ[2]) * Geo::WCPCBZ * 0.5f;
+        plane.zMin = plane.center[2] - halfZ;
+        plane.zMax = plane.center[2] + halfZ;
+      }
+    }
+  }
+}
+
+//______________________________________________
+int MatchTOF::findCrossedStrips(o2::track::TrackParCov& trc, o2::track::TrackLTIntegral& intLT, int detId[2][5], float deltaPos[2][3], o2::track::TrackLTIntegral trkLTInt[2]) const
+{
+  ///< find the (max 2) strips crossed by the track, intersecting the helix with the cached strip planes of its sector
+  ///< (and of the neighbouring one if the track leaves its sector), then propagate the track to each crossing to get
+  ///< the integrated length and time and the residuals wrt the center of the crossed pad.
+  ///< Return the number of crossed strips
+
+  const int matCorr = 1; // material correction method
+  const float tanHalfSector = tan(o2::constants::math::SectorSpanRad / 2);
+  const float bz = o2::base::Propagator::Instance()->getNominalBz();
+
+  struct Crossing {
+    int pass; // 0 for the sector of the track, 1 for the neighbouring one
+    int sec;
+    int plane;
+    float x;
+  };
+  std::array<Crossing, 8> crossings;
+  int nCrossings = 0;
+
+  int sec = o2::utils::Angle2Sector(trc.getAlpha());
+  o2::track::TrackPar trcSec(trc);
+  for (int pass = 0; pass < 2; pass++) {
+    float yLow, zLow, yUp, zUp;
+    if (!trcSec.getYZAt(Geo::RMIN, bz, yLow, zLow) || !trcSec.getYZAt(Geo::RMAX, bz, yUp, zUp)) {
+      break;
+    }
+    // only the strips overlapping in Z with the track are intersected
+    float zMin = std::min(zLow, zUp) - Geo::WCPCBZ, zMax = std::max(zLow, zUp) + Geo::WCPCBZ;
+    const auto& planes = mStripPlanes[sec];
+    for (int ip = 0; ip < int(planes.size()) && nCrossings < int(crossings.size()); ip++) {
+      const auto& plane = planes[ip];
+      if (plane.zMax < zMin || plane.zMin > zMax) {
+        continue;
+      }
+      // signed distance of the track from the plane at given X, found at 0 by the secant method;
+      // NaN if the track does not reach this X
+      auto dist = [&plane, &trcSec, bz](float x, float& y, float& z) {
+        if (!trcSec.getYZAt(x, bz, y, z)) {
+          return std::numeric_limits<float>::quiet_NaN();
+        }
+        return (x - plane.center[0]) * plane.normal[0] + (y - plane.center[1]) * plane.normal[1] + (z - plane.center[2]) * plane.normal[2];
+      };
+      float x0 = Geo::RMIN, x1 = Geo::RMAX, y, z;
+      float d0 = dist(x0, y, z), d1 = dist(x1, y, z);
+      if (std::isnan(d0) || std::isnan(d1) || d0 * d1 > 0.f) {
+        continue; // the plane is not crossed between RMIN and RMAX
+      }
+      float x = x0;
+      bool reached = true;
+      for (int iter = 0; iter < 10 && std::abs(d1 - d0) > 1.e-6f; iter++) {
+        x = x1 - d1 * (x1 - x0) / (d1 - d0);
+        x0 = x1;
+        d0 = d1;
+        x1 = x;
+        d1 = dist(x1, y, z);
+        if (std::isnan(d1)) {
+          reached = false;
+          break;
+        }
+        if (std::abs(x1 - x0) < 1.e-3f) {
+          break;
+        }
+      }
+      if (!reached || std::isnan(dist(x, y, z))) {
+        continue; // the helix does not reach the crossing
+      }
+      float dx = x - plane.center[0], dy = y - plane.center[1], dz = z - plane.center[2];
+      if (std::abs(dx * plane.axisX[0] + dy * plane.axisX[1] + dz * plane.axisX[2]) > Geo::STRIPLENGTH * 0.5f ||
+          std::abs(dx * plane.axisZ[0] + dy * plane.axisZ[1] + dz * plane.axisZ[2]) > Geo::WCPCBZ * 0.5f) {
+        continue; // outside of the strip
+      }
+      crossings[nCrossings++] = {pass, sec, ip, x};
+    }
+    if (pass || std::abs(yUp) < Geo::RMAX * tanHalfSector) {
+      break; // the track does not go to the neighbouring sector
+    }
+    sec = yUp > 0 ? (sec + 1) % o2::constants::math::NSectors : (sec + o2::constants::math::NSectors - 1) % o2::constants::math::NSectors;
+    if (!trcSec.rotate(o2::utils::Sector2Angle(sec))) {
+      break;
+    }
+  }
+
+  // the crossings are visited in the order in which the track goes through them
+  std::sort(crossings.begin(), crossings.begin() + nCrossings, [](const Crossing& a, const Crossing& b) { return a.pass < b.pass || (a.pass == b.pass && a.x < b.x); });
+
+  int nStripsCrossed = 0;
+  for (int ic = 0; ic < nCrossings && nStripsCrossed < 2; ic++) {
+    const auto& crossing = crossings[ic];
+    const auto& plane = mStripPlanes[crossing.sec][crossing.plane];
+    if (crossing.pass && o2::utils::Angle2Sector(trc.getAlpha()) != crossing.sec && !trc.rotate(o2::utils::Sector2Angle(crossing.sec))) {
+      break;
+    }
+    if (!o2::base::Propagator::Instance()->PropagateToXBxByBz(trc, crossing.x, o2::constants::physics::MassPionCharged, MAXSNP, Geo::RMAX - Geo::RMIN, matCorr, &intLT)) {
+      break;
+    }
+    // position in the strip frame, with the origin at the corner of the pad (0, 0)
+    float dx = trc.getX() - plane.center[0], dy = trc.getY() - plane.center[1], dz = trc.getZ() - plane.center[2];
+    float posX = dx * plane.axisX[0] + dy * plane.axisX[1] + dz * plane.axisX[2] + 0.5f * Geo::NPADX * Geo::XPAD;
+    float posY = dx * plane.normal[0] + dy * plane.normal[1] + dz * plane.normal[2];
+    float posZ = dx * plane.axisZ[0] + dy * plane.axisZ[1] + dz * plane.axisZ[2] + 0.5f * Geo::NPADZ * Geo::ZPAD;
+    int padX = std::max(0, std::min(Geo::NPADX - 1, int(std::floor(posX / Geo::XPAD))));
+    int padZ = std::max(0, std::min(Geo::NPADZ - 1, int(std::floor(posZ / Geo::ZPAD))));
+    detId[nStripsCrossed][0] = crossing.sec;
+    detId[nStripsCrossed][1] = plane.plate;
+    detId[nStripsCrossed][2] = plane.strip;
+    detId[nStripsCrossed][3] = padZ;
+    detId[nStripsCrossed][4] = padX;
+    deltaPos[nStripsCrossed][0] = posX - (padX + 0.5f) * Geo::XPAD;
+    deltaPos[nStripsCrossed][1] = posY;
+    deltaPos[nStripsCrossed][2] = posZ - (padZ + 0.5f) * Geo::ZPAD;
+    trkLTInt[nStripsCrossed] = intLT;
+    nStripsCrossed++;
+  }
+  return nStripsCrossed;
+}
+
+//______________________________________________
+int MatchTOF::findCrossedStripsStepping(o2::track::TrackParCov& trc, o2::track::TrackLTIntegral& intLT, int detId[2][5], float deltaPos[2][3], o2::track::TrackLTIntegral trkLTInt[2], int nStepsInsideSameStrip[2])
+{
+  ///< find the (max 2) strips crossed by the track propagating it in steps of 1 cm through the TOF volume,
+  ///< the residuals being summed up over the steps inside the same strip (nStepsInsideSameStrip).
+  ///< Return the number of crossed strips
+
+  int nStripsCrossedInPropagation = 0; // how many strips were hit during the propagation
+  int istep = 1;                       // number of steps
+  float step = 1.0;                    // step size in cm
+  float deltaPosTemp[3];
+  std::array<float, 3> pos;
+  float posFloat[3];
+  int detIdTemp[5] = {-1, -1, -1, -1, -1}; // TOF detector id at the current propagation point
+
+  double reachedPoint = mXRef + istep * step;
+
+  while (propagateToRefX(trc, reachedPoint, step, intLT) && nStripsCrossedInPropagation <= 2 && reachedPoint < Geo::RMAX) {
+    // while (o2::base::Propagator::Instance()->PropagateToXBxByBz(trc,  mXRef + istep * step, o2::constants::physics::MassPionCharged, MAXSNP, step, 1, &intLT) && nStripsCrossedInPropagation <= 2 && mXRef + istep * step < Geo::RMAX) {
+
+    trc.getXYZGlo(pos);
+    for (int ii = 0; ii < 3; ii++) { // we need to change the type...
+      posFloat[ii] = pos[ii];
+    }
+    // uncomment below only for local debug; this will produce A LOT of output - one print per propagation step
+    /*
+    Printf("posFloat[0] = %f, posFloat[1] = %f, posFloat[2] = %f", posFloat[0], posFloat[1], posFloat[2]);
+    Printf("radius xy = %f", TMath::Sqrt(posFloat[0]*posFloat[0] + posFloat[1]*posFloat[1]));
+    Printf("radius xyz = %f", TMath::Sqrt(posFloat[0]*posFloat[0] + posFloat[1]*posFloat[1] + posFloat[2]*posFloat[2]));
+    */
+
+    for (int idet = 0; idet < 5; idet++)
+      detIdTemp[idet] = -1;
+
+    Geo::getPadDxDyDz(posFloat, detIdTemp, deltaPosTemp);
+
+    if (detIdTemp[2] == -1) {
+      reachedPoint += step;
+      continue;
+    }
+
+    // to reduce the active region of the strip -> uncomment these lines
+    // float yresidual = TMath::Abs(deltaPosTemp[1]);
+    // if(yresidual > 0.55){
+    // 	reachedPoint += step;
+    // 	continue;
+    // }
+
+    //      printf("res %f %f %f -- %f %f %f (%d)\n",deltaPosTemp[0],deltaPosTemp[1],deltaPosTemp[2],pos[0],pos[1],pos[2],detIdTemp[2]);
+
+    // if you want to exit from the strip matched uncomment this line
+    //      reachedPoint += 3.0; // go out from the strip at the next step
+
+    //      printf("idet: %d %d %d %d %d\n",detIdTemp[0],detIdTemp[1],detIdTemp[2],detIdTemp[3],detIdTemp[4]);
+
+    // uncomment below only for local debug; this will produce A LOT of output - one print per propagation step
+    //Printf("detIdTemp[0] = %d, detIdTemp[1] = %d, detIdTemp[2] = %d, detIdTemp[3] = %d, detIdTemp[4] = %d", detIdTemp[0], detIdTemp[1], detIdTemp[2], detIdTemp[3], detIdTemp[4]);
+    // if (nStripsCrossedInPropagation == 0) { // print in case you have a useful propagation
+    //   LOG(DEBUG) << "*********** We have crossed a strip during propagation!*********";
+    //   LOG(DEBUG) << "Global coordinates: pos[0] = " << pos[0] << ", pos[1] = " << pos[1] << ", pos[2] = " << pos[2];
+    //   LOG(DEBUG) << "detIdTemp[0] = " << detIdTemp[0] << ", detIdTemp[1] = " << detIdTemp[1] << ", detIdTemp[2] = " << detIdTemp[2] << ", detIdTemp[3] = " << detIdTemp[3] << ", detIdTemp[4] = " << detIdTemp[4];
+    //   LOG(DEBUG) << "deltaPosTemp[0] = " << deltaPosTemp[0] << ", deltaPosTemp[1] = " << deltaPosTemp[1] << " deltaPosTemp[2] = " << deltaPosTemp[2];
+    // } else {
+    //   LOG(DEBUG) << "*********** We have NOT crossed a strip during propagation!*********";
+    //   LOG(DEBUG) << "Global coordinates: pos[0] = " << pos[0] << ", pos[1] = " << pos[1] << ", pos[2] = " << pos[2];
+    //   LOG(DEBUG) << "detIdTemp[0] = " << detIdTemp[0] << ", detIdTemp[1] = " << detIdTemp[1] << ", detIdTemp[2] = " << detIdTemp[2] << ", detIdTemp[3] = " << detIdTemp[3] << ", detIdTemp[4] = " << detIdTemp[4];
+    //   LOG(DEBUG) << "deltaPosTemp[0] = " << deltaPosTemp[0] << ", deltaPosTemp[1] = " << deltaPosTemp[1] << " deltaPosTemp[2] = " << deltaPosTemp[2];
+    // }
+
+    // check if after the propagation we are in a TOF strip
+    // we ended in a TOF strip
+    // LOG(DEBUG) << "nStripsCrossedInPropagation = " << nStripsCrossedInPropagation << ", detId[nStripsCrossedInPropagation][0] = " << detId[nStripsCrossedInPropagation][0] << ", detIdTemp[0] = " << detIdTemp[0] << ", detId[nStripsCrossedInPropagation][1] = " << detId[nStripsCrossedInPropagation][1] << ", detIdTemp[1] = " << detIdTemp[1] << ", detId[nStripsCrossedInPropagation][2] = " << detId[nStripsCrossedInPropagation][2] << ", detIdTemp[2] = " << detIdTemp[2];
+    if (nStripsCrossedInPropagation == 0 ||                                                                                                                                                                                            // we are crossing a strip for the first time...
+        (nStripsCrossedInPropagation >= 1 && (detId[nStripsCrossedInPropagation - 1][0] != detIdTemp[0] || detId[nStripsCrossedInPropagation - 1][1] != detIdTemp[1] || detId[nStripsCrossedInPropagation - 1][2] != detIdTemp[2]))) { // ...or we are crossing a new strip
+      if (nStripsCrossedInPropagation == 0)
+        // LOG(DEBUG) << "We cross a strip for the first time";
+        if (nStripsCrossedInPropagation == 2) {
+          break; // we have already matched 2 strips, we cannot match more
+        }
+      nStripsCrossedInPropagation++;
+    }
+    //Printf("nStepsInsideSameStrip[nStripsCrossedInPropagation-1] = %d", nStepsInsideSameStrip[nStripsCrossedInPropagation - 1]);
+    if (nStepsInsideSameStrip[nStripsCrossedInPropagation - 1] == 0) {
+      detId[nStripsCrossedInPropagation - 1][0] = detIdTemp[0];
+      detId[nStripsCrossedInPropagation - 1][1] = detIdTemp[1];
+      detId[nStripsCrossedInPropagation - 1][2] = detIdTemp[2];
+      detId[nStripsCrossedInPropagation - 1][3] = detIdTemp[3];
+      detId[nStripsCrossedInPropagation - 1][4] = detIdTemp[4];
+      deltaPos[nStripsCrossedInPropagation - 1][0] = deltaPosTemp[0];
+      deltaPos[nStripsCrossedInPropagation - 1][1] = deltaPosTemp[1];
+      deltaPos[nStripsCrossedInPropagation - 1][2] = deltaPosTemp[2];
+      trkLTInt[nStripsCrossedInPropagation - 1] = intLT;
+      //          Printf("intLT (after matching to strip %d): length = %f, time (Pion) = %f", nStripsCrossedInPropagation - 1, trkLTInt[nStripsCrossedInPropagation - 1].getL(), trkLTInt[nStripsCrossedInPropagation - 1].getTOF(o2::track::PID::Pion));
+      nStepsInsideSameStrip[nStripsCrossedInPropagation - 1]++;
+    } else { // a further propagation step in the same strip -> update info (we sum up on all matching with strip - we will divide for the number of steps a bit below)
+      // N.B. the integrated length and time are taken (at least for now) from the first time we crossed the strip, so here we do nothing with those
+      deltaPos[nStripsCrossedInPropagation - 1][0] += deltaPosTemp[0] + (detIdTemp[4] - detId[nStripsCrossedInPropagation - 1][4]) * Geo::XPAD; // residual in x
+      deltaPos[nStripsCrossedInPropagation - 1][1] += deltaPosTemp[1];                                                                          // residual in y
+      deltaPos[nStripsCrossedInPropagation - 1][2] += deltaPosTemp[2] + (detIdTemp[3] - detId[nStripsCrossedInPropagation - 1][3]) * Geo::ZPAD; // residual in z
+      nStepsInsideSameStrip[nStripsCrossedInPropagation - 1]++;
+    }
+  }
+  return nStripsCrossedInPropagation;
+}
+
+#ifdef _ALLOW_TOF_DEBUG_
+//______________________________________________
+void MatchTOF::checkCrossedStrips(o2::track::TrackParCov trc, o2::track::TrackLTIntegral intLT, int nStrips, const int detId[2][5])
+{
+  ///< debug: find the strips crossed by the track (taken before its propagation to the strips) by stepping,
+  ///< and report the tracks for which they differ from the strips found from the strip planes
+  int detIdStep[2][5];
+  float deltaPosStep[2][3];
+  o2::track::TrackLTIntegral trkLTIntStep[2];
+  int nStepsInsideSameStrip[2] = {0, 0};
+  for (int ii = 0; ii < 2; ii++) {
+    for (int iii = 0; iii < 5; iii++) {
+      detIdStep[ii][iii] = -1;
+    }
+  }
+  int nStripsStep = findCrossedStripsStepping(trc, intLT, detIdStep, deltaPosStep, trkLTIntStep, nStepsInsideSameStrip);
+  bool same = nStripsStep == nStrips;
+  for (int ii = 0; same && ii < nStrips; ii++) {
+    same = detId[ii][0] == detIdStep[ii][0] && detId[ii][1] == detIdStep[ii][1] && detId[ii][2] == detIdStep[ii][2];
+  }
+  if (same) {
+    return;
+  }
+  LOG(WARNING) << "The track crosses " << nStrips << " strips from the strip planes but " << nStripsStep << " strips by stepping";
+  // strips as sector * 100 + strip in the sector, -1 if not crossed
+  auto stripIndex = [](const int id[5]) { return id[2] < 0 ? -1 : id[0] * 100 + Geo::getStripNumberPerSM(id[1], id[2]); };
+  (*mDBGOut) << "stripsCheck"
+             << "track=" << trc << "nStrips=" << nStrips << "nStripsStep=" << nStripsStep
+             << "strip0=" << stripIndex(detId[0]) << "strip1=" << stripIndex(detId[1])
+             << "strip0Step=" << stripIndex(detIdStep[0]) << "strip1Step=" << stripIndex(detIdStep[1]) << "\n";
+}
+#endif
+
 //______________________________________________
 void MatchTOF::doMatching(int sec)
 {
   ///< do the real matching per sector
-  mMatchedTracksPairs.clear(); // new sector
+  auto& matchedTracksPairs = mMatchedTracksPairsSec[sec];
+  matchedTracksPairs.clear(); // new sector
 
   //uncomment for local debug
   /*
@@ -572,10 +949,7 @@ void MatchTOF::doMatching(int sec)
   float deltaPos[2][3];                   // at maximum one track can fall in 2 strips during the propagation; the second dimention of the array is the residuals
   o2::track::TrackLTIntegral trkLTInt[2]; // Here we store the integrated track length and time for the (max 2) matched strips
   int nStepsInsideSameStrip[2] = {0, 0};  // number of propagation steps in the same strip (since we have maximum 2 strips, it has dimention = 2)
-  float deltaPosTemp[3];
-  std::array<float, 3> pos;
   std::array<float, 3> posBeforeProp;
-  float posFloat[3];
 
   LOG(DEBUG) << "Trying to match %d tracks" << cacheTrk.size();
   for (int itrk = 0; itrk < cacheTrk.size(); itrk++) {
@@ -590,10 +964,8 @@ void MatchTOF::doMatching(int sec)
     //    Printf("intLT (before doing anything): length = %f, time (Pion) = %f", intLT.getL(), intLT.getTOF(o2::track::PID::Pion));
     float minTrkTime = (trackWork.getTimeMUS().getTimeStamp() - mSigmaTimeCut * trackWork.getTimeMUS().getTimeStampError()) * 1.E6; // minimum time in ps
     float maxTrkTime = (trackWork.getTimeMUS().getTimeStamp() + mSigmaTimeCut * trackWork.getTimeMUS().getTimeStampError()) * 1.E6; // maximum time in ps
-    int istep = 1;                                                                                                                  // number of steps
-    float step = 1.0;                                                                                                               // step size in cm
-                                                                                                                                    //uncomment for local debug
-                                                                                                                                    /*
+    //uncomment for local debug
+    /*
 																//trefTrk.getXYZGlo(posBeforeProp);
 																//float posBeforeProp[3] = {trefTrk.getX(), trefTrk.getY(), trefTrk.getZ()}; // in local ref system
 																//printf("Global coordinates: posBeforeProp[0] = %f, posBeforeProp[1] = %f, posBeforeProp[2] = %f\n", posBeforeProp[0], posBeforeProp[1], posBeforeProp[2]);
@@ -615,94 +987,22 @@ void MatchTOF::doMatching(int sec)
       }
     }
 
-    int detIdTemp[5] = {-1, -1, -1, -1, -1}; // TOF detector id at the current propagation point
-
-    double reachedPoint = mXRef + istep * step;
-
-    while (propagateToRefX(trefTrk, reachedPoint, step, intLT) && nStripsCrossedInPropagation <= 2 && reachedPoint < Geo::RMAX) {
-      // while (o2::base::Propagator::Instance()->PropagateToXBxByBz(trefTrk,  mXRef + istep * step, o2::constants::physics::MassPionCharged, MAXSNP, step, 1, &intLT) && nStripsCrossedInPropagation <= 2 && mXRef + istep * step < Geo::RMAX) {
-
-      trefTrk.getXYZGlo(pos);
-      for (int ii = 0; ii < 3; ii++) { // we need to change the type...
-        posFloat[ii] = pos[ii];
-      }
-      // uncomment below only for local debug; this will produce A LOT of output - one print per propagation step
-      /*
-      Printf("posFloat[0] = %f, posFloat[1] = %f, posFloat[2] = %f", posFloat[0], posFloat[1], posFloat[2]);
-      Printf("radius xy = %f", TMath::Sqrt(posFloat[0]*posFloat[0] + posFloat[1]*posFloat[1]));
-      Printf("radius xyz = %f", TMath::Sqrt(posFloat[0]*posFloat[0] + posFloat[1]*posFloat[1] + posFloat[2]*posFloat[2]));
-      */
-
-      for (int idet = 0; idet < 5; idet++)
-        detIdTemp[idet] = -1;
-
-      Geo::getPadDxDyDz(posFloat, detIdTemp, deltaPosTemp);
-
-      if (detIdTemp[2] == -1) {
-        reachedPoint += step;
-        continue;
-      }
-
-      // to reduce the active region of the strip -> uncomment these lines
-      // float yresidual = TMath::Abs(deltaPosTemp[1]);
-      // if(yresidual > 0.55){
-      // 	reachedPoint += step;
-      // 	continue;
-      // }
-
-      //      printf("res %f %f %f -- %f %f %f (%d)\n",deltaPosTemp[0],deltaPosTemp[1],deltaPosTemp[2],pos[0],pos[1],pos[2],detIdTemp[2]);
-
-      // if you want to exit from the strip matched uncomment this line
-      //      reachedPoint += 3.0; // go out from the strip at the next step
-
-      //      printf("idet: %d %d %d %d %d\n",detIdTemp[0],detIdTemp[1],detIdTemp[2],detIdTemp[3],detIdTemp[4]);
-
-      // uncomment below only for local debug; this will produce A LOT of output - one print per propagation step
-      //Printf("detIdTemp[0] = %d, detIdTemp[1] = %d, detIdTemp[2] = %d, detIdTemp[3] = %d, detIdTemp[4] = %d", detIdTemp[0], detIdTemp[1], detIdTemp[2], detIdTemp[3], detIdTemp[4]);
-      // if (nStripsCrossedInPropagation == 0) { // print in case you have a useful propagation
-      //   LOG(DEBUG) << "*********** We have crossed a strip during propagation!*********";
-      //   LOG(DEBUG) << "Global coordinates: pos[0] = " << pos[0] << ", pos[1] = " << pos[1] << ", pos[2] = " << pos[2];
-      //   LOG(DEBUG) << "detIdTemp[0] = " << detIdTemp[0] << ", detIdTemp[1] = " << detIdTemp[1] << ", detIdTemp[2] = " << detIdTemp[2] << ", detIdTemp[3] = " << detIdTemp[3] << ", detIdTemp[4] = " << detIdTemp[4];
-      //   LOG(DEBUG) << "deltaPosTemp[0] = " << deltaPosTemp[0] << ", deltaPosTemp[1] = " << deltaPosTemp[1] << " deltaPosTemp[2] = " << deltaPosTemp[2];
-      // } else {
-      //   LOG(DEBUG) << "*********** We have NOT crossed a strip during propagation!*********";
-      //   LOG(DEBUG) << "Global coordinates: pos[0] = " << pos[0] << ", pos[1] = " << pos[1] << ", pos[2] = " << pos[2];
-      //   LOG(DEBUG) << "detIdTemp[0] = " << detIdTemp[0] << ", detIdTemp[1] = " << detIdTemp[1] << ", detIdTemp[2] = " << detIdTemp[2] << ", detIdTemp[3] = " << detIdTemp[3] << ", detIdTemp[4] = " << detIdTemp[4];
-      //   LOG(DEBUG) << "deltaPosTemp[0] = " << deltaPosTemp[0] << ", deltaPosTemp[1] = " << deltaPosTemp[1] << " deltaPosTemp[2] = " << deltaPosTemp[2];
-      // }
-
-      // check if after the propagation we are in a TOF strip
-      // we ended in a TOF strip
-      // LOG(DEBUG) << "nStripsCrossedInPropagation = " << nStripsCrossedInPropagation << ", detId[nStripsCrossedInPropagation][0] = " << detId[nStripsCrossedInPropagation][0] << ", detIdTemp[0] = " << detIdTemp[0] << ", detId[nStripsCrossedInPropagation][1] = " << detId[nStripsCrossedInPropagation][1] << ", detIdTemp[1] = " << detIdTemp[1] << ", detId[nStripsCrossedInPropagation][2] = " << detId[nStripsCrossedInPropagation][2] << ", detIdTemp[2] = " << detIdTemp[2];
-      if (nStripsCrossedInPropagation == 0 ||                                                                                                                                                                                            // we are crossing a strip for the first time...
-          (nStripsCrossedInPropagation >= 1 && (detId[nStripsCrossedInPropagation - 1][0] != detIdTemp[0] || detId[nStripsCrossedInPropagation - 1][1] != detIdTemp[1] || detId[nStripsCrossedInPropagation - 1][2] != detIdTemp[2]))) { // ...or we are crossing a new strip
-        if (nStripsCrossedInPropagation == 0)
-          // LOG(DEBUG) << "We cross a strip for the first time";
-          if (nStripsCrossedInPropagation == 2) {
-            break; // we have already matched 2 strips, we cannot match more
-          }
-        nStripsCrossedInPropagation++;
+    if (mUseStripPlanes) { // fast path: the crossed strips are found analytically, no stepping through the TOF volume
+#ifdef _ALLOW_TOF_DEBUG_
+      auto trkBeforeProp = trefTrk;
+      auto intLTBeforeProp = intLT;
+#endif
+      nStripsCrossedInPropagation = findCrossedStrips(trefTrk, intLT, detId, deltaPos, trkLTInt);
+      for (int ii = 0; ii < nStripsCrossedInPropagation; ii++) {
+        nStepsInsideSameStrip[ii] = 1;
       }
-      //Printf("nStepsInsideSameStrip[nStripsCrossedInPropagation-1] = %d", nStepsInsideSameStrip[nStripsCrossedInPropagation - 1]);
-      if (nStepsInsideSameStrip[nStripsCrossedInPropagation - 1] == 0) {
-        detId[nStripsCrossedInPropagation - 1][0] = detIdTemp[0];
-        detId[nStripsCrossedInPropagation - 1][1] = detIdTemp[1];
-        detId[nStripsCrossedInPropagation - 1][2] = detIdTemp[2];
-        detId[nStripsCrossedInPropagation - 1][3] = detIdTemp[3];
-        detId[nStripsCrossedInPropagation - 1][4] = detIdTemp[4];
-        deltaPos[nStripsCrossedInPropagation - 1][0] = deltaPosTemp[0];
-        deltaPos[nStripsCrossedInPropagation - 1][1] = deltaPosTemp[1];
-        deltaPos[nStripsCrossedInPropagation - 1][2] = deltaPosTemp[2];
-        trkLTInt[nStripsCrossedInPropagation - 1] = intLT;
-        //          Printf("intLT (after matching to strip %d): length = %f, time (Pion) = %f", nStripsCrossedInPropagation - 1, trkLTInt[nStripsCrossedInPropagation - 1].getL(), trkLTInt[nStripsCrossedInPropagation - 1].getTOF(o2::track::PID::Pion));
-        nStepsInsideSameStrip[nStripsCrossedInPropagation - 1]++;
-      } else { // a further propagation step in the same strip -> update info (we sum up on all matching with strip - we will divide for the number of steps a bit below)
-        // N.B. the integrated length and time are taken (at least for now) from the first time we crossed the strip, so here we do nothing with those
-        deltaPos[nStripsCrossedInPropagation - 1][0] += deltaPosTemp[0] + (detIdTemp[4] - detId[nStripsCrossedInPropagation - 1][4]) * Geo::XPAD; // residual in x
-        deltaPos[nStripsCrossedInPropagation - 1][1] += deltaPosTemp[1];                                                                          // residual in y
-        deltaPos[nStripsCrossedInPropagation - 1][2] += deltaPosTemp[2] + (detIdTemp[3] - detId[nStripsCrossedInPropagation - 1][3]) * Geo::ZPAD; // residual in z
-        nStepsInsideSameStrip[nStripsCrossedInPropagation - 1]++;
+#ifdef _ALLOW_TOF_DEBUG_
+      if (isDebugFlag(CheckStripPlanes)) {
+        checkCrossedStrips(trkBeforeProp, intLTBeforeProp, nStripsCrossedInPropagation, detId);
       }
+#endif
+    } else {
+      nStripsCrossedInPropagation = findCrossedStripsStepping(trefTrk, intLT, detId, deltaPos, trkLTInt, nStepsInsideSameStrip);
     }
     //    LOG(DEBUG) << "while done, we propagated track " << itrk << " in %d strips" << nStripsCrossedInPropagation;
     //    LOG(INFO) << "while done, we propagated track " << itrk << " in %d strips" << nStripsCrossedInPropagation;
@@ -828,7 +1128,7 @@ void MatchTOF::doMatching(int sec)
           // set event indexes (to be checked)
           evIdx eventIndexTOFCluster(trefTOF.getEntryInTree(), mTOFClusSectIndexCache[indices[0]][itof]);
           evIdx eventIndexTracks(mCurrTracksTreeEntry, mTracksSectIndexCache[indices[0]][itrk]);
-          mMatchedTracksPairs.emplace_back(o2::dataformats::MatchInfoTOF(eventIndexTOFCluster, chi2, trkLTInt[iPropagation], eventIndexTracks)); // TODO: check if this is correct!
+          matchedTracksPairs.emplace_back(o2::dataformats::MatchInfoTOF(eventIndexTOFCluster, chi2, trkLTInt[iPropagation], eventIndexTracks)); // TODO: check if this is correct!
 
 #ifdef _ALLOW_TOF_DEBUG_
           if (mMCTruthON) {
@@ -0,0 +1,49 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   SecondaryVertexingSpec.h
+
+#ifndef O2_SECONDARY_VERTEXING_SPEC
+#define O2_SECONDARY_VERTEXING_SPEC
+
+#include "DetectorsVertexing/SVertexer.h"
+#include "Framework/DataProcessorSpec.h"
+#include "Framework/Task.h"
+#include "TStopwatch.h"
+
+using namespace o2::framework;
+
+namespace o2
+{
+namespace globaltracking
+{
+
+class SecondaryVertexingDPL : public Task
+{
+ public:
+  SecondaryVertexingDPL() = default;
+  ~SecondaryVertexingDPL() override = default;
+  void init(InitContext& ic) final;
+  void run(ProcessingContext& pc) final;
+  void endOfStream(EndOfStreamContext& ec) final;
+
+ private:
+  o2::vertexing::SVertexer mVertexer;
+  o2::vertexing::SVertexer::Statistics mStatTot; // statistics accumulated over all TFs
+  TStopwatch mTimer;
+};
+
+/// create a processor spec
+framework::DataProcessorSpec getSecondaryVertexingSpec();
+
+} // namespace globaltracking
+} // namespace o2
+
+#endif /* O2_SECONDARY_VERTEXING_SPEC */
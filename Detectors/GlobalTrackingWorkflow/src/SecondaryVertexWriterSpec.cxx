@@ -0,0 +1,40 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   SecondaryVertexWriterSpec.cxx
+
+#include <vector>
+
+#include "GlobalTrackingWorkflow/SecondaryVertexWriterSpec.h"
+#include "DPLUtils/MakeRootTreeWriterSpec.h"
+#include "ReconstructionDataFormats/DecayVertex.h"
+
+using namespace o2::framework;
+
+namespace o2
+{
+namespace globaltracking
+{
+
+template <typename T>
+using BranchDefinition = MakeRootTreeWriterSpec::BranchDefinition<T>;
+
+DataProcessorSpec getSecondaryVertexWriterSpec()
+{
+  return MakeRootTreeWriterSpec("secondary-vertex-writer",
+                                "o2secondary_vertex.root",
+                                "o2sim",
+                                -1,
+                                BranchDefinition<std::vector<o2::dataformats::V0>>{InputSpec{"v0s", "GLO", "V0S", 0}, "V0s"},
+                                BranchDefinition<std::vector<o2::dataformats::DecayVertex3Prong>>{InputSpec{"prongs3", "GLO", "PRONGS3", 0}, "Vertices3Prong"})();
+}
+
+} // namespace globaltracking
+} // namespace o2
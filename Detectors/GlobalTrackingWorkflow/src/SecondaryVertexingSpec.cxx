@@ -0,0 +1,89 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   SecondaryVertexingSpec.cxx
+
+#include <vector>
+
+#include "Framework/ConfigParamRegistry.h"
+#include "GlobalTrackingWorkflow/SecondaryVertexingSpec.h"
+#include "ReconstructionDataFormats/TrackTPCITS.h"
+#include "ReconstructionDataFormats/DecayVertex.h"
+#include "DetectorsBase/GeometryManager.h"
+#include "DetectorsBase/Propagator.h"
+
+using namespace o2::framework;
+
+namespace o2
+{
+namespace globaltracking
+{
+
+void SecondaryVertexingDPL::init(InitContext& ic)
+{
+  mTimer.Stop();
+  mTimer.Reset();
+  //-------- init geometry and field --------//
+  o2::base::GeometryManager::loadGeometry();
+  o2::base::Propagator::initFieldFromGRP("o2sim_grp.root");
+  mVertexer.setBz(o2::base::Propagator::Instance()->getNominalBz());
+  mVertexer.setNThreads(ic.options().get<int>("nthreads"));
+  mVertexer.init();
+}
+
+void SecondaryVertexingDPL::run(ProcessingContext& pc)
+{
+  double timeCPU0 = mTimer.CpuTime(), timeReal0 = mTimer.RealTime();
+  mTimer.Start(false);
+  const auto tracks = pc.inputs().get<gsl::span<o2::dataformats::TrackTPCITS>>("match");
+
+  std::vector<o2::dataformats::V0> v0s;
+  std::vector<o2::dataformats::DecayVertex3Prong> vertices3Prong;
+  mVertexer.process(tracks, v0s, vertices3Prong);
+
+  pc.outputs().snapshot(Output{"GLO", "V0S", 0, Lifetime::Timeframe}, v0s);
+  pc.outputs().snapshot(Output{"GLO", "PRONGS3", 0, Lifetime::Timeframe}, vertices3Prong);
+  mTimer.Stop();
+
+  const auto& stat = mVertexer.getStatistics();
+  mStatTot.add(stat);
+  stat.print();
+  double dtReal = mTimer.RealTime() - timeReal0;
+  LOGF(INFO, "Found %lu V0s and %lu 3-prong vertices out of %lu tracks in %.3e s (Cpu: %.3e s), %.3e fitted pairs/s",
+       v0s.size(), vertices3Prong.size(), tracks.size(), dtReal, mTimer.CpuTime() - timeCPU0,
+       dtReal > 0. ? stat.nPairsAngular / dtReal : 0.);
+}
+
+void SecondaryVertexingDPL::endOfStream(EndOfStreamContext& ec)
+{
+  LOGF(INFO, "Secondary vertexing total timing: Cpu: %.3e Real: %.3e s in %d slots, %.3e candidates/s",
+       mTimer.CpuTime(), mTimer.RealTime(), mTimer.Counter() - 1,
+       mTimer.RealTime() > 0. ? (mStatTot.nV0s + mStatTot.n3Prongs) / mTimer.RealTime() : 0.);
+  mStatTot.print();
+}
+
+DataProcessorSpec getSecondaryVertexingSpec()
+{
+  std::vector<InputSpec> inputs;
+  std::vector<OutputSpec> outputs;
+  inputs.emplace_back("match", "GLO", "TPCITS", 0, Lifetime::Timeframe);
+  outputs.emplace_back("GLO", "V0S", 0, Lifetime::Timeframe);
+  outputs.emplace_back("GLO", "PRONGS3", 0, Lifetime::Timeframe);
+
+  return DataProcessorSpec{
+    "secondary-vertexing",
+    inputs,
+    outputs,
+    AlgorithmSpec{adaptFromTask<SecondaryVertexingDPL>()},
+    Options{{"nthreads", VariantType::Int, 1, {"Number of vertexing threads (<1: rely on openMP default)"}}}};
+}
+
+} // namespace globaltracking
+} // namespace o2
@@ -10,6 +10,7 @@
 
 #include "TOFWorkflow/RecoWorkflowSpec.h"
 #include "Framework/ControlService.h"
+#include "Framework/ConfigParamRegistry.h"
 #include "Framework/DataProcessorSpec.h"
 #include "Framework/DataRefUtils.h"
 #include "Framework/Lifetime.h"
@@ -55,6 +56,8 @@ class TOFDPLRecoWorkflowTask
     // nothing special to be set up
     o2::base::GeometryManager::loadGeometry();
     o2::base::Propagator::initFieldFromGRP("o2sim_grp.root");
+    mMatcher.setNThreads(ic.options().get<int>("nthreads"));
+    mMatcher.setUseStripPlanes(ic.options().get<bool>("use-strip-planes"));
     mTimer.Stop();
     mTimer.Reset();
   }
@@ -160,7 +163,9 @@ o2::framework::DataProcessorSpec getTOFRecoWorkflowSpec(bool useMC, bool useFIT)
     inputs,
     outputs,
     AlgorithmSpec{adaptFromTask<TOFDPLRecoWorkflowTask>(useMC, useFIT)},
-    Options{/* for the moment no options */}};
+    Options{
+      {"nthreads", VariantType::Int, 1, {"Number of sectors matched in parallel (<1: rely on openMP default)"}},
+      {"use-strip-planes", VariantType::Bool, false, {"Find the crossed TOF strips analytically instead of stepping through the TOF volume"}}}};
 }
 
 } // end namespace tof
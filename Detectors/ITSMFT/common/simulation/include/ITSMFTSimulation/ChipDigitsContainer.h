@@ -18,7 +18,9 @@
 
 #include "SimulationDataFormat/MCCompLabel.h"
 #include "ITSMFTSimulation/PreDigit.h"
-#include <map>
+#include <algorithm>
+#include <deque>
+#include <memory>
 #include <vector>
 
 namespace o2
@@ -29,18 +31,44 @@ class DigiParams;
 
 /// @class ChipDigitsContainer
 /// @brief Container for similated points connected to a given chip
+///
+/// The fired pixels are kept per readout frame, each frame having a flat vector of
+/// PreDigits and an open addressing hash table to find the pixel already fired.
+/// The frames are given back to the container pool once read out, so that in the
+/// continuous mode their memory is reused rather than allocated for every pixel.
 
 class ChipDigitsContainer
 {
  public:
+  /// fired pixels of a single readout frame
+  struct FrameDigits {
+    std::vector<o2::itsmft::PreDigit> digits; ///< fired pixels, in the pixel order once sorted
+    std::vector<int> table;                   ///< hash table: index of the pixel in digits, -1 if empty
+
+    o2::itsmft::PreDigit* find(UShort_t row, UShort_t col);
+    void add(const o2::itsmft::PreDigit& digit);
+    void sort();
+    void clear();
+
+   private:
+    void rehash(size_t size);
+    size_t slot(UShort_t row, UShort_t col) const
+    {
+      // Fibonacci hashing of the pixel index, the table size is a power of 2
+      return (((static_cast<UInt_t>(col) << 16) | row) * 0x9e3779b1u) & (table.size() - 1);
+    }
+  };
+
   /// Default constructor
   ChipDigitsContainer(UShort_t idx = 0) : mChipIndex(idx){};
 
   /// Destructor
   ~ChipDigitsContainer() = default;
 
-  std::map<ULong64_t, o2::itsmft::PreDigit>& getPreDigits() { return mDigits; }
-  bool isEmpty() const { return mDigits.empty(); }
+  ChipDigitsContainer(ChipDigitsContainer&&) = default;
+  ChipDigitsContainer& operator=(ChipDigitsContainer&&) = default;
+
+  bool isEmpty() const { return mFrames.empty(); }
 
   void setChipIndex(UShort_t ind) { mChipIndex = ind; }
   UShort_t getChipIndex() const { return mChipIndex; }
@@ -49,6 +77,11 @@ class ChipDigitsContainer
   void addDigit(ULong64_t key, UInt_t roframe, UShort_t row, UShort_t col, int charge, o2::MCCompLabel lbl);
   void addNoise(UInt_t rofMin, UInt_t rofMax, const o2::itsmft::DigiParams* params);
 
+  /// Get the digits of given frame sorted in the ordering key order, nullptr if there are none
+  const std::vector<o2::itsmft::PreDigit>* getSortedDigits(UInt_t roframe);
+  /// Discard the digits of all frames up to roframe included
+  void releaseFrames(UInt_t roframe);
+
   /// Get global ordering key made of readout frame, column and row
   static ULong64_t getOrderingKey(UInt_t roframe, UShort_t row, UShort_t col)
   {
@@ -61,26 +94,87 @@ class ChipDigitsContainer
     return static_cast<UInt_t>(key >> (8 * sizeof(UInt_t)));
   }
 
+  /// Get row from the ordering key
+  static UShort_t key2Row(ULong64_t key)
+  {
+    return static_cast<UShort_t>(key);
+  }
+
+  /// Get column from the ordering key
+  static UShort_t key2Col(ULong64_t key)
+  {
+    return static_cast<UShort_t>(key >> (8 * sizeof(Short_t)));
+  }
+
  protected:
-  UShort_t mChipIndex = 0;                           ///< chip index
-  std::map<ULong64_t, o2::itsmft::PreDigit> mDigits; ///< Map of fired pixels, possibly in multiple frames
+  FrameDigits* getFrame(UInt_t roframe) const;
+  FrameDigits& getOrCreateFrame(UInt_t roframe);
 
-  ClassDefNV(ChipDigitsContainer, 1);
+  UShort_t mChipIndex = 0;                              ///< chip index
+  UInt_t mFirstFrame = 0;                               ///< readout frame of mFrames.front()
+  std::deque<std::unique_ptr<FrameDigits>> mFrames;     //! fired pixels per frame from mFirstFrame, null if none
+  std::vector<std::unique_ptr<FrameDigits>> mFramePool; //! released frames, to be reused
+
+  ClassDefNV(ChipDigitsContainer, 2);
 };
 
+//_______________________________________________________________________
+inline ChipDigitsContainer::FrameDigits* ChipDigitsContainer::getFrame(UInt_t roframe) const
+{
+  // get the digits of given frame, if any
+  if (roframe < mFirstFrame || roframe - mFirstFrame >= mFrames.size()) {
+    return nullptr;
+  }
+  return mFrames[roframe - mFirstFrame].get();
+}
+
 //_______________________________________________________________________
 inline o2::itsmft::PreDigit* ChipDigitsContainer::findDigit(ULong64_t key)
 {
   // finds the digit corresponding to global key
-  auto digitentry = mDigits.find(key);
-  return digitentry != mDigits.end() ? &(digitentry->second) : nullptr;
+  auto frame = getFrame(key2ROFrame(key));
+  return frame ? frame->find(key2Row(key), key2Col(key)) : nullptr;
 }
 
 //_______________________________________________________________________
 inline void ChipDigitsContainer::addDigit(ULong64_t key, UInt_t roframe, UShort_t row, UShort_t col,
                                           int charge, o2::MCCompLabel lbl)
 {
-  mDigits.emplace(std::make_pair(key, o2::itsmft::PreDigit(roframe, row, col, charge, lbl)));
+  // the pixel must not be fired yet in this frame, see findDigit
+  getOrCreateFrame(roframe).add(o2::itsmft::PreDigit(roframe, row, col, charge, lbl));
+}
+
+//_______________________________________________________________________
+inline o2::itsmft::PreDigit* ChipDigitsContainer::FrameDigits::find(UShort_t row, UShort_t col)
+{
+  if (table.empty()) {
+    return nullptr;
+  }
+  for (auto i = slot(row, col);; i = (i + 1) & (table.size() - 1)) {
+    int idx = table[i];
+    if (idx < 0) {
+      return nullptr;
+    }
+    auto& digit = digits[idx];
+    if (digit.row == row && digit.col == col) {
+      return &digit;
+    }
+  }
+}
+
+//_______________________________________________________________________
+inline void ChipDigitsContainer::FrameDigits::add(const o2::itsmft::PreDigit& digit)
+{
+  // keep the table at most half full
+  if (2 * (digits.size() + 1) > table.size()) {
+    rehash(std::max<size_t>(64, 2 * table.size()));
+  }
+  auto i = slot(digit.row, digit.col);
+  while (table[i] >= 0) {
+    i = (i + 1) & (table.size() - 1);
+  }
+  table[i] = digits.size();
+  digits.push_back(digit);
 }
 } // namespace itsmft
 } // namespace o2
@@ -17,6 +17,7 @@
 #include "ITSMFTSimulation/DigiParams.h"
 #include "ITSMFTBase/SegmentationAlpide.h"
 #include <TRandom.h>
+#include <algorithm>
 
 using namespace o2::itsmft;
 using Segmentation = o2::itsmft::SegmentationAlpide;
@@ -47,3 +48,90 @@ void ChipDigitsContainer::addNoise(UInt_t rofMin, UInt_t rofMax, const o2::itsmf
     }
   }
 }
+
+//______________________________________________________________________
+const std::vector<PreDigit>* ChipDigitsContainer::getSortedDigits(UInt_t roframe)
+{
+  // sort the digits of the frame in the column then row order, as the ordering key does.
+  // The frame should not be modified afterwards, except for being released
+  auto frame = getFrame(roframe);
+  if (!frame) {
+    return nullptr;
+  }
+  frame->sort();
+  return &frame->digits;
+}
+
+//______________________________________________________________________
+void ChipDigitsContainer::releaseFrames(UInt_t roframe)
+{
+  // give the frames up to roframe back to the pool
+  while (!mFrames.empty() && mFirstFrame <= roframe) {
+    if (mFrames.front()) {
+      mFrames.front()->clear();
+      mFramePool.emplace_back(std::move(mFrames.front()));
+    }
+    mFrames.pop_front();
+    mFirstFrame++;
+  }
+}
+
+//______________________________________________________________________
+ChipDigitsContainer::FrameDigits& ChipDigitsContainer::getOrCreateFrame(UInt_t roframe)
+{
+  // get the digits of given frame, creating the frame if needed
+  if (mFrames.empty()) {
+    mFirstFrame = roframe;
+  }
+  while (roframe < mFirstFrame) {
+    mFrames.emplace_front();
+    mFirstFrame--;
+  }
+  while (roframe - mFirstFrame >= mFrames.size()) {
+    mFrames.emplace_back();
+  }
+  auto& frame = mFrames[roframe - mFirstFrame];
+  if (!frame) {
+    if (mFramePool.empty()) {
+      frame = std::make_unique<FrameDigits>();
+    } else {
+      frame = std::move(mFramePool.back());
+      mFramePool.pop_back();
+    }
+  }
+  return *frame;
+}
+
+//______________________________________________________________________
+void ChipDigitsContainer::FrameDigits::rehash(size_t size)
+{
+  table.assign(size, -1);
+  for (int idx = 0; idx < int(digits.size()); idx++) {
+    auto i = slot(digits[idx].row, digits[idx].col);
+    while (table[i] >= 0) {
+      i = (i + 1) & (table.size() - 1);
+    }
+    table[i] = idx;
+  }
+}
+
+//______________________________________________________________________
+void ChipDigitsContainer::FrameDigits::sort()
+{
+  // same order as the ordering key within a frame: column, then row
+  std::sort(digits.begin(), digits.end(), [](const PreDigit& a, const PreDigit& b) {
+    return a.col < b.col || (a.col == b.col && a.row < b.row);
+  });
+  // the positions in the table are not valid anymore
+  if (!digits.empty()) {
+    rehash(table.size());
+  }
+}
+
+//______________________________________________________________________
+void ChipDigitsContainer::FrameDigits::clear()
+{
+  // keep the capacity of both the digits and the table for the next frame
+  digits.clear();
+  std::fill(table.begin(), table.end(), -1);
+}
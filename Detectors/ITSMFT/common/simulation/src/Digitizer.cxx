@@ -139,30 +139,24 @@ void Digitizer::fillOutputContainer(UInt_t frameLast)
     auto& extra = *(mExtraBuff.front().get());
     for (auto& chip : mChips) {
       chip.addNoise(mROFrameMin, mROFrameMin, &mParams);
-      auto& buffer = chip.getPreDigits();
-      if (buffer.empty()) {
+      if (chip.isEmpty()) {
         continue;
       }
-      auto itBeg = buffer.begin();
-      auto iter = itBeg;
-      ULong64_t maxKey = chip.getOrderingKey(mROFrameMin + 1, 0, 0) - 1; // fetch digits with key below that
-      for (; iter != buffer.end(); ++iter) {
-        if (iter->first > maxKey) {
-          break; // is the digit ROFrame from the key > the max requested frame
-        }
-        auto& preDig = iter->second; // preDigit
+      auto buffer = chip.getSortedDigits(mROFrameMin); // digits of this frame only, if any
+      for (int i = 0; buffer && i < int(buffer->size()); i++) {
+        auto& preDig = (*buffer)[i]; // preDigit
         if (preDig.charge >= mParams.getChargeThreshold()) {
           int digID = mDigits->size();
           mDigits->emplace_back(chip.getChipIndex(), preDig.row, preDig.col, preDig.charge);
           mMCLabels->addElement(digID, preDig.labelRef.label);
-          auto& nextRef = preDig.labelRef; // extra contributors are in extra array
+          auto nextRef = preDig.labelRef; // extra contributors are in extra array
           while (nextRef.next >= 0) {
             nextRef = extra[nextRef.next];
             mMCLabels->addElement(digID, nextRef.label);
           }
         }
       }
-      buffer.erase(itBeg, iter);
+      chip.releaseFrames(mROFrameMin);
     }
     // finalize ROF record
     rcROF.setNEntries(mDigits->size() - rcROF.getFirstEntry()); // number of digits
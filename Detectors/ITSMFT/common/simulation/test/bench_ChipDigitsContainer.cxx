@@ -0,0 +1,146 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file bench_ChipDigitsContainer.cxx
+/// \brief Benchmark of the pre-digit storage of the ITS/MFT digitizer, compared to the std::map it replaced
+///
+/// The digits are filled and read out frame by frame, as Digitizer::processHit and fillOutputContainer do.
+/// The peakRSS counter (kB) is the peak of the whole process, the input being the same for both storages:
+/// run one benchmark at a time, e.g. with --benchmark_filter='BM_Digits<MapDigits>/1000$', to compare them.
+
+#include "benchmark/benchmark.h"
+#include "ITSMFTSimulation/ChipDigitsContainer.h"
+#include <sys/resource.h>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace o2::itsmft;
+
+/// pixels of all frames in a single map, as ChipDigitsContainer kept them before
+class MapDigits
+{
+ public:
+  PreDigit* findDigit(ULong64_t key)
+  {
+    auto digitentry = mDigits.find(key);
+    return digitentry != mDigits.end() ? &(digitentry->second) : nullptr;
+  }
+  void addDigit(ULong64_t key, UInt_t roframe, UShort_t row, UShort_t col, int charge, o2::MCCompLabel lbl)
+  {
+    mDigits.emplace(std::make_pair(key, PreDigit(roframe, row, col, charge, lbl)));
+  }
+  template <typename F>
+  void readFrame(UInt_t roframe, F&& f)
+  {
+    auto itBeg = mDigits.begin();
+    auto iter = itBeg;
+    ULong64_t maxKey = ChipDigitsContainer::getOrderingKey(roframe + 1, 0, 0) - 1;
+    for (; iter != mDigits.end() && iter->first <= maxKey; ++iter) {
+      f(iter->second);
+    }
+    mDigits.erase(itBeg, iter);
+  }
+
+ private:
+  std::map<ULong64_t, PreDigit> mDigits;
+};
+
+/// the frame-bucketed container
+class FrameDigits
+{
+ public:
+  PreDigit* findDigit(ULong64_t key) { return mChip.findDigit(key); }
+  void addDigit(ULong64_t key, UInt_t roframe, UShort_t row, UShort_t col, int charge, o2::MCCompLabel lbl)
+  {
+    mChip.addDigit(key, roframe, row, col, charge, lbl);
+  }
+  template <typename F>
+  void readFrame(UInt_t roframe, F&& f)
+  {
+    if (auto digits = mChip.getSortedDigits(roframe)) {
+      for (const auto& digit : *digits) {
+        f(digit);
+      }
+    }
+    mChip.releaseFrames(roframe);
+  }
+
+ private:
+  ChipDigitsContainer mChip;
+};
+
+struct Contribution {
+  UInt_t frameOffset; ///< 0 for the current frame, 1 for the next one
+  UShort_t row;
+  UShort_t col;
+  int charge;
+};
+
+/// contributions of the hits of one frame to a chip: clusters of 2x2 pixels, some of them
+/// hit again, and 10% of the charge collected in the next frame
+std::vector<Contribution> generateFrame(std::mt19937& gen, int nHits)
+{
+  std::uniform_int_distribution<int> row(0, 510), col(0, 1022), charge(50, 500);
+  std::bernoulli_distribution nextFrame(0.1);
+  std::vector<Contribution> contributions;
+  contributions.reserve(4 * nHits);
+  for (int i = 0; i < nHits; i++) {
+    int r = row(gen), c = col(gen);
+    for (int k = 0; k < 4; k++) {
+      contributions.push_back({nextFrame(gen) ? 1u : 0u, UShort_t(r + k / 2), UShort_t(c + k % 2), charge(gen)});
+    }
+  }
+  return contributions;
+}
+
+template <typename Storage>
+static void BM_Digits(benchmark::State& state)
+{
+  // a few different frames per chip, repeated, to keep the input small compared to the storage
+  constexpr int nChips = 50, nFrames = 20, nPatterns = 4;
+  std::mt19937 gen(42);
+  std::vector<std::vector<Contribution>> frames;
+  frames.reserve(nChips * nPatterns);
+  for (int i = 0; i < nChips * nPatterns; i++) {
+    frames.push_back(generateFrame(gen, state.range(0)));
+  }
+  std::vector<Storage> chips(nChips);
+  UInt_t roframe = 0;
+  size_t nDigits = 0;
+  for (auto _ : state) {
+    for (int f = 0; f < nFrames; f++, roframe++) {
+      for (int iChip = 0; iChip < nChips; iChip++) {
+        auto& chip = chips[iChip];
+        for (const auto& contribution : frames[(f % nPatterns) * nChips + iChip]) {
+          UInt_t rof = roframe + contribution.frameOffset;
+          auto key = ChipDigitsContainer::getOrderingKey(rof, contribution.row, contribution.col);
+          if (auto pd = chip.findDigit(key)) {
+            pd->charge += contribution.charge;
+          } else {
+            chip.addDigit(key, rof, contribution.row, contribution.col, contribution.charge, o2::MCCompLabel(f, 0, 0));
+          }
+        }
+        chip.readFrame(roframe, [&nDigits](const PreDigit& digit) {
+          nDigits += digit.charge > 100;
+        });
+      }
+    }
+  }
+  state.counters["digits"] = benchmark::Counter(nDigits, benchmark::Counter::kIsRate);
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  state.counters["peakRSS"] = usage.ru_maxrss;
+}
+
+BENCHMARK_TEMPLATE(BM_Digits, MapDigits)->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_Digits, FrameDigits)->Arg(10)->Arg(100)->Arg(1000);
+
+BENCHMARK_MAIN();
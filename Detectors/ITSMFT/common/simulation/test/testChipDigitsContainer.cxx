@@ -0,0 +1,68 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test ChipDigitsContainer
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "ITSMFTSimulation/ChipDigitsContainer.h"
+#include <TRandom.h>
+#include <map>
+
+using namespace o2::itsmft;
+
+BOOST_AUTO_TEST_CASE(ChipDigitsContainer_test)
+{
+  // fill the container and a map with the same random pixels, in 3 frames
+  ChipDigitsContainer chip(1);
+  std::map<ULong64_t, int> ref;
+  const UInt_t rofFirst = 10, nROF = 3;
+  for (int i = 0; i < 5000; i++) {
+    UInt_t rof = rofFirst + gRandom->Integer(nROF);
+    UShort_t row = gRandom->Integer(512), col = gRandom->Integer(1024);
+    int charge = 1 + gRandom->Integer(100);
+    auto key = ChipDigitsContainer::getOrderingKey(rof, row, col);
+    auto pd = chip.findDigit(key);
+    BOOST_CHECK_EQUAL(pd != nullptr, ref.find(key) != ref.end());
+    if (pd) {
+      pd->charge += charge;
+      ref[key] += charge;
+    } else {
+      chip.addDigit(key, rof, row, col, charge, o2::MCCompLabel(i, 0, 0));
+      ref[key] = charge;
+    }
+  }
+  BOOST_CHECK(!chip.isEmpty());
+  BOOST_CHECK(chip.getSortedDigits(rofFirst - 1) == nullptr);
+
+  // read the frames back, they must come in the same order as from the map
+  auto itRef = ref.begin();
+  for (UInt_t rof = rofFirst; rof < rofFirst + nROF; rof++) {
+    auto digits = chip.getSortedDigits(rof);
+    BOOST_REQUIRE(digits != nullptr);
+    for (const auto& digit : *digits) {
+      BOOST_REQUIRE(itRef != ref.end());
+      BOOST_CHECK_EQUAL(ChipDigitsContainer::getOrderingKey(digit.roFrame, digit.row, digit.col), itRef->first);
+      BOOST_CHECK_EQUAL(digit.charge, itRef->second);
+      ++itRef;
+    }
+    chip.releaseFrames(rof);
+    BOOST_CHECK(chip.getSortedDigits(rof) == nullptr);
+  }
+  BOOST_CHECK(itRef == ref.end());
+  BOOST_CHECK(chip.isEmpty());
+
+  // released frames are reused empty
+  auto key = ChipDigitsContainer::getOrderingKey(rofFirst + nROF, 1, 2);
+  BOOST_CHECK(chip.findDigit(key) == nullptr);
+  chip.addDigit(key, rofFirst + nROF, 1, 2, 10, o2::MCCompLabel(0, 0, 0));
+  BOOST_REQUIRE(chip.findDigit(key) != nullptr);
+  BOOST_CHECK_EQUAL(chip.getSortedDigits(rofFirst + nROF)->size(), size_t(1));
+}
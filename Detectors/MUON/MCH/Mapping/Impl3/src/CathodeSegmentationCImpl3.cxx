@@ -52,6 +52,12 @@ int mchCathodeSegmentationFindPadByFEE(MchCathodeSegmentationHandle segHandle, i
   return segHandle->impl->findPadByFEE(dualSampaId, dualSampaChannel);
 }
 
+O2MCHMAPPINGIMPL3_EXPORT
+void mchCathodeSegmentationUsePadGrid(MchCathodeSegmentationHandle /*segHandle*/, int /*usePadGrid*/)
+{
+  // this implementation only has the R-tree
+}
+
 O2MCHMAPPINGIMPL3_EXPORT
 void mchCathodeSegmentationForEachDetectionElement(MchDetectionElementHandler handler, void* clientData)
 {
@@ -60,6 +60,12 @@ O2MCHMAPPINGIMPL4_EXPORT int mchCathodeSegmentationFindPadByFEE(
   return segHandle->impl->findPadByFEE(dualSampaId, dualSampaChannel);
 }
 
+O2MCHMAPPINGIMPL4_EXPORT void mchCathodeSegmentationUsePadGrid(
+  MchCathodeSegmentationHandle segHandle, int usePadGrid)
+{
+  segHandle->impl->usePadGrid(usePadGrid > 0);
+}
+
 O2MCHMAPPINGIMPL4_EXPORT void mchCathodeSegmentationForEachDetectionElement(
   MchDetectionElementHandler handler, void* clientData)
 {
@@ -18,8 +18,11 @@
 #include "PadSize.h"
 #include "MCHMappingInterface/CathodeSegmentation.h"
 #include "CathodeSegmentationCreator.h"
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
 #include <set>
@@ -70,10 +73,10 @@ void CathodeSegmentation::fillRtree()
           double ymin = iy * dy + pg.mY;
           double ymax = (iy + 1) * dy + pg.mY;
 
-          mRtree.insert(std::make_pair(
-            CathodeSegmentation::Box{CathodeSegmentation::Point(xmin, ymin),
-                                     CathodeSegmentation::Point(xmax, ymax)},
-            catPadIndex));
+          CathodeSegmentation::Box box{CathodeSegmentation::Point(xmin, ymin),
+                                       CathodeSegmentation::Point(xmax, ymax)};
+          mRtree.insert(std::make_pair(box, catPadIndex));
+          mPadBoxes.push_back(box);
 
           mCatPadIndex2PadGroupIndex.push_back(padGroupIndex);
           mCatPadIndex2PadGroupTypeFastIndex.push_back(pgt.fastIndex(ix, iy));
@@ -84,6 +87,89 @@ void CathodeSegmentation::fillRtree()
   }
 }
 
+namespace
+{
+// half-size of the box used to find pads at a given position
+constexpr double PadSearchEpsilon{1E-4};
+} // namespace
+
+void CathodeSegmentation::fillPadGrid()
+{
+  if (mPadBoxes.empty()) {
+    return;
+  }
+
+  double xmin{std::numeric_limits<double>::max()};
+  double ymin{std::numeric_limits<double>::max()};
+  double xmax{std::numeric_limits<double>::lowest()};
+  double ymax{std::numeric_limits<double>::lowest()};
+  double dxmin{std::numeric_limits<double>::max()};
+  double dymin{std::numeric_limits<double>::max()};
+
+  for (const auto& box : mPadBoxes) {
+    xmin = std::min(xmin, box.min_corner().get<0>());
+    ymin = std::min(ymin, box.min_corner().get<1>());
+    xmax = std::max(xmax, box.max_corner().get<0>());
+    ymax = std::max(ymax, box.max_corner().get<1>());
+    dxmin = std::min(dxmin, box.max_corner().get<0>() - box.min_corner().get<0>());
+    dymin = std::min(dymin, box.max_corner().get<1>() - box.min_corner().get<1>());
+  }
+
+  // start from cells of the size of the smallest pad and enlarge them
+  // (keeping their aspect ratio) so that there are about 2 cells per pad
+  double cellSizeX{dxmin};
+  double cellSizeY{dymin};
+  double scale = std::sqrt((xmax - xmin) * (ymax - ymin) /
+                           (2.0 * mPadBoxes.size() * cellSizeX * cellSizeY));
+  if (scale > 1.0) {
+    cellSizeX *= scale;
+    cellSizeY *= scale;
+  }
+
+  mGridXmin = xmin;
+  mGridYmin = ymin;
+  mGridNofCellsX = std::max(1, static_cast<int>(std::ceil((xmax - xmin) / cellSizeX)));
+  mGridNofCellsY = std::max(1, static_cast<int>(std::ceil((ymax - ymin) / cellSizeY)));
+  mGridInvCellSizeX = mGridNofCellsX / (xmax - xmin);
+  mGridInvCellSizeY = mGridNofCellsY / (ymax - ymin);
+
+  auto cellX = [this](double x) {
+    return std::clamp(static_cast<int>(std::floor((x - mGridXmin) * mGridInvCellSizeX)), 0, mGridNofCellsX - 1);
+  };
+  auto cellY = [this](double y) {
+    return std::clamp(static_cast<int>(std::floor((y - mGridYmin) * mGridInvCellSizeY)), 0, mGridNofCellsY - 1);
+  };
+
+  // each pad is attached to all the cells overlapping its box enlarged by
+  // (more than) the search epsilon, so a cell lists all the pads
+  // findPadByPositionRtree could return for a position within that cell
+  const double margin{2 * PadSearchEpsilon};
+  auto forEachCell = [&](const Box& box, auto&& func) {
+    int ix1 = cellX(box.min_corner().get<0>() - margin);
+    int ix2 = cellX(box.max_corner().get<0>() + margin);
+    int iy1 = cellY(box.min_corner().get<1>() - margin);
+    int iy2 = cellY(box.max_corner().get<1>() + margin);
+    for (int iy = iy1; iy <= iy2; ++iy) {
+      for (int ix = ix1; ix <= ix2; ++ix) {
+        func(iy * mGridNofCellsX + ix);
+      }
+    }
+  };
+
+  mGridCellOffsets.assign(mGridNofCellsX * mGridNofCellsY + 1, 0);
+  for (const auto& box : mPadBoxes) {
+    forEachCell(box, [this](int cell) { ++mGridCellOffsets[cell + 1]; });
+  }
+  for (auto i = 1; i < mGridCellOffsets.size(); ++i) {
+    mGridCellOffsets[i] += mGridCellOffsets[i - 1];
+  }
+  mGridCatPadIndexs.resize(mGridCellOffsets.back());
+  std::vector<int> fill(mGridCellOffsets.begin(), mGridCellOffsets.end() - 1);
+  for (auto catPadIndex = 0; catPadIndex < mPadBoxes.size(); ++catPadIndex) {
+    forEachCell(mPadBoxes[catPadIndex], [&](int cell) { mGridCatPadIndexs[fill[cell]++] = catPadIndex; });
+  }
+}
+
 std::set<int> getUnique(const std::vector<PadGroup>& padGroups)
 {
   // extract from padGroup vector the unique integer values given by func
@@ -123,6 +209,15 @@ CathodeSegmentation::CathodeSegmentation(
   fillRtree();
 }
 
+void CathodeSegmentation::usePadGrid(bool value)
+{
+  // the grid is only built when first requested
+  if (value && mGridCellOffsets.empty()) {
+    fillPadGrid();
+  }
+  mUsePadGrid = value;
+}
+
 std::vector<int> CathodeSegmentation::getCatPadIndexs(int dualSampaId) const
 {
   std::vector<int> pi;
@@ -182,7 +277,46 @@ double CathodeSegmentation::squaredDistance(int catPadIndex, double x,
 
 int CathodeSegmentation::findPadByPosition(double x, double y) const
 {
-  const double epsilon{1E-4};
+  return mUsePadGrid ? findPadByPositionGrid(x, y) : findPadByPositionRtree(x, y);
+}
+
+int CathodeSegmentation::findPadByPositionGrid(double x, double y) const
+{
+  if (mGridCellOffsets.empty()) {
+    return InvalidCatPadIndex;
+  }
+
+  const double epsilon{PadSearchEpsilon};
+  int ix = std::clamp(static_cast<int>(std::floor((x - mGridXmin) * mGridInvCellSizeX)), 0, mGridNofCellsX - 1);
+  int iy = std::clamp(static_cast<int>(std::floor((y - mGridYmin) * mGridInvCellSizeY)), 0, mGridNofCellsY - 1);
+  int cell = iy * mGridNofCellsX + ix;
+
+  double dmin{std::numeric_limits<double>::max()};
+  int catPadIndex{InvalidCatPadIndex};
+
+  for (auto i = mGridCellOffsets[cell]; i < mGridCellOffsets[cell + 1]; ++i) {
+    int candidate = mGridCatPadIndexs[i];
+    const auto& box = mPadBoxes[candidate];
+    // same (inclusive) intersection test as the R-tree query
+    if (x - epsilon > box.max_corner().get<0>() ||
+        x + epsilon < box.min_corner().get<0>() ||
+        y - epsilon > box.max_corner().get<1>() ||
+        y + epsilon < box.min_corner().get<1>()) {
+      continue;
+    }
+    double d{squaredDistance(candidate, x, y)};
+    if (d < dmin || (d == dmin && candidate < catPadIndex)) {
+      catPadIndex = candidate;
+      dmin = d;
+    }
+  }
+
+  return catPadIndex;
+}
+
+int CathodeSegmentation::findPadByPositionRtree(double x, double y) const
+{
+  const double epsilon{PadSearchEpsilon};
   auto pads =
     getCatPadIndexs(x - epsilon, y - epsilon, x + epsilon, y + epsilon);
 
@@ -191,7 +325,8 @@ int CathodeSegmentation::findPadByPosition(double x, double y) const
 
   for (auto i = 0; i < pads.size(); ++i) {
     double d{squaredDistance(pads[i], x, y)};
-    if (d < dmin) {
+    // equidistant pads (e.g. on a shared edge) : the lowest index wins, whatever the order of the candidates
+    if (d < dmin || (d == dmin && pads[i] < catPadIndex)) {
       catPadIndex = pads[i];
       dmin = d;
     }
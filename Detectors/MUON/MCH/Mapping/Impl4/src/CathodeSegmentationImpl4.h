@@ -61,6 +61,12 @@ class CathodeSegmentation
 
   int findPadByPosition(double x, double y) const;
 
+  /// Select whether findPadByPosition uses the pad grid
+  /// or the R-tree (default). The grid is built on first use.
+  void usePadGrid(bool value);
+
+  bool isUsingPadGrid() const { return mUsePadGrid; }
+
   int findPadByFEE(int dualSampaId, int dualSampaChannel) const;
 
   bool hasPadByPosition(double x, double y) const
@@ -93,6 +99,12 @@ class CathodeSegmentation
 
   void fillRtree();
 
+  void fillPadGrid();
+
+  int findPadByPositionRtree(double x, double y) const;
+
+  int findPadByPositionGrid(double x, double y) const;
+
   std::ostream& showPad(std::ostream& out, int index) const;
 
   const PadGroup& padGroup(int catPadIndex) const;
@@ -113,6 +125,19 @@ class CathodeSegmentation
   std::vector<int> mCatPadIndex2PadGroupIndex;
   std::vector<int> mCatPadIndex2PadGroupTypeFastIndex;
   std::vector<int> mPadGroupIndex2CatPadIndexIndex;
+  // uniform grid over the bounding box of the cathode, each cell
+  // pointing to the range of pads overlapping it
+  // (mGridCatPadIndexs[mGridCellOffsets[cell]..mGridCellOffsets[cell+1]])
+  std::vector<Box> mPadBoxes;
+  bool mUsePadGrid{false};
+  double mGridXmin{0};
+  double mGridYmin{0};
+  double mGridInvCellSizeX{0};
+  double mGridInvCellSizeY{0};
+  int mGridNofCellsX{0};
+  int mGridNofCellsY{0};
+  std::vector<int> mGridCellOffsets;
+  std::vector<int> mGridCatPadIndexs;
 };
 
 CathodeSegmentation* createCathodeSegmentation(int detElemId,
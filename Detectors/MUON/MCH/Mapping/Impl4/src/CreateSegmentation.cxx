@@ -8,6 +8,8 @@
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
 
+#include <cstdlib>
+#include <cstring>
 #include <map>
 #include <fmt/format.h>
 #include "MCHMappingInterface/Segmentation.h"
@@ -178,6 +180,9 @@ namespace
 {
 std::map<int, o2::mch::mapping::Segmentation*> createSegmentations()
 {
+  // the pooled segmentations are const, the pad grid can only be selected here
+  const char* padGrid = std::getenv("O2_MCH_MAPPING_PADGRID");
+  bool usePadGrid = padGrid && std::strcmp(padGrid, "1") == 0;
   std::map<int, o2::mch::mapping::Segmentation*> segs;
   for (auto deid : {100,
                     300,
@@ -200,7 +205,9 @@ std::map<int, o2::mch::mapping::Segmentation*> createSegmentations()
                     903,
                     904,
                     905}) {
-    segs.emplace(deid, new o2::mch::mapping::Segmentation(deid));
+    auto seg = new o2::mch::mapping::Segmentation(deid);
+    seg->usePadGrid(usePadGrid);
+    segs.emplace(deid, seg);
   };
   return segs;
 } // namespace
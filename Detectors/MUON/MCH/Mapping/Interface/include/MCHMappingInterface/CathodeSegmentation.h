@@ -104,6 +104,7 @@ class CathodeSegmentation
     swap(a.mDetElemId, b.mDetElemId);
     swap(a.mIsBendingPlane, b.mIsBendingPlane);
     swap(a.mNofPads, b.mNofPads);
+    swap(a.mUsePadGrid, b.mUsePadGrid);
   }
 
   CathodeSegmentation(const CathodeSegmentation& seg)
@@ -113,6 +114,7 @@ class CathodeSegmentation
     mImpl = mchCathodeSegmentationConstruct(mDetElemId, mIsBendingPlane);
     mDualSampaIds = seg.mDualSampaIds;
     mNofPads = seg.mNofPads;
+    usePadGrid(seg.mUsePadGrid);
   }
 
   CathodeSegmentation& operator=(CathodeSegmentation seg)
@@ -153,6 +155,16 @@ class CathodeSegmentation
     }
     return mchCathodeSegmentationFindPadByFEE(mImpl, dualSampaId, dualSampaChannel);
   }
+
+  /** Select whether findPadByPosition may use a precomputed grid of pads
+   * instead of a generic spatial index (the default).
+   * Both give the same result, the grid being faster but using more memory
+   * and only available in some implementations. */
+  void usePadGrid(bool value)
+  {
+    mUsePadGrid = value;
+    mchCathodeSegmentationUsePadGrid(mImpl, value);
+  }
   ///@}
 
   /// @name Pad information retrieval.
@@ -204,6 +216,7 @@ class CathodeSegmentation
   int mDetElemId;
   bool mIsBendingPlane;
   int mNofPads = 0;
+  bool mUsePadGrid = false;
 };
 
 template <typename CALLABLE>
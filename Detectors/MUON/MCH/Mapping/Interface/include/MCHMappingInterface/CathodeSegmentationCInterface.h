@@ -78,6 +78,10 @@ int mchCathodeSegmentationFindPadByPosition(MchCathodeSegmentationHandle segHand
 
 /// Find the pad connected to the given channel of the given dual sampa.
 int mchCathodeSegmentationFindPadByFEE(MchCathodeSegmentationHandle segHandle, int dualSampaId, int dualSampaChannel);
+
+/// Select (usePadGrid > 0) or not a precomputed pad grid (if the implementation has one)
+/// to speed up mchCathodeSegmentationFindPadByPosition.
+void mchCathodeSegmentationUsePadGrid(MchCathodeSegmentationHandle segHandle, int usePadGrid);
 ///@}
 
 /** @name Pad information retrieval.
@@ -87,6 +87,10 @@ class Segmentation
 
   /** Find the pad connected to the given channel of the given dual sampa. */
   int findPadByFEE(int dualSampaId, int dualSampaChannel) const;
+
+  /** Select whether the position lookups use the precomputed pad grid
+   * of the cathode segmentations (see CathodeSegmentation::usePadGrid). */
+  void usePadGrid(bool value);
   ///@}
 
   /// @name Pad information retrieval.
@@ -164,6 +168,10 @@ class Segmentation
 /// the Segmentation ctor simply, and ensure by yourself
 /// that you are only creating it once in order not to incur
 /// the (high) price of the construction time of that Segmentation.
+///
+/// The pooled Segmentations use the pad grid for the position lookups
+/// (see Segmentation::usePadGrid) if the environment variable
+/// O2_MCH_MAPPING_PADGRID is set to 1 when the pool is created.
 const Segmentation& segmentation(int detElemId);
 
 } // namespace mapping
@@ -63,6 +63,12 @@ inline int Segmentation::findPadByFEE(int dualSampaId, int dualSampaChannel) con
   return padC2DE(catPadIndex, isBending);
 }
 
+inline void Segmentation::usePadGrid(bool value)
+{
+  mBending.usePadGrid(value);
+  mNonBending.usePadGrid(value);
+}
+
 inline bool Segmentation::isValid(int dePadIndex) const
 {
   if (dePadIndex < mPadIndexOffset) {
@@ -48,6 +48,17 @@ static void segmentationList(benchmark::internal::Benchmark* b)
   });
 }
 
+static void segmentationListWithPadGrid(benchmark::internal::Benchmark* b)
+{
+  o2::mch::mapping::forOneDetectionElementOfEachSegmentationType([&b](int detElemId) {
+    for (auto bending : {true, false}) {
+      for (auto padGrid : {true, false}) {
+        b->Args({detElemId, bending, padGrid});
+      }
+    }
+  });
+}
+
 class BenchO2 : public benchmark::Fixture
 {
 };
@@ -92,6 +103,7 @@ BENCHMARK_DEFINE_F(BenchO2, findPadByPosition)
   int detElemId = state.range(0);
   bool isBendingPlane = state.range(1);
   o2::mch::mapping::CathodeSegmentation seg{detElemId, isBendingPlane};
+  seg.usePadGrid(state.range(2));
   auto bbox = o2::mch::mapping::getBBox(seg);
 
   const int n = 100000;
@@ -106,11 +118,12 @@ BENCHMARK_DEFINE_F(BenchO2, findPadByPosition)
     }
   }
   state.counters["ntp"] = ntp;
+  state.SetItemsProcessed(state.iterations() * n);
 }
 
 BENCHMARK(benchCathodeSegmentationConstructionAll)->Unit(benchmark::kMillisecond);
 
-BENCHMARK_REGISTER_F(BenchO2, findPadByPosition)->Apply(segmentationList)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(BenchO2, findPadByPosition)->Apply(segmentationListWithPadGrid)->Unit(benchmark::kMillisecond);
 
 BENCHMARK_REGISTER_F(BenchO2, ctor)->Apply(segmentationList)->Unit(benchmark::kMicrosecond);
 
@@ -0,0 +1,138 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// Check that the pad grid gives the same answers as the R-tree
+/// for findPadByPosition, for all the detection elements, and which
+/// pad both select when several are equally close.
+
+#define BOOST_TEST_MODULE Test MCHMappingTest PadGrid
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include "MCHMappingInterface/CathodeSegmentation.h"
+#include "MCHMappingSegContour/CathodeSegmentationContours.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace o2::mch::mapping;
+
+BOOST_AUTO_TEST_SUITE(o2_mch_mapping)
+BOOST_AUTO_TEST_SUITE(pad_grid)
+
+/// Test positions : all pad centers, points on and just inside the pad edges,
+/// points on and around the pad corners, and random points
+/// covering the bounding box (and a bit beyond).
+std::vector<std::pair<double, double>> getTestPositions(const CathodeSegmentation& seg)
+{
+  std::vector<std::pair<double, double>> positions;
+  seg.forEachPad([&seg, &positions](int catPadIndex) {
+    double x = seg.padPositionX(catPadIndex);
+    double y = seg.padPositionY(catPadIndex);
+    double dx = seg.padSizeX(catPadIndex) / 2.0;
+    double dy = seg.padSizeY(catPadIndex) / 2.0;
+    positions.emplace_back(x, y);
+    // on the exact edges and corners, shared by several equidistant pads,
+    // both lookups must select the same one
+    for (auto fx : {-1.0, -0.999, 0.0, 0.999, 1.0, 1.00005, 1.01}) {
+      for (auto fy : {-1.0, -0.999, 0.0, 0.999, 1.0, 1.00005, 1.01}) {
+        positions.emplace_back(x + fx * dx, y + fy * dy);
+      }
+    }
+  });
+
+  auto bbox = getBBox(seg);
+  std::mt19937 mt(seg.nofPads());
+  std::uniform_real_distribution<double> distX{bbox.xmin() - 2.0, bbox.xmax() + 2.0};
+  std::uniform_real_distribution<double> distY{bbox.ymin() - 2.0, bbox.ymax() + 2.0};
+  for (int i = 0; i < 10 * seg.nofPads(); ++i) {
+    positions.emplace_back(distX(mt), distY(mt));
+  }
+  return positions;
+}
+
+BOOST_AUTO_TEST_CASE(PadGridGivesSameResultsAsRtreeForAllDetectionElements)
+{
+  forEachDetectionElement([](int detElemId) {
+    for (auto isBendingPlane : {true, false}) {
+      CathodeSegmentation grid{detElemId, isBendingPlane};
+      CathodeSegmentation rtree{detElemId, isBendingPlane};
+      grid.usePadGrid(true);
+      rtree.usePadGrid(false);
+      int nofMismatches{0};
+      for (const auto& p : getTestPositions(grid)) {
+        int padGrid = grid.findPadByPosition(p.first, p.second);
+        int padRtree = rtree.findPadByPosition(p.first, p.second);
+        if (padGrid != padRtree) {
+          // only report the first few ones
+          if (nofMismatches++ < 5) {
+            BOOST_TEST_MESSAGE("DE " << detElemId << (isBendingPlane ? " B" : " NB") << " at (" << p.first << "," << p.second
+                                     << ") grid " << padGrid << " rtree " << padRtree);
+          }
+        }
+      }
+      BOOST_CHECK_MESSAGE(nofMismatches == 0, "DE " << detElemId << (isBendingPlane ? " B" : " NB") << " : " << nofMismatches
+                                                    << " positions where the pad grid and the R-tree disagree");
+    }
+  });
+}
+
+BOOST_AUTO_TEST_CASE(EquidistantPadsGiveTheLowestIndex)
+{
+  // on the edge shared by two pads, findPadByPosition used to return whichever
+  // the R-tree listed first : it now returns the lowest pad index, whatever the lookup
+  for (auto detElemId : {100, 501, 1025}) {
+    for (auto isBendingPlane : {true, false}) {
+      CathodeSegmentation rtree{detElemId, isBendingPlane};
+      CathodeSegmentation grid{detElemId, isBendingPlane};
+      grid.usePadGrid(true);
+      std::vector<int> pads;
+      rtree.forEachPad([&pads](int catPadIndex) { pads.push_back(catPadIndex); });
+      int nofTies{0};
+      for (auto catPadIndex : pads) {
+        // middle of the right edge of the pad
+        double x = rtree.padPositionX(catPadIndex) + rtree.padSizeX(catPadIndex) / 2.0;
+        double y = rtree.padPositionY(catPadIndex);
+        double dmin{std::numeric_limits<double>::max()};
+        int expected{-1};
+        int nofClosest{0};
+        for (auto candidate : pads) {
+          double px = rtree.padPositionX(candidate) - x;
+          double py = rtree.padPositionY(candidate) - y;
+          if (std::abs(px) > rtree.padSizeX(candidate) / 2.0 + 1E-4 ||
+              std::abs(py) > rtree.padSizeY(candidate) / 2.0 + 1E-4) {
+            continue;
+          }
+          double d = px * px + py * py;
+          if (d < dmin) {
+            dmin = d;
+            expected = candidate;
+            nofClosest = 1;
+          } else if (d == dmin) {
+            expected = std::min(expected, candidate);
+            ++nofClosest;
+          }
+        }
+        nofTies += nofClosest > 1;
+        BOOST_CHECK_EQUAL(rtree.findPadByPosition(x, y), expected);
+        BOOST_CHECK_EQUAL(grid.findPadByPosition(x, y), expected);
+      }
+      BOOST_CHECK_GT(nofTies, 0);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
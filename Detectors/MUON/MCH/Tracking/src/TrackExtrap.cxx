@@ -34,6 +34,7 @@ namespace mch
 bool TrackExtrap::sExtrapV2 = false;
 double TrackExtrap::sSimpleBValue = 0.;
 bool TrackExtrap::sFieldON = false;
+std::unique_ptr<o2::field::MagFieldGrid> TrackExtrap::sFieldGrid{};
 std::size_t TrackExtrap::sNCallExtrapToZCov = 0;
 std::size_t TrackExtrap::sNCallField = 0;
 
@@ -50,6 +51,22 @@ void TrackExtrap::setField()
   LOG(INFO) << "Track extrapolation with magnetic field " << (sFieldON ? "ON" : "OFF");
 }
 
+//__________________________________________________________________________
+void TrackExtrap::useFieldGrid(double step)
+{
+  /// Precompute the field on a grid with the given step (cm) covering the tracking chambers,
+  /// to be interpolated instead of evaluating the field map during the Runge-Kutta extrapolation.
+  /// The field must be set beforehand and not change afterward.
+  /// Outside of the grid the field map is used as before
+  if (!TGeoGlobalMagField::Instance()->GetField()) {
+    LOG(ERROR) << "Cannot build the field grid: no magnetic field";
+    return;
+  }
+  sFieldGrid = std::make_unique<o2::field::MagFieldGrid>();
+  sFieldGrid->build(*TGeoGlobalMagField::Instance()->GetField(), {-SFieldGridHalfSize, -SFieldGridHalfSize, SFieldGridZMin},
+                    {SFieldGridHalfSize, SFieldGridHalfSize, SAbsZEnd}, step);
+}
+
 //__________________________________________________________________________
 double TrackExtrap::getImpactParamFromBendingMomentum(double bendingMomentum)
 {
@@ -1039,8 +1056,7 @@ bool TrackExtrap::extrapOneStepRungekutta(double charge, double step, const doub
       h = rest;
     }
     // cmodif: call gufld(vout,f) changed into:
-    TGeoGlobalMagField::Instance()->Field(vout, f);
-    ++sNCallField;
+    getField(vout, f);
 
     // *
     // *             start of integration
@@ -1088,8 +1104,7 @@ bool TrackExtrap::extrapOneStepRungekutta(double charge, double step, const doub
     xyzt[2] = zt;
 
     // cmodif: call gufld(xyzt,f) changed into:
-    TGeoGlobalMagField::Instance()->Field(xyzt, f);
-    ++sNCallField;
+    getField(xyzt, f);
 
     at = a + secxs[0];
     bt = b + secys[0];
@@ -1128,8 +1143,7 @@ bool TrackExtrap::extrapOneStepRungekutta(double charge, double step, const doub
     xyzt[2] = zt;
 
     // cmodif: call gufld(xyzt,f) changed into:
-    TGeoGlobalMagField::Instance()->Field(xyzt, f);
-    ++sNCallField;
+    getField(xyzt, f);
 
     z = z + (c + (seczs[0] + seczs[1] + seczs[2]) * kthird) * h;
     y = y + (b + (secys[0] + secys[1] + secys[2]) * kthird) * h;
@@ -1228,6 +1242,16 @@ bool TrackExtrap::extrapOneStepRungekutta(double charge, double step, const doub
   return true;
 }
 
+//__________________________________________________________________________
+void TrackExtrap::getField(const double* x, double* b)
+{
+  /// Get the field at point x, from the precomputed grid if any and if x is inside it
+  if (!sFieldGrid || !sFieldGrid->Field(x, b)) {
+    TGeoGlobalMagField::Instance()->Field(x, b);
+  }
+  ++sNCallField;
+}
+
 //__________________________________________________________________________
 void TrackExtrap::printNCalls()
 {
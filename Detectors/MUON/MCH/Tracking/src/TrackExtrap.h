@@ -17,9 +17,12 @@
 #define ALICEO2_MCH_TRACKEXTRAP_H_
 
 #include <cstddef>
+#include <memory>
 
 #include <TMatrixD.h>
 
+#include "Field/MagFieldGrid.h"
+
 namespace o2
 {
 namespace mch
@@ -48,6 +51,8 @@ class TrackExtrap
   /// Switch to Runge-Kutta extrapolation v2
   static void useExtrapV2() { sExtrapV2 = true; }
 
+  static void useFieldGrid(double step);
+
   static double getImpactParamFromBendingMomentum(double bendingMomentum);
   static double getBendingMomentumFromImpactParam(double impactParam);
 
@@ -114,6 +119,8 @@ class TrackExtrap
   static bool extrapToZRungekuttaV2(TrackParam* trackParam, double zEnd);
   static bool extrapOneStepRungekutta(double charge, double step, const double* vect, double* vout);
 
+  static void getField(const double* x, double* b);
+
   static constexpr double SMuMass = 0.105658;                         ///< Muon mass (GeV/c2)
   static constexpr double SAbsZBeg = -90.;                            ///< Position of the begining of the absorber (cm)
   static constexpr double SAbsZEnd = -505.;                           ///< Position of the end of the absorber (cm)
@@ -122,6 +129,8 @@ class TrackExtrap
   static constexpr int SMaxStepNumber = 5000;                         ///< Maximum number of steps for track extrapolation
   static constexpr double SRungeKuttaMaxResidue = 0.002;              ///< Max z-distance to destination to stop the track extrap (cm)
   static constexpr double SRungeKuttaMaxResidueV2 = 0.01;             ///< Max z-distance to destination to stop the track extrap v2 (cm)
+  static constexpr double SFieldGridHalfSize = 300.;                  ///< Half size in x and y of the precomputed field grid (cm)
+  static constexpr double SFieldGridZMin = -1460.;                    ///< Position of the downstream end of the precomputed field grid (cm)
   /// Most probable value (GeV/c) of muon momentum in bending plane (used when B = 0)
   /// Needed to get some "reasonable" corrections for MCS and E loss even if B = 0
   static constexpr double SMostProbBendingMomentum = 2.;
@@ -131,6 +140,8 @@ class TrackExtrap
   static double sSimpleBValue; ///< Magnetic field value at the centre
   static bool sFieldON;        ///< true if the field is switched ON
 
+  static std::unique_ptr<o2::field::MagFieldGrid> sFieldGrid; ///< precomputed field in the spectrometer, if requested
+
   static std::size_t sNCallExtrapToZCov; ///< number of times the method extrapToZCov(...) is called
   static std::size_t sNCallField;        ///< number of times the method Field(...) is called
 };
@@ -64,89 +64,162 @@ void TrackFinder::init(float l3Current, float dipoleCurrent)
   // grouping DEs in z-planes (2 for chambers 1-4 and 4 for chambers 5-10)
   for (int iCh = 0; iCh < 4; ++iCh) {
     mClusters[2 * iCh].reserve(2);
-    mClusters[2 * iCh].emplace_back(100 * (iCh + 1) + 1, nullptr);
-    mClusters[2 * iCh].emplace_back(100 * (iCh + 1) + 3, nullptr);
+    mClusters[2 * iCh].emplace_back(100 * (iCh + 1) + 1);
+    mClusters[2 * iCh].emplace_back(100 * (iCh + 1) + 3);
     mClusters[2 * iCh + 1].reserve(2);
-    mClusters[2 * iCh + 1].emplace_back(100 * (iCh + 1), nullptr);
-    mClusters[2 * iCh + 1].emplace_back(100 * (iCh + 1) + 2, nullptr);
+    mClusters[2 * iCh + 1].emplace_back(100 * (iCh + 1));
+    mClusters[2 * iCh + 1].emplace_back(100 * (iCh + 1) + 2);
   }
   for (int iCh = 4; iCh < 6; ++iCh) {
     mClusters[8 + 4 * (iCh - 4)].reserve(5);
-    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1), nullptr);
-    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 2, nullptr);
-    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 4, nullptr);
-    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 14, nullptr);
-    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 16, nullptr);
+    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1));
+    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 2);
+    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 4);
+    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 14);
+    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 16);
     mClusters[8 + 4 * (iCh - 4) + 1].reserve(4);
-    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 1, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 3, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 15, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 17, nullptr);
+    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 1);
+    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 3);
+    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 15);
+    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 17);
     mClusters[8 + 4 * (iCh - 4) + 2].reserve(4);
-    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 6, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 8, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 10, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 12, nullptr);
+    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 6);
+    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 8);
+    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 10);
+    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 12);
     mClusters[8 + 4 * (iCh - 4) + 3].reserve(5);
-    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 5, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 7, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 9, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 11, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 13, nullptr);
+    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 5);
+    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 7);
+    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 9);
+    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 11);
+    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 13);
   }
   for (int iCh = 6; iCh < 10; ++iCh) {
     mClusters[8 + 4 * (iCh - 4)].reserve(7);
-    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1), nullptr);
-    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 2, nullptr);
-    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 4, nullptr);
-    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 6, nullptr);
-    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 20, nullptr);
-    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 22, nullptr);
-    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 24, nullptr);
+    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1));
+    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 2);
+    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 4);
+    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 6);
+    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 20);
+    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 22);
+    mClusters[8 + 4 * (iCh - 4)].emplace_back(100 * (iCh + 1) + 24);
     mClusters[8 + 4 * (iCh - 4) + 1].reserve(6);
-    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 1, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 3, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 5, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 21, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 23, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 25, nullptr);
+    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 1);
+    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 3);
+    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 5);
+    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 21);
+    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 23);
+    mClusters[8 + 4 * (iCh - 4) + 1].emplace_back(100 * (iCh + 1) + 25);
     mClusters[8 + 4 * (iCh - 4) + 2].reserve(6);
-    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 8, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 10, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 12, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 14, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 16, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 18, nullptr);
+    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 8);
+    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 10);
+    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 12);
+    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 14);
+    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 16);
+    mClusters[8 + 4 * (iCh - 4) + 2].emplace_back(100 * (iCh + 1) + 18);
     mClusters[8 + 4 * (iCh - 4) + 3].reserve(7);
-    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 7, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 9, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 11, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 13, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 15, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 17, nullptr);
-    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 19, nullptr);
+    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 7);
+    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 9);
+    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 11);
+    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 13);
+    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 15);
+    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 17);
+    mClusters[8 + 4 * (iCh - 4) + 3].emplace_back(100 * (iCh + 1) + 19);
   }
+
+  // index the DEs by their ID
+  for (auto& plane : mClusters) {
+    for (auto& de : plane) {
+      if (de.deId >= static_cast<int>(mDEs.size())) {
+        mDEs.resize(de.deId + 1, nullptr);
+      }
+      mDEs[de.deId] = &de;
+    }
+  }
+  mDECursors.resize(mDEs.size());
 }
 
 //_________________________________________________________________________________________________
 const std::list<Track>& TrackFinder::findTracks(const std::unordered_map<int, std::list<Cluster>>& clusters)
 {
-  /// Run the track finder algorithm
-
-  mTracks.clear();
-
-  // fill the internal array of pointers to the list of clusters per DE
+  /// Run the track finder algorithm on the lists of clusters per DE
+
+  // copy the clusters in the internal storage, contiguous per DE
+  std::size_t nClusters(0);
+  for (const auto& plane : mClusters) {
+    for (const auto& de : plane) {
+      auto itDE = clusters.find(de.deId);
+      nClusters += (itDE == clusters.end()) ? 0 : itDE->second.size();
+    }
+  }
+  mClusterStore.clear();
+  mClusterStore.reserve(nClusters);
   for (auto& plane : mClusters) {
     for (auto& de : plane) {
-      auto itDE = clusters.find(de.first);
+      auto itDE = clusters.find(de.deId);
       if (itDE == clusters.end()) {
-        de.second = nullptr;
-      } else {
-        de.second = &(itDE->second);
+        de.clusters = {};
+        continue;
       }
+      auto first = mClusterStore.size();
+      mClusterStore.insert(mClusterStore.end(), itDE->second.begin(), itDE->second.end());
+      de.clusters = gsl::span<const Cluster>(mClusterStore.data() + first, itDE->second.size());
+    }
+  }
+
+  return findTracks();
+}
+
+//_________________________________________________________________________________________________
+const std::list<Track>& TrackFinder::findTracks(gsl::span<const ClusterStruct> clusters)
+{
+  /// Run the track finder algorithm on the given clusters
+  /// Within a DE, the clusters are considered in the order they are given
+
+  // count the clusters per DE
+  for (auto& plane : mClusters) {
+    for (auto& de : plane) {
+      mDECursors[de.deId] = 0;
+    }
+  }
+  std::size_t nClusters(0);
+  for (const auto& cluster : clusters) {
+    if (findDE(cluster.getDEId()) != nullptr) {
+      ++mDECursors[cluster.getDEId()];
+      ++nClusters;
+    }
+  }
+
+  // give each DE a contiguous range in the internal storage
+  mClusterStore.resize(nClusters);
+  std::size_t first(0);
+  for (auto& plane : mClusters) {
+    for (auto& de : plane) {
+      auto nClustersInDE = mDECursors[de.deId];
+      de.clusters = gsl::span<const Cluster>(mClusterStore.data() + first, nClustersInDE);
+      mDECursors[de.deId] = first;
+      first += nClustersInDE;
+    }
+  }
+
+  // and fill it
+  for (const auto& cluster : clusters) {
+    if (findDE(cluster.getDEId()) != nullptr) {
+      mClusterStore[mDECursors[cluster.getDEId()]++] = Cluster(cluster);
     }
   }
 
+  return findTracks();
+}
+
+//_________________________________________________________________________________________________
+const std::list<Track>& TrackFinder::findTracks()
+{
+  /// Run the track finder algorithm on the clusters in the internal storage
+
+  mTracks.clear();
+  prepareClusterSets();
+
   // find track candidates on stations 4 and 5
   auto tStart = std::chrono::high_resolution_clock::now();
   findTrackCandidates();
@@ -165,8 +238,8 @@ const std::list<Track>& TrackFinder::findTracks(const std::unordered_map<int, st
   // track each candidate down to chamber 1 and remove it
   tStart = std::chrono::high_resolution_clock::now();
   for (auto itTrack = mTracks.begin(); itTrack != mTracks.end();) {
-    std::unordered_map<int, std::unordered_set<uint32_t>> excludedClusters{};
-    followTrackInChamber(itTrack, 5, 0, false, excludedClusters);
+    ExcludedClusters excludedClusters(*this);
+    followTrackInChamber(itTrack, 5, 0, false, *excludedClusters);
     print("findTracks: removing candidate at position #", getTrackIndex(itTrack));
     itTrack = mTracks.erase(itTrack);
   }
@@ -211,11 +284,11 @@ void TrackFinder::findTrackCandidates()
     }
 
     // look for compatible clusters on station 4
-    std::unordered_map<int, std::unordered_set<uint32_t>> excludedClusters{};
-    auto itNewTrack = followTrackInChamber(itTrack, 7, 6, false, excludedClusters);
+    ExcludedClusters excludedClusters(*this);
+    auto itNewTrack = followTrackInChamber(itTrack, 7, 6, false, *excludedClusters);
 
     // keep the current candidate only if no compatible cluster is found and the station is not requested
-    if (!SRequestStation[3] && excludedClusters.empty() && itTrack->areCurrentParamValid()) {
+    if (!SRequestStation[3] && excludedClusters->empty() && itTrack->areCurrentParamValid()) {
       ++itTrack;
     } else {
       print("findTrackCandidates: removing candidate at position #", getTrackIndex(itTrack));
@@ -249,18 +322,18 @@ void TrackFinder::findTrackCandidates()
     // look for compatible clusters on each chamber of station 5 separately,
     // exluding those already attached to an identical candidate on station 4
     // (cases where both chambers of station 5 are fired should have been found in the first step)
-    std::unordered_map<int, std::unordered_set<uint32_t>> excludedClusters{};
+    ExcludedClusters excludedClusters(*this);
     if (itLastCandidateFromSt5 != mTracks.end()) {
-      excludeClustersFromIdenticalTracks(itTrack, excludedClusters, std::next(itLastCandidateFromSt5));
+      excludeClustersFromIdenticalTracks(itTrack, *excludedClusters, std::next(itLastCandidateFromSt5));
     }
-    auto itFirstNewTrack = followTrackInChamber(itTrack, 8, 8, false, excludedClusters);
-    auto itNewTrack = followTrackInChamber(itTrack, 9, 9, false, excludedClusters);
+    auto itFirstNewTrack = followTrackInChamber(itTrack, 8, 8, false, *excludedClusters);
+    auto itNewTrack = followTrackInChamber(itTrack, 9, 9, false, *excludedClusters);
     if (itFirstNewTrack == mTracks.end()) {
       itFirstNewTrack = itNewTrack;
     }
 
     // keep the current candidate only if no compatible cluster is found and the station is not requested
-    if (!SRequestStation[4] && excludedClusters.empty()) {
+    if (!SRequestStation[4] && excludedClusters->empty()) {
       itFirstNewTrack = itTrack;
       ++itTrack;
     } else {
@@ -600,22 +673,22 @@ std::list<Track>::iterator TrackFinder::findTrackCandidates(int plane1, int plan
   for (auto& de1 : mClusters[plane1]) {
 
     // skip DE without cluster
-    if (de1.second == nullptr) {
+    if (de1.clusters.empty()) {
       continue;
     }
 
-    for (const auto& cluster1 : *de1.second) {
+    for (const auto& cluster1 : de1.clusters) {
 
       double z1 = cluster1.getZ();
 
       for (auto& de2 : mClusters[plane2]) {
 
         // skip DE without cluster
-        if (de2.second == nullptr) {
+        if (de2.clusters.empty()) {
           continue;
         }
 
-        for (const auto& cluster2 : *de2.second) {
+        for (const auto& cluster2 : de2.clusters) {
 
           // skip combinations of clusters already part of a track if requested
           if (skipUsedPairs && itTrack != mTracks.end() && areUsed(cluster1, cluster2, itFirstTrack, std::next(itTrack))) {
@@ -688,17 +761,17 @@ std::list<Track>::iterator TrackFinder::followTrackInOverlapDE(const std::list<T
   for (auto& de : mClusters[plane]) {
 
     // skip DE without cluster
-    if (de.second == nullptr) {
+    if (de.clusters.empty()) {
       continue;
     }
 
     // skip DE that do not overlap with the current DE
-    if (de.first % 100 != (currentDE % 100 + 1) % SNDE[currentChamber] && de.first % 100 != (currentDE % 100 - 1 + SNDE[currentChamber]) % SNDE[currentChamber]) {
+    if (de.deId % 100 != (currentDE % 100 + 1) % SNDE[currentChamber] && de.deId % 100 != (currentDE % 100 - 1 + SNDE[currentChamber]) % SNDE[currentChamber]) {
       continue;
     }
 
     // look for cluster candidate in this DE
-    for (const auto& cluster : *de.second) {
+    for (const auto& cluster : de.clusters) {
 
       // try to add the current cluster
       if (!isCompatible(currentParam, cluster, paramAtCluster)) {
@@ -723,7 +796,7 @@ std::list<Track>::iterator TrackFinder::followTrackInOverlapDE(const std::list<T
 //_________________________________________________________________________________________________
 std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::iterator& itTrack,
                                                              int chamber, int lastChamber, bool canSkip,
-                                                             std::unordered_map<int, std::unordered_set<uint32_t>>& excludedClusters)
+                                                             ClusterSet& excludedClusters)
 {
   /// Follow the track candidate pointed to by "itTrack" to the given "chamber"
   /// The tracking starts from the current parameters, which must have already been set
@@ -731,18 +804,372 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
   /// Look for compatible cluster(s), excluding those in the "excludedClusters" list, which
   /// correspond to compatible clusters already associated to this candidate in a previous step
   /// For each (pair of) cluster(s) found, continue the tracking to the next chamber, up to "lastChamber"
-  /// This is a recursive procedure. Once reaching the last requested chamber, every valid tracks found
-  /// are added before "itTrack" and the associated clusters from this chamber onward are attached to them
+  /// The possible continuations are recorded as branches and every valid tracks found are only
+  /// created at the end, before "itTrack", with the associated clusters from this chamber onward
   /// The method returns an iterator to the first new candidate, or mTracks.end() if none is found
   /// Every compatible clusters found in the process are added to the "excludedClusters" list
   /// The initial candidate "itTrack" is not modified, with the exception of its current parameters,
   /// which are set to the parameters at "chamber" or invalidated in case of propagation issue
 
+  if (mDuplicateAtBranching) {
+    return followTrackInChamberByCopy(itTrack, chamber, lastChamber, canSkip, excludedClusters);
+  }
+
+  mNBranches = 0;
+  mLeaves.clear();
+  followBranchInChamber(itTrack, -1, chamber, lastChamber, canSkip, excludedClusters);
+  return createTracksFromBranches(itTrack);
+}
+
+//_________________________________________________________________________________________________
+void TrackFinder::followBranchInChamber(std::list<Track>::iterator& itTrack, int branch,
+                                        int chamber, int lastChamber, bool canSkip,
+                                        ClusterSet& excludedClusters)
+{
+  /// Follow the track candidate pointed to by "itTrack", extended with the clusters of "branch", to the given "chamber"
+  /// This is a recursive procedure. Once reaching the last requested chamber, every valid branches found
+  /// are recorded in mLeaves. See followTrackInChamber for the other parameters
+
   // list of (half-)planes, 2 or 4 per chamber, ordered according to the direction of propagation,
   // which is forward when going to station 5 and backward otherwise with the present algorithm
   static constexpr int plane[10][4] = {{1, 0, -1, -1}, {3, 2, -1, -1}, {5, 4, -1, -1}, {7, 6, -1, -1}, {11, 10, 9, 8}, {15, 14, 13, 12}, {19, 18, 17, 16}, {23, 22, 21, 20}, {24, 25, 26, 27}, {28, 29, 30, 31}};
 
-  print("followTrackInChamber: follow track #", getTrackIndex(itTrack), " to chamber ", chamber + 1, " up to chamber ", lastChamber + 1);
+  print("followBranchInChamber: follow track #", getTrackIndex(itTrack), " to chamber ", chamber + 1, " up to chamber ", lastChamber + 1);
+
+  // the current track parameters must be set at a different chamber and valid
+  if (!itTrack->areCurrentParamValid() || chamber == itTrack->getCurrentChamber()) {
+    return;
+  }
+
+  // determine whether the chamber is the first one reached on the station
+  int currentChamber = itTrack->getCurrentChamber();
+  bool isFirstOnStation = ((chamber < currentChamber && chamber % 2 == 1) || (chamber > currentChamber && chamber % 2 == 0));
+
+  // follow the track in the 2 planes or 4 half-planes of the chamber
+  followBranchInPlanes(itTrack, branch, plane[chamber][0], plane[chamber][1], lastChamber, excludedClusters);
+  if (chamber > 3) {
+    followBranchInPlanes(itTrack, branch, plane[chamber][2], plane[chamber][3], lastChamber, excludedClusters);
+  }
+
+  // add MCS effects in that chamber before going further with this track or stop here if the track could not reach that chamber
+  if (itTrack->areCurrentParamValid()) {
+    TrackExtrap::addMCSEffect(&(itTrack->getCurrentParam()), SChamberThicknessInX0[chamber], -1.);
+  } else {
+    return;
+  }
+
+  if (chamber != lastChamber) {
+
+    // save the current track parameters before going to the next chamber
+    TrackParam currentParam = itTrack->getCurrentParam();
+
+    // consider the possibility to skip the chamber if it is the first one of the station or if we know we can skip it,
+    // i.e. if a compatible cluster has been found on the first chamber and none has been found on the second
+    if (isFirstOnStation || (canSkip && excludedClusters.empty())) {
+      int nextChamber = (chamber > lastChamber) ? chamber - 1 : chamber + 1;
+      followBranchInChamber(itTrack, branch, nextChamber, lastChamber, false, excludedClusters);
+    }
+
+    // consider the possibility to skip the entire station if not requested and not the last one
+    if (isFirstOnStation && !SRequestStation[chamber / 2] && chamber / 2 != lastChamber / 2) {
+      int nextChamber = (chamber > lastChamber) ? chamber - 2 : chamber + 2;
+      followBranchInChamber(itTrack, branch, nextChamber, lastChamber, false, excludedClusters);
+    }
+
+    // reset the current track parameters to the ones at that chamber if needed
+    // (not sure it is needed at all but that way it is clear what the current track parameters are at the end of this function)
+    if (itTrack->getCurrentChamber() != chamber) {
+      setCurrentParam(*itTrack, currentParam, chamber);
+    }
+  } else {
+
+    // keep the branch as a new track if a cluster has been found on the first chamber of the station but not on the second and last one
+    // or if one reaches station 1 and it is not requested, whether a cluster has been found on it or not
+    if ((!isFirstOnStation && canSkip && excludedClusters.empty()) ||
+        (chamber / 2 == 0 && !SRequestStation[0] && (isFirstOnStation || !canSkip))) {
+      mLeaves.push_back(branch);
+      print("followBranchInChamber: new track from branch ", branch);
+    }
+  }
+}
+
+//_________________________________________________________________________________________________
+void TrackFinder::followBranchInPlanes(std::list<Track>::iterator& itTrack, int branch,
+                                       int plane1, int plane2, int lastChamber,
+                                       ClusterSet& excludedClusters)
+{
+  /// Follow the track candidate pointed to by "itTrack", extended with the clusters of "branch",
+  /// to the (half)chamber formed by "plane1" and "plane2"
+  /// The tracking starts from the current parameters, which must have already been set
+  /// Look for compatible cluster(s), excluding those in the "excludedClusters" list, which
+  /// correspond to compatible clusters already associated to this candidate in a previous step
+  /// For each (pair of) cluster(s) found, start a new branch and continue the tracking to the next chamber, up to "lastChamber"
+  /// This is a recursive procedure. Once reaching the last requested chamber, every valid branches found are recorded in mLeaves
+  /// Only the branches with at least one compatible cluster found on plane1 or plane2 are considered
+  /// Every compatible clusters found in the process are added to the "excludedClusters" list
+  /// The initial candidate "itTrack" is not modified, with the exception of its current parameters,
+  /// which are set to the parameters at that chamber without adding MCS effects, or invalidated in case of issue
+
+  print("followBranchInPlanes: follow track #", getTrackIndex(itTrack), " to planes ", plane1, " and ", plane2, " up to chamber ", lastChamber + 1);
+  printTrack(*itTrack);
+
+  // the current track parameters must be set and valid
+  if (!itTrack->areCurrentParamValid()) {
+    return;
+  }
+
+  // add MCS effects in the missing chambers if any. Update the current parameters in the process
+  int chamber = getChamberId(plane1);
+  if ((chamber < itTrack->getCurrentChamber() - 1 || chamber > itTrack->getCurrentChamber() + 1) &&
+      !propagateCurrentParam(*itTrack, (chamber < itTrack->getCurrentChamber()) ? chamber + 1 : chamber - 1)) {
+    return;
+  }
+
+  // extrapolate the candidate to the chamber if not already there
+  TrackParam paramAtChamber = itTrack->getCurrentParam();
+  if (itTrack->getCurrentChamber() != chamber && !TrackExtrap::extrapToZCov(&paramAtChamber, SDefaultChamberZ[chamber], true)) {
+    itTrack->invalidateCurrentParam();
+    return;
+  }
+
+  // determine the next chamber to go to, if lastChamber is not yet reached
+  int nextChamber(-1);
+  if (chamber > lastChamber) {
+    nextChamber = chamber - 1;
+  } else if (chamber < lastChamber) {
+    nextChamber = chamber + 1;
+  }
+
+  // loop over all DEs of plane1
+  TrackParam paramAtCluster1{};
+  TrackParam currentParamAtCluster1{};
+  TrackParam paramAtCluster2{};
+  ExcludedClusters newExcludedClusters(*this);
+  for (auto& de1 : mClusters[plane1]) {
+
+    // skip DE without cluster
+    if (de1.clusters.empty()) {
+      continue;
+    }
+
+    // look for cluster candidate in this DE
+    for (const auto& cluster1 : de1.clusters) {
+
+      // skip excluded clusters
+      if (excludedClusters.contains(getStoreIndex(cluster1))) {
+        continue;
+      }
+
+      // try to add the current cluster
+      if (!isCompatible(paramAtChamber, cluster1, paramAtCluster1)) {
+        continue;
+      }
+
+      // add it to the list of excluded clusters for this candidate
+      excludedClusters.insert(getStoreIndex(cluster1));
+
+      // skip tracks out of limits, but after checking for overlaps
+      bool isAcceptableAtCluster1 = isAcceptable(paramAtCluster1);
+
+      // save the current parameters at cluster1, reset the propagator and add MCS effects before going to plane2
+      currentParamAtCluster1 = paramAtCluster1;
+      currentParamAtCluster1.resetPropagator();
+      TrackExtrap::addMCSEffect(&currentParamAtCluster1, SChamberThicknessInX0[chamber], -1.);
+
+      // loop over all DEs of plane2
+      bool cluster2Found(false);
+      for (auto& de2 : mClusters[plane2]) {
+
+        // skip DE without cluster
+        if (de2.clusters.empty()) {
+          continue;
+        }
+
+        // skip DE that do not overlap with the DE of plane1
+        if (de2.deId % 100 != (de1.deId % 100 + 1) % SNDE[chamber] && de2.deId % 100 != (de1.deId % 100 - 1 + SNDE[chamber]) % SNDE[chamber]) {
+          continue;
+        }
+
+        // look for cluster candidate in this DE
+        for (const auto& cluster2 : de2.clusters) {
+
+          // try to add the current cluster
+          if (!isCompatible(currentParamAtCluster1, cluster2, paramAtCluster2)) {
+            continue;
+          }
+
+          cluster2Found = true;
+
+          // add it to the list of excluded clusters for this candidate
+          excludedClusters.insert(getStoreIndex(cluster2));
+
+          // skip tracks out of limits
+          if (!isAcceptableAtCluster1 || !isAcceptable(paramAtCluster2)) {
+            continue;
+          }
+
+          // continue the tracking to the next chambers with a new branch holding the 2 clusters
+          addClustersAndFollowBranch(itTrack, branch, paramAtCluster1, &paramAtCluster2, nextChamber, lastChamber, *newExcludedClusters);
+
+          // transfert the list of new excluded clusters to the full list for the initial candidate
+          newExcludedClusters->moveTo(excludedClusters);
+        }
+      }
+
+      if (!cluster2Found && isAcceptableAtCluster1) {
+
+        // continue the tracking with only cluster1 if no compatible cluster is found on plane2 and the track stays within limits
+        addClustersAndFollowBranch(itTrack, branch, paramAtCluster1, nullptr, nextChamber, lastChamber, *newExcludedClusters);
+
+        // transfert the list of new excluded clusters to the full list for the initial candidate
+        newExcludedClusters->moveTo(excludedClusters);
+      }
+    }
+  }
+
+  // loop over all DEs of plane2
+  for (auto& de2 : mClusters[plane2]) {
+
+    // skip DE without cluster
+    if (de2.clusters.empty()) {
+      continue;
+    }
+
+    // look for cluster candidate in this DE
+    for (const auto& cluster2 : de2.clusters) {
+
+      // skip excluded clusters (in particular the ones already attached together with a cluster on plane1)
+      if (excludedClusters.contains(getStoreIndex(cluster2))) {
+        continue;
+      }
+
+      // try to add the current cluster
+      if (!isCompatible(paramAtChamber, cluster2, paramAtCluster2)) {
+        continue;
+      }
+
+      // add it to the list of excluded clusters for this candidate
+      excludedClusters.insert(getStoreIndex(cluster2));
+
+      // skip tracks out of limits
+      if (!isAcceptable(paramAtCluster2)) {
+        continue;
+      }
+
+      // continue the tracking to the next chambers with a new branch holding the cluster
+      addClustersAndFollowBranch(itTrack, branch, paramAtCluster2, nullptr, nextChamber, lastChamber, *newExcludedClusters);
+
+      // transfert the list of new excluded clusters to the full list for the initial candidate
+      newExcludedClusters->moveTo(excludedClusters);
+    }
+  }
+
+  // reset the current parameters to the ones at that chamber if needed, not adding MCS effects yet
+  if (itTrack->getCurrentChamber() != chamber) {
+    setCurrentParam(*itTrack, paramAtChamber, chamber);
+  }
+}
+
+//_________________________________________________________________________________________________
+void TrackFinder::addClustersAndFollowBranch(std::list<Track>::iterator& itTrack, int branch, const TrackParam& paramAtCluster1,
+                                             const TrackParam* paramAtCluster2, int nextChamber, int lastChamber,
+                                             ClusterSet& excludedClusters)
+{
+  /// Start a new branch from "branch" holding the cluster(s)
+  /// If "nextChamber" >= 0: continue the tracking of "itTrack" along the new branch up to "lastChamber"
+  /// Every compatible clusters found in the process is added to the "excludedClusters" list of this candidate
+  /// If nextChamber < 0: record the new branch as a new track
+  /// The initial candidate "itTrack" is not modified, with the exception of its current parameters
+
+  // the list of excluded clusters must be empty here as new cluster(s) are being attached to the candidate
+  assert(excludedClusters.empty());
+
+  int newBranch = addBranch(branch, paramAtCluster1, paramAtCluster2);
+
+  if (nextChamber >= 0) {
+
+    // the tracking continues from paramAtCluster2, if any, or from paramAtCluster1
+    if (paramAtCluster2) {
+      print("addClustersAndFollowBranch: 2 clusters found (", paramAtCluster1.getClusterPtr()->getIdAsString(), " and ",
+            paramAtCluster2->getClusterPtr()->getIdAsString(), "). Continuing the tracking of candidate #", getTrackIndex(itTrack));
+      setCurrentParam(*itTrack, *paramAtCluster2, paramAtCluster2->getClusterPtr()->getChamberId());
+    } else {
+      print("addClustersAndFollowBranch: 1 cluster found (", paramAtCluster1.getClusterPtr()->getIdAsString(),
+            "). Continuing the tracking of candidate #", getTrackIndex(itTrack));
+      setCurrentParam(*itTrack, paramAtCluster1, paramAtCluster1.getClusterPtr()->getChamberId());
+    }
+
+    // follow the track to the next chamber, which can be skipped if it is on the same station
+    bool canSkip = (nextChamber / 2 == paramAtCluster1.getClusterPtr()->getChamberId() / 2);
+    followBranchInChamber(itTrack, newBranch, nextChamber, lastChamber, canSkip, excludedClusters);
+
+  } else {
+
+    // or keep the new branch as a new track
+    mLeaves.push_back(newBranch);
+    print("addClustersAndFollowBranch: new track from branch ", newBranch);
+  }
+}
+
+//_________________________________________________________________________________________________
+int TrackFinder::addBranch(int previous, const TrackParam& paramAtCluster1, const TrackParam* paramAtCluster2)
+{
+  /// Record the cluster(s) attached after the branch "previous" (-1 if none) and return the index of the new branch
+  /// The branches of the previous candidates are reused to limit the allocations
+
+  if (mNBranches == mBranches.size()) {
+    mBranches.emplace_back();
+  }
+  auto& branch = mBranches[mNBranches];
+  branch.paramAtCluster1 = paramAtCluster1;
+  branch.hasCluster2 = (paramAtCluster2 != nullptr);
+  if (paramAtCluster2) {
+    branch.paramAtCluster2 = *paramAtCluster2;
+  }
+  branch.previous = previous;
+  return mNBranches++;
+}
+
+//_________________________________________________________________________________________________
+std::list<Track>::iterator TrackFinder::createTracksFromBranches(const std::list<Track>::iterator& itTrack)
+{
+  /// Add a copy of "itTrack" before it for every branch recorded in mLeaves, in the order they were found,
+  /// and attach to it the clusters of the branch and of all the previous ones
+  /// Return an iterator to the first new track, or mTracks.end() if none
+
+  auto itFirstNewTrack(mTracks.end());
+
+  for (int leaf : mLeaves) {
+    auto itNewTrack = mTracks.emplace(itTrack, *itTrack);
+    print("createTracksFromBranches: duplicating candidate at position #", getTrackIndex(itNewTrack), " for branch ", leaf);
+    for (int branch = leaf; branch >= 0; branch = mBranches[branch].previous) {
+      itNewTrack->addParamAtCluster(mBranches[branch].paramAtCluster1);
+      if (mBranches[branch].hasCluster2) {
+        itNewTrack->addParamAtCluster(mBranches[branch].paramAtCluster2);
+      }
+    }
+    if (itFirstNewTrack == mTracks.end()) {
+      itFirstNewTrack = itNewTrack;
+    }
+  }
+
+  return itFirstNewTrack;
+}
+
+//_________________________________________________________________________________________________
+std::list<Track>::iterator TrackFinder::followTrackInChamberByCopy(std::list<Track>::iterator& itTrack,
+                                                                   int chamber, int lastChamber, bool canSkip,
+                                                                   ClusterSet& excludedClusters)
+{
+  /// Same as followTrackInChamber, but every valid track found is added before "itTrack" as soon as it reaches
+  /// the last requested chamber, the clusters being attached to the new tracks while going back up the recursion
+  /// This is the original algorithm, slower as the candidate is copied at each branching, kept as a reference
+
+  // list of (half-)planes, 2 or 4 per chamber, ordered according to the direction of propagation,
+  // which is forward when going to station 5 and backward otherwise with the present algorithm
+  static constexpr int plane[10][4] = {{1, 0, -1, -1}, {3, 2, -1, -1}, {5, 4, -1, -1}, {7, 6, -1, -1}, {11, 10, 9, 8}, {15, 14, 13, 12}, {19, 18, 17, 16}, {23, 22, 21, 20}, {24, 25, 26, 27}, {28, 29, 30, 31}};
+
+  print("followTrackInChamberByCopy: follow track #", getTrackIndex(itTrack), " to chamber ", chamber + 1, " up to chamber ", lastChamber + 1);
 
   // the current track parameters must be set at a different chamber and valid
   if (!itTrack->areCurrentParamValid() || chamber == itTrack->getCurrentChamber()) {
@@ -754,9 +1181,9 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
   bool isFirstOnStation = ((chamber < currentChamber && chamber % 2 == 1) || (chamber > currentChamber && chamber % 2 == 0));
 
   // follow the track in the 2 planes or 4 half-planes of the chamber
-  auto itFirstNewTrack = followTrackInChamber(itTrack, plane[chamber][0], plane[chamber][1], lastChamber, excludedClusters);
+  auto itFirstNewTrack = followTrackInPlanesByCopy(itTrack, plane[chamber][0], plane[chamber][1], lastChamber, excludedClusters);
   if (chamber > 3) {
-    auto itNewTrack = followTrackInChamber(itTrack, plane[chamber][2], plane[chamber][3], lastChamber, excludedClusters);
+    auto itNewTrack = followTrackInPlanesByCopy(itTrack, plane[chamber][2], plane[chamber][3], lastChamber, excludedClusters);
     if (itFirstNewTrack == mTracks.end()) {
       itFirstNewTrack = itNewTrack;
     }
@@ -778,7 +1205,7 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
     // i.e. if a compatible cluster has been found on the first chamber and none has been found on the second
     if (isFirstOnStation || (canSkip && excludedClusters.empty())) {
       int nextChamber = (chamber > lastChamber) ? chamber - 1 : chamber + 1;
-      auto itNewTrack = followTrackInChamber(itTrack, nextChamber, lastChamber, false, excludedClusters);
+      auto itNewTrack = followTrackInChamberByCopy(itTrack, nextChamber, lastChamber, false, excludedClusters);
       if (itFirstNewTrack == mTracks.end()) {
         itFirstNewTrack = itNewTrack;
       }
@@ -787,7 +1214,7 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
     // consider the possibility to skip the entire station if not requested and not the last one
     if (isFirstOnStation && !SRequestStation[chamber / 2] && chamber / 2 != lastChamber / 2) {
       int nextChamber = (chamber > lastChamber) ? chamber - 2 : chamber + 2;
-      auto itNewTrack = followTrackInChamber(itTrack, nextChamber, lastChamber, false, excludedClusters);
+      auto itNewTrack = followTrackInChamberByCopy(itTrack, nextChamber, lastChamber, false, excludedClusters);
       if (itFirstNewTrack == mTracks.end()) {
         itFirstNewTrack = itNewTrack;
       }
@@ -805,7 +1232,7 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
     if ((!isFirstOnStation && canSkip && excludedClusters.empty()) ||
         (chamber / 2 == 0 && !SRequestStation[0] && (isFirstOnStation || !canSkip))) {
       itFirstNewTrack = mTracks.emplace(itTrack, *itTrack);
-      print("followTrackInChamber: duplicating candidate at position #", getTrackIndex(itFirstNewTrack));
+      print("followTrackInChamberByCopy: duplicating candidate at position #", getTrackIndex(itFirstNewTrack));
     }
   }
 
@@ -813,9 +1240,9 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
 }
 
 //_________________________________________________________________________________________________
-std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::iterator& itTrack,
-                                                             int plane1, int plane2, int lastChamber,
-                                                             std::unordered_map<int, std::unordered_set<uint32_t>>& excludedClusters)
+std::list<Track>::iterator TrackFinder::followTrackInPlanesByCopy(std::list<Track>::iterator& itTrack,
+                                                                  int plane1, int plane2, int lastChamber,
+                                                                  ClusterSet& excludedClusters)
 {
   /// Follow the track candidate pointed to by "itTrack" to the (half)chamber formed by "plane1" and "plane2"
   /// The tracking starts from the current parameters, which must have already been set
@@ -830,7 +1257,7 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
   /// The initial candidate "itTrack" is not modified, with the exception of its current parameters,
   /// which are set to the parameters at that chamber without adding MCS effects, or invalidated in case of issue
 
-  print("followTrackInChamber: follow track #", getTrackIndex(itTrack), " to planes ", plane1, " and ", plane2, " up to chamber ", lastChamber + 1);
+  print("followTrackInPlanesByCopy: follow track #", getTrackIndex(itTrack), " to planes ", plane1, " and ", plane2, " up to chamber ", lastChamber + 1);
   printTrack(*itTrack);
 
   // the current track parameters must be set and valid
@@ -866,23 +1293,19 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
   TrackParam paramAtCluster1{};
   TrackParam currentParamAtCluster1{};
   TrackParam paramAtCluster2{};
-  std::unordered_map<int, std::unordered_set<uint32_t>> newExcludedClusters{};
+  ExcludedClusters newExcludedClusters(*this);
   for (auto& de1 : mClusters[plane1]) {
 
     // skip DE without cluster
-    if (de1.second == nullptr) {
+    if (de1.clusters.empty()) {
       continue;
     }
 
-    // get the list of excluded clusters for the DE
-    auto itExcludedClusters = excludedClusters.find(de1.first);
-    bool hasExcludedClusters = (itExcludedClusters != excludedClusters.end());
-
     // look for cluster candidate in this DE
-    for (const auto& cluster1 : *de1.second) {
+    for (const auto& cluster1 : de1.clusters) {
 
       // skip excluded clusters
-      if (hasExcludedClusters && itExcludedClusters->second.count(cluster1.getUniqueId()) > 0) {
+      if (excludedClusters.contains(getStoreIndex(cluster1))) {
         continue;
       }
 
@@ -892,7 +1315,7 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
       }
 
       // add it to the list of excluded clusters for this candidate
-      excludedClusters[de1.first].emplace(cluster1.getUniqueId());
+      excludedClusters.insert(getStoreIndex(cluster1));
 
       // skip tracks out of limits, but after checking for overlaps
       bool isAcceptableAtCluster1 = isAcceptable(paramAtCluster1);
@@ -907,17 +1330,17 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
       for (auto& de2 : mClusters[plane2]) {
 
         // skip DE without cluster
-        if (de2.second == nullptr) {
+        if (de2.clusters.empty()) {
           continue;
         }
 
         // skip DE that do not overlap with the DE of plane1
-        if (de2.first % 100 != (de1.first % 100 + 1) % SNDE[chamber] && de2.first % 100 != (de1.first % 100 - 1 + SNDE[chamber]) % SNDE[chamber]) {
+        if (de2.deId % 100 != (de1.deId % 100 + 1) % SNDE[chamber] && de2.deId % 100 != (de1.deId % 100 - 1 + SNDE[chamber]) % SNDE[chamber]) {
           continue;
         }
 
         // look for cluster candidate in this DE
-        for (const auto& cluster2 : *de2.second) {
+        for (const auto& cluster2 : de2.clusters) {
 
           // try to add the current cluster
           if (!isCompatible(currentParamAtCluster1, cluster2, paramAtCluster2)) {
@@ -927,7 +1350,7 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
           cluster2Found = true;
 
           // add it to the list of excluded clusters for this candidate
-          excludedClusters[de2.first].emplace(cluster2.getUniqueId());
+          excludedClusters.insert(getStoreIndex(cluster2));
 
           // skip tracks out of limits
           if (!isAcceptableAtCluster1 || !isAcceptable(paramAtCluster2)) {
@@ -935,26 +1358,26 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
           }
 
           // continue the tracking to the next chambers and attach the 2 clusters to the new tracks if any
-          auto itNewTrack = addClustersAndFollowTrack(itTrack, paramAtCluster1, &paramAtCluster2, nextChamber, lastChamber, newExcludedClusters);
+          auto itNewTrack = addClustersAndFollowTrackByCopy(itTrack, paramAtCluster1, &paramAtCluster2, nextChamber, lastChamber, *newExcludedClusters);
           if (itFirstNewTrack == mTracks.end()) {
             itFirstNewTrack = itNewTrack;
           }
 
           // transfert the list of new excluded clusters to the full list for the initial candidate
-          moveClusters(newExcludedClusters, excludedClusters);
+          newExcludedClusters->moveTo(excludedClusters);
         }
       }
 
       if (!cluster2Found && isAcceptableAtCluster1) {
 
         // continue the tracking with only cluster1 if no compatible cluster is found on plane2 and the track stays within limits
-        auto itNewTrack = addClustersAndFollowTrack(itTrack, paramAtCluster1, nullptr, nextChamber, lastChamber, newExcludedClusters);
+        auto itNewTrack = addClustersAndFollowTrackByCopy(itTrack, paramAtCluster1, nullptr, nextChamber, lastChamber, *newExcludedClusters);
         if (itFirstNewTrack == mTracks.end()) {
           itFirstNewTrack = itNewTrack;
         }
 
         // transfert the list of new excluded clusters to the full list for the initial candidate
-        moveClusters(newExcludedClusters, excludedClusters);
+        newExcludedClusters->moveTo(excludedClusters);
       }
     }
   }
@@ -963,19 +1386,15 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
   for (auto& de2 : mClusters[plane2]) {
 
     // skip DE without cluster
-    if (de2.second == nullptr) {
+    if (de2.clusters.empty()) {
       continue;
     }
 
-    // get the list of excluded clusters for the DE
-    auto itExcludedClusters = excludedClusters.find(de2.first);
-    bool hasExcludedClusters = (itExcludedClusters != excludedClusters.end());
-
     // look for cluster candidate in this DE
-    for (const auto& cluster2 : *de2.second) {
+    for (const auto& cluster2 : de2.clusters) {
 
       // skip excluded clusters (in particular the ones already attached together with a cluster on plane1)
-      if (hasExcludedClusters && itExcludedClusters->second.count(cluster2.getUniqueId()) > 0) {
+      if (excludedClusters.contains(getStoreIndex(cluster2))) {
         continue;
       }
 
@@ -985,7 +1404,7 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
       }
 
       // add it to the list of excluded clusters for this candidate
-      excludedClusters[de2.first].emplace(cluster2.getUniqueId());
+      excludedClusters.insert(getStoreIndex(cluster2));
 
       // skip tracks out of limits
       if (!isAcceptable(paramAtCluster2)) {
@@ -993,13 +1412,13 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
       }
 
       // continue the tracking to the next chambers and attach the cluster to the new tracks if any
-      auto itNewTrack = addClustersAndFollowTrack(itTrack, paramAtCluster2, nullptr, nextChamber, lastChamber, newExcludedClusters);
+      auto itNewTrack = addClustersAndFollowTrackByCopy(itTrack, paramAtCluster2, nullptr, nextChamber, lastChamber, *newExcludedClusters);
       if (itFirstNewTrack == mTracks.end()) {
         itFirstNewTrack = itNewTrack;
       }
 
       // transfert the list of new excluded clusters to the full list for the initial candidate
-      moveClusters(newExcludedClusters, excludedClusters);
+      newExcludedClusters->moveTo(excludedClusters);
     }
   }
 
@@ -1012,9 +1431,9 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
 }
 
 //_________________________________________________________________________________________________
-std::list<Track>::iterator TrackFinder::addClustersAndFollowTrack(std::list<Track>::iterator& itTrack, const TrackParam& paramAtCluster1,
-                                                                  const TrackParam* paramAtCluster2, int nextChamber, int lastChamber,
-                                                                  std::unordered_map<int, std::unordered_set<uint32_t>>& excludedClusters)
+std::list<Track>::iterator TrackFinder::addClustersAndFollowTrackByCopy(std::list<Track>::iterator& itTrack, const TrackParam& paramAtCluster1,
+                                                                        const TrackParam* paramAtCluster2, int nextChamber, int lastChamber,
+                                                                        ClusterSet& excludedClusters)
 {
   /// If "nextChamber" >= 0: continue the tracking of "itTrack" up to "lastChamber", attach the two clusters
   /// to every new tracks found and return an iterator to the first of them (or mTracks.end() if none is found)
@@ -1031,18 +1450,18 @@ std::list<Track>::iterator TrackFinder::addClustersAndFollowTrack(std::list<Trac
 
     // the tracking continues from paramAtCluster2, if any, or from paramAtCluster1
     if (paramAtCluster2) {
-      print("addClustersAndFollowTrack: 2 clusters found (", paramAtCluster1.getClusterPtr()->getIdAsString(), " and ",
+      print("addClustersAndFollowTrackByCopy: 2 clusters found (", paramAtCluster1.getClusterPtr()->getIdAsString(), " and ",
             paramAtCluster2->getClusterPtr()->getIdAsString(), "). Continuing the tracking of candidate #", getTrackIndex(itTrack));
       setCurrentParam(*itTrack, *paramAtCluster2, paramAtCluster2->getClusterPtr()->getChamberId());
     } else {
-      print("addClustersAndFollowTrack: 1 cluster found (", paramAtCluster1.getClusterPtr()->getIdAsString(),
+      print("addClustersAndFollowTrackByCopy: 1 cluster found (", paramAtCluster1.getClusterPtr()->getIdAsString(),
             "). Continuing the tracking of candidate #", getTrackIndex(itTrack));
       setCurrentParam(*itTrack, paramAtCluster1, paramAtCluster1.getClusterPtr()->getChamberId());
     }
 
     // follow the track to the next chamber, which can be skipped if it is on the same station
     bool canSkip = (nextChamber / 2 == paramAtCluster1.getClusterPtr()->getChamberId() / 2);
-    auto itNewTrack = followTrackInChamber(itTrack, nextChamber, lastChamber, canSkip, excludedClusters);
+    auto itNewTrack = followTrackInChamberByCopy(itTrack, nextChamber, lastChamber, canSkip, excludedClusters);
     itFirstNewTrack = itNewTrack;
 
     // attach the current cluster(s) to every new tracks found
@@ -1051,10 +1470,10 @@ std::list<Track>::iterator TrackFinder::addClustersAndFollowTrack(std::list<Trac
         itNewTrack->addParamAtCluster(paramAtCluster1);
         if (paramAtCluster2) {
           itNewTrack->addParamAtCluster(*paramAtCluster2);
-          print("addClustersAndFollowTrack: add to the candidate at position #", getTrackIndex(itNewTrack),
+          print("addClustersAndFollowTrackByCopy: add to the candidate at position #", getTrackIndex(itNewTrack),
                 " clusters ", paramAtCluster1.getClusterPtr()->getIdAsString(), " and ", paramAtCluster2->getClusterPtr()->getIdAsString());
         } else {
-          print("addClustersAndFollowTrack: add to the candidate at position #", getTrackIndex(itNewTrack),
+          print("addClustersAndFollowTrackByCopy: add to the candidate at position #", getTrackIndex(itNewTrack),
                 " cluster ", paramAtCluster1.getClusterPtr()->getIdAsString());
         }
         ++itNewTrack;
@@ -1068,10 +1487,10 @@ std::list<Track>::iterator TrackFinder::addClustersAndFollowTrack(std::list<Trac
     itFirstNewTrack->addParamAtCluster(paramAtCluster1);
     if (paramAtCluster2) {
       itFirstNewTrack->addParamAtCluster(*paramAtCluster2);
-      print("addClustersAndFollowTrack: duplicating candidate at position #", getTrackIndex(itFirstNewTrack), " to add 2 clusters (",
+      print("addClustersAndFollowTrackByCopy: duplicating candidate at position #", getTrackIndex(itFirstNewTrack), " to add 2 clusters (",
             paramAtCluster1.getClusterPtr()->getIdAsString(), " and ", paramAtCluster2->getClusterPtr()->getIdAsString(), ")");
     } else {
-      print("addClustersAndFollowTrack: duplicating candidate at position #", getTrackIndex(itFirstNewTrack),
+      print("addClustersAndFollowTrackByCopy: duplicating candidate at position #", getTrackIndex(itFirstNewTrack),
             " to add 1 cluster (", paramAtCluster1.getClusterPtr()->getIdAsString(), ")");
     }
   }
@@ -1413,7 +1832,7 @@ bool TrackFinder::areUsed(const Cluster& cl1, const Cluster& cl2, const std::lis
 
 //_________________________________________________________________________________________________
 void TrackFinder::excludeClustersFromIdenticalTracks(const std::list<Track>::iterator& itTrack,
-                                                     std::unordered_map<int, std::unordered_set<uint32_t>>& excludedClusters,
+                                                     ClusterSet& excludedClusters,
                                                      const std::list<Track>::iterator& itEndTrack)
 {
   /// Find tracks in the range [mTracks.begin(), itEndTrack[ that contain all the clusters of itTrack
@@ -1423,7 +1842,7 @@ void TrackFinder::excludeClustersFromIdenticalTracks(const std::list<Track>::ite
       for (auto itParam = itTrack2->rbegin(); itParam != itTrack2->rend(); ++itParam) {
         const Cluster* cluster = itParam->getClusterPtr();
         if (cluster->getChamberId() > 7) {
-          excludedClusters[cluster->getDEId()].emplace(cluster->getUniqueId());
+          excludedClusters.insert(getStoreIndex(*cluster));
         } else {
           break;
         }
@@ -1433,13 +1852,39 @@ void TrackFinder::excludeClustersFromIdenticalTracks(const std::list<Track>::ite
 }
 
 //_________________________________________________________________________________________________
-void TrackFinder::moveClusters(std::unordered_map<int, std::unordered_set<uint32_t>>& source, std::unordered_map<int, std::unordered_set<uint32_t>>& destination)
+TrackFinder::DEClusters* TrackFinder::findDE(int deId)
+{
+  /// Return the DE with this ID or nullptr if it does not exist
+  return (deId >= 0 && deId < static_cast<int>(mDEs.size())) ? mDEs[deId] : nullptr;
+}
+
+//_________________________________________________________________________________________________
+void TrackFinder::prepareClusterSets()
 {
-  /// Move cluster Ids listed in source into destination then clear source
-  for (auto& sourceDE : source) {
-    destination[sourceDE.first].insert(sourceDE.second.begin(), sourceDE.second.end());
+  /// Resize the sets of excluded clusters to the number of clusters of the current event
+  assert(mNUsedClusterSets == 0);
+  for (auto& clusterSet : mClusterSets) {
+    clusterSet->reset(mClusterStore.size());
   }
-  source.clear();
+}
+
+//_________________________________________________________________________________________________
+TrackFinder::ClusterSet& TrackFinder::acquireClusterSet()
+{
+  /// Take an empty set of excluded clusters from the pool, creating it if needed
+  /// The sets are taken and released in LIFO order, following the recursion of the tracking
+  if (mNUsedClusterSets == mClusterSets.size()) {
+    mClusterSets.emplace_back(std::make_unique<ClusterSet>());
+    mClusterSets.back()->reset(mClusterStore.size());
+  }
+  return *mClusterSets[mNUsedClusterSets++];
+}
+
+//_________________________________________________________________________________________________
+void TrackFinder::releaseClusterSet()
+{
+  /// Give back to the pool the last set of excluded clusters taken from it
+  mClusterSets[--mNUsedClusterSets]->clear();
 }
 
 //_________________________________________________________________________________________________
@@ -17,13 +17,18 @@
 #define ALICEO2_MCH_TRACKFINDER_H_
 
 #include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
 #include <unordered_map>
-#include <unordered_set>
 #include <list>
 #include <array>
 #include <vector>
 #include <utility>
 
+#include <gsl/span>
+
+#include "MCHBase/ClusterBlock.h"
 #include "Cluster.h"
 #include "Track.h"
 #include "TrackFitter.h"
@@ -47,11 +52,24 @@ class TrackFinder
 
   void init(float l3Current, float dipoleCurrent);
 
+  /// The clusters are copied internally and the track parameters of the returned tracks (and of their copies)
+  /// point to these copies, which remain valid until the next call to findTracks or the destruction of the finder
   const std::list<Track>& findTracks(const std::unordered_map<int, std::list<Cluster>>& clusters);
+  const std::list<Track>& findTracks(gsl::span<const ClusterStruct> clusters);
+
+  /// return true if the cluster belongs to the internal storage of the current event
+  bool isFromCurrentEvent(const Cluster* cluster) const
+  {
+    return !mClusterStore.empty() && cluster >= mClusterStore.data() && cluster < mClusterStore.data() + mClusterStore.size();
+  }
 
   /// set the flag to try to find more track candidates starting from 1 cluster in each of station (1..) 4 and 5
   void findMoreTrackCandidates(bool moreCandidates) { mMoreCandidates = moreCandidates; }
 
+  /// set the flag to duplicate the candidates at each branching, as originally done, instead of recording the
+  /// branches and creating the tracks at the end. Both give the same tracks, this is kept as a reference for the tests
+  void duplicateCandidatesAtBranching(bool duplicate) { mDuplicateAtBranching = duplicate; }
+
   /// set the debug level defining the verbosity
   void debug(int debugLevel) { mDebugLevel = debugLevel; }
 
@@ -59,6 +77,88 @@ class TrackFinder
   void printTimers() const;
 
  private:
+  /// clusters of one DE, stored contiguously in mClusterStore
+  struct DEClusters {
+    explicit DEClusters(int id) : deId(id) {}
+    int deId;                          ///< DE ID
+    gsl::span<const Cluster> clusters; ///< clusters of this DE, if any
+  };
+
+  /// set of clusters, identified by their position in mClusterStore
+  class ClusterSet
+  {
+   public:
+    /// resize the set for the given number of clusters and empty it
+    void reset(size_t nClusters)
+    {
+      mBits.assign((nClusters + 63) / 64, 0);
+      mIndices.clear();
+    }
+    bool contains(int index) const { return (mBits[index / 64] >> (index % 64)) & 1; }
+    void insert(int index)
+    {
+      auto bit = uint64_t(1) << (index % 64);
+      if ((mBits[index / 64] & bit) == 0) {
+        mBits[index / 64] |= bit;
+        mIndices.push_back(index);
+      }
+    }
+    bool empty() const { return mIndices.empty(); }
+    /// add the clusters to the destination then empty this set
+    void moveTo(ClusterSet& destination)
+    {
+      for (auto index : mIndices) {
+        destination.insert(index);
+        mBits[index / 64] = 0;
+      }
+      mIndices.clear();
+    }
+    /// empty the set, at a cost proportional to its size
+    void clear()
+    {
+      for (auto index : mIndices) {
+        mBits[index / 64] = 0;
+      }
+      mIndices.clear();
+    }
+
+   private:
+    std::vector<uint64_t> mBits{}; ///< one bit per cluster
+    std::vector<int> mIndices{};   ///< clusters in the set
+  };
+
+  /// cluster(s) attached to a track candidate at one chamber, continuing the branch "previous" (-1 if none)
+  struct Branch {
+    TrackParam paramAtCluster1{}; ///< parameters at the first cluster
+    TrackParam paramAtCluster2{}; ///< parameters at the second cluster, if any
+    bool hasCluster2 = false;     ///< true if a second cluster is attached
+    int previous = -1;            ///< index of the previous branch in mBranches
+  };
+
+  /// set of excluded clusters taken from the pool of the track finder for the lifetime of this object
+  class ExcludedClusters
+  {
+   public:
+    ExcludedClusters(TrackFinder& finder) : mFinder(finder), mSet(finder.acquireClusterSet()) {}
+    ~ExcludedClusters() { mFinder.releaseClusterSet(); }
+    ExcludedClusters(const ExcludedClusters&) = delete;
+    ExcludedClusters& operator=(const ExcludedClusters&) = delete;
+    ClusterSet& operator*() { return mSet; }
+    ClusterSet* operator->() { return &mSet; }
+
+   private:
+    TrackFinder& mFinder;
+    ClusterSet& mSet;
+  };
+
+  const std::list<Track>& findTracks();
+  void prepareClusterSets();
+  ClusterSet& acquireClusterSet();
+  void releaseClusterSet();
+  /// return the position of the cluster in mClusterStore
+  int getStoreIndex(const Cluster& cluster) const { return &cluster - mClusterStore.data(); }
+  DEClusters* findDE(int deId);
+
   void findTrackCandidates();
   void findTrackCandidatesInSt5();
   void findTrackCandidatesInSt4();
@@ -68,13 +168,27 @@ class TrackFinder
   std::list<Track>::iterator followTrackInOverlapDE(const std::list<Track>::iterator& itTrack, int currentDE, int plane);
   std::list<Track>::iterator followTrackInChamber(std::list<Track>::iterator& itTrack,
                                                   int chamber, int lastChamber, bool canSkip,
-                                                  std::unordered_map<int, std::unordered_set<uint32_t>>& excludedClusters);
-  std::list<Track>::iterator followTrackInChamber(std::list<Track>::iterator& itTrack,
-                                                  int plane1, int plane2, int lastChamber,
-                                                  std::unordered_map<int, std::unordered_set<uint32_t>>& excludedClusters);
-  std::list<Track>::iterator addClustersAndFollowTrack(std::list<Track>::iterator& itTrack, const TrackParam& paramAtCluster1,
-                                                       const TrackParam* paramAtCluster2, int nextChamber, int lastChamber,
-                                                       std::unordered_map<int, std::unordered_set<uint32_t>>& excludedClusters);
+                                                  ClusterSet& excludedClusters);
+  void followBranchInChamber(std::list<Track>::iterator& itTrack, int branch,
+                             int chamber, int lastChamber, bool canSkip,
+                             ClusterSet& excludedClusters);
+  void followBranchInPlanes(std::list<Track>::iterator& itTrack, int branch,
+                            int plane1, int plane2, int lastChamber,
+                            ClusterSet& excludedClusters);
+  void addClustersAndFollowBranch(std::list<Track>::iterator& itTrack, int branch, const TrackParam& paramAtCluster1,
+                                  const TrackParam* paramAtCluster2, int nextChamber, int lastChamber,
+                                  ClusterSet& excludedClusters);
+  int addBranch(int previous, const TrackParam& paramAtCluster1, const TrackParam* paramAtCluster2);
+  std::list<Track>::iterator createTracksFromBranches(const std::list<Track>::iterator& itTrack);
+  std::list<Track>::iterator followTrackInChamberByCopy(std::list<Track>::iterator& itTrack,
+                                                        int chamber, int lastChamber, bool canSkip,
+                                                        ClusterSet& excludedClusters);
+  std::list<Track>::iterator followTrackInPlanesByCopy(std::list<Track>::iterator& itTrack,
+                                                       int plane1, int plane2, int lastChamber,
+                                                       ClusterSet& excludedClusters);
+  std::list<Track>::iterator addClustersAndFollowTrackByCopy(std::list<Track>::iterator& itTrack, const TrackParam& paramAtCluster1,
+                                                             const TrackParam* paramAtCluster2, int nextChamber, int lastChamber,
+                                                             ClusterSet& excludedClusters);
 
   void improveTracks();
 
@@ -93,9 +207,8 @@ class TrackFinder
 
   bool areUsed(const Cluster& cl1, const Cluster& cl2, const std::list<Track>::iterator& itFirstTrack, const std::list<Track>::iterator& itLastTrack);
   void excludeClustersFromIdenticalTracks(const std::list<Track>::iterator& itTrack,
-                                          std::unordered_map<int, std::unordered_set<uint32_t>>& excludedClusters,
+                                          ClusterSet& excludedClusters,
                                           const std::list<Track>::iterator& itEndTrack);
-  void moveClusters(std::unordered_map<int, std::unordered_set<uint32_t>>& source, std::unordered_map<int, std::unordered_set<uint32_t>>& destination);
 
   bool isCompatible(const TrackParam& param, const Cluster& cluster, TrackParam& paramAtCluster);
   bool tryOneClusterFast(const TrackParam& param, const Cluster& cluster);
@@ -136,13 +249,24 @@ class TrackFinder
 
   TrackFitter mTrackFitter{}; /// track fitter
 
-  std::array<std::vector<std::pair<const int, const std::list<Cluster>*>>, 32> mClusters{}; ///< array of pointers to the lists of clusters per DE
+  std::array<std::vector<DEClusters>, 32> mClusters{}; ///< clusters per DE, grouped in (half-)planes
+  std::vector<Cluster> mClusterStore{};               ///< clusters of the current event, contiguous per DE
+  std::vector<DEClusters*> mDEs{};                    ///< DEs indexed by their ID, nullptr if unknown
+  std::vector<int> mDECursors{};                      ///< working space to fill mClusterStore, indexed by DE ID
+
+  std::vector<std::unique_ptr<ClusterSet>> mClusterSets{}; ///< pool of sets of excluded clusters
+  std::size_t mNUsedClusterSets = 0;                       ///< number of sets currently taken from the pool
+
+  std::deque<Branch> mBranches{}; ///< branches of the candidate being followed, reused from one candidate to the next
+  std::size_t mNBranches = 0;     ///< number of branches in use
+  std::vector<int> mLeaves{};     ///< last branch of every new track found for the candidate being followed
 
   std::list<Track> mTracks{}; ///< list of reconstructed tracks
 
   double mMaxMCSAngle2[10]{}; ///< maximum angle dispersion due to MCS
 
   bool mMoreCandidates = false; ///< try to find more track candidates starting from 1 cluster in each of station (1..) 4 and 5
+  bool mDuplicateAtBranching = false; ///< duplicate the candidates at each branching instead of recording the branches
 
   int mDebugLevel = 0; ///< debug level defining the verbosity
 
@@ -15,11 +15,13 @@
 
 #include "TrackFinderSpec.h"
 
+#include <cassert>
 #include <chrono>
-#include <unordered_map>
 #include <list>
 #include <stdexcept>
 
+#include <gsl/span>
+
 #include "Framework/CallbackService.h"
 #include "Framework/ConfigParamRegistry.h"
 #include "Framework/ControlService.h"
@@ -31,6 +33,7 @@
 #include "MCHBase/ClusterBlock.h"
 #include "MCHBase/TrackBlock.h"
 #include "TrackParam.h"
+#include "TrackExtrap.h"
 #include "Cluster.h"
 #include "Track.h"
 #include "TrackFinder.h"
@@ -56,6 +59,10 @@ class TrackFinderTask
     auto l3Current = ic.options().get<float>("l3Current");
     auto dipoleCurrent = ic.options().get<float>("dipoleCurrent");
     mTrackFinder.init(l3Current, dipoleCurrent);
+    auto fieldGridStep = ic.options().get<float>("fieldGridStep");
+    if (fieldGridStep > 0.f) {
+      TrackExtrap::useFieldGrid(fieldGridStep);
+    }
 
     auto moreCandidates = ic.options().get<bool>("moreCandidates");
     mTrackFinder.findMoreTrackCandidates(moreCandidates);
@@ -67,6 +74,10 @@ class TrackFinderTask
       mTrackFinder.printStats();
       mTrackFinder.printTimers();
       LOG(INFO) << "tracking duration = " << mElapsedTime.count() << " s";
+      if (mElapsedTime.count() > 0.) {
+        LOG(INFO) << "tracking throughput = " << mNTracks / mElapsedTime.count() << " tracks/s, "
+                  << mNEvents / mElapsedTime.count() << " events/s";
+      }
     };
     ic.services().get<CallbackService>().set(CallbackService::Id::Stop, stop);
   }
@@ -90,14 +101,15 @@ class TrackFinderTask
     sizeLeft -= SSizeOfInt;
 
     // get the input clusters
-    std::unordered_map<int, std::list<Cluster>> clusters{};
-    readClusters(bufferPtr, sizeLeft, clusters);
+    auto clusters = readClusters(bufferPtr, sizeLeft);
 
     // run the track finder
     auto tStart = std::chrono::high_resolution_clock::now();
     const auto& tracks = mTrackFinder.findTracks(clusters);
     auto tEnd = std::chrono::high_resolution_clock::now();
     mElapsedTime += tEnd - tStart;
+    mNTracks += tracks.size();
+    ++mNEvents;
 
     // calculate the size of the payload for the output message, excluding the event header
     int trackSize = getSize(tracks);
@@ -117,9 +129,9 @@ class TrackFinderTask
 
  private:
   //_________________________________________________________________________________________________
-  void readClusters(const char*& bufferPtr, int& sizeLeft, std::unordered_map<int, std::list<Cluster>>& clusters)
+  gsl::span<const ClusterStruct> readClusters(const char*& bufferPtr, int& sizeLeft)
   {
-    /// read the cluster informations from the buffer
+    /// read the cluster informations from the buffer, without copying them
     /// move the buffer ptr and decrease the size left
     /// throw an exception in case of error
 
@@ -131,21 +143,19 @@ class TrackFinderTask
     bufferPtr += SSizeOfInt;
     sizeLeft -= SSizeOfInt;
 
-    for (int iCl = 0; iCl < nClusters; ++iCl) {
-
-      // read cluster info
-      if (sizeLeft < SSizeOfClusterStruct) {
-        throw out_of_range("missing cluster");
-      }
-      const auto cluster = reinterpret_cast<const ClusterStruct*>(bufferPtr);
-      clusters[cluster->getDEId()].emplace_back(*cluster);
-      bufferPtr += SSizeOfClusterStruct;
-      sizeLeft -= SSizeOfClusterStruct;
+    // read cluster info
+    if (nClusters < 0 || sizeLeft < nClusters * SSizeOfClusterStruct) {
+      throw out_of_range("missing cluster");
     }
+    gsl::span<const ClusterStruct> clusters(reinterpret_cast<const ClusterStruct*>(bufferPtr), nClusters);
+    bufferPtr += nClusters * SSizeOfClusterStruct;
+    sizeLeft -= nClusters * SSizeOfClusterStruct;
 
     if (sizeLeft != 0) {
       throw length_error("incorrect payload");
     }
+
+    return clusters;
   }
 
   //_________________________________________________________________________________________________
@@ -182,6 +192,7 @@ class TrackFinderTask
   void writeTracks(const std::list<Track>& tracks, char*& bufferPtr) const
   {
     /// write the track informations in the buffer and move the buffer ptr
+    /// the tracks must come from the last call to findTracks, their clusters being owned by the track finder
 
     // write the number of tracks
     int nTracks = tracks.size();
@@ -208,6 +219,7 @@ class TrackFinderTask
       for (const auto& param : track) {
 
         // write cluster info
+        assert(mTrackFinder.isFromCurrentEvent(param.getClusterPtr()));
         ClusterStruct clusterStruct = param.getClusterPtr()->getClusterStruct();
         memcpy(bufferPtr, &clusterStruct, SSizeOfClusterStruct);
         bufferPtr += SSizeOfClusterStruct;
@@ -223,6 +235,8 @@ class TrackFinderTask
 
   TrackFinder mTrackFinder{};                   ///< track finder
   std::chrono::duration<double> mElapsedTime{}; ///< timer
+  std::size_t mNTracks = 0;                     ///< number of tracks found
+  std::size_t mNEvents = 0;                     ///< number of events processed
 };
 
 //_________________________________________________________________________________________________
@@ -235,6 +249,7 @@ o2::framework::DataProcessorSpec getTrackFinderSpec()
     AlgorithmSpec{adaptFromTask<TrackFinderTask>()},
     Options{{"l3Current", VariantType::Float, -30000.0f, {"L3 current"}},
             {"dipoleCurrent", VariantType::Float, -6000.0f, {"Dipole current"}},
+            {"fieldGridStep", VariantType::Float, 0.0f, {"step (cm) of the precomputed field grid used in the extrapolation (0 = use the field map)"}},
             {"moreCandidates", VariantType::Bool, false, {"Find more track candidates"}},
             {"debug", VariantType::Int, 0, {"debug level"}}}};
 }
@@ -28,6 +28,7 @@
 #include "MCHBase/ClusterBlock.h"
 #include "MCHBase/TrackBlock.h"
 #include "TrackParam.h"
+#include "TrackExtrap.h"
 #include "Cluster.h"
 #include "Track.h"
 #include "TrackFitter.h"
@@ -51,6 +52,10 @@ class TrackFitterTask
     auto l3Current = ic.options().get<float>("l3Current");
     auto dipoleCurrent = ic.options().get<float>("dipoleCurrent");
     mTrackFitter.initField(l3Current, dipoleCurrent);
+    auto fieldGridStep = ic.options().get<float>("fieldGridStep");
+    if (fieldGridStep > 0.f) {
+      TrackExtrap::useFieldGrid(fieldGridStep);
+    }
     mTrackFitter.smoothTracks(true);
   }
 
@@ -212,7 +217,8 @@ o2::framework::DataProcessorSpec getTrackFitterSpec()
     Outputs{OutputSpec{"MCH", "REFITTRACKS", 0, Lifetime::Timeframe}},
     AlgorithmSpec{adaptFromTask<TrackFitterTask>()},
     Options{{"l3Current", VariantType::Float, -30000.0f, {"L3 current"}},
-            {"dipoleCurrent", VariantType::Float, -6000.0f, {"Dipole current"}}}};
+            {"dipoleCurrent", VariantType::Float, -6000.0f, {"Dipole current"}},
+            {"fieldGridStep", VariantType::Float, 0.0f, {"step (cm) of the precomputed field grid used in the extrapolation (0 = use the field map)"}}}};
 }
 
 } // namespace mch
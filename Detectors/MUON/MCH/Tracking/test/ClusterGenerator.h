@@ -0,0 +1,125 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ClusterGenerator.h
+/// \brief Generation of the clusters of tracks coming from the vertex, to test the track finder
+
+#ifndef ALICEO2_MCH_CLUSTERGENERATOR_H_
+#define ALICEO2_MCH_CLUSTERGENERATOR_H_
+
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "MCHBase/ClusterBlock.h"
+#include "Cluster.h"
+#include "TrackExtrap.h"
+#include "TrackParam.h"
+
+namespace o2
+{
+namespace mch
+{
+
+/// Return the ID of the quadrant (chambers 1-4) or of the slat (chambers 5-10) at this position,
+/// in a simplified geometry with slats of 40 cm in y, or shifted by "rowShift" slats along y
+inline int getDEId(int chamber, double x, double y, int rowShift = 0)
+{
+  if (chamber < 4) {
+    int quadrant = (x >= 0.) ? ((y >= 0.) ? 0 : 3) : ((y >= 0.) ? 1 : 2);
+    return 100 * (chamber + 1) + quadrant;
+  }
+  int nDE = (chamber < 6) ? 18 : 26;
+  int maxRow = (nDE / 2 - 1) / 2;
+  int row = std::clamp(static_cast<int>(std::lround(y / 40.)) + rowShift, -maxRow, maxRow);
+  int index = (x >= 0.) ? ((row >= 0) ? row : nDE + row) : nDE / 2 - row;
+  return 100 * (chamber + 1) + index;
+}
+
+/// Generate the clusters of "nTracks" tracks from the vertex, with a copy in the overlapping DE when close to its edge,
+/// plus "nNoise" random clusters per chamber. The track extrapolation must have been initialized
+inline std::vector<ClusterStruct> generateClusters(std::mt19937& gen, int nTracks, int nNoise)
+{
+  static constexpr double chamberZ[10] = {-526.16, -545.24, -676.4, -695.4, -967.5,
+                                          -998.5, -1276.5, -1307.5, -1406.6, -1437.6};
+  std::uniform_real_distribution<double> theta(0.035, 0.16), phi(0., 2. * M_PI), invP(0.05, 0.3), uniform(-1., 1.);
+  std::normal_distribution<double> smearing(0., 0.05);
+  std::bernoulli_distribution positive(0.5);
+  std::map<int, uint32_t> nClustersInDE{};
+  std::vector<ClusterStruct> clusters{};
+
+  auto addCluster = [&](int chamber, int deId, double x, double y) {
+    uint32_t uid = (uint32_t(chamber) << 28) | (uint32_t(deId) << 17) | nClustersInDE[deId]++;
+    clusters.push_back({float(x + smearing(gen)), float(y + smearing(gen)), float(chamberZ[chamber]), 0.2f, 0.2f, uid});
+  };
+
+  for (int iTrack = 0; iTrack < nTracks; ++iTrack) {
+    double tanTheta = std::tan(theta(gen));
+    double phiTrack = phi(gen);
+    TrackParam param{};
+    param.setZ(0.);
+    param.setNonBendingSlope(tanTheta * std::cos(phiTrack));
+    param.setBendingSlope(tanTheta * std::sin(phiTrack));
+    param.setInverseBendingMomentum(positive(gen) ? invP(gen) : -invP(gen));
+    for (int iCh = 0; iCh < 10; ++iCh) {
+      if (!TrackExtrap::extrapToZ(&param, chamberZ[iCh])) {
+        break;
+      }
+      double x = param.getNonBendingCoor();
+      double y = param.getBendingCoor();
+      int deId = getDEId(iCh, x, y);
+      addCluster(iCh, deId, x, y);
+      // a second cluster in the neighbouring DE, if close enough to the edge
+      int overlapDEId(deId);
+      if (iCh < 4) {
+        if (std::abs(y) < 2.) {
+          overlapDEId = getDEId(iCh, x, -y);
+        } else if (std::abs(x) < 2.) {
+          overlapDEId = getDEId(iCh, -x, y);
+        }
+      } else if (std::abs(y - 40. * std::lround(y / 40.)) > 17.) {
+        overlapDEId = getDEId(iCh, x, y, (y > 40. * std::lround(y / 40.)) ? 1 : -1);
+      }
+      if (overlapDEId != deId) {
+        addCluster(iCh, overlapDEId, x, y);
+      }
+    }
+  }
+
+  for (int iCh = 0; iCh < 10; ++iCh) {
+    double size = 0.16 * std::abs(chamberZ[iCh]);
+    for (int i = 0; i < nNoise; ++i) {
+      double x = size * uniform(gen);
+      double y = size * uniform(gen);
+      addCluster(iCh, getDEId(iCh, x, y), x, y);
+    }
+  }
+
+  return clusters;
+}
+
+/// Return the clusters grouped per DE, in the order they are given
+inline std::unordered_map<int, std::list<Cluster>> groupClustersPerDE(const std::vector<ClusterStruct>& clusters)
+{
+  std::unordered_map<int, std::list<Cluster>> clustersPerDE{};
+  for (const auto& cluster : clusters) {
+    clustersPerDE[cluster.getDEId()].emplace_back(cluster);
+  }
+  return clustersPerDE;
+}
+
+} // namespace mch
+} // namespace o2
+
+#endif // ALICEO2_MCH_CLUSTERGENERATOR_H_
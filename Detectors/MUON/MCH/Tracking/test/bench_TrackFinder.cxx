@@ -0,0 +1,74 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file bench_TrackFinder.cxx
+/// \brief Benchmark of the MCH track finder, compared to the version that duplicated the candidates at each branching
+
+#include "benchmark/benchmark.h"
+
+#include <list>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "TrackFinder.h"
+#include "ClusterGenerator.h"
+
+using namespace o2::mch;
+
+constexpr int nEvents = 100;
+
+std::vector<std::vector<ClusterStruct>> generateEvents(int nTracks)
+{
+  std::mt19937 gen(1234);
+  std::vector<std::vector<ClusterStruct>> events{};
+  for (int event = 0; event < nEvents; ++event) {
+    events.push_back(generateClusters(gen, nTracks, nTracks));
+  }
+  return events;
+}
+
+static void BM_TrackFinder(benchmark::State& state)
+{
+  TrackFinder finder{};
+  finder.init(-30000., -6000.);
+  auto events = generateEvents(state.range(0));
+  double nTracks(0.);
+  for (auto _ : state) {
+    for (const auto& clusters : events) {
+      nTracks += finder.findTracks(clusters).size();
+    }
+  }
+  state.counters["tracks"] = benchmark::Counter(nTracks, benchmark::Counter::kIsRate);
+}
+
+static void BM_TrackFinderDuplicateAtBranching(benchmark::State& state)
+{
+  TrackFinder finder{};
+  finder.init(-30000., -6000.);
+  finder.duplicateCandidatesAtBranching(true);
+  auto events = generateEvents(state.range(0));
+  std::vector<std::unordered_map<int, std::list<Cluster>>> eventsPerDE{};
+  for (const auto& clusters : events) {
+    eventsPerDE.push_back(groupClustersPerDE(clusters));
+  }
+  double nTracks(0.);
+  for (auto _ : state) {
+    for (const auto& clusters : eventsPerDE) {
+      nTracks += finder.findTracks(clusters).size();
+    }
+  }
+  state.counters["tracks"] = benchmark::Counter(nTracks, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_TrackFinder)->Arg(1)->Arg(5)->Arg(20)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TrackFinderDuplicateAtBranching)->Arg(1)->Arg(5)->Arg(20)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
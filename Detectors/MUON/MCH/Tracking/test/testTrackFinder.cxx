@@ -0,0 +1,84 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testTrackFinder.cxx
+/// \brief Test the MCH track finder against the version that duplicated the candidates at each branching
+
+#define BOOST_TEST_MODULE Test MCH TrackFinder
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include <list>
+#include <random>
+#include <vector>
+
+#include "Track.h"
+#include "TrackFinder.h"
+#include "ClusterGenerator.h"
+
+namespace o2
+{
+namespace mch
+{
+
+void compareTracks(const std::list<Track>& tracks, const std::list<Track>& reference)
+{
+  BOOST_REQUIRE_EQUAL(tracks.size(), reference.size());
+  for (auto itTrack = tracks.begin(), itReference = reference.begin(); itTrack != tracks.end(); ++itTrack, ++itReference) {
+    BOOST_REQUIRE_EQUAL(itTrack->getNClusters(), itReference->getNClusters());
+    for (auto itParam = itTrack->begin(), itRefParam = itReference->begin(); itParam != itTrack->end(); ++itParam, ++itRefParam) {
+      BOOST_CHECK_EQUAL(itParam->getClusterPtr()->getUniqueId(), itRefParam->getClusterPtr()->getUniqueId());
+      BOOST_CHECK_EQUAL(itParam->getNonBendingCoor(), itRefParam->getNonBendingCoor());
+      BOOST_CHECK_EQUAL(itParam->getNonBendingSlope(), itRefParam->getNonBendingSlope());
+      BOOST_CHECK_EQUAL(itParam->getBendingCoor(), itRefParam->getBendingCoor());
+      BOOST_CHECK_EQUAL(itParam->getBendingSlope(), itRefParam->getBendingSlope());
+      BOOST_CHECK_EQUAL(itParam->getInverseBendingMomentum(), itRefParam->getInverseBendingMomentum());
+      BOOST_CHECK_EQUAL(itParam->getTrackChi2(), itRefParam->getTrackChi2());
+    }
+  }
+}
+
+/// The tracks built from the recorded branches are exactly those obtained duplicating the candidates at each branching,
+/// in the same order and with the same parameters, with and without the search for more candidates
+BOOST_AUTO_TEST_CASE(TrackFinder_vs_reference)
+{
+  TrackFinder finder{};
+  TrackFinder reference{};
+  reference.duplicateCandidatesAtBranching(true);
+  finder.init(-30000., -6000.);
+  reference.init(-30000., -6000.);
+
+  std::mt19937 gen(1234);
+  int nTracksFound(0);
+  for (bool moreCandidates : {false, true}) {
+    finder.findMoreTrackCandidates(moreCandidates);
+    reference.findMoreTrackCandidates(moreCandidates);
+    for (int event = 0; event < 20; ++event) {
+      auto clusters = generateClusters(gen, 1 + event, 2 * event);
+      auto clustersPerDE = groupClustersPerDE(clusters);
+      const auto& referenceTracks = reference.findTracks(clustersPerDE);
+      nTracksFound += referenceTracks.size();
+      compareTracks(finder.findTracks(clustersPerDE), referenceTracks);
+      const auto& tracks = finder.findTracks(clusters);
+      compareTracks(tracks, referenceTracks);
+      for (const auto& track : tracks) {
+        for (const auto& param : track) {
+          BOOST_CHECK(finder.isFromCurrentEvent(param.getClusterPtr()));
+        }
+      }
+    }
+  }
+  BOOST_CHECK_GT(nTracksFound, 0);
+}
+
+} // namespace mch
+} // namespace o2
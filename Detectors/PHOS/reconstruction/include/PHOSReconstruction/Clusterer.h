@@ -12,6 +12,9 @@
 /// \brief Definition of the PHOS cluster finder
 #ifndef ALICEO2_PHOS_CLUSTERER_H
 #define ALICEO2_PHOS_CLUSTERER_H
+#include <functional>
+#include <memory>
+#include <vector>
 #include "DataFormatsPHOS/Digit.h"
 #include "DataFormatsPHOS/Cell.h"
 #include "DataFormatsPHOS/Cluster.h"
@@ -35,6 +38,10 @@ class Clusterer
   ~Clusterer() = default;
 
   void initialize();
+  /// Number of threads used to clusterize the trigger records of a TF in parallel
+  void setNThreads(int n) { mNThreads = n > 0 ? n : 1; }
+  int getNThreads() const { return mNThreads; }
+
   void process(gsl::span<const Digit> digits, gsl::span<const TriggerRecord> dtr,
                const o2::dataformats::MCTruthContainer<MCLabel>* dmc,
                std::vector<Cluster>* clusters, std::vector<TriggerRecord>* rigRec,
@@ -44,6 +51,8 @@ class Clusterer
                     std::vector<Cluster>* clusters, std::vector<TriggerRecord>* rigRec,
                     o2::dataformats::MCTruthContainer<MCLabel>* cluMC);
 
+  /// Collect the digits of the event in clusters of neighbours. The digits are taken in increasing
+  /// absId order, so the clusters do not depend on the order of the input digits.
   void makeClusters(gsl::span<const Digit> digits);
   void evalCluProperties(gsl::span<const Digit> digits, std::vector<Cluster>* clusters,
                          const o2::dataformats::MCTruthContainer<MCLabel>* dmc,
@@ -55,6 +64,17 @@ class Clusterer
   void unfoldOneCluster(FullCluster& iniClu, char nMax, gsl::span<int> digitId, gsl::span<const Digit> digits);
 
  protected:
+  using EventPreparation = std::function<gsl::span<const Digit>(Clusterer&, const TriggerRecord&)>;
+  /// Clusterize each trigger record, possibly in parallel. @a prepare sets the digit range of the event
+  /// on the given clusterer and returns the digits to be used.
+  void processTriggerRecords(gsl::span<const TriggerRecord> trs, const EventPreparation& prepare,
+                             const o2::dataformats::MCTruthContainer<MCLabel>* dmc,
+                             std::vector<Cluster>* clusters, std::vector<TriggerRecord>* trigRec,
+                             o2::dataformats::MCTruthContainer<MCLabel>* cluMC);
+  /// Clusterize the digits from mFirstDigitInEvent to mLastDigitInEvent, appending to @a clusters and @a cluMC
+  void processEvent(gsl::span<const Digit> digits, const o2::dataformats::MCTruthContainer<MCLabel>* dmc,
+                    std::vector<Cluster>* clusters, o2::dataformats::MCTruthContainer<MCLabel>* cluMC);
+  void loadCalibration();
   void convertCellsToDigits(gsl::span<const Cell> cells, int firstCellInEvent, int lastCellInEvent, gsl::span<const unsigned int> mcmap);
 
   //Calibrate energy
@@ -81,6 +101,15 @@ class Clusterer
   int mFirstDigitInEvent;             ///< Range of digits from one event
   int mLastDigitInEvent;              ///< Range of digits from one event
   std::vector<Digit> mDigits;         ///< vector of trancient digits for cell processing
+
+  int mNThreads = 1;                                 ///< number of threads for trigger record parallelism
+  std::vector<int> mDigitOrder;                      //! digits of the event in increasing absId order, see makeClusters
+  std::vector<int> mAbsIdToDigit;                    //! occupancy map: first digit of the event with a given absId, -1 if none
+  std::vector<int> mNextDigitSameAbsId;              //! next digit of the event with the same absId, -1 if none
+  std::vector<float> mDigitEnergy;                   //! calibrated energies of the digits of the event, 0 for bad channels
+  std::vector<bool> mDigitUsed;                      //! digits of the event already assigned to a cluster
+  std::vector<int> mNeighbourDigits;                 //! transient list of neighbour digits to be added to a cluster
+  std::vector<std::unique_ptr<Clusterer>> mThreads; //! clusterers used by the extra threads
 };
 } // namespace phos
 } // namespace o2
@@ -10,7 +10,9 @@
 
 /// \file Clusterer.cxx
 /// \brief Implementation of the PHOS cluster finder
+#include <algorithm>
 #include <memory>
+#include <numeric>
 
 #include "PHOSReconstruction/Clusterer.h" // for LOG
 #include "PHOSBase/Geometry.h"
@@ -22,10 +24,47 @@
 
 #include "FairLogger.h" // for LOG
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 using namespace o2::phos;
 
 ClassImp(Clusterer);
 
+namespace
+{
+// Neighbours (as defined by Geometry::areNeighbours) of each cell, the cell itself included.
+// The neighbours of absId are neighbours[offsets[absId]] ... neighbours[offsets[absId + 1] - 1], in increasing absId.
+struct NeighbourTable {
+  std::vector<int> offsets;
+  std::vector<short> neighbours;
+};
+
+const NeighbourTable& neighbourTable()
+{
+  static const NeighbourTable table = [] {
+    NeighbourTable t;
+    const int nCells = Geometry::getTotalNCells();
+    const int window = 56 + 1; // cells in one row (along z) plus one, larger absId differences can not be neighbours
+    t.offsets.reserve(nCells + 2);
+    t.neighbours.reserve(9 * nCells);
+    t.offsets.push_back(0); // absId 0 does not exist
+    t.offsets.push_back(0);
+    for (int absId = 1; absId <= nCells; absId++) {
+      for (int n = std::max(1, absId - window); n <= std::min(nCells, absId + window); n++) {
+        if (Geometry::areNeighbours(absId, n) == 1) {
+          t.neighbours.push_back(n);
+        }
+      }
+      t.offsets.push_back(t.neighbours.size());
+    }
+    return t;
+  }();
+  return table;
+}
+} // namespace
+
 //____________________________________________________________________________
 void Clusterer::initialize()
 {
@@ -45,52 +84,14 @@ void Clusterer::process(gsl::span<const Digit> digits, gsl::span<const TriggerRe
   trigRec->clear();
   cluMC->clear();
 
-  for (const auto& tr : dtr) {
-    mFirstDigitInEvent = tr.getFirstEntry();
-    mLastDigitInEvent = mFirstDigitInEvent + tr.getNumberOfObjects();
-    int indexStart = clusters->size();
-    mClusters.clear(); // internal list of FullClusters
-
-    LOG(DEBUG) << "Starting clusteriztion digits from " << mFirstDigitInEvent << " to " << mLastDigitInEvent;
-
-    if (!mBadMap) {
-      if (o2::phos::PHOSSimParams::Instance().mCCDBPath.compare("localtest") == 0) {
-        mBadMap = new BadChannelMap(1);    // test default map
-        mCalibParams = new CalibParams(1); //test calibration map
-        LOG(INFO) << "No reading BadMap/Calibration from ccdb requested, set default";
-      } else {
-        LOG(INFO) << "Getting BadMap object from ccdb";
-        o2::ccdb::CcdbApi ccdb;
-        std::map<std::string, std::string> metadata; // do we want to store any meta data?
-        ccdb.init("http://ccdb-test.cern.ch:8080");  // or http://localhost:8080 for a local installation
-        long bcTime = 1;                             //TODO!!! Convert BC time to time o2::InteractionRecord bcTime = digitsTR.front().getBCData() ;
-        mBadMap = ccdb.retrieveFromTFileAny<o2::phos::BadChannelMap>("PHOS/BadMap", metadata, bcTime);
-        mCalibParams = ccdb.retrieveFromTFileAny<o2::phos::CalibParams>("PHOS/Calib", metadata, bcTime);
-        if (!mBadMap) {
-          LOG(FATAL) << "[PHOSCellConverter - run] can not get Bad Map";
-        }
-        if (!mCalibParams) {
-          LOG(FATAL) << "[PHOSCellConverter - run] can not get CalibParams";
-        }
-      }
-    }
-
-    // Collect digits to clusters
-    makeClusters(digits);
-
-    // Unfold overlapped clusters
-    // Split clusters with several local maxima if necessary
-    if (o2::phos::PHOSSimParams::Instance().mUnfoldClusters) {
-      makeUnfoldings(digits);
-    }
-
-    // Calculate properties of collected clusters (Local position, energy, disp etc.)
-    evalCluProperties(digits, clusters, dmc, cluMC);
-
-    LOG(DEBUG) << "Found clusters from " << indexStart << " to " << clusters->size();
-
-    trigRec->emplace_back(tr.getBCData(), indexStart, clusters->size());
-  }
+  processTriggerRecords(
+    dtr, [digits](Clusterer& clusterer, const TriggerRecord& tr) {
+      clusterer.mFirstDigitInEvent = tr.getFirstEntry();
+      clusterer.mLastDigitInEvent = clusterer.mFirstDigitInEvent + tr.getNumberOfObjects();
+      LOG(DEBUG) << "Starting clusteriztion digits from " << clusterer.mFirstDigitInEvent << " to " << clusterer.mLastDigitInEvent;
+      return digits;
+    },
+    dmc, clusters, trigRec, cluMC);
 }
 //____________________________________________________________________________
 void Clusterer::processCells(gsl::span<const Cell> cells, gsl::span<const TriggerRecord> ctr,
@@ -103,53 +104,124 @@ void Clusterer::processCells(gsl::span<const Cell> cells, gsl::span<const Trigge
   trigRec->clear();
   cluMC->clear();
 
-  for (const auto& tr : ctr) {
-    int firstCellInEvent = tr.getFirstEntry();
-    int lastCellInEvent = firstCellInEvent + tr.getNumberOfObjects();
-    int indexStart = clusters->size();
-    mClusters.clear(); // internal list of FullClusters
-
-    LOG(DEBUG) << "Starting clusteriztion cells from " << mFirstDigitInEvent << " to " << mLastDigitInEvent;
-
-    if (!mBadMap) {
-      if (o2::phos::PHOSSimParams::Instance().mCCDBPath.compare("localtest") == 0) {
-        mBadMap = new BadChannelMap(1);    // test default map
-        mCalibParams = new CalibParams(1); //test calibration map
-        LOG(INFO) << "No reading BadMap/Calibration from ccdb requested, set default";
-      } else {
-        LOG(INFO) << "Getting BadMap object from ccdb";
-        o2::ccdb::CcdbApi ccdb;
-        std::map<std::string, std::string> metadata; // do we want to store any meta data?
-        ccdb.init("http://ccdb-test.cern.ch:8080");  // or http://localhost:8080 for a local installation
-        long bcTime = 1;                             //TODO!!! Convert BC time to time o2::InteractionRecord bcTime = digitsTR.front().getBCData() ;
-        mBadMap = ccdb.retrieveFromTFileAny<o2::phos::BadChannelMap>("PHOS/BadMap", metadata, bcTime);
-        mCalibParams = ccdb.retrieveFromTFileAny<o2::phos::CalibParams>("PHOS/Calib", metadata, bcTime);
-        if (!mBadMap) {
-          LOG(FATAL) << "[PHOSCellConverter - run] can not get Bad Map";
-        }
-        if (!mCalibParams) {
-          LOG(FATAL) << "[PHOSCellConverter - run] can not get CalibParams";
-        }
-      }
+  processTriggerRecords(
+    ctr, [cells, mcmap](Clusterer& clusterer, const TriggerRecord& tr) {
+      int firstCellInEvent = tr.getFirstEntry();
+      int lastCellInEvent = firstCellInEvent + tr.getNumberOfObjects();
+      LOG(DEBUG) << "Starting clusteriztion cells from " << firstCellInEvent << " to " << lastCellInEvent;
+      clusterer.convertCellsToDigits(cells, firstCellInEvent, lastCellInEvent, mcmap);
+      return gsl::span<const Digit>(clusterer.mDigits);
+    },
+    dmc, clusters, trigRec, cluMC);
+}
+//____________________________________________________________________________
+void Clusterer::processTriggerRecords(gsl::span<const TriggerRecord> trs, const EventPreparation& prepare,
+                                      const o2::dataformats::MCTruthContainer<MCLabel>* dmc,
+                                      std::vector<Cluster>* clusters, std::vector<TriggerRecord>* trigRec,
+                                      o2::dataformats::MCTruthContainer<MCLabel>* cluMC)
+{
+  if (trs.empty()) {
+    return;
+  }
+  loadCalibration();
+
+  int nThreads = 1;
+#ifdef WITH_OPENMP
+  nThreads = std::min<int>(mNThreads, trs.size());
+#endif
+  if (nThreads == 1) {
+    for (const auto& tr : trs) {
+      auto digits = prepare(*this, tr);
+      int indexStart = clusters->size();
+      processEvent(digits, dmc, clusters, cluMC);
+      LOG(DEBUG) << "Found clusters from " << indexStart << " to " << clusters->size();
+      trigRec->emplace_back(tr.getBCData(), indexStart, clusters->size());
     }
+    return;
+  }
 
-    convertCellsToDigits(cells, firstCellInEvent, lastCellInEvent, mcmap);
-
-    // Collect digits to clusters
-    makeClusters(mDigits);
+  // Trigger records are independent: each thread clusterizes whole events into
+  // containers of its own, which are then appended in the original order.
+  while (int(mThreads.size()) < nThreads) {
+    mThreads.emplace_back(std::make_unique<Clusterer>());
+    mThreads.back()->initialize();
+  }
+  for (auto& clusterer : mThreads) {
+    clusterer->mBadMap = mBadMap;
+    clusterer->mCalibParams = mCalibParams;
+  }
+  std::vector<std::vector<Cluster>> eventClusters(trs.size());
+  std::vector<o2::dataformats::MCTruthContainer<MCLabel>> eventMC(cluMC ? trs.size() : 0);
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(nThreads)
+#endif
+  for (int iev = 0; iev < int(trs.size()); iev++) {
+    int ith = 0;
+#ifdef WITH_OPENMP
+    ith = omp_get_thread_num();
+#endif
+    auto& clusterer = *mThreads[ith];
+    auto digits = prepare(clusterer, trs[iev]);
+    clusterer.processEvent(digits, dmc, &eventClusters[iev], cluMC ? &eventMC[iev] : nullptr);
+  }
 
-    // Unfold overlapped clusters
-    // Split clusters with several local maxima if necessary
-    if (o2::phos::PHOSSimParams::Instance().mUnfoldClusters) {
-      makeUnfoldings(mDigits);
+  for (int iev = 0; iev < int(trs.size()); iev++) {
+    int indexStart = clusters->size();
+    int labelOffset = cluMC ? cluMC->getIndexedSize() : 0;
+    for (auto& clu : eventClusters[iev]) {
+      if (clu.getLabel() >= 0) {
+        clu.setLabel(clu.getLabel() + labelOffset);
+      }
+      clusters->emplace_back(clu);
     }
+    if (cluMC) {
+      cluMC->mergeAtBack(eventMC[iev]);
+    }
+    LOG(DEBUG) << "Found clusters from " << indexStart << " to " << clusters->size();
+    trigRec->emplace_back(trs[iev].getBCData(), indexStart, clusters->size());
+  }
+}
+//____________________________________________________________________________
+void Clusterer::processEvent(gsl::span<const Digit> digits, const o2::dataformats::MCTruthContainer<MCLabel>* dmc,
+                             std::vector<Cluster>* clusters, o2::dataformats::MCTruthContainer<MCLabel>* cluMC)
+{
+  mClusters.clear(); // internal list of FullClusters
 
-    // Calculate properties of collected clusters (Local position, energy, disp etc.)
-    evalCluProperties(mDigits, clusters, dmc, cluMC);
+  // Collect digits to clusters
+  makeClusters(digits);
 
-    LOG(DEBUG) << "Found clusters from " << indexStart << " to " << clusters->size();
+  // Unfold overlapped clusters
+  // Split clusters with several local maxima if necessary
+  if (o2::phos::PHOSSimParams::Instance().mUnfoldClusters) {
+    makeUnfoldings(digits);
+  }
 
-    trigRec->emplace_back(tr.getBCData(), indexStart, clusters->size());
+  // Calculate properties of collected clusters (Local position, energy, disp etc.)
+  evalCluProperties(digits, clusters, dmc, cluMC);
+}
+//____________________________________________________________________________
+void Clusterer::loadCalibration()
+{
+  if (!mBadMap) {
+    if (o2::phos::PHOSSimParams::Instance().mCCDBPath.compare("localtest") == 0) {
+      mBadMap = new BadChannelMap(1);    // test default map
+      mCalibParams = new CalibParams(1); //test calibration map
+      LOG(INFO) << "No reading BadMap/Calibration from ccdb requested, set default";
+    } else {
+      LOG(INFO) << "Getting BadMap object from ccdb";
+      o2::ccdb::CcdbApi ccdb;
+      std::map<std::string, std::string> metadata; // do we want to store any meta data?
+      ccdb.init("http://ccdb-test.cern.ch:8080");  // or http://localhost:8080 for a local installation
+      long bcTime = 1;                             //TODO!!! Convert BC time to time o2::InteractionRecord bcTime = digitsTR.front().getBCData() ;
+      mBadMap = ccdb.retrieveFromTFileAny<o2::phos::BadChannelMap>("PHOS/BadMap", metadata, bcTime);
+      mCalibParams = ccdb.retrieveFromTFileAny<o2::phos::CalibParams>("PHOS/Calib", metadata, bcTime);
+      if (!mBadMap) {
+        LOG(FATAL) << "[PHOSCellConverter - run] can not get Bad Map";
+      }
+      if (!mCalibParams) {
+        LOG(FATAL) << "[PHOSCellConverter - run] can not get CalibParams";
+      }
+    }
   }
 }
 //____________________________________________________________________________
@@ -188,23 +260,46 @@ void Clusterer::convertCellsToDigits(gsl::span<const Cell> cells, int firstCellI
 void Clusterer::makeClusters(gsl::span<const Digit> digits)
 {
   // A cluster is defined as a list of neighbour digits
+  // Instead of scanning all the digits of the event for each digit in a cluster, the neighbours
+  // are taken from the neighbour table and looked up in the occupancy map of the event.
+  // The digits are processed in increasing absId order, stable for the same absId, which is the
+  // order the old scan relied on. So the clusters do not depend on the order of the input digits,
+  // and are the same as with the scan for absId-sorted input, as produced by the digitizers.
+
+  const auto& table = neighbourTable();
+  const int nDigits = mLastDigitInEvent - mFirstDigitInEvent;
+  if (mAbsIdToDigit.empty()) {
+    mAbsIdToDigit.resize(Geometry::getTotalNCells() + 1, -1);
+  }
+  mNextDigitSameAbsId.resize(nDigits);
+  mDigitEnergy.resize(nDigits);
+  mDigitUsed.assign(nDigits, false); // Mark all digits as unused yet
+
+  // Below, i and j are positions in the processing order, not digit indices
+  mDigitOrder.resize(nDigits);
+  std::iota(mDigitOrder.begin(), mDigitOrder.end(), 0);
+  std::stable_sort(mDigitOrder.begin(), mDigitOrder.end(), [digits, first = mFirstDigitInEvent](int a, int b) {
+    return digits[first + a].getAbsId() < digits[first + b].getAbsId();
+  });
+
+  // Calibrate once and fill the occupancy map, backwards so that the digits sharing an absId are chained in order
+  for (int i = nDigits - 1; i >= 0; i--) {
+    const Digit& digit = digits[mFirstDigitInEvent + mDigitOrder[i]];
+    float energy = calibrate(digit.getAmplitude(), digit.getAbsId());
+    if (isBadChannel(digit.getAbsId())) {
+      energy = 0.;
+    }
+    mDigitEnergy[i] = energy;
+    mNextDigitSameAbsId[i] = mAbsIdToDigit[digit.getAbsId()];
+    mAbsIdToDigit[digit.getAbsId()] = i;
+  }
 
-  // Mark all digits as unused yet
-  const int maxNDigits = 12546; // There is no digits more than in PHOS modules ;)
-  bool digitsUsed[maxNDigits];
-  memset(digitsUsed, 0, sizeof(bool) * maxNDigits);
-
-  int iFirst = mFirstDigitInEvent; // first index of digit which potentially can be a part of cluster
-
-  for (int i = iFirst; i < mLastDigitInEvent; i++) {
-    if (digitsUsed[i - mFirstDigitInEvent])
+  for (int i = 0; i < nDigits; i++) {
+    if (mDigitUsed[i])
       continue;
 
-    const Digit& digitSeed = digits[i];
-    float digitSeedEnergy = calibrate(digitSeed.getAmplitude(), digitSeed.getAbsId());
-    if (isBadChannel(digitSeed.getAbsId())) {
-      digitSeedEnergy = 0.;
-    }
+    const Digit& digitSeed = digits[mFirstDigitInEvent + mDigitOrder[i]];
+    float digitSeedEnergy = mDigitEnergy[i];
     if (digitSeedEnergy < o2::phos::PHOSSimParams::Instance().mDigitMinEnergy) {
       continue;
     }
@@ -219,48 +314,38 @@ void Clusterer::makeClusters(gsl::span<const Digit> digits)
                              digitSeed.getLabel(), 1.);
       clu = &(mClusters.back());
 
-      digitsUsed[i - mFirstDigitInEvent] = true;
+      mDigitUsed[i] = true;
       iDigitInCluster = 1;
     } else {
       continue;
     }
-    // Now scan remaining digits in list to find neigbours of our seed
+    // Now look for the remaining neighbours of the digits in the cluster
     int index = 0;
     while (index < iDigitInCluster) { // scan over digits already in cluster
       short digitSeedAbsId = clu->getDigitAbsId(index);
       index++;
-      for (Int_t j = iFirst; j < mLastDigitInEvent; j++) {
-        if (digitsUsed[j - mFirstDigitInEvent])
-          continue; // look through remaining digits
-        const Digit* digitN = &(digits[j]);
-        float digitNEnergy = calibrate(digitN->getAmplitude(), digitN->getAbsId());
-        if (isBadChannel(digitN->getAbsId())) { //remove digit
-          digitNEnergy = 0.;
-        }
-        if (digitNEnergy < o2::phos::PHOSSimParams::Instance().mDigitMinEnergy) {
-          continue;
+      mNeighbourDigits.clear();
+      for (int k = table.offsets[digitSeedAbsId]; k < table.offsets[digitSeedAbsId + 1]; k++) {
+        for (int j = mAbsIdToDigit[table.neighbours[k]]; j >= 0; j = mNextDigitSameAbsId[j]) {
+          if (!mDigitUsed[j] && mDigitEnergy[j] >= o2::phos::PHOSSimParams::Instance().mDigitMinEnergy) {
+            mNeighbourDigits.push_back(j);
+          }
         }
-
-        // call (digit,digitN) in THAT oder !!!!!
-        Int_t ineb = mPHOSGeom->areNeighbours(digitSeedAbsId, digitN->getAbsId());
-        switch (ineb) {
-          case -1: // too early (e.g. previous module), do not look before j at subsequent passes
-            iFirst = j;
-            break;
-          case 0: // not a neighbour
-            break;
-          case 1: // are neighbours
-            clu->addDigit(digitN->getAbsId(), digitNEnergy, calibrateT(digitN->getTime(), digitN->getAbsId(), digitN->isHighGain()), digitN->getLabel(), 1.);
-            iDigitInCluster++;
-            digitsUsed[j - mFirstDigitInEvent] = true;
-            break;
-          case 2: // too far from each other
-          default:
-            break;
-        } // switch
+      }
+      std::sort(mNeighbourDigits.begin(), mNeighbourDigits.end());
+      for (int j : mNeighbourDigits) {
+        const Digit& digitN = digits[mFirstDigitInEvent + mDigitOrder[j]];
+        clu->addDigit(digitN.getAbsId(), mDigitEnergy[j], calibrateT(digitN.getTime(), digitN.getAbsId(), digitN.isHighGain()), digitN.getLabel(), 1.);
+        iDigitInCluster++;
+        mDigitUsed[j] = true;
       }
     } // loop over cluster
   }   // energy theshold
+
+  // Leave the occupancy map empty for the next event
+  for (int i = 0; i < nDigits; i++) {
+    mAbsIdToDigit[digits[mFirstDigitInEvent + i].getAbsId()] = -1;
+  }
 }
 //__________________________________________________________________________
 void Clusterer::makeUnfoldings(gsl::span<const Digit> digits)
@@ -0,0 +1,177 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test PHOS Clusterer
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "PHOSReconstruction/Clusterer.h"
+#include "PHOSBase/Geometry.h"
+#include "PHOSBase/PHOSSimParams.h"
+#include "PHOSCalib/BadChannelMap.h"
+#include "PHOSCalib/CalibParams.h"
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace o2
+{
+namespace phos
+{
+
+/// Access to the internals of the clusterer, and the scan over all digits it replaced as reference
+class TestClusterer : public Clusterer
+{
+ public:
+  TestClusterer()
+  {
+    mPHOSGeom = Geometry::GetInstance("Run3");
+    mBadMap = new BadChannelMap(1);    // test default map
+    mCalibParams = new CalibParams(1); // test calibration map
+    initialize();
+  }
+  ~TestClusterer()
+  {
+    delete mBadMap;
+    delete mCalibParams;
+  }
+
+  std::vector<FullCluster> cluster(const std::vector<Digit>& digits)
+  {
+    mFirstDigitInEvent = 0;
+    mLastDigitInEvent = digits.size();
+    mClusters.clear();
+    makeClusters(digits);
+    return mClusters;
+  }
+
+  /// The clusterization before the neighbour table: for each digit in a cluster, scan all the digits of the event
+  std::vector<FullCluster> oldScan(const std::vector<Digit>& digits)
+  {
+    mFirstDigitInEvent = 0;
+    mLastDigitInEvent = digits.size();
+    mClusters.clear();
+
+    std::vector<bool> digitsUsed(digits.size(), false);
+    int iFirst = mFirstDigitInEvent; // first index of digit which potentially can be a part of cluster
+
+    for (int i = iFirst; i < mLastDigitInEvent; i++) {
+      if (digitsUsed[i - mFirstDigitInEvent])
+        continue;
+
+      const Digit& digitSeed = digits[i];
+      float digitSeedEnergy = calibrate(digitSeed.getAmplitude(), digitSeed.getAbsId());
+      if (isBadChannel(digitSeed.getAbsId())) {
+        digitSeedEnergy = 0.;
+      }
+      if (digitSeedEnergy < PHOSSimParams::Instance().mDigitMinEnergy) {
+        continue;
+      }
+      if (digitSeedEnergy <= PHOSSimParams::Instance().mClusteringThreshold) {
+        continue;
+      }
+      mClusters.emplace_back(digitSeed.getAbsId(), digitSeedEnergy,
+                             calibrateT(digitSeed.getTime(), digitSeed.getAbsId(), digitSeed.isHighGain()),
+                             digitSeed.getLabel(), 1.);
+      FullCluster* clu = &(mClusters.back());
+      digitsUsed[i - mFirstDigitInEvent] = true;
+      int iDigitInCluster = 1;
+
+      int index = 0;
+      while (index < iDigitInCluster) { // scan over digits already in cluster
+        short digitSeedAbsId = clu->getDigitAbsId(index);
+        index++;
+        for (int j = iFirst; j < mLastDigitInEvent; j++) {
+          if (digitsUsed[j - mFirstDigitInEvent])
+            continue;
+          const Digit* digitN = &(digits[j]);
+          float digitNEnergy = calibrate(digitN->getAmplitude(), digitN->getAbsId());
+          if (isBadChannel(digitN->getAbsId())) {
+            digitNEnergy = 0.;
+          }
+          if (digitNEnergy < PHOSSimParams::Instance().mDigitMinEnergy) {
+            continue;
+          }
+          switch (mPHOSGeom->areNeighbours(digitSeedAbsId, digitN->getAbsId())) {
+            case -1: // too early (e.g. previous module), do not look before j at subsequent passes
+              iFirst = j;
+              break;
+            case 1: // are neighbours
+              clu->addDigit(digitN->getAbsId(), digitNEnergy, calibrateT(digitN->getTime(), digitN->getAbsId(), digitN->isHighGain()), digitN->getLabel(), 1.);
+              iDigitInCluster++;
+              digitsUsed[j - mFirstDigitInEvent] = true;
+              break;
+            default:
+              break;
+          }
+        }
+      }
+    }
+    return mClusters;
+  }
+};
+
+/// Showers of neighbour cells around random centres, with unique absIds and energies around the thresholds
+std::vector<Digit> makeDigits(std::mt19937& gen, int nShowers)
+{
+  const short nZ = 56, nPhi = 64, nModules = 4;
+  std::uniform_int_distribution<short> module(0, nModules - 1), row(0, nPhi - 1), col(0, nZ - 1), spread(-2, 2);
+  std::uniform_real_distribution<float> energy(0.002, 0.5);
+  std::set<short> used;
+  std::vector<Digit> digits;
+  for (int s = 0; s < nShowers; s++) {
+    short m = module(gen), r = row(gen), c = col(gen);
+    for (int k = 0; k < 8; k++) {
+      short rr = r + spread(gen), cc = c + spread(gen);
+      if (rr < 0 || rr >= nPhi || cc < 0 || cc >= nZ) {
+        continue;
+      }
+      short absId = 1 + m * nZ * nPhi + rr * nZ + cc;
+      if (!used.insert(absId).second) {
+        continue;
+      }
+      digits.emplace_back(absId, energy(gen) / 0.005, 10.e-9, s); // test calibration: gain 0.005 GeV/ADC
+    }
+  }
+  return digits;
+}
+
+void compareClusters(const std::vector<FullCluster>& a, const std::vector<FullCluster>& b)
+{
+  BOOST_REQUIRE_EQUAL(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); i++) {
+    BOOST_REQUIRE_EQUAL(a[i].getMultiplicity(), b[i].getMultiplicity());
+    for (int j = 0; j < a[i].getMultiplicity(); j++) {
+      BOOST_CHECK_EQUAL(a[i].getDigitAbsId(j), b[i].getDigitAbsId(j));
+      BOOST_CHECK_EQUAL(a[i].getElementList()->at(j).energy, b[i].getElementList()->at(j).energy);
+    }
+  }
+}
+
+/// \brief The clusters from the neighbour table are those of the old scan over absId-sorted digits,
+/// whatever the order of the input digits
+BOOST_AUTO_TEST_CASE(Clusterer_unsorted_vs_scan)
+{
+  TestClusterer clusterer;
+  std::mt19937 gen(4242);
+  for (int event = 0; event < 20; event++) {
+    auto digits = makeDigits(gen, 10 + 10 * event);
+    std::sort(digits.begin(), digits.end(), [](const Digit& a, const Digit& b) { return a.getAbsId() < b.getAbsId(); });
+    auto reference = clusterer.oldScan(digits);
+    BOOST_REQUIRE(!reference.empty());
+    compareClusters(clusterer.cluster(digits), reference);
+
+    std::shuffle(digits.begin(), digits.end(), gen);
+    compareClusters(clusterer.cluster(digits), reference);
+  }
+}
+
+} // namespace phos
+} // namespace o2
@@ -23,6 +23,7 @@ void ClusterizerSpec::init(framework::InitContext& ctx)
 
   // Initialize clusterizer and link geometry
   mClusterizer.initialize();
+  mClusterizer.setNThreads(ctx.options().get<int>("nthreads"));
 }
 
 void ClusterizerSpec::run(framework::ProcessingContext& ctx)
@@ -96,7 +97,9 @@ o2::framework::DataProcessorSpec o2::phos::reco_workflow::getClusterizerSpec(boo
   return o2::framework::DataProcessorSpec{"PHOSClusterizerSpec",
                                           inputs,
                                           outputs,
-                                          o2::framework::adaptFromTask<o2::phos::reco_workflow::ClusterizerSpec>(propagateMC)};
+                                          o2::framework::adaptFromTask<o2::phos::reco_workflow::ClusterizerSpec>(propagateMC),
+                                          o2::framework::Options{
+                                            {"nthreads", o2::framework::VariantType::Int, 1, {"number of threads clusterizing trigger records in parallel"}}}};
 }
 
 o2::framework::DataProcessorSpec o2::phos::reco_workflow::getCellClusterizerSpec(bool propagateMC)
@@ -119,5 +122,7 @@ o2::framework::DataProcessorSpec o2::phos::reco_workflow::getCellClusterizerSpec
   return o2::framework::DataProcessorSpec{"PHOSClusterizerSpec",
                                           inputs,
                                           outputs,
-                                          o2::framework::adaptFromTask<o2::phos::reco_workflow::ClusterizerSpec>(propagateMC)};
+                                          o2::framework::adaptFromTask<o2::phos::reco_workflow::ClusterizerSpec>(propagateMC),
+                                          o2::framework::Options{
+                                            {"nthreads", o2::framework::VariantType::Int, 1, {"number of threads clusterizing trigger records in parallel"}}}};
 }
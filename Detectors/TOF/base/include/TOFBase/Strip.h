@@ -19,7 +19,6 @@
 #include <TOFBase/Digit.h>
 #include <TObject.h>
 #include <exception>
-#include <map>
 #include <sstream>
 #include <vector>
 #include "MathUtils/Cartesian3D.h"
@@ -56,7 +55,7 @@ class Strip
 
   /// Empties the point container
   /// @param option unused
-  void clear() { mDigits.clear(); }
+  void clear();
 
   /// Change the chip index
   /// @param index New chip index
@@ -81,22 +80,47 @@ class Strip
 
   Int_t addDigit(Int_t channel, Int_t tdc, Int_t tot, Int_t bc, Int_t lbl = 0, int triggerorbit = 0, int triggerbunch = 0); // returns the MC label
 
+  /// Move all the digits to the output, in the order of their ordering key
   void fillOutputContainer(std::vector<o2::tof::Digit>& digits);
 
   static int mDigitMerged;
 
  protected:
-  Int_t mStripIndex = -1;                      ///< Strip ID
-  std::map<ULong64_t, o2::tof::Digit> mDigits; ///< Map of fired digits, possibly in multiple frames
+  size_t getSlot(ULong64_t key) const
+  {
+    // Fibonacci hashing, the table size is a power of 2
+    return (key * 0x9e3779b97f4a7c15ull) >> (64 - mTableBits);
+  }
+  void rehash(int bits);
+  void rebuildIndex();
+
+  Int_t mStripIndex = -1;             ///< Strip ID
+  std::vector<o2::tof::Digit> mDigits; ///< Fired digits, in the order they were added, possibly in multiple frames
+  std::vector<ULong64_t> mKeys;       //! ordering key of each digit in mDigits, rebuilt if not in sync (e.g. after reading)
+  std::vector<int> mTable;            //! open addressing hash table: index in mDigits of the key, -1 if empty
+  int mTableBits = 0;                 //! log2 of the table size
 
-  ClassDefNV(Strip, 1);
+  ClassDefNV(Strip, 2);
 };
 
 inline o2::tof::Digit* Strip::findDigit(ULong64_t key)
 {
   // finds the digit corresponding to global key
-  auto digitentry = mDigits.find(key);
-  return digitentry != mDigits.end() ? &(digitentry->second) : nullptr;
+  if (mKeys.size() != mDigits.size()) {
+    rebuildIndex(); // the index is not persistent
+  }
+  if (mTable.empty()) {
+    return nullptr;
+  }
+  for (auto i = getSlot(key);; i = (i + 1) & (mTable.size() - 1)) {
+    int idx = mTable[i];
+    if (idx < 0) {
+      return nullptr;
+    }
+    if (mKeys[idx] == key) {
+      return &mDigits[idx];
+    }
+  }
 }
 
 } // namespace tof
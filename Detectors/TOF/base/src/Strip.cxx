@@ -13,6 +13,7 @@
 // for clusterization purposes
 //  ALICEO2
 //
+#include <algorithm>
 #include <cstring>
 #include <tuple>
 
@@ -33,6 +34,41 @@ Strip::Strip(Int_t index)
 {
 }
 //_______________________________________________________________________
+void Strip::clear()
+{
+  // the storage is kept for the next readout window
+  mDigits.clear();
+  mKeys.clear();
+  std::fill(mTable.begin(), mTable.end(), -1);
+}
+//_______________________________________________________________________
+void Strip::rehash(int bits)
+{
+  mTableBits = bits;
+  mTable.assign(size_t(1) << bits, -1);
+  for (int idx = 0; idx < int(mKeys.size()); idx++) {
+    auto i = getSlot(mKeys[idx]);
+    while (mTable[i] >= 0) {
+      i = (i + 1) & (mTable.size() - 1);
+    }
+    mTable[i] = idx;
+  }
+}
+//_______________________________________________________________________
+void Strip::rebuildIndex()
+{
+  // recompute the keys and the hash table from the digits, e.g. after reading them from file
+  mKeys.clear();
+  for (const auto& dig : mDigits) {
+    mKeys.push_back(Digit::getOrderingKey(dig.getChannel(), dig.getBC(), dig.getTDC()));
+  }
+  int bits = 6;
+  while (2 * (mKeys.size() + 1) > (size_t(1) << bits)) {
+    bits++;
+  }
+  rehash(bits);
+}
+//_______________________________________________________________________
 Int_t Strip::addDigit(Int_t channel, Int_t tdc, Int_t tot, Int_t bc, Int_t lbl, Int_t triggerorbit, Int_t triggerbunch)
 {
 
@@ -46,7 +82,17 @@ Int_t Strip::addDigit(Int_t channel, Int_t tdc, Int_t tot, Int_t bc, Int_t lbl,
     dig->merge(tdc, tot);  // merging to the existing digit
     mDigitMerged++;
   } else {
-    mDigits.emplace(std::make_pair(key, Digit(channel, tdc, tot, bc, lbl, triggerorbit, triggerbunch)));
+    // keep the hash table at most half full
+    if (2 * (mKeys.size() + 1) > mTable.size()) {
+      rehash(std::max(mTableBits + 1, 6));
+    }
+    auto i = getSlot(key);
+    while (mTable[i] >= 0) {
+      i = (i + 1) & (mTable.size() - 1);
+    }
+    mTable[i] = mDigits.size();
+    mKeys.push_back(key);
+    mDigits.emplace_back(channel, tdc, tot, bc, lbl, triggerorbit, triggerbunch);
   }
 
   return lbl;
@@ -61,13 +107,12 @@ void Strip::fillOutputContainer(std::vector<Digit>& digits)
 
   if (mDigits.empty())
     return;
-  auto itBeg = mDigits.begin();
-  auto iter = itBeg;
-  for (; iter != mDigits.end(); ++iter) {
-    Digit& dig = iter->second;
-    digits.emplace_back(dig);
-  }
 
-  //  if (iter!=mDigits.end()) iter--;
-  mDigits.erase(itBeg, iter);
+  // emit them in the key order, as they used to come out of a map
+  std::sort(mDigits.begin(), mDigits.end(), [](const Digit& a, const Digit& b) {
+    return Digit::getOrderingKey(a.getChannel(), a.getBC(), a.getTDC()) < Digit::getOrderingKey(b.getChannel(), b.getBC(), b.getTDC());
+  });
+  digits.insert(digits.end(), mDigits.begin(), mDigits.end());
+
+  clear();
 }
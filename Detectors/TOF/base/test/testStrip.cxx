@@ -0,0 +1,84 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test TOFStrip
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include "TOFBase/Geo.h"
+#include "TOFBase/Strip.h"
+#include <TFile.h>
+#include <TRandom.h>
+#include <boost/test/unit_test.hpp>
+#include <map>
+
+using namespace o2::tof;
+
+BOOST_AUTO_TEST_CASE(testTOFStrip)
+{
+  // digits of the same channel and BC are merged, the output is ordered by key
+  Strip strip(3);
+  std::map<ULong64_t, int> ref; // key -> label of the first digit
+  for (int i = 0; i < 2000; i++) {
+    int channel = 3 * Geo::NPADS + gRandom->Integer(Geo::NPADS);
+    int bc = gRandom->Integer(20);
+    int lbl = strip.addDigit(channel, gRandom->Integer(1000), 10, bc, i);
+    auto key = Digit::getOrderingKey(channel, bc, 0);
+    auto it = ref.emplace(key, i).first;
+    BOOST_CHECK_EQUAL(lbl, it->second);
+  }
+  BOOST_CHECK_EQUAL(size_t(strip.getNumberOfDigits()), ref.size());
+
+  std::vector<Digit> digits;
+  strip.fillOutputContainer(digits);
+  BOOST_CHECK_EQUAL(strip.getNumberOfDigits(), 0);
+  BOOST_REQUIRE_EQUAL(digits.size(), ref.size());
+  auto it = ref.begin();
+  for (const auto& dig : digits) {
+    BOOST_CHECK_EQUAL(Digit::getOrderingKey(dig.getChannel(), dig.getBC(), dig.getTDC()), it->first);
+    BOOST_CHECK_EQUAL(dig.getLabel(), it->second);
+    ++it;
+  }
+
+  // the strip is reusable for the next window
+  strip.addDigit(3 * Geo::NPADS, 1, 1, 1, 7);
+  BOOST_CHECK_EQUAL(strip.getNumberOfDigits(), 1);
+  BOOST_CHECK(strip.findDigit(Digit::getOrderingKey(3 * Geo::NPADS, 1, 1)) != nullptr);
+  BOOST_CHECK(strip.findDigit(Digit::getOrderingKey(3 * Geo::NPADS, 2, 1)) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(testTOFStripROOTIO)
+{
+  // the digits read from file are found again, the index being rebuilt
+  Strip strip(3);
+  for (int i = 0; i < 100; i++) {
+    strip.addDigit(3 * Geo::NPADS + i, 100, 10, 5, i);
+  }
+
+  auto f = TFile::Open("TOFStrip_ROOTIO.root", "recreate");
+  f->WriteObject(&strip, "strip");
+  delete f;
+
+  Strip* stripRead = nullptr;
+  f = TFile::Open("TOFStrip_ROOTIO.root");
+  f->GetObject("strip", stripRead);
+  delete f;
+
+  BOOST_REQUIRE(stripRead != nullptr);
+  BOOST_REQUIRE_EQUAL(stripRead->getNumberOfDigits(), 100);
+  for (int i = 0; i < 100; i++) {
+    BOOST_CHECK(stripRead->findDigit(Digit::getOrderingKey(3 * Geo::NPADS + i, 5, 0)) != nullptr);
+  }
+  BOOST_CHECK(stripRead->findDigit(Digit::getOrderingKey(3 * Geo::NPADS, 6, 0)) == nullptr);
+
+  // and new contributions are merged with them
+  BOOST_CHECK_EQUAL(stripRead->addDigit(3 * Geo::NPADS, 200, 10, 5, 1000), 0);
+  BOOST_CHECK_EQUAL(stripRead->getNumberOfDigits(), 100);
+  delete stripRead;
+}
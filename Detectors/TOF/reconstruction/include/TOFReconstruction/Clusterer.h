@@ -13,8 +13,10 @@
 #ifndef ALICEO2_TOF_CLUSTERER_H
 #define ALICEO2_TOF_CLUSTERER_H
 
+#include <memory>
 #include <utility>
 #include <vector>
+#include <gsl/span>
 #include "DataFormatsTOF/Cluster.h"
 #include "TOFBase/Geo.h"
 #include "TOFReconstruction/DataReader.h"
@@ -52,19 +54,36 @@ class Clusterer
     Printf("mCalibApi = %p", mCalibApi);
   }
 
+  /// number of threads sharing the strips of a readout window (<1: rely on openMP default)
+  void setNThreads(int n) { mNThreads = n; }
+  int getNThreads() const { return mNThreads; }
+
  private:
-  void calibrateStrip();
-  void processStrip(std::vector<Cluster>& clusters, MCLabelContainer const* digitMCTruth);
-  //void fetchMCLabels(const Digit* dig, std::array<Label, Cluster::maxLabels>& labels, int& nfilled) const;
+  /// clusterization of a contiguous range of strips, done by a single thread
+  struct ClustererThread {
+    Clusterer* parent = nullptr; // parent clusterer
+
+    Digit* mContributingDigit[6];    //! array of digits contributing to the cluster; this will not be stored, it is temporary to build the final cluster
+    int mNumberOfContributingDigits; //! number of digits contributing to the cluster; this will not be stored, it is temporary to build the final cluster
+
+    /// temporary storage for the thread output
+    std::vector<Cluster> clusters;
+    MCLabelContainer labels;
+
+    ClustererThread(Clusterer* par = nullptr) : parent(par) {}
+    void process(gsl::span<StripData> strips, std::vector<Cluster>& clusters, MCLabelContainer* clsLabels, MCLabelContainer const* digitMCTruth);
+    void calibrateStrip(StripData& strip);
+    void processStrip(StripData& strip, std::vector<Cluster>& clusters, MCLabelContainer* clsLabels, MCLabelContainer const* digitMCTruth);
+    void addContributingDigit(Digit* dig);
+    void buildCluster(Cluster& c, MCLabelContainer* clsLabels, MCLabelContainer const* digitMCTruth);
+  };
 
-  StripData mStripData; ///< single strip data provided by the reader
+  std::vector<StripData> mStrips;                         //! strips of the readout window provided by the reader, storage is reused
+  std::vector<std::unique_ptr<ClustererThread>> mThreads; //! per thread clusterization buffers
+  int mNThreads = 1;                                      ///< number of threads to use
 
   o2::dataformats::MCTruthContainer<o2::MCCompLabel>* mClsLabels = nullptr; // Cluster MC labels
 
-  Digit* mContributingDigit[6];    //! array of digits contributing to the cluster; this will not be stored, it is temporary to build the final cluster
-  int mNumberOfContributingDigits; //! number of digits contributing to the cluster; this will not be stored, it is temporary to build the final cluster
-  void addContributingDigit(Digit* dig);
-  void buildCluster(Cluster& c, MCLabelContainer const* digitMCTruth);
   CalibApi* mCalibApi = nullptr; //! calib api to handle the TOF calibration
 };
 
@@ -18,6 +18,10 @@
 #include "SimulationDataFormat/MCTruthContainer.h"
 #include <TStopwatch.h>
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 using namespace o2::tof;
 
 //__________________________________________________
@@ -29,13 +33,68 @@ void Clusterer::process(DataReader& reader, std::vector<Cluster>& clusters, MCLa
   reader.init();
   int totNumDigits = 0;
 
-  while (reader.getNextStripData(mStripData)) {
-    LOG(DEBUG) << "TOFClusterer got Strip " << mStripData.stripID << " with Ndigits "
-               << mStripData.digits.size();
-    totNumDigits += mStripData.digits.size();
+  // the strips are independent: collect them all, then share them between the threads
+  int nStrips = 0;
+  while (true) {
+    if (nStrips == int(mStrips.size())) {
+      mStrips.emplace_back();
+    }
+    if (!reader.getNextStripData(mStrips[nStrips])) {
+      break;
+    }
+    LOG(DEBUG) << "TOFClusterer got Strip " << mStrips[nStrips].stripID << " with Ndigits "
+               << mStrips[nStrips].digits.size();
+    totNumDigits += mStrips[nStrips].digits.size();
+    nStrips++;
+  }
 
-    calibrateStrip();
-    processStrip(clusters, digitMCTruth);
+  int nThreads = mNThreads;
+#ifdef WITH_OPENMP
+  if (nThreads < 1) {
+    nThreads = omp_get_max_threads();
+  }
+#else
+  nThreads = 1;
+#endif
+  int nLoops = std::max(1, std::min(nThreads, nStrips));
+  // contiguous ranges of strips with about the same number of digits, so that the clusters can be
+  // merged in the same order as if they were found by a single thread
+  std::vector<int> loopLim{0};
+  int nAvDigPerLoop = totNumDigits / nLoops, nDig = 0;
+  for (int i = 0; i < nStrips; i++) {
+    nDig += mStrips[i].digits.size();
+    if (nDig > nAvDigPerLoop * int(loopLim.size()) && int(loopLim.size()) < nLoops) {
+      loopLim.push_back(i + 1);
+    }
+  }
+  if (loopLim.back() != nStrips) {
+    loopLim.push_back(nStrips);
+  }
+  nLoops = loopLim.size() - 1;
+  while (int(mThreads.size()) < nLoops) {
+    mThreads.emplace_back(std::make_unique<ClustererThread>(this));
+  }
+
+  MCLabelContainer* clsLabels = digitMCTruth ? mClsLabels : nullptr;
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(nLoops)
+#endif
+  for (int ith = 0; ith < nLoops; ith++) {
+    auto strips = gsl::span<StripData>(&mStrips[loopLim[ith]], loopLim[ith + 1] - loopLim[ith]);
+    if (!ith) { // the 1st thread can write directly to the final destination
+      mThreads[ith]->process(strips, clusters, clsLabels, digitMCTruth);
+    } else { // extra threads will store in their own containers
+      mThreads[ith]->process(strips, mThreads[ith]->clusters, clsLabels ? &mThreads[ith]->labels : nullptr, digitMCTruth);
+    }
+  }
+
+  for (int ith = 1; ith < nLoops; ith++) {
+    clusters.insert(clusters.end(), mThreads[ith]->clusters.begin(), mThreads[ith]->clusters.end());
+    mThreads[ith]->clusters.clear();
+    if (clsLabels) {
+      clsLabels->mergeAtBack(mThreads[ith]->labels);
+      mThreads[ith]->labels.clear();
+    }
   }
 
   LOG(DEBUG) << "We had " << totNumDigits << " digits in this event";
@@ -46,23 +105,33 @@ void Clusterer::process(DataReader& reader, std::vector<Cluster>& clusters, MCLa
 }
 
 //__________________________________________________
-void Clusterer::calibrateStrip()
+void Clusterer::ClustererThread::process(gsl::span<StripData> strips, std::vector<Cluster>& clusters, MCLabelContainer* clsLabels, MCLabelContainer const* digitMCTruth)
+{
+  for (auto& strip : strips) {
+    calibrateStrip(strip);
+    processStrip(strip, clusters, clsLabels, digitMCTruth);
+  }
+}
+
+//__________________________________________________
+void Clusterer::ClustererThread::calibrateStrip(StripData& strip)
 {
   // method to calibrate the times from the current strip
 
-  for (int idig = 0; idig < mStripData.digits.size(); idig++) {
+  auto calibApi = parent->mCalibApi;
+  for (int idig = 0; idig < strip.digits.size(); idig++) {
     //    LOG(DEBUG) << "Checking digit " << idig;
-    Digit* dig = &mStripData.digits[idig];
-    double calib = mCalibApi->getTimeCalibration(dig->getChannel(), dig->getTOT() * Geo::TOTBIN_NS);
-    //printf("channel %d) isProblematic = %d, fractionUnderPeak = %f\n",dig->getChannel(),mCalibApi->isProblematic(dig->getChannel()),mCalibApi->getFractionUnderPeak(dig->getChannel())); // toberem
-    dig->setIsProblematic(mCalibApi->isProblematic(dig->getChannel()));
+    Digit* dig = &strip.digits[idig];
+    double calib = calibApi->getTimeCalibration(dig->getChannel(), dig->getTOT() * Geo::TOTBIN_NS);
+    //printf("channel %d) isProblematic = %d, fractionUnderPeak = %f\n",dig->getChannel(),calibApi->isProblematic(dig->getChannel()),calibApi->getFractionUnderPeak(dig->getChannel())); // toberem
+    dig->setIsProblematic(calibApi->isProblematic(dig->getChannel()));
     dig->setCalibratedTime(dig->getTDC() * Geo::TDCBIN + dig->getBC() * o2::constants::lhc::LHCBunchSpacingNS * 1E3 - calib); //TODO:  to be checked that "-" is correct, and we did not need "+" instead :-)
     //printf("calibration correction = %f\n",calib); // toberem
   }
 }
 
 //__________________________________________________
-void Clusterer::processStrip(std::vector<Cluster>& clusters, MCLabelContainer const* digitMCTruth)
+void Clusterer::ClustererThread::processStrip(StripData& strip, std::vector<Cluster>& clusters, MCLabelContainer* clsLabels, MCLabelContainer const* digitMCTruth)
 {
   // method to clusterize the current strip
 
@@ -72,16 +141,16 @@ void Clusterer::processStrip(std::vector<Cluster>& clusters, MCLabelContainer co
   Int_t iphi, iphi2, iphi3;
   Int_t ieta, ieta2, ieta3; // it is the number of padz-row increasing along the various strips
 
-  for (int idig = 0; idig < mStripData.digits.size(); idig++) {
+  for (int idig = 0; idig < strip.digits.size(); idig++) {
     //    LOG(DEBUG) << "Checking digit " << idig;
-    Digit* dig = &mStripData.digits[idig];
+    Digit* dig = &strip.digits[idig];
     //printf("checking digit %d - alreadyUsed=%d   -  problematic=%d\n",idig,dig->isUsedInCluster(),dig->isProblematic()); // toberem
     if (dig->isUsedInCluster() || dig->isProblematic())
       continue; // the digit was already used to build a cluster, or it was declared problematic
 
     mNumberOfContributingDigits = 0;
     dig->getPhiAndEtaIndex(iphi, ieta);
-    if (mStripData.digits.size() > 1)
+    if (strip.digits.size() > 1)
       LOG(DEBUG) << "idig = " << idig;
 
     // first we make a cluster out of the digit
@@ -92,8 +161,8 @@ void Clusterer::processStrip(std::vector<Cluster>& clusters, MCLabelContainer co
     addContributingDigit(dig);
     double timeDig = dig->getCalibratedTime();
 
-    for (int idigNext = idig + 1; idigNext < mStripData.digits.size(); idigNext++) {
-      Digit* digNext = &mStripData.digits[idigNext];
+    for (int idigNext = idig + 1; idigNext < strip.digits.size(); idigNext++) {
+      Digit* digNext = &strip.digits[idigNext];
       if (digNext->isUsedInCluster() || dig->isProblematic())
         continue; // the digit was already used to build a cluster, or was problematic
       // check if the TOF time are close enough to be merged; if not, it means that nothing else will contribute to the cluster (since digits are ordered in time)
@@ -115,12 +184,12 @@ void Clusterer::processStrip(std::vector<Cluster>& clusters, MCLabelContainer co
     } // loop on the second digit
 
     //printf("build cluster\n");
-    buildCluster(c, digitMCTruth); // toberem
+    buildCluster(c, clsLabels, digitMCTruth); // toberem
 
   } // loop on the first digit
 }
 //______________________________________________________________________
-void Clusterer::addContributingDigit(Digit* dig)
+void Clusterer::ClustererThread::addContributingDigit(Digit* dig)
 {
 
   // adding a digit to the array that stores the contributing ones
@@ -150,7 +219,7 @@ void Clusterer::addContributingDigit(Digit* dig)
 }
 
 //_____________________________________________________________________
-void Clusterer::buildCluster(Cluster& c, MCLabelContainer const* digitMCTruth)
+void Clusterer::ClustererThread::buildCluster(Cluster& c, MCLabelContainer* clsLabels, MCLabelContainer const* digitMCTruth)
 {
   static const float inv12 = 1. / 12.;
 
@@ -217,8 +286,8 @@ void Clusterer::buildCluster(Cluster& c, MCLabelContainer const* digitMCTruth)
   }
 
   // filling the MC labels of this cluster; the first will be those of the main digit; then the others
-  if (digitMCTruth != nullptr) {
-    int lbl = mClsLabels->getIndexedSize(); // this should correspond to the number of digits also;
+  if (clsLabels != nullptr) {
+    int lbl = clsLabels->getIndexedSize(); // this should correspond to the number of digits also;
     //printf("lbl = %d\n", lbl);
     for (int i = 0; i < mNumberOfContributingDigits; i++) {
       //printf("contributing digit = %d\n", i);
@@ -229,7 +298,7 @@ void Clusterer::buildCluster(Cluster& c, MCLabelContainer const* digitMCTruth)
         //printf("checking element %d in the array of labels\n", j);
         auto label = digitMCTruth->getElement(digitMCTruth->getMCTruthHeader(digitLabel).index + j);
         //printf("EventID = %d\n", label.getEventID());
-        mClsLabels->addElement(lbl, label);
+        clsLabels->addElement(lbl, label);
       }
     }
   }
@@ -9,6 +9,7 @@
 // or submit itself to any jurisdiction.
 
 #include "TOFWorkflow/TOFClusterizerSpec.h"
+#include "Framework/ConfigParamRegistry.h"
 #include "Framework/ControlService.h"
 #include "Framework/DataProcessorSpec.h"
 #include "Framework/DataRefUtils.h"
@@ -47,7 +48,7 @@ class TOFDPLClustererTask
   explicit TOFDPLClustererTask(bool useMC, bool useCCDB) : mUseMC(useMC), mUseCCDB(useCCDB) {}
   void init(framework::InitContext& ic)
   {
-    // nothing special to be set up
+    mClusterer.setNThreads(ic.options().get<int>("nthreads"));
     mTimer.Stop();
     mTimer.Reset();
   }
@@ -112,6 +113,8 @@ class TOFDPLClustererTask
     }
     LOG(INFO) << "TOF CLUSTERER : TRANSFORMED " << digits.size()
               << " DIGITS TO " << mClustersArray.size() << " CLUSTERS";
+    mNDigits += digits.size();
+    mNClusters += mClustersArray.size();
 
     // send clusters
     pc.outputs().snapshot(Output{o2::header::gDataOriginTOF, "CLUSTERS", 0, Lifetime::Timeframe}, mClustersArray);
@@ -126,12 +129,18 @@ class TOFDPLClustererTask
   {
     LOGF(INFO, "TOF Clusterer total timing: Cpu: %.3e Real: %.3e s in %d slots",
          mTimer.CpuTime(), mTimer.RealTime(), mTimer.Counter() - 1);
+    if (mTimer.RealTime() > 0.) {
+      LOGF(INFO, "TOF Clusterer throughput: %.3e digits/s, %.3e clusters/s",
+           mNDigits / mTimer.RealTime(), mNClusters / mTimer.RealTime());
+    }
   }
 
  private:
   DigitDataReader mReader; ///< Digit reader
   Clusterer mClusterer;    ///< Cluster finder
   TStopwatch mTimer;
+  size_t mNDigits = 0;   ///< digits processed since the start
+  size_t mNClusters = 0; ///< clusters produced since the start
 
   std::vector<Cluster> mClustersArray; ///< Array of clusters
   MCLabelContainer mClsLabels;
@@ -155,7 +164,7 @@ o2::framework::DataProcessorSpec getTOFClusterizerSpec(bool useMC, bool useCCDB)
     Outputs{OutputSpec{o2::header::gDataOriginTOF, "CLUSTERS", 0, Lifetime::Timeframe},
             OutputSpec{o2::header::gDataOriginTOF, "CLUSTERSMCTR", 0, Lifetime::Timeframe}},
     AlgorithmSpec{adaptFromTask<TOFDPLClustererTask>(useMC, useCCDB)},
-    Options{/* for the moment no options */}};
+    Options{{"nthreads", VariantType::Int, 1, {"Number of clustering threads (<1: rely on openMP default)"}}}};
 }
 
 } // end namespace tof
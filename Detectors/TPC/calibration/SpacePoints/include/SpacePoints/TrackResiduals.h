@@ -98,6 +98,23 @@ class TrackResiduals
     std::array<unsigned char, VoxDim> bvox{}; ///< voxel identifier: VoxZ, VoxF, VoxX
   };
 
+  /// Column-wise in-memory storage of the local residuals of one sector.
+  /// Used instead of the per-sector trees of LocalResid when mKeepLocalResidInMemory is set.
+  struct LocalResidBuffer {
+    std::vector<short> dy;              ///< residuals in y, compressed as in LocalResid
+    std::vector<short> dz;              ///< residuals in z, compressed as in LocalResid
+    std::vector<short> tgSlp;           ///< track dip angles, compressed as in LocalResid
+    std::vector<unsigned short> voxBin; ///< global voxel bin (see getGlbVoxBin())
+    size_t size() const { return voxBin.size(); }
+    void clear()
+    {
+      dy.clear();
+      dz.clear();
+      tgSlp.clear();
+      voxBin.clear();
+    }
+  };
+
   /// Helper structure to organize acess to delta trees from Run2 (legacy method)
   /// All parameters are on a per-track basis
   struct DeltaStruct {
@@ -150,6 +167,13 @@ class TrackResiduals
   /// \param scP Scale factor to increase smoothing bandwidth at sector edges in Y/X
   /// \param scZ Scale factor to increase smoothing bandwidth at sector edges in Z
   void setKernelType(KernelType kernel = KernelType::Epanechnikov, float bwX = 2.1f, float bwP = 2.1f, float bwZ = 1.7f, float scX = 1.f, float scP = 1.f, float scZ = 1.f);
+  /// Keep the local residuals in per-sector memory buffers instead of writing them to the intermediate trees.
+  /// The tree based path (default) remains available for debugging.
+  /// \param flag If true, no local residual trees are created and processSectorResiduals() takes its input from memory
+  void setKeepLocalResidualsInMemory(bool flag = true) { mKeepLocalResidInMemory = flag; }
+  /// Sets the number of threads used for processing sectors and voxels in parallel (only effective with OpenMP).
+  /// \param n Number of threads
+  void setNThreads(int n) { mNThreads = n > 0 ? n : 1; }
 
   // -------------------------------------- steering functions --------------------------------------------------
 
@@ -176,7 +200,21 @@ class TrackResiduals
 
   /// Processes residuals for given sector.
   /// \param iSec Sector to process
-  void processSectorResiduals(Int_t iSec);
+  /// \return Number of voxels for which the residuals were extracted
+  int processSectorResiduals(Int_t iSec);
+
+  /// Reads the local residuals of given sector from the intermediate tree.
+  /// \param iSec Sector to read
+  /// \param dy Vector to be filled with the residuals in y
+  /// \param dz Vector to be filled with the residuals in z
+  /// \param tg Vector to be filled with tan(phi) of the tracks
+  /// \param bin Vector to be filled with the global voxel bin of each residual
+  /// \return Flag if the data could be read
+  bool readLocalResidualTree(int iSec, std::vector<float>& dy, std::vector<float>& dz, std::vector<float>& tg, std::vector<unsigned short>& bin) const;
+
+  /// Decompresses the local residuals of given sector from the in-memory buffer.
+  /// Same arguments as for readLocalResidualTree()
+  bool readLocalResidualBuffer(int iSec, std::vector<float>& dy, std::vector<float>& dz, std::vector<float>& tg, std::vector<unsigned short>& bin) const;
 
   /// Performs the robust linear fit for one voxel to estimate the distortions in X, Y and Z and their errors.
   /// \param dy Vector with residuals in y
@@ -251,6 +289,7 @@ class TrackResiduals
   float selectKthMin(const int k, std::vector<float>& data) const;
 
   /// Calculates a smooth estimate for the distortions in specified dimensions around the COG for a given voxel.
+  /// Only the results of neighbouring voxels are read, so it can be called concurrently for different voxels.
   /// \param iSec Sector in which the voxel is located
   /// \param x COG position in X
   /// \param p COG position in Y/X
@@ -258,7 +297,7 @@ class TrackResiduals
   /// \param res Array to store the results
   /// \param whichDim Integer value with bits set for the dimensions which need to be smoothed
   /// \return Flag if the estimate was successfull
-  bool getSmoothEstimate(int iSec, float x, float p, float z, std::array<float, ResDim>& res, int whichDim = 0);
+  bool getSmoothEstimate(int iSec, float x, float p, float z, std::array<float, ResDim>& res, int whichDim = 0) const;
 
   /// Calculates the weight of the given point used for the kernel smoothing.
   /// Takes into account the defined kernel in mKernelType.
@@ -435,6 +474,9 @@ class TrackResiduals
 
   // -------------------------------------- settings --------------------------------------------------
 
+  int getNThreads() const { return mNThreads; }
+  bool getKeepLocalResidualsInMemory() const { return mKeepLocalResidInMemory; }
+
   void setPathToResFileRun2(std::string fPath) { mPathToResidualFiles = fPath; }
   void setLocalResFileName(std::string fName) { mLocalResFileName = fName; }
   void setLocalResTreeName(std::string tName) { mLocalResTreeName = tName; }
@@ -509,6 +551,10 @@ class TrackResiduals
   void closeOutputFile();
 
  private:
+  /// Stores the content of mLocalResid for given sector either in the local residual tree or in the in-memory buffer
+  /// \param iSec Sector number (0..35)
+  void storeLocalResidual(int iSec);
+
   // names of input files / trees
   std::string mInputFileNameResiduals{"residuals_tpc.root"}; ///< name of file with track residuals
   // some constants
@@ -532,6 +578,8 @@ class TrackResiduals
   // status flags
   bool mIsInitialized{}; ///< initialize only once
   bool mPrintMem{};      ///< turn on to print memory usage at certain points
+  bool mKeepLocalResidInMemory{}; ///< keep local residuals in mLocalResidBuffer instead of mTmpTree
+  int mNThreads{1};               ///< number of threads for sector and voxel processing
   // binning
   int mNXBins{param::NPadRows};            ///< number of bins in radial direction
   int mNY2XBins{param::NY2XBins};          ///< number of y/x bins per sector
@@ -557,6 +605,7 @@ class TrackResiduals
   std::array<std::unique_ptr<TTree>, SECTORSPERSIDE * SIDES> mTmpTree{}; ///< I/O tree per sector
   LocalResid mLocalResid{};                                              ///< data exchange structure for filling mTmpTree
   LocalResid* mLocalResidPtr{&mLocalResid};                              ///< pointer to mLocalResid
+  std::array<LocalResidBuffer, SECTORSPERSIDE * SIDES> mLocalResidBuffer{}; ///< in-memory alternative to mTmpTree
   // settings
   std::string mLocalResFileName{"deltasSect"};   ///< filename for local residuals input
   std::string mLocalResTreeName{"treeSec"};      ///< name for tree with local residuals
@@ -583,7 +632,6 @@ class TrackResiduals
   std::array<int, VoxDim> mStepKern{};                             ///< N bins to consider with given kernel settings
   std::array<float, VoxDim> mKernelScaleEdge{};                    ///< optional scaling factors for kernel width on the edge
   std::array<float, VoxDim> mKernelWInv{};                         ///< inverse kernel width in bins
-  std::array<double, ResDim * sMaxSmtDim> mLastSmoothingRes{};     ///< results of last smoothing operation
   // (intermediate) results
   std::array<std::bitset<param::NPadRows>, SECTORSPERSIDE * SIDES> mXBinsIgnore{};          ///< flags which X bins to ignore
   std::array<std::array<float, param::NPadRows>, SECTORSPERSIDE * SIDES> mValidFracXBins{}; ///< for each sector for each X-bin the fraction of validated voxels
@@ -31,6 +31,7 @@
 // for debugging
 #include "TStopwatch.h"
 #include "TSystem.h"
+#include "TROOT.h"
 #include <iostream>
 #include <fstream>
 #include <limits>
@@ -531,8 +532,7 @@ void TrackResiduals::fillLocalResidualsTrees()
     mLocalResid.dy = static_cast<short>(mArrDY[iCl] * 0x7fff / param::MaxResid);
     mLocalResid.dz = static_cast<short>(mArrDZ[iCl] * 0x7fff / param::MaxResid);
     mLocalResid.tgSlp = static_cast<short>(mArrTgSlp[iCl] * 0x7fff / param::MaxTgSlp);
-    // fill tree
-    mTmpTree[secId]->Fill();
+    storeLocalResidual(secId);
     // TODO: fill statistics distribution within the voxel
   }
 }
@@ -690,6 +690,13 @@ void TrackResiduals::prepareDeltaTreeBranches()
 
 void TrackResiduals::prepareLocalResidualTrees()
 {
+  if (mKeepLocalResidInMemory) {
+    // no trees needed, only make sure the buffers are empty
+    for (auto& buffer : mLocalResidBuffer) {
+      buffer.clear();
+    }
+    return;
+  }
   // prepare tree structure
   for (int iSec = 0; iSec < SECTORSPERSIDE * SIDES; ++iSec) {
     mTmpFile[iSec] = std::make_unique<TFile>(Form("%s%d.root", mLocalResFileName.c_str(), iSec), "recreate");
@@ -700,6 +707,14 @@ void TrackResiduals::prepareLocalResidualTrees()
 
 void TrackResiduals::writeLocalResidualTreesToFile()
 {
+  if (mKeepLocalResidInMemory) {
+    size_t nResid = 0;
+    for (const auto& buffer : mLocalResidBuffer) {
+      nResid += buffer.size();
+    }
+    LOG(info) << "keeping " << nResid << " local residuals in memory, no trees are written";
+    return;
+  }
   // write trees with local residuals to file
   for (int iSec = 0; iSec < SECTORSPERSIDE * SIDES; ++iSec) {
     if (!mTmpFile[iSec]) {
@@ -713,6 +728,19 @@ void TrackResiduals::writeLocalResidualTreesToFile()
   }
 }
 
+void TrackResiduals::storeLocalResidual(int iSec)
+{
+  if (mKeepLocalResidInMemory) {
+    auto& buffer = mLocalResidBuffer[iSec];
+    buffer.dy.push_back(mLocalResid.dy);
+    buffer.dz.push_back(mLocalResid.dz);
+    buffer.tgSlp.push_back(mLocalResid.tgSlp);
+    buffer.voxBin.push_back(getGlbVoxBin(mLocalResid.bvox));
+  } else {
+    mTmpTree[iSec]->Fill();
+  }
+}
+
 void TrackResiduals::convertToLocalResiduals()
 {
   // When using data generated with o2 without distortions the residuals can easily be converted
@@ -762,7 +790,7 @@ void TrackResiduals::convertToLocalResiduals()
       mLocalResid.dz = mClRes[clIdx].dz;
       mLocalResid.tgSlp = mClRes[clIdx].phi;
       mLocalResid.bvox = bvox;
-      mTmpTree[sec]->Fill();
+      storeLocalResidual(sec);
       // TODO calculate mean position of clusters in each voxel (can be updated each time a new measurement is found inside voxel)
     }
   }
@@ -777,34 +805,39 @@ void TrackResiduals::processResiduals()
   if (!mIsInitialized) {
     init();
   }
+  TStopwatch timer;
+  int nVoxProcessed = 0;
+#ifdef WITH_OPENMP
+  if (mNThreads > 1 && !mKeepLocalResidInMemory) {
+    // the sectors are read from separate files concurrently
+    ROOT::EnableThreadSafety();
+  }
+#pragma omp parallel for schedule(dynamic) num_threads(mNThreads) reduction(+ \
+                                                                            : nVoxProcessed)
+#endif
   for (int iSec = 0; iSec < SECTORSPERSIDE * SIDES; ++iSec) {
-    processSectorResiduals(iSec);
+    nVoxProcessed += processSectorResiduals(iSec);
   }
+  timer.Stop();
+  LOG(info) << "processed " << nVoxProcessed << " voxels in " << timer.RealTime() << " s using " << mNThreads << " thread(s) ("
+            << (timer.RealTime() > 0 ? nVoxProcessed / timer.RealTime() : 0.) << " voxels/s)";
 }
 
 //______________________________________________________________________________
-void TrackResiduals::processSectorResiduals(int iSec)
+bool TrackResiduals::readLocalResidualTree(int iSec, std::vector<float>& dyData, std::vector<float>& dzData, std::vector<float>& tgSlpData, std::vector<unsigned short>& binData) const
 {
-  if (iSec < 0 || iSec > 35) {
-    LOG(error) << "wrong sector: " << iSec;
-    return;
-  }
-  LOG(info) << "processing sector residuals for sector " << iSec;
-  if (!mIsInitialized) {
-    init();
-  }
   // open file and retrieve data tree (only local files are supported at the moment)
   std::string filename = mLocalResFileName + std::to_string(iSec) + ".root";
   std::unique_ptr<TFile> flin = std::make_unique<TFile>(filename.c_str());
   if (!flin || flin->IsZombie()) {
     LOG(error) << "failed to open " << filename.c_str();
-    return;
+    return false;
   }
   std::string treename = mLocalResTreeName + std::to_string(iSec);
   std::unique_ptr<TTree> tree((TTree*)flin->Get(treename.c_str()));
   if (!tree) {
     LOG(error) << "did not find the data tree " << treename.c_str();
-    return;
+    return false;
   }
   // read compact delte trees created with AliRoot or o2
   LocResStruct trkRes;
@@ -814,24 +847,20 @@ void TrackResiduals::processSectorResiduals(int iSec)
   if (!nPoints) {
     LOG(warning) << "no entries found for sector " << iSec;
     flin->Close();
-    return;
+    return false;
   }
   if (nPoints > mMaxPointsPerSector) {
     nPoints = mMaxPointsPerSector;
   }
-  // initialize container holding results
-  initResultsContainer(iSec);
 
   LOG(info) << "extracted " << nPoints << " of unbinned data";
 
-  std::vector<VoxRes>& secData = mVoxelResults[iSec];
-
   unsigned int nAccepted = 0;
 
-  std::vector<float> dyData(nPoints);
-  std::vector<float> dzData(nPoints);
-  std::vector<float> tgSlpData(nPoints);
-  std::vector<unsigned short> binData(nPoints);
+  dyData.resize(nPoints);
+  dzData.resize(nPoints);
+  tgSlpData.resize(nPoints);
+  binData.resize(nPoints);
 
   if (mPrintMem) {
     printMem();
@@ -868,8 +897,6 @@ void TrackResiduals::processSectorResiduals(int iSec)
 
   LOG(info) << "Done reading input data (accepted " << nAccepted << " points)";
 
-  std::vector<size_t> binIndices(nAccepted);
-
   dyData.resize(nAccepted);
   dzData.resize(nAccepted);
   tgSlpData.resize(nAccepted);
@@ -877,61 +904,124 @@ void TrackResiduals::processSectorResiduals(int iSec)
 
 #ifdef LOCAL_RESIDUAL_FORMAT_OLD
   // convert to short and back to float to be compatible with AliRoot version
-  std::vector<short> dyDataShort(nAccepted);
-  std::vector<short> dzDataShort(nAccepted);
-  std::vector<short> tgSlpDataShort(nAccepted);
   for (unsigned int i = 0; i < nAccepted; ++i) {
-    dyDataShort[i] = short(dyData[i] * 0x7fff / param::MaxResid);
-    dzDataShort[i] = short(dzData[i] * 0x7fff / param::MaxResid);
-    tgSlpDataShort[i] = short(tgSlpData[i] * 0x7fff / param::MaxTgSlp);
-
-    dyData[i] = dyDataShort[i] * param::MaxResid / 0x7fff;
-    dzData[i] = dzDataShort[i] * param::MaxResid / 0x7fff;
-    tgSlpData[i] = tgSlpDataShort[i] * param::MaxTgSlp / 0x7fff;
+    dyData[i] = short(dyData[i] * 0x7fff / param::MaxResid) * param::MaxResid / 0x7fff;
+    dzData[i] = short(dzData[i] * 0x7fff / param::MaxResid) * param::MaxResid / 0x7fff;
+    tgSlpData[i] = short(tgSlpData[i] * 0x7fff / param::MaxTgSlp) * param::MaxTgSlp / 0x7fff;
   }
 #endif
+  return true;
+}
+
+//______________________________________________________________________________
+bool TrackResiduals::readLocalResidualBuffer(int iSec, std::vector<float>& dyData, std::vector<float>& dzData, std::vector<float>& tgSlpData, std::vector<unsigned short>& binData) const
+{
+  const auto& buffer = mLocalResidBuffer[iSec];
+  size_t nPoints = buffer.size();
+  if (!nPoints) {
+    LOG(warning) << "no entries found for sector " << iSec;
+    return false;
+  }
+  if (nPoints > static_cast<size_t>(mMaxPointsPerSector)) {
+    nPoints = mMaxPointsPerSector;
+  }
+  dyData.resize(nPoints);
+  dzData.resize(nPoints);
+  tgSlpData.resize(nPoints);
+  binData.resize(nPoints);
+  // the residuals are stored in the same compressed format as the LocalResid written to the trees
+  size_t nAccepted = 0;
+  for (size_t i = 0; i < nPoints; ++i) {
+    if (fabs(buffer.tgSlp[i] * param::MaxTgSlp / 0x7fff) >= param::MaxTgSlp) {
+      continue;
+    }
+    dyData[nAccepted] = buffer.dy[i] * param::MaxResid / 0x7fff;
+    dzData[nAccepted] = buffer.dz[i] * param::MaxResid / 0x7fff;
+    tgSlpData[nAccepted] = buffer.tgSlp[i] * param::MaxTgSlp / 0x7fff;
+    binData[nAccepted] = buffer.voxBin[i];
+    nAccepted++;
+  }
+  LOG(info) << "Done reading input data from memory (accepted " << nAccepted << " points)";
+
+  dyData.resize(nAccepted);
+  dzData.resize(nAccepted);
+  tgSlpData.resize(nAccepted);
+  binData.resize(nAccepted);
+  return true;
+}
+
+//______________________________________________________________________________
+int TrackResiduals::processSectorResiduals(int iSec)
+{
+  if (iSec < 0 || iSec > 35) {
+    LOG(error) << "wrong sector: " << iSec;
+    return 0;
+  }
+  LOG(info) << "processing sector residuals for sector " << iSec;
+  if (!mIsInitialized) {
+    init();
+  }
+
+  std::vector<float> dyData;
+  std::vector<float> dzData;
+  std::vector<float> tgSlpData;
+  std::vector<unsigned short> binData;
+  bool dataOK = mKeepLocalResidInMemory ? readLocalResidualBuffer(iSec, dyData, dzData, tgSlpData, binData)
+                                        : readLocalResidualTree(iSec, dyData, dzData, tgSlpData, binData);
+  if (!dataOK) {
+    return 0;
+  }
+  // initialize container holding results
+  initResultsContainer(iSec);
 
-  // sort in voxel increasing order
-  o2::math_utils::math_base::SortData(binData, binIndices);
+  std::vector<VoxRes>& secData = mVoxelResults[iSec];
+  const size_t nAccepted = binData.size();
+
+  // group the data by voxel (stable counting sort), afterwards the residuals of voxel i
+  // are stored contiguously in the range [voxOffset[i], voxOffset[i+1])
+  std::vector<unsigned int> voxOffset(mNVoxPerSector + 1, 0);
+  for (auto bin : binData) {
+    ++voxOffset[bin + 1];
+  }
+  for (int iVox = 0; iVox < mNVoxPerSector; ++iVox) {
+    voxOffset[iVox + 1] += voxOffset[iVox];
+  }
+  {
+    std::vector<unsigned int> fillPos(voxOffset.begin(), voxOffset.end() - 1);
+    std::vector<float> tmp(nAccepted);
+    std::vector<unsigned int> sortedIdx(nAccepted);
+    for (size_t i = 0; i < nAccepted; ++i) {
+      sortedIdx[fillPos[binData[i]]++] = i;
+    }
+    for (auto* vec : {&dyData, &dzData, &tgSlpData}) {
+      for (size_t i = 0; i < nAccepted; ++i) {
+        tmp[i] = (*vec)[sortedIdx[i]];
+      }
+      vec->swap(tmp);
+    }
+  }
+  binData.clear();
+  binData.shrink_to_fit();
   if (mPrintMem) {
     printMem();
   }
 
-  // vectors holding the data for one voxel at a time
-  std::vector<float> dyVec;
-  std::vector<float> dzVec;
-  std::vector<float> tgVec;
-  // assuming we will always have around 1000 entries per voxel
-  dyVec.reserve(1e3);
-  dzVec.reserve(1e3);
-  tgVec.reserve(1e3);
-  int currVoxBin = -1;
-  unsigned int nPointsInVox = 0;
-  unsigned int nProcessed = 0;
-  while (nProcessed < nAccepted) {
-    // read all points, voxel by voxel
-    int idx = binIndices[nProcessed];
-    if (currVoxBin != binData[idx]) {
-      if (nPointsInVox) {
-        VoxRes& resVox = secData[currVoxBin];
-        processVoxelResiduals(dyVec, dzVec, tgVec, resVox);
-      }
-      currVoxBin = binData[idx];
-      nPointsInVox = 0;
-      dyVec.clear();
-      dzVec.clear();
-      tgVec.clear();
-    }
-    dyVec.push_back(dyData[idx]);
-    dzVec.push_back(dzData[idx]);
-    tgVec.push_back(tgSlpData[idx]);
-    ++nPointsInVox;
-    ++nProcessed;
-  }
-  if (nPointsInVox) {
-    // process last voxel
-    VoxRes& resVox = secData[currVoxBin];
-    processVoxelResiduals(dyVec, dzVec, tgVec, resVox);
+  // fit the residuals voxel by voxel, each voxel only modifies its own results
+  int nVoxProcessed = 0;
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic, 64) num_threads(mNThreads) reduction(+ \
+                                                                                : nVoxProcessed)
+#endif
+  for (int iVox = 0; iVox < mNVoxPerSector; ++iVox) {
+    auto first = voxOffset[iVox], last = voxOffset[iVox + 1];
+    if (first == last) {
+      continue;
+    }
+    std::vector<float> dyVec(dyData.begin() + first, dyData.begin() + last);
+    std::vector<float> dzVec(dzData.begin() + first, dzData.begin() + last);
+    std::vector<float> tgVec(tgSlpData.begin() + first, tgSlpData.begin() + last);
+    processVoxelResiduals(dyVec, dzVec, tgVec, secData[iVox]);
+    ++nVoxProcessed;
   }
   LOG(info) << "extracted residuals for sector " << iSec;
 
@@ -939,46 +1029,29 @@ void TrackResiduals::processSectorResiduals(int iSec)
   LOG(info) << "number of validated X rows: " << nRowsOK;
   if (!nRowsOK) {
     LOG(warning) << "sector " << iSec << ": all X-bins disabled, abandon smoothing";
-    return;
+    return nVoxProcessed;
   } else {
     smooth(iSec);
   }
-  //dumpResults(iSec);
-  //return;
 
   // process dispersions
-  dyVec.clear();
-  tgVec.clear();
-  currVoxBin = -1;
-  nProcessed = 0;
-  nPointsInVox = 0;
-  while (nProcessed < nAccepted) {
-    int idx = binIndices[nProcessed];
-    if (currVoxBin != binData[idx]) {
-      if (nPointsInVox) {
-        VoxRes& resVox = secData[currVoxBin];
-        if (!getXBinIgnored(iSec, resVox.bvox[VoxX])) {
-          processVoxelDispersions(tgVec, dyVec, resVox);
-        }
-      }
-      currVoxBin = binData[idx];
-      nPointsInVox = 0;
-      dyVec.clear();
-      tgVec.clear();
-    }
-    dyVec.push_back(dyData[idx]);
-    tgVec.push_back(tgSlpData[idx]);
-    ++nPointsInVox;
-    ++nProcessed;
-  }
-  if (nPointsInVox) {
-    // process last voxel
-    VoxRes& resVox = secData[currVoxBin];
-    if (!getXBinIgnored(iSec, resVox.bvox[VoxX])) {
-      processVoxelDispersions(tgVec, dyVec, resVox);
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic, 64) num_threads(mNThreads)
+#endif
+  for (int iVox = 0; iVox < mNVoxPerSector; ++iVox) {
+    auto first = voxOffset[iVox], last = voxOffset[iVox + 1];
+    VoxRes& resVox = secData[iVox];
+    if (first == last || getXBinIgnored(iSec, resVox.bvox[VoxX])) {
+      continue;
     }
+    std::vector<float> dyVec(dyData.begin() + first, dyData.begin() + last);
+    std::vector<float> tgVec(tgSlpData.begin() + first, tgSlpData.begin() + last);
+    processVoxelDispersions(tgVec, dyVec, resVox);
   }
   // smooth dispersions
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(mNThreads)
+#endif
   for (int ix = 0; ix < mNXBins; ++ix) {
     if (getXBinIgnored(iSec, ix)) {
       continue;
@@ -992,7 +1065,11 @@ void TrackResiduals::processSectorResiduals(int iSec)
     }
   }
   LOG(info) << "Done processing residuals for sector " << iSec;
+#ifdef WITH_OPENMP
+#pragma omp critical(TrackResidualsDump)
+#endif
   dumpResults(iSec);
+  return nVoxProcessed;
 }
 
 //______________________________________________________________________________
@@ -1184,6 +1261,13 @@ int TrackResiduals::validateVoxels(int iSec)
 void TrackResiduals::smooth(int iSec)
 {
   std::vector<VoxRes>& secData = mVoxelResults[iSec];
+  // the smoothing reads the flags of the neighbouring voxels, so they are only updated once all voxels are done
+  std::vector<char> smoothOK(mNVoxPerSector, 0);
+  int nFailed = 0;
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(mNThreads) reduction(+ \
+                                                                            : nFailed)
+#endif
   for (int ix = 0; ix < mNXBins; ++ix) {
     if (getXBinIgnored(iSec, ix)) {
       continue;
@@ -1192,12 +1276,27 @@ void TrackResiduals::smooth(int iSec)
       for (int iz = 0; iz < mNZ2XBins; ++iz) {
         int voxBin = getGlbVoxBin(ix, ip, iz);
         VoxRes& resVox = secData[voxBin];
-        resVox.flags &= ~SmoothDone;
         bool res = getSmoothEstimate(resVox.bsec, resVox.stat[VoxX], resVox.stat[VoxF], resVox.stat[VoxZ], resVox.DS, (0x1 << VoxX | 0x1 << VoxF | 0x1 << VoxZ));
         if (!res) {
-          mNSmoothingFailedBins[iSec]++;
+          ++nFailed;
         } else {
-          resVox.flags |= SmoothDone;
+          smoothOK[voxBin] = 1;
+        }
+      }
+    }
+  }
+  mNSmoothingFailedBins[iSec] += nFailed;
+  for (int ix = 0; ix < mNXBins; ++ix) {
+    if (getXBinIgnored(iSec, ix)) {
+      continue;
+    }
+    for (int ip = 0; ip < mNY2XBins; ++ip) {
+      for (int iz = 0; iz < mNZ2XBins; ++iz) {
+        int voxBin = getGlbVoxBin(ix, ip, iz);
+        if (smoothOK[voxBin]) {
+          secData[voxBin].flags |= SmoothDone;
+        } else {
+          secData[voxBin].flags &= ~SmoothDone;
         }
       }
     }
@@ -1221,7 +1320,7 @@ void TrackResiduals::smooth(int iSec)
   }
 }
 
-bool TrackResiduals::getSmoothEstimate(int iSec, float x, float p, float z, std::array<float, ResDim>& res, int whichDim)
+bool TrackResiduals::getSmoothEstimate(int iSec, float x, float p, float z, std::array<float, ResDim>& res, int whichDim) const
 {
   // get smooth estimate for distortions for point in sector coordinates
   /// \todo correct use of the symmetric matrix should speed up the code
@@ -1247,16 +1346,16 @@ bool TrackResiduals::getSmoothEstimate(int iSec, float x, float p, float z, std:
 
   int ix0, ip0, iz0;
   findVoxel(x, p, iSec < SECTORSPERSIDE ? z : -z, ix0, ip0, iz0); // find nearest voxel
-  std::vector<VoxRes>& secData = mVoxelResults[iSec];
+  const std::vector<VoxRes>& secData = mVoxelResults[iSec];
   int binCenter = getGlbVoxBin(ix0, ip0, iz0); // global bin of nearest voxel
-  VoxRes& voxCenter = secData[binCenter];      // nearest voxel
+  const VoxRes& voxCenter = secData[binCenter]; // nearest voxel
   LOG(debug) << "getting smooth estimate around voxel " << binCenter;
 
   // cache
   // \todo maybe a 1-D cache would be more efficient?
   std::array<std::array<double, sMaxSmtDim*(sMaxSmtDim + 1) / 2>, ResDim> cmat;
   int maxNeighb = 10 * 10 * 10;
-  std::vector<VoxRes*> currVox;
+  std::vector<const VoxRes*> currVox;
   currVox.reserve(maxNeighb);
   std::vector<float> currCache;
   currCache.reserve(maxNeighb * VoxHDim);
@@ -1267,9 +1366,10 @@ bool TrackResiduals::getSmoothEstimate(int iSec, float x, float p, float z, std:
   maxTrials[VoxX] = mMaxBadXBinsToCover * 2;
 
   std::array<int, VoxDim> trial{0};
+  std::array<double, ResDim * sMaxSmtDim> smoothRes; // results of the current smoothing trial
 
   while (true) {
-    std::fill(mLastSmoothingRes.begin(), mLastSmoothingRes.end(), 0);
+    std::fill(smoothRes.begin(), smoothRes.end(), 0);
     memset(&cmat[0][0], 0, sizeof(cmat));
 
     int nbOK = 0; // accounted neighbours
@@ -1348,7 +1448,7 @@ bool TrackResiduals::getSmoothEstimate(int iSec, float x, float p, float z, std:
       for (int ip = ipMin; ip <= ipMax; ++ip) {
         for (int iz = izMin; iz <= izMax; ++iz) {
           int binNb = getGlbVoxBin(ix, ip, iz);
-          VoxRes& voxNb = secData[binNb];
+          const VoxRes& voxNb = secData[binNb];
           if (!(voxNb.flags & DistDone) ||
               (voxNb.flags & Masked) ||
               getXBinIgnored(iSec, ix)) {
@@ -1455,7 +1555,7 @@ bool TrackResiduals::getSmoothEstimate(int iSec, float x, float p, float z, std:
           wi /= (voxNb->E[iDim] * voxNb->E[iDim]);
         }
         std::array<double, sMaxSmtDim*(sMaxSmtDim + 1) / 2>& cmatD = cmat[iDim];
-        double* rhsD = &mLastSmoothingRes[iDim * sMaxSmtDim];
+        double* rhsD = &smoothRes[iDim * sMaxSmtDim];
         unsigned short iMat = 0;
         unsigned short iRhs = 0;
         // linear part
@@ -1521,7 +1621,7 @@ bool TrackResiduals::getSmoothEstimate(int iSec, float x, float p, float z, std:
       }
       matrix.Zero(); // reset matrix
       std::array<double, sMaxSmtDim*(sMaxSmtDim + 1) / 2>& cmatD = cmat[iDim];
-      double* rhsD = &mLastSmoothingRes[iDim * sMaxSmtDim];
+      double* rhsD = &smoothRes[iDim * sMaxSmtDim];
       short iMat = -1;
       short iRhs = -1;
       short row = -1;
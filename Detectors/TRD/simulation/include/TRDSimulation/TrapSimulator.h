@@ -106,6 +106,10 @@ class TrapSimulator
   static void setStoreClusters(bool storeClusters) { mgStoreClusters = storeClusters; }
   static bool getStoreClusters() { return mgStoreClusters; }
 
+  /// use filterBatch() in filter() instead of the individual filters, the results are bit-exact identical
+  static void setUseBatchFilter(bool useBatchFilter) { mgUseBatchFilter = useBatchFilter; }
+  static bool getUseBatchFilter() { return mgUseBatchFilter; }
+
   int getDetector() const { return mDetector; }; // Returns Chamber ID (0-539)
   int getRobPos() const { return mRobPos; };     // Returns ROB position (0-7)
   int getMcmPos() const { return mMcmPos; };     // Returns MCM position (0-17) (16,17 are mergers)
@@ -130,6 +134,9 @@ class TrapSimulator
   void filterGain();     // Apply gain filter
   void filterTail();     // Apply tail filter
 
+  // apply pedestal, gain and tail filter in one pass, processing all channels of a timebin together
+  void filterBatch();
+
   // filter initialization (resets internal registers)
   void filterPedestalInit(int baseline = 10);
   void filterGainInit();
@@ -343,6 +350,8 @@ class TrapSimulator
   static int mgAddBaseline; // add baseline to the ADC values
 
   static bool mgStoreClusters; // whether to store all clusters in the tracklets
+
+  static bool mgUseBatchFilter; // use the batch implementation of the filter chain
   bool mDataIsSet = false;
 };
 
@@ -58,6 +58,7 @@ using namespace std;
 bool TrapSimulator::mgApplyCut = true;
 int TrapSimulator::mgAddBaseline = 0;
 bool TrapSimulator::mgStoreClusters = true;
+bool TrapSimulator::mgUseBatchFilter = false;
 const int TrapSimulator::mgkFormatIndex = std::ios_base::xalloc();
 const std::array<unsigned short, 4> TrapSimulator::mgkFPshifts{11, 14, 17, 21};
 
@@ -1001,12 +1002,118 @@ void TrapSimulator::filter()
   // outputs to mADCF.
 
   // Non-linearity filter not implemented.
-  filterPedestal();
-  filterGain();
-  filterTail();
+  if (mgUseBatchFilter) {
+    filterBatch();
+  } else {
+    filterPedestal();
+    filterGain();
+    filterTail();
+  }
   // Crosstalk filter not implemented.
 }
 
+void TrapSimulator::filterBatch()
+{
+  //
+  // Apply pedestal, gain and tail filter in one pass.
+  //
+  // This emulates exactly the same fixed-point arithmetic as the
+  // filter*NextSample() methods. As the internal registers of each
+  // filter only depend on the history of the same channel, the three
+  // filters can be applied per timebin instead of per filter. The
+  // configuration is read once per MCM and the internal registers
+  // are kept as arrays over the channels, such that the loops over
+  // the channels have no branches and can be vectorised.
+
+  constexpr int nAdc = NOfAdcPerMcm;
+
+  // pedestal filter configuration
+  const unsigned int fpnp = (unsigned short)mTrapConfig->getTrapReg(TrapConfig::kFPNP, mDetector, mRobPos, mMcmPos);
+  const unsigned int fpShift = mgkFPshifts[(unsigned short)mTrapConfig->getTrapReg(TrapConfig::kFPTC, mDetector, mRobPos, mMcmPos)];
+  const bool fpby = (unsigned short)mTrapConfig->getTrapReg(TrapConfig::kFPBY, mDetector, mRobPos, mMcmPos) != 0;
+  // gain filter configuration
+  const bool fgby = (unsigned short)mTrapConfig->getTrapReg(TrapConfig::kFGBY, mDetector, mRobPos, mMcmPos) == 1;
+  const unsigned int fgta = (unsigned short)mTrapConfig->getTrapReg(TrapConfig::kFGTA, mDetector, mRobPos, mMcmPos);
+  const unsigned int fgtb = (unsigned short)mTrapConfig->getTrapReg(TrapConfig::kFGTB, mDetector, mRobPos, mMcmPos);
+  // tail filter configuration
+  const unsigned int alphaLong = 0x3ff & mTrapConfig->getTrapReg(TrapConfig::kFTAL, mDetector, mRobPos, mMcmPos);
+  const unsigned int lambdaLong = (unsigned short)((1 << 10) | (1 << 9) | (mTrapConfig->getTrapReg(TrapConfig::kFTLL, mDetector, mRobPos, mMcmPos) & 0x1FF));
+  const unsigned int lambdaShort = (unsigned short)((0 << 10) | (1 << 9) | (mTrapConfig->getTrapReg(TrapConfig::kFTLS, mDetector, mRobPos, mMcmPos) & 0x1FF));
+  const bool ftby = mTrapConfig->getTrapReg(TrapConfig::kFTBY, mDetector, mRobPos, mMcmPos) != 0;
+
+  // internal registers and per channel configuration
+  std::array<unsigned int, nAdc> pedAcc, gainCntA, gainCntB, tailLong, tailShort, fgf, fga;
+  for (int adc = 0; adc < nAdc; adc++) {
+    pedAcc[adc] = mInternalFilterRegisters[adc].mPedAcc;
+    gainCntA[adc] = mInternalFilterRegisters[adc].mGainCounterA;
+    gainCntB[adc] = mInternalFilterRegisters[adc].mGainCounterB;
+    tailLong[adc] = mInternalFilterRegisters[adc].mTailAmplLong;
+    tailShort[adc] = mInternalFilterRegisters[adc].mTailAmplShort;
+    fgf[adc] = 0x700 + (unsigned short)mTrapConfig->getTrapReg(TrapConfig::TrapReg_t(TrapConfig::kFGF0 + adc), mDetector, mRobPos, mMcmPos);
+    fga[adc] = (unsigned short)mTrapConfig->getTrapReg(TrapConfig::TrapReg_t(TrapConfig::kFGA0 + adc), mDetector, mRobPos, mMcmPos);
+  }
+
+  std::array<unsigned int, nAdc> value;
+  for (int iTimeBin = 0; iTimeBin < mNTimeBin; iTimeBin++) {
+    for (int adc = 0; adc < nAdc; adc++) {
+      value[adc] = (unsigned short)mADCR[adc * mNTimeBin + iTimeBin];
+    }
+
+    // pedestal filter, see filterPedestalNextSample()
+    const bool updatePedestal = iTimeBin == 0; // the accumulator is disabled in the drift time
+    for (int adc = 0; adc < nAdc; adc++) {
+      unsigned int in = value[adc];
+      unsigned int inpAdd = (in + fpnp) & 0xFFFF;
+      unsigned int accumulatorShifted = (pedAcc[adc] >> fpShift) & 0x3FF;
+      unsigned int correctedAcc = (pedAcc[adc] + (in & 0x3FF) - accumulatorShifted) & 0x7FFFFFFF;
+      pedAcc[adc] = updatePedestal ? correctedAcc : pedAcc[adc];
+      unsigned int diff = inpAdd - accumulatorShifted;
+      unsigned int out = inpAdd <= accumulatorShifted ? 0 : (diff > 0xFFF ? 0xFFF : diff);
+      value[adc] = fpby ? out : in;
+    }
+
+    // gain filter, see filterGainNextSample()
+    for (int adc = 0; adc < nAdc; adc++) {
+      unsigned int in = value[adc] & 0xFFF;
+      unsigned int corr = (in * fgf[adc]) >> 11;
+      corr = corr > 0xFFF ? 0xFFF : corr;
+      corr = corr + fga[adc] > 0xFFF ? 0xFFF : corr + fga[adc];
+      unsigned int notFull = (gainCntA[adc] != 0x3FFFFFF) & (gainCntB[adc] != 0x3FFFFFF);
+      gainCntB[adc] += notFull & (corr >= fgtb);
+      gainCntA[adc] += notFull & (corr < fgtb) & (corr >= fgta);
+      value[adc] = fgby ? corr : in;
+    }
+
+    // tail filter, see filterTailNextSample()
+    for (int adc = 0; adc < nAdc; adc++) {
+      unsigned int inpVolt = value[adc] & 0xFFF;
+      unsigned int aQ = tailLong[adc] + tailShort[adc];
+      aQ = aQ > 0xFFF ? 0xFFF : aQ;
+      unsigned int aDiff = inpVolt > aQ ? inpVolt - aQ : 0;
+      unsigned int alInpv = (aDiff * alphaLong) >> 11;
+      unsigned int tmp = tailLong[adc] + alInpv;
+      tmp = tmp > 0xFFF ? 0xFFF : tmp;
+      tailLong[adc] = ((tmp * lambdaLong) >> 11) & 0xFFF;
+      tmp = tailShort[adc] + aDiff - alInpv;
+      tmp = tmp > 0xFFF ? 0xFFF : tmp;
+      tailShort[adc] = ((tmp * lambdaShort) >> 11) & 0xFFF;
+      value[adc] = ftby ? aDiff : value[adc];
+    }
+
+    for (int adc = 0; adc < nAdc; adc++) {
+      mADCF[adc * mNTimeBin + iTimeBin] = value[adc];
+    }
+  }
+
+  for (int adc = 0; adc < nAdc; adc++) {
+    mInternalFilterRegisters[adc].mPedAcc = pedAcc[adc];
+    mInternalFilterRegisters[adc].mGainCounterA = gainCntA[adc];
+    mInternalFilterRegisters[adc].mGainCounterB = gainCntB[adc];
+    mInternalFilterRegisters[adc].mTailAmplLong = tailLong[adc];
+    mInternalFilterRegisters[adc].mTailAmplShort = tailShort[adc];
+  }
+}
+
 void TrapSimulator::filterPedestalInit(int baseline)
 {
   // Initializes the pedestal filter assuming that the input has
@@ -0,0 +1,107 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file benchmark_TrapFilter.cxx
+/// \brief Compare the per-sample filter chain of the TrapSimulator with the batch implementation
+
+#include "benchmark/benchmark.h"
+#include "TRDSimulation/TrapSimulator.h"
+#include "TRDSimulation/TrapConfig.h"
+#include "TRDSimulation/TrapConfigHandler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace o2::trd;
+
+namespace
+{
+constexpr int NMCMs = 1000;
+
+// ADC data of one MCM: the channels with a digit and their time bins
+struct MCMData {
+  std::vector<int> channels;
+  std::vector<ArrayADC> adcs;
+};
+
+// creates MCMs where each channel has a digit with the given probability (in percent),
+// 1 in 5 digits contains a signal on top of the pedestal, roughly shaped like the TRD pulse
+std::vector<MCMData> createMCMData(int occupancy)
+{
+  std::mt19937 gen(1234);
+  std::uniform_int_distribution<int> channel(0, 99);
+  std::normal_distribution<float> noise(10.f, 1.5f);
+  std::uniform_real_distribution<float> amplitude(20.f, 600.f);
+  std::vector<MCMData> mcms(NMCMs);
+  for (auto& mcm : mcms) {
+    for (int adc = 0; adc < FeeParam::getNadcMcm(); ++adc) {
+      if (channel(gen) >= occupancy) {
+        continue;
+      }
+      ArrayADC data;
+      float ampl = channel(gen) < 20 ? amplitude(gen) : 0.f;
+      for (int timebin = 0; timebin < kTimeBins; ++timebin) {
+        float t = timebin - 5.f;
+        float pulse = t > 0 ? ampl * t / 3.f * std::exp(1.f - t / 3.f) : 0.f;
+        data[timebin] = std::max(0, static_cast<int>(noise(gen) + pulse));
+      }
+      mcm.channels.push_back(adc);
+      mcm.adcs.push_back(data);
+    }
+  }
+  return mcms;
+}
+
+TrapConfig* getConfig()
+{
+  static TrapConfig trapConfig("benchmark");
+  static bool initialized = false;
+  if (!initialized) {
+    TrapConfigHandler cfgHandler(&trapConfig);
+    cfgHandler.init();
+    cfgHandler.loadConfig();
+    // activate all filters, they are bypassed in the default configuration
+    for (int det = 0; det < kNdet; ++det) {
+      trapConfig.setTrapReg(TrapConfig::kFPBY, 1, det);
+      trapConfig.setTrapReg(TrapConfig::kFGBY, 1, det);
+      trapConfig.setTrapReg(TrapConfig::kFTBY, 1, det);
+    }
+    initialized = true;
+  }
+  return &trapConfig;
+}
+} // namespace
+
+// the first argument selects the batch filter, the second one is the channel occupancy in percent
+static void BM_TrapFilter(benchmark::State& state)
+{
+  auto trapConfig = getConfig();
+  auto mcms = createMCMData(state.range(1));
+  TrapSimulator::setUseBatchFilter(state.range(0));
+  TrapSimulator trapSimulator;
+  for (auto _ : state) {
+    for (int imcm = 0; imcm < NMCMs; ++imcm) {
+      trapSimulator.init(trapConfig, 0, imcm % 8, imcm % 16);
+      for (size_t i = 0; i < mcms[imcm].channels.size(); ++i) {
+        trapSimulator.setData(mcms[imcm].channels[i], mcms[imcm].adcs[i]);
+      }
+      trapSimulator.filter();
+      benchmark::DoNotOptimize(trapSimulator.getDataFiltered(0, 0));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NMCMs);
+  TrapSimulator::setUseBatchFilter(false);
+}
+
+BENCHMARK(BM_TrapFilter)->Args({0, 5})->Args({1, 5})->Args({0, 20})->Args({1, 20})->Args({0, 50})->Args({1, 50});
+
+BENCHMARK_MAIN();
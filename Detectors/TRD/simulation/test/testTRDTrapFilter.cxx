@@ -0,0 +1,93 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testTRDTrapFilter.cxx
+/// \brief This task tests that the batch filter chain of the TrapSimulator is bit-exact with the per-sample filters
+
+#define BOOST_TEST_MODULE Test TRD TrapFilter
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "TRDSimulation/TrapSimulator.h"
+#include "TRDSimulation/TrapConfig.h"
+#include "TRDSimulation/TrapConfigHandler.h"
+
+#include <random>
+
+namespace o2
+{
+namespace trd
+{
+
+// gives access to the full precision filtered data and the filter registers
+class TrapSimulatorInspector : public TrapSimulator
+{
+ public:
+  int getADCF(int adc, int timebin) const { return mADCF[adc * mNTimeBin + timebin]; }
+  const FilterReg& getFilterReg(int adc) const { return mInternalFilterRegisters[adc]; }
+};
+
+/// \brief Compare the batch filter with the individual filters for random data and all bypass settings
+BOOST_AUTO_TEST_CASE(TRDTrapFilterBatch_test)
+{
+  const int det = 0, rob = 0, mcm = 5;
+  TrapConfig trapConfig("testconfig");
+  TrapConfigHandler cfgHandler(&trapConfig);
+  cfgHandler.init();
+  cfgHandler.loadConfig();
+  trapConfig.setTrapReg(TrapConfig::kFPTC, 1, det);
+  trapConfig.setTrapReg(TrapConfig::kFGTA, 20, det);
+  trapConfig.setTrapReg(TrapConfig::kFGTB, 600, det);
+
+  std::mt19937 gen(4321);
+  std::uniform_int_distribution<int> noise(0, 20);
+  std::uniform_int_distribution<int> signal(0, 1023);
+  std::bernoulli_distribution occupied(0.3);
+
+  for (int bypass = 0; bypass < 8; ++bypass) {
+    trapConfig.setTrapReg(TrapConfig::kFPBY, bypass & 0x1, det);
+    trapConfig.setTrapReg(TrapConfig::kFGBY, (bypass >> 1) & 0x1, det);
+    trapConfig.setTrapReg(TrapConfig::kFTBY, (bypass >> 2) & 0x1, det);
+    for (int event = 0; event < 20; ++event) {
+      TrapSimulatorInspector scalar, batch;
+      scalar.init(&trapConfig, det, rob, mcm);
+      batch.init(&trapConfig, det, rob, mcm);
+      for (int adc = 0; adc < FeeParam::getNadcMcm(); ++adc) {
+        if (!occupied(gen)) {
+          continue;
+        }
+        ArrayADC data;
+        for (auto& value : data) {
+          value = 10 + noise(gen) + (occupied(gen) ? signal(gen) : 0);
+        }
+        scalar.setData(adc, data);
+        batch.setData(adc, data);
+      }
+      TrapSimulator::setUseBatchFilter(false);
+      scalar.filter();
+      TrapSimulator::setUseBatchFilter(true);
+      batch.filter();
+      for (int adc = 0; adc < FeeParam::getNadcMcm(); ++adc) {
+        for (int timebin = 0; timebin < scalar.getNumberOfTimeBins(); ++timebin) {
+          BOOST_REQUIRE_EQUAL(scalar.getADCF(adc, timebin), batch.getADCF(adc, timebin));
+        }
+        BOOST_CHECK_EQUAL(scalar.getFilterReg(adc).mPedAcc, batch.getFilterReg(adc).mPedAcc);
+        BOOST_CHECK_EQUAL(scalar.getFilterReg(adc).mGainCounterA, batch.getFilterReg(adc).mGainCounterA);
+        BOOST_CHECK_EQUAL(scalar.getFilterReg(adc).mGainCounterB, batch.getFilterReg(adc).mGainCounterB);
+        BOOST_CHECK_EQUAL(scalar.getFilterReg(adc).mTailAmplLong, batch.getFilterReg(adc).mTailAmplLong);
+        BOOST_CHECK_EQUAL(scalar.getFilterReg(adc).mTailAmplShort, batch.getFilterReg(adc).mTailAmplShort);
+      }
+    }
+  }
+  TrapSimulator::setUseBatchFilter(false);
+}
+
+} // namespace trd
+} // namespace o2
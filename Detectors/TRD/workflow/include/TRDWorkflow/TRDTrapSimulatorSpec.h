@@ -13,11 +13,13 @@
 
 #include <vector>
 #include <array>
+#include <gsl/span>
 
 #include "Framework/DataProcessorSpec.h"
 #include "Framework/Task.h"
 #include "TRDBase/FeeParam.h"
 #include "TRDBase/Tracklet.h"
+#include "TRDBase/Digit.h"
 #include "TRDSimulation/TrapSimulator.h"
 
 #include "TRDSimulation/TrapConfig.h"
@@ -39,10 +41,18 @@ class TRDDPLTrapSimulatorTask : public framework::Task
   void init(o2::framework::InitContext& ic) override;
   void run(o2::framework::ProcessingContext& pc) override;
 
+  // set the trap config and the number of threads (0 : padrow loop, <0 : all available), done by init
+  void configure(TrapConfig* trapConfig, int nThreads);
+  // run the trap simulation with the padrow loop or the MCM parallel mode, both give the same tracklets
+  void process(gsl::span<const o2::trd::Digit> digits, std::vector<Tracklet>& tracklets);
+
  private:
   std::array<TrapSimulator, 8> mTrapSimulator; //the 8 trap simulators for a given padrow.
-  FeeParam* mfeeparam;
-  TrapConfig* mTrapConfig;
+  std::vector<TrapSimulator> mTrapSimulatorPool; // one trap simulator per thread for the MCM parallel mode
+  int mNThreads{0};                              // number of threads for the MCM parallel mode, 0 uses the padrow loop
+  int mDrawIndex{0};                             // index of the next drawn MCM
+  FeeParam* mfeeparam{nullptr};
+  TrapConfig* mTrapConfig{nullptr};
   std::unique_ptr<TRDGeometry> mGeo;
   //  std::unique_ptr<TrapConfigHandler> mTrapConfigHandler;
   bool mDriveFromConfig{false};     // option to disable using the trapconfig to drive the simulation
@@ -54,6 +64,12 @@ class TRDDPLTrapSimulatorTask : public framework::Task
   std::string mTrapConfigBaseName = "TRD_test/TrapConfig/";
   TrapConfig* getTrapConfig();
   void loadTrapConfig();
+  // sort the digits by pad row and run the 8 trap simulators of each pad row
+  void processPadRows(std::vector<o2::trd::Digit>& digits, std::vector<Tracklet>& tracklets);
+  void runPadRow(std::vector<Tracklet>& tracklets);
+  // run the trap simulation independently for each MCM with data, the digits are not copied but referenced by index.
+  // the tracklets are added in the order of (time stamp, detector, pad row, MCM column), independent of the number of threads
+  void processMCMs(gsl::span<const o2::trd::Digit> digits, std::vector<Tracklet>& tracklets);
 };
 
 o2::framework::DataProcessorSpec getTRDTrapSimulatorSpec();
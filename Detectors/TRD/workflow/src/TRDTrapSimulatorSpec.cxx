@@ -42,6 +42,10 @@
 #include "TRDSimulation/TrapSimulator.h"
 #include "DataFormatsTRD/TriggerRecord.h"
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 using namespace o2::framework;
 
@@ -131,6 +135,26 @@ bool DigitSortComparatorPadRow(o2::trd::Digit const& a, o2::trd::Digit const& b)
   return 0;
 }
 
+int getMCMChannels(int pad, std::array<int, 2>& columns, std::array<int, 2>& adcs)
+{
+  // MCM columns (0..7 along the pad row) and ADC channels a pad is connected to: the MCM it belongs to and,
+  // for the shared pads at the MCM borders, the neighbouring one. This is the inverse of FeeParam::getPadColFromADC(),
+  // the first 2 pads of a MCM are also read by the ADC 1 and 0 of the preceding one, the last one by the ADC 20 of the next one.
+  constexpr int NMCMColumns = 8;
+  int nchannels = 0;
+  int ownColumn = pad / FeeParam::getNcolMcm();
+  for (int column = ownColumn - 1; column <= ownColumn + 1; ++column) {
+    int adc = column * FeeParam::getNcolMcm() + FeeParam::getNcolMcm() + 1 - pad;
+    if (column < 0 || column >= NMCMColumns || adc < 0 || adc >= FeeParam::getNadcMcm()) {
+      continue;
+    }
+    columns[nchannels] = column;
+    adcs[nchannels] = adc;
+    nchannels++;
+  }
+  return nchannels;
+}
+
 TrapConfig* TRDDPLTrapSimulatorTask::getTrapConfig()
 {
   // return an existing TRAPconfig or load it from the CCDB
@@ -211,22 +235,45 @@ void TRDDPLTrapSimulatorTask::init(o2::framework::InitContext& ic)
   //               LOG(debug) << "Input data file is : " << ic.options().get<std::string>("simdatasrc");
   //               LOG(info) << "simSm is : " << ic.options().get<int>("simSM");
   LOG(debug1) << "TRD Trap Simulator Device with pid of : " << ::getpid();
-  mfeeparam = FeeParam::instance();
   mPrintTrackletOptions = ic.options().get<int>("printtracklets");
   mDrawTrackletOptions = ic.options().get<int>("drawtracklets");
   mShowTrackletStats = ic.options().get<int>("show-trd-trackletstats");
   mTrapConfigName = ic.options().get<std::string>("trapconfig");
+  TrapSimulator::setUseBatchFilter(ic.options().get<bool>("trapsim-batch-filter"));
   LOG(info) << "Trap Simulator Device initialising with trap config of : " << mTrapConfigName;
+  configure(getTrapConfig(), ic.options().get<int>("trapsim-threads"));
+  if (mNThreads != 0) {
+    LOG(info) << "Trap Simulator running independent MCMs with " << mNThreads << " threads";
+    if (mDrawTrackletOptions != 0) {
+      LOG(warn) << "Drawing of tracklets is not supported in the MCM parallel mode, disabling it";
+      mDrawTrackletOptions = 0;
+    }
+  }
   //  if(mDisableTrapSimulation){
   //  //now get a trapconfig to work with.
   //    LOG(warn) << "You elected to not do a trap chip simulation and hence no trapconfig was saught";
   //  }
   //  else{
-  getTrapConfig();
   LOG(info) << "Trap Simulator Device initialised ... ";
   //  }
 }
 
+void TRDDPLTrapSimulatorTask::configure(TrapConfig* trapConfig, int nThreads)
+{
+  mfeeparam = FeeParam::instance();
+  mTrapConfig = trapConfig;
+  mNThreads = nThreads;
+  if (mNThreads != 0) {
+#ifdef WITH_OPENMP
+    int maxthreads = omp_get_max_threads();
+    mNThreads = mNThreads < 0 ? maxthreads : std::min(maxthreads, mNThreads);
+#else
+    mNThreads = 1;
+#endif
+    mTrapSimulatorPool = std::vector<TrapSimulator>(mNThreads);
+  }
+}
+
 void TRDDPLTrapSimulatorTask::run(o2::framework::ProcessingContext& pc)
 {
   LOG(info) << "TRD Trap Simulator Device running over incoming message ...";
@@ -235,185 +282,199 @@ void TRDDPLTrapSimulatorTask::run(o2::framework::ProcessingContext& pc)
   // the digits are going to be sorted, we therefore need a copy of the vector rather than an object created
   // directly on the input data, the output vector however is created directly inside the message
   // memory thus avoiding copy by snapshot
-  auto digitsinput = pc.inputs().get<std::vector<o2::trd::Digit>>("digitinput");
+  auto digitsinput = pc.inputs().get<gsl::span<o2::trd::Digit>>("digitinput");
   // TODO: not clear yet whether to send the digits because the snapshot method
   // has been commented out below. Rather than using snapshot (thus a copy) on a vector
   // object, this target object should be created directly in the message memory
   //auto& digits = pc.outputs().make<std::vector<o2::trd::Digit>>(Output{"TRD", "DIGITS", 0, Lifetime::Timeframe}, digitsinput.begin(), digitsinput.end());
+  if (mNThreads > 0) {
+    // no copy and no sorting of the digits needed, they are grouped by MCM via an index array
+    auto& tracklets = pc.outputs().make<std::vector<Tracklet>>(Output{"TRD", "TRACKLETS", 0, Lifetime::Timeframe});
+    auto mcmloopstart = std::chrono::high_resolution_clock::now();
+    processMCMs(digitsinput, tracklets);
+    std::chrono::duration<double> mcmlooptime = std::chrono::high_resolution_clock::now() - mcmloopstart;
+    LOG(info) << "Trap simulator found " << tracklets.size() << " tracklets from " << digitsinput.size() << " Digits";
+    if (mShowTrackletStats > 0) {
+      LOG(info) << "MCM loop with " << mNThreads << " threads took : " << mcmlooptime.count()
+                << " (" << digitsinput.size() / mcmlooptime.count() << " Digits/s)";
+    }
+    return;
+  }
   std::vector<o2::trd::Digit> digits(digitsinput.begin(), digitsinput.end());
   //auto mMCLabels = pc.inputs().get<o2::dataformats::MCTruthContainer<o2::trd::MCLabel>*>("labelinput");
   //auto mTriggerRecords = pc.inputs().get<std::vector<o2::trd::TriggerRecord>>("triggerrecords");
 
   LOG(debug) << "Read in Digits with size of : " << digits.size();
 
-  //set up structures to hold the returning tracklets.
-  // TODO: correct naming convention, wrong convention used for local variables
-  std::vector<Tracklet> mMCMTracklets; //vector to store the retrieved tracklets from an mcm
   auto& mMCMTrackletsAccum = pc.outputs().make<std::vector<Tracklet>>(Output{"TRD", "TRACKLETS", 0, Lifetime::Timeframe});
-  mMCMTracklets.reserve(30);
   mMCMTrackletsAccum.reserve(digits.size() / 3); //attempt to a. conserve mem, b. stop a vector resize
 
-  //TODO we can ignore time, and use the triggerrecords as to defined subsets to sort. TriggerRecord has the time in it for all the digits, by creation.
-  //
-  std::chrono::duration<double> sortingtime{0}; ///< full timer
-  auto sortstart = std::chrono::high_resolution_clock::now();
-
-  std::sort(digits.begin(), digits.end(), DigitSortComparator);
-
-  sortingtime = std::chrono::high_resolution_clock::now() - sortstart;
-
-  //TODO Do we care about tracklet order so long as its time stamped.
-  //TODO Dont sort, just build an index array
-  //TODO sort from mTriggerRecords.getFirstEntry() to mTriggerRecords.getFirstEntry()+mTriggerRecords.getNumberOfObjects();
-
-  int olddetector = -1;
-  int oldrow = -1;
-  int oldpad = -1;
-  int loopindex = 0;
-  int counttrackletadditions = 0;
-  int oldsize = 0;
-  double trackletrate;
-  unsigned long oldtrackletcount = 0;
-  //various timers so we can see how long things take
-  std::chrono::duration<double> trapsimaccumulatedtime{0}; ///< full timer
-  std::chrono::duration<double> digitlooptime{0};          ///< full timer
-  std::chrono::duration<double> traplooptime{0};           ///< full timer
-  std::chrono::duration<double> oldelse{0};                ///< full timer
-  std::chrono::duration<double> tracklettime{0};           ///< full timer
-
-  // now to loop over the incoming digits.
   auto digitloopstart = std::chrono::high_resolution_clock::now();
+  processPadRows(digits, mMCMTrackletsAccum);
+  std::chrono::duration<double> digitlooptime = std::chrono::high_resolution_clock::now() - digitloopstart;
+
+  LOG(info) << "Trap simulator found " << mMCMTrackletsAccum.size() << " tracklets from " << digits.size() << " Digits";
+  if (mShowTrackletStats > 0) {
+    LOG(info) << "Trap Simulator done \\o/ ";
+    LOG(info) << "Digit loop took : " << digitlooptime.count();
+  }
+  // Note: do not use snapshot for TRD/DIGITS and TRD/TRACKLETS, we can avoif the copy by allocating
+  // the vectors directly in the message memory, see above
+
+  //  pc.outputs().snapshot(Output{"TRD","TRKLABELS",0,Lifetime::Timeframe},mMCLabels);
+  //pc.outputs().snapshot(Output{"TRD","TRGRRecords",0,Lifetime::Timeframe},mTriggerRecords);
+}
+
+void TRDDPLTrapSimulatorTask::process(gsl::span<const o2::trd::Digit> digits, std::vector<Tracklet>& tracklets)
+{
+  if (mNThreads > 0) {
+    processMCMs(digits, tracklets);
+  } else {
+    std::vector<o2::trd::Digit> sorted(digits.begin(), digits.end());
+    processPadRows(sorted, tracklets);
+  }
+}
+
+void TRDDPLTrapSimulatorTask::processPadRows(std::vector<o2::trd::Digit>& digits, std::vector<Tracklet>& tracklets)
+{
+  // the digits are sorted by (time stamp, detector, pad row, pad), the stable sort keeps the input order of
+  // digits of the same pad. Each pad row is then contiguous and populates the 8 trap simulators of the pad row,
+  // which are run on change of pad row (or time stamp), and at the end for the last pad row.
+  std::stable_sort(digits.begin(), digits.end(), DigitSortComparatorPadRow);
 
+  std::array<int, 2> columns, adcs;
   for (auto digititerator = digits.begin(); digititerator != digits.end(); ++digititerator) {
-    //in here we have an entire padrow which corresponds to 8 TRAPs.
-    //while on a single padrow, populate data structures in the 8 trapsimulator.
-    //on change of padrow
-    //  fireup trapsim, do its thing with each 18 sequence of pads data that already exists inside the class from previous iterations of the loop
-    double digittime = digititerator->getTimeStamp();
-    int pad = digititerator->getPad();
     int row = digititerator->getRow();
     int detector = digititerator->getDetector();
-    int rob = mfeeparam->getROBfromPad(row, pad);
-    int mcm = mfeeparam->getMCMfromPad(row, pad);
-    if (digititerator == digits.begin()) { // first time in loop
-      oldrow = row;
-      olddetector = detector;
+    if (digititerator != digits.begin()) {
+      const auto& previous = *(digititerator - 1);
+      if (previous.getTimeStamp() != digititerator->getTimeStamp() || previous.getDetector() != detector || previous.getRow() != row) {
+        LOG(debug) << "processing of row,mcm"
+                   << " padrow changed from " << previous.getDetector() << "," << previous.getRow() << " to " << detector << "," << row;
+        runPadRow(tracklets);
+      }
     }
-    if (olddetector != detector || oldrow != row) {
-      // we haved gone over the pad row. //TODO ??? do we need to check for change of time as well?
-      //all data is inside the 8 relavent trapsimulators
-      rob = mfeeparam->getROBfromPad(oldrow, oldpad); //
-      LOG(debug) << "processing of row,mcm"
-                 << " padrow changed from " << olddetector << "," << oldrow << " to " << detector << "," << row;
-      //fireup Trapsim.
-      auto traploopstart = std::chrono::high_resolution_clock::now();
-      for (int trapcounter = 0; trapcounter < 8; trapcounter++) {
-        unsigned int isinit = mTrapSimulator[trapcounter].checkInitialized();
-        LOG(debug) << "is init : " << isinit;
-        if (mTrapSimulator[trapcounter].isDataSet()) { //firedtraps & (1<<trapcounter){ /}/mTrapSimulator[trapcounter].checkInitialized()){
-          //this one has been filled with data for the now previous pad row.
-          auto trapsimtimerstart = std::chrono::high_resolution_clock::now();
-
-          mTrapSimulator[trapcounter].filter();
-          mTrapSimulator[trapcounter].tracklet();
-
-          mMCMTracklets = mTrapSimulator[trapcounter].getTrackletArray(); //TODO remove the copy and send the Accumulated array into the Trapsimulator
-
-          LOG(debug) << mMCMTrackletsAccum.size() << " :: " << mMCMTracklets.size() << " count tracklet additions :  " << counttrackletadditions;
-          counttrackletadditions++;
-          mMCMTrackletsAccum.insert(mMCMTrackletsAccum.end(), mMCMTracklets.begin(), mMCMTracklets.end());
-          trapsimaccumulatedtime += std::chrono::high_resolution_clock::now() - trapsimtimerstart;
-          if (mShowTrackletStats > 0) {
-            if (mMCMTrackletsAccum.size() - oldsize > mShowTrackletStats) {
-              LOG(debug) << "TrapSim Accumulated tracklets: " << mMCMTrackletsAccum.size() << " :: " << mMCMTracklets.size();
-              oldsize = mMCMTrackletsAccum.size();
-            }
-          }
-
-          // mTrapSimulator[trapcounter].zeroSupressionMapping();
-
-          if (mDrawTrackletOptions != 0)
-            mTrapSimulator[trapcounter].draw(mDrawTrackletOptions, loopindex);
-          if (mPrintTrackletOptions != 0)
-            mTrapSimulator[trapcounter].print(mPrintTrackletOptions);
-
-          loopindex++;
-          //set this trap sim object to have not data (effectively) reset.
-          mTrapSimulator[trapcounter].unsetData();
-        } else {
-          LOG(debug) << "if statement is init failed [" << trapcounter << "] PROCESSING TRAP !";
-        }
-      } //end of loop over trap chips
-      traplooptime += std::chrono::high_resolution_clock::now() - traploopstart;
-      LOG(debug) << "Row change ... Tracklets so far: " << mMCMTrackletsAccum.size();
-      if (mShowTrackletStats > 0) {
-        if (mMCMTrackletsAccum.size() - oldtrackletcount > mShowTrackletStats) {
-          oldtrackletcount = mMCMTrackletsAccum.size();
-          unsigned long mcmTrackletsize = mMCMTrackletsAccum.size();
-          tracklettime = std::chrono::high_resolution_clock::now() - digitloopstart;
-          trackletrate = mcmTrackletsize / tracklettime.count();
-          LOG(info) << "Getting tracklets at the rate of : " << trackletrate << " Tracklets/s ... Accumulated tracklets : " << mMCMTrackletsAccum.size();
-        }
+    // copy pad time data into where they belong in the TrapSimulators for this pad, including the shared pads
+    int nchannels = getMCMChannels(digititerator->getPad(), columns, adcs);
+    for (int ichannel = 0; ichannel < nchannels; ++ichannel) {
+      auto& trapSimulator = mTrapSimulator[columns[ichannel]];
+      if (!trapSimulator.isDataSet()) {
+        int firstPadOfColumn = columns[ichannel] * FeeParam::getNcolMcm();
+        trapSimulator.init(mTrapConfig, detector, mfeeparam->getROBfromPad(row, firstPadOfColumn), mfeeparam->getMCMfromPad(row, firstPadOfColumn));
       }
-    } //if oldetector!= detector ....
-    //we are still on the same detector and row.
-    //add the digits to the padrow.
-    //copy pad time data into where they belong in the 8 TrapSimulators for this pad.
-    int mcmoffset = -1;
-    int firstrob = mfeeparam->getROBfromPad(row, 5); // 5 is arbitrary, but above the lower shared pads. so will get first rob and mcm
-    int firstmcm = mfeeparam->getMCMfromPad(row, 5); // 5 for same reason
-    int trapindex = pad / 18;
-    //check trap is initialised.
-    if (!mTrapSimulator[trapindex].isDataSet()) {
-      LOG(debug) << "Initialising trapsimulator for triplet (" << detector << "," << rob << ","
-                 << mcm << ") as its not initialized and we need to send it some adc data.";
-      mTrapSimulator[trapindex].init(mTrapConfig, detector, rob, mcm);
+      LOG(debug) << "setting data for simulator : " << columns[ichannel] << " and adc : " << adcs[ichannel];
+      trapSimulator.setData(adcs[ichannel], digititerator->getADC());
     }
-    int adc = 0;
-    adc = 20 - (pad % 18) - 1;
-    LOG(debug) << "setting data for simulator : " << trapindex << " and adc : " << adc;
-    mTrapSimulator[trapindex].setData(adc, digititerator->getADC());
-    // mTrapSimulator[trapindex].printAdcDatHuman(cout);
-
-    // now take care of the case of shared pads (the whole reason for doing this pad row wise).
-
-    if (pad % 18 == 0 || (pad + 1) % 18 == 0) { //case of pad 18 and 19 must be shared to preceding trap chip adc 1 and 0 respectively.
-                                                //check trap is initialised.
+  } // end of loop over digits.
+  runPadRow(tracklets); // the last pad row
+}
 
-      adc = 20 - (pad % 18) - 1;
-      LOG(debug) << "setting data for simulator : " << trapindex - 1 << " and adc : " << adc;
-      mTrapSimulator[trapindex - 1].setData(adc, digititerator->getADC());
+void TRDDPLTrapSimulatorTask::runPadRow(std::vector<Tracklet>& tracklets)
+{
+  // run the trap simulators of the current pad row which received data, and reset them
+  for (int trapcounter = 0; trapcounter < 8; trapcounter++) {
+    auto& trapSimulator = mTrapSimulator[trapcounter];
+    if (!trapSimulator.isDataSet()) {
+      continue;
     }
-    if ((pad - 1) % 18 == 0) { // case of pad 17 must shared to next trap chip as adc 20
-                               //check trap is initialised.
-      adc = 20 - (pad % 18) - 1;
-      LOG(debug) << "setting data for simulator : " << trapindex + 1 << " and adc : " << adc;
-      if (trapindex + 1 != 8) {
-        mTrapSimulator[trapindex + 1].setData(adc, digititerator->getADC());
-      }
-      //else { // this is not an issue as its a shared pad, simply the sharing to the next trap chip is meaningless.
-      //}
+    trapSimulator.filter();
+    trapSimulator.tracklet();
+    trapSimulator.getTracklets(tracklets);
+    if (mDrawTrackletOptions != 0) {
+      trapSimulator.draw(mDrawTrackletOptions, mDrawIndex++);
     }
+    if (mPrintTrackletOptions != 0) {
+      trapSimulator.print(mPrintTrackletOptions);
+    }
+    //set this trap sim object to have not data (effectively) reset.
+    trapSimulator.unsetData();
+  }
+  LOG(debug) << "Row change ... Tracklets so far: " << tracklets.size();
+}
 
-    olddetector = detector;
-    oldrow = row;
-    oldpad = pad;
-  } // end of loop over digits.
-
-  LOG(info) << "Trap simulator found " << mMCMTrackletsAccum.size() << " tracklets from " << digits.size() << " Digits";
-  if (mShowTrackletStats > 0) {
-    digitlooptime = std::chrono::high_resolution_clock::now() - digitloopstart;
-    LOG(info) << "Trap Simulator done \\o/ ";
-    LOG(info) << "Sorting took " << sortingtime.count();
-    LOG(info) << "Digit loop took : " << digitlooptime.count();
-    LOG(info) << "Trapsim took : " << trapsimaccumulatedtime.count();
-    LOG(info) << "Traploop took : " << traplooptime.count();
+void TRDDPLTrapSimulatorTask::processMCMs(gsl::span<const o2::trd::Digit> digits, std::vector<Tracklet>& tracklets)
+{
+  // each digit feeds the ADC channel of the MCM it is connected to and, for the shared pads at the MCM borders,
+  // one channel of the neighbouring MCM. The ADC channel follows from the inverse of FeeParam::getPadColFromADC()
+  constexpr int NMCMColumns = 8;                                    // MCM columns per pad row
+  const int NMCMPerDetector = NMCMColumns * FeeParam::getNrowC1(); // MCM slots per detector, (row, MCM column)
+  struct MCMInput {
+    unsigned int digit; // index of the digit in the input
+    int mcmKey;         // (detector, pad row, MCM column) packed, defines the processing order within one time stamp
+    int adc;            // ADC channel of the MCM
+  };
+  std::vector<MCMInput> inputs;
+  inputs.reserve(digits.size() + digits.size() / 8);
+  std::array<int, 2> columns, adcs;
+  for (unsigned int idigit = 0; idigit < digits.size(); ++idigit) {
+    const auto& digit = digits[idigit];
+    int nchannels = getMCMChannels(digit.getPad(), columns, adcs);
+    for (int ichannel = 0; ichannel < nchannels; ++ichannel) {
+      inputs.push_back({idigit, digit.getDetector() * NMCMPerDetector + digit.getRow() * NMCMColumns + columns[ichannel], adcs[ichannel]});
+    }
+  }
+  std::sort(inputs.begin(), inputs.end(), [digits](const MCMInput& a, const MCMInput& b) {
+    double timea = digits[a.digit].getTimeStamp();
+    double timeb = digits[b.digit].getTimeStamp();
+    if (timea != timeb) {
+      return timea < timeb;
+    }
+    if (a.mcmKey != b.mcmKey) {
+      return a.mcmKey < b.mcmKey;
+    }
+    // digits of the same pad are set in the input order, as in the padrow loop
+    return a.adc != b.adc ? a.adc < b.adc : a.digit < b.digit;
+  });
+
+  // the first input of each MCM
+  std::vector<unsigned int> mcmStart;
+  for (unsigned int i = 0; i < inputs.size(); ++i) {
+    if (i == 0 || inputs[i].mcmKey != inputs[i - 1].mcmKey || digits[inputs[i].digit].getTimeStamp() != digits[inputs[i - 1].digit].getTimeStamp()) {
+      mcmStart.push_back(i);
+    }
+  }
+  int nMCMs = mcmStart.size();
+  mcmStart.push_back(inputs.size());
+  std::vector<std::vector<Tracklet>> mcmTracklets(nMCMs);
+
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(mNThreads)
+#endif
+  for (int imcm = 0; imcm < nMCMs; ++imcm) {
+#ifdef WITH_OPENMP
+    const int threadid = omp_get_thread_num();
+#else
+    const int threadid = 0;
+#endif
+    auto& trapSimulator = mTrapSimulatorPool[threadid];
+    const auto& first = inputs[mcmStart[imcm]];
+    int detector = first.mcmKey / NMCMPerDetector;
+    int row = (first.mcmKey % NMCMPerDetector) / NMCMColumns;
+    int firstPadOfColumn = (first.mcmKey % NMCMColumns) * FeeParam::getNcolMcm();
+    trapSimulator.init(mTrapConfig, detector, mfeeparam->getROBfromPad(row, firstPadOfColumn), mfeeparam->getMCMfromPad(row, firstPadOfColumn));
+    for (unsigned int i = mcmStart[imcm]; i < mcmStart[imcm + 1]; ++i) {
+      trapSimulator.setData(inputs[i].adc, digits[inputs[i].digit].getADC());
+    }
+    trapSimulator.filter();
+    trapSimulator.tracklet();
+    trapSimulator.getTracklets(mcmTracklets[imcm]);
+    if (mPrintTrackletOptions != 0) {
+#ifdef WITH_OPENMP
+#pragma omp critical(TRDTrapSimulatorPrint)
+#endif
+      trapSimulator.print(mPrintTrackletOptions);
+    }
+    trapSimulator.unsetData();
   }
-  // Note: do not use snapshot for TRD/DIGITS and TRD/TRACKLETS, we can avoif the copy by allocating
-  // the vectors directly in the message memory, see above
 
-  //  pc.outputs().snapshot(Output{"TRD","TRKLABELS",0,Lifetime::Timeframe},mMCLabels);
-  //pc.outputs().snapshot(Output{"TRD","TRGRRecords",0,Lifetime::Timeframe},mTriggerRecords);
+  size_t nTracklets = tracklets.size();
+  for (const auto& mcm : mcmTracklets) {
+    nTracklets += mcm.size();
+  }
+  tracklets.reserve(nTracklets);
+  for (const auto& mcm : mcmTracklets) {
+    tracklets.insert(tracklets.end(), mcm.begin(), mcm.end());
+  }
 }
 
 o2::framework::DataProcessorSpec getTRDTrapSimulatorSpec()
@@ -426,6 +487,8 @@ o2::framework::DataProcessorSpec getTRDTrapSimulatorSpec()
                            Options{
                              {"show-trd-trackletstats", VariantType::Int, 25000, {"Display the accumulated size and capacity at number of track intervals"}},
                              {"trapconfig", VariantType::String, "default", {"Name of the trap config from the CCDB"}},
+                             {"trapsim-threads", VariantType::Int, 0, {"Number of threads to simulate independent MCMs in parallel, 0 : serial padrow loop, <0 : all available"}},
+                             {"trapsim-batch-filter", VariantType::Bool, false, {"Run the digital filters on all channels of an MCM per time bin instead of per sample"}},
                              {"drawtracklets", VariantType::Int, 0, {"Bitpattern of input to TrapSimulator Draw method (be very careful) one file per track"}},
                              {"printtracklets", VariantType::Int, 0, {"Bitpattern of input to TrapSimulator print method"}}}};
 };
@@ -0,0 +1,94 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testTRDTrapSimulatorSpec.cxx
+/// \brief This task tests that the MCM parallel mode of the trap simulator device gives the same tracklets as the padrow loop
+
+#define BOOST_TEST_MODULE Test TRD TrapSimulatorSpec
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "TRDWorkflow/TRDTrapSimulatorSpec.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+
+namespace o2
+{
+namespace trd
+{
+
+// random noise digits with clusters spread over neighbouring pads, which makes use of the shared pads
+std::vector<Digit> generateDigits(int nClusters, unsigned int seed)
+{
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> detector(0, 5), row(0, FeeParam::getNrowC1() - 1), pad(0, FeeParam::getNcol() - 1);
+  std::uniform_int_distribution<int> noise(0, 5), charge(50, 400), event(0, 2);
+  std::vector<Digit> digits;
+  for (int icluster = 0; icluster < nClusters; ++icluster) {
+    int det = detector(gen), padrow = row(gen), centre = pad(gen);
+    double time = event(gen) * 100.;
+    int q = charge(gen);
+    for (int ipad = centre - 2; ipad <= centre + 2; ++ipad) {
+      if (ipad < 0 || ipad >= FeeParam::getNcol()) {
+        continue;
+      }
+      ArrayADC adc;
+      for (int tb = 0; tb < (int)adc.size(); ++tb) {
+        adc[tb] = 10 + noise(gen) + ((tb > 3 && tb < 25) ? q / (1 + std::abs(ipad - centre) * 2) : 0);
+      }
+      digits.emplace_back(det, padrow, ipad, adc, time);
+    }
+  }
+  // the edge pads of the pad row, which have no neighbouring MCM on one side
+  for (int ipad : {0, 1, 17, 18, 126, 142, 143}) {
+    ArrayADC adc;
+    adc.fill(200);
+    digits.emplace_back(0, 3, ipad, adc, 0.);
+  }
+  std::shuffle(digits.begin(), digits.end(), gen);
+  return digits;
+}
+
+BOOST_AUTO_TEST_CASE(TRDTrapSimulatorParallel_test)
+{
+  TrapConfig trapConfig("testconfig");
+  TrapConfigHandler cfgHandler(&trapConfig);
+  cfgHandler.init();
+  cfgHandler.loadConfig();
+
+  auto digits = generateDigits(300, 1234);
+
+  TRDDPLTrapSimulatorTask serial;
+  serial.configure(&trapConfig, 0);
+  std::vector<Tracklet> serialTracklets;
+  serial.process(digits, serialTracklets);
+  BOOST_CHECK(!serialTracklets.empty());
+
+  for (int nThreads : {1, 4}) {
+    TRDDPLTrapSimulatorTask parallel;
+    parallel.configure(&trapConfig, nThreads);
+    std::vector<Tracklet> parallelTracklets;
+    parallel.process(digits, parallelTracklets);
+    BOOST_REQUIRE_EQUAL(serialTracklets.size(), parallelTracklets.size());
+    for (size_t i = 0; i < serialTracklets.size(); ++i) {
+      BOOST_CHECK_EQUAL(serialTracklets[i].getHCId(), parallelTracklets[i].getHCId());
+      BOOST_CHECK_EQUAL(serialTracklets[i].getROB(), parallelTracklets[i].getROB());
+      BOOST_CHECK_EQUAL(serialTracklets[i].getMCM(), parallelTracklets[i].getMCM());
+      BOOST_CHECK_EQUAL(serialTracklets[i].getTrackletWord(), parallelTracklets[i].getTrackletWord());
+      BOOST_CHECK_EQUAL(serialTracklets[i].getQ0(), parallelTracklets[i].getQ0());
+      BOOST_CHECK_EQUAL(serialTracklets[i].getQ1(), parallelTracklets[i].getQ1());
+    }
+  }
+}
+
+} // namespace trd
+} // namespace o2
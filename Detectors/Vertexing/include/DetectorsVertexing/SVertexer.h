@@ -0,0 +1,131 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file SVertexer.h
+/// \brief Secondary vertex finder running the DCAFitterN over the tracks of a TF
+
+#ifndef ALICEO2_SVERTEXER_H
+#define ALICEO2_SVERTEXER_H
+
+#include "DetectorsVertexing/DCAFitterN.h"
+#include "ReconstructionDataFormats/TrackTPCITS.h"
+#include "ReconstructionDataFormats/DecayVertex.h"
+#include <gsl/span>
+#include <array>
+#include <vector>
+
+namespace o2
+{
+namespace vertexing
+{
+
+struct SVertexerParams;
+
+// Finds V0 candidates among the pairs of opposite sign tracks of a TF, and optionally
+// 3-prong vertices made of a V0 candidate and an additional track.
+// To avoid trying all pairs, the tracks of each charge are binned in phi and tgl
+// (the bin widths being the max allowed differences of the prongs) and sorted in each bin
+// by the lower edge of their time bracket: only the tracks of neighbouring bins with
+// overlapping time brackets are fitted together.
+// The positive tracks are shared among several threads, each having its own fitters,
+// the candidates being merged in the same order whatever the number of threads.
+class SVertexer
+{
+ public:
+  using TrackTPCITS = o2::dataformats::TrackTPCITS;
+  using V0 = o2::dataformats::V0;
+  using DecayVertex3Prong = o2::dataformats::DecayVertex3Prong;
+
+  ///< counters of the pairs (or triplets) considered at each step of the selection
+  struct Statistics {
+    size_t nPairsAll = 0;       ///< pairs of opposite sign tracks
+    size_t nPairsTime = 0;      ///< pairs in neighbouring bins with overlapping time brackets
+    size_t nPairsAngular = 0;   ///< pairs passing the cuts on the phi and tgl differences, which are fitted
+    size_t nPairsFitted = 0;    ///< pairs with a converged fit
+    size_t nV0s = 0;            ///< V0 candidates
+    size_t nTriplets = 0;       ///< V0 + track combinations fitted
+    size_t nTripletsFitted = 0; ///< V0 + track combinations with a converged fit
+    size_t n3Prongs = 0;        ///< 3-prong candidates
+
+    void add(const Statistics& other);
+    void print() const;
+  };
+
+  SVertexer() = default;
+  ~SVertexer() = default;
+
+  ///< take the cuts from the SVertexerParams
+  void init();
+
+  ///< find the V0s (and 3-prong vertices, if requested) among the provided tracks
+  void process(const gsl::span<const TrackTPCITS> tracks, std::vector<V0>& v0s, std::vector<DecayVertex3Prong>& vertices3Prong);
+
+  void setBz(float bz) { mBz = bz; }
+  float getBz() const { return mBz; }
+
+  ///< set number of threads (<1: rely on openMP default)
+  void setNThreads(int n) { mNThreads = n; }
+  int getNThreads() const { return mNThreads; }
+
+  ///< statistics of the last processed TF
+  const Statistics& getStatistics() const { return mStat; }
+
+ private:
+  ///< time bracket and direction of the track
+  struct TrackAux {
+    float tMin = 0.f;
+    float tMax = 0.f;
+    float phi = 0.f;
+    float tgl = 0.f;
+    int cell = 0;
+  };
+
+  ///< tracks of the same charge, sorted by cell and by the lower edge of their time bracket
+  struct CellTable {
+    std::vector<int> trackIDs;
+    std::vector<int> cellStart;      // first entry of each cell in trackIDs (+1 extra entry for the end)
+    std::vector<float> cellMaxWidth; // max width of the time brackets of the tracks of each cell
+  };
+
+  ///< per thread fitters
+  struct ThreadData {
+    DCAFitter2 fitter2;
+    DCAFitter3 fitter3;
+  };
+
+  int getCell(float phi, float tgl) const;
+  int getNeighbourCells(int cell, std::array<int, 9>& cells) const;
+  void buildCellTable(const gsl::span<const TrackTPCITS> tracks, bool positive, CellTable& table);
+  void findV0s(const gsl::span<const TrackTPCITS> tracks, int first, int last, ThreadData& thread, std::vector<V0>& v0s, Statistics& stat) const;
+  void find3Prongs(const gsl::span<const TrackTPCITS> tracks, const gsl::span<const V0> v0s, ThreadData& thread, std::vector<DecayVertex3Prong>& vertices3Prong, Statistics& stat) const;
+  int getThreadsNumber() const;
+  void configureFitters(int nThreads);
+
+  float mBz = 0.f;
+  int mNThreads = 1;
+  const SVertexerParams* mParams = nullptr;
+  float mMinR2 = 0.f; ///< squared min transverse radius of the decay vertex
+  float mMaxR2 = 0.f; ///< squared max transverse radius of the decay vertex
+
+  int mNPhiBins = 1;
+  int mNTglBins = 1;
+  float mPhiBinWInv = 0.f;
+  float mTglBinWInv = 0.f;
+
+  std::vector<TrackAux> mTrackAux;      // aux info of each input track
+  std::array<CellTable, 2> mCellTables; // positive and negative tracks
+  std::vector<ThreadData> mThreads;
+  Statistics mStat;
+};
+
+} // namespace vertexing
+} // namespace o2
+
+#endif
@@ -0,0 +1,55 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file SVertexerParams.h
+/// \brief Configurable params for the secondary vertex finder
+
+#ifndef ALICEO2_SVERTEXER_PARAMS_H
+#define ALICEO2_SVERTEXER_PARAMS_H
+
+#include "CommonUtils/ConfigurableParam.h"
+#include "CommonUtils/ConfigurableParamHelper.h"
+
+namespace o2
+{
+namespace vertexing
+{
+
+// These are configurable params for the secondary vertex finder
+struct SVertexerParams : public o2::conf::ConfigurableParamHelper<SVertexerParams> {
+  // pairing of the tracks
+  float nSigmaTime = 4.f; ///< half-width of the track time brackets, in sigmas of the track time
+  float maxDPhi = 0.6f;   ///< max difference in phi of the prongs directions (also defines the phi binning)
+  float maxDTgl = 0.6f;   ///< max difference in tgl of the prongs (also defines the tgl binning)
+  float maxTgl = 2.f;     ///< tracks with larger |tgl| go to the edge tgl bins
+
+  // vertex fit
+  bool useAbsDCA = true;        ///< minimize the absolute DCA instead of the weighted one
+  float maxDZIni = 5.f;         ///< max Z distance of the prongs at the initial seed
+  float maxChi2 = 2.f;          ///< max chi2 (or sum of squared DCAs) per prong at the PCA
+  float minParamChange = 1e-3;  ///< stop iterations if max correction is below this value
+  float minRelChi2Change = 0.9; ///< stop iterations if chi2 improves by less than this factor
+
+  // selection of the candidates
+  float minRDecay = 0.5f;   ///< min transverse radius of the decay vertex
+  float maxRDecay = 180.f;  ///< max transverse radius of the decay vertex
+  float minCosPAV0 = 0.99f; ///< min cosine of the V0 pointing angle wrt the nominal interaction point
+
+  // 3-prong vertices seeded by the V0 candidates
+  bool find3Prongs = false;     ///< add a 3rd track to the V0 candidates and fit them with the 3-prong fitter
+  float minCosPA3Prong = 0.99f; ///< min cosine of the 3-prong pointing angle wrt the nominal interaction point
+
+  O2ParamDef(SVertexerParams, "svertexer");
+};
+
+} // namespace vertexing
+} // namespace o2
+
+#endif
@@ -0,0 +1,388 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file SVertexer.cxx
+/// \brief Secondary vertex finder running the DCAFitterN over the tracks of a TF
+
+#include "DetectorsVertexing/SVertexer.h"
+#include "DetectorsVertexing/SVertexerParams.h"
+#include "CommonConstants/MathConstants.h"
+#include "MathUtils/Utils.h"
+#include "FairLogger.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+using namespace o2::vertexing;
+
+namespace
+{
+///< cosine of the angle between the momentum and the position wrt the nominal interaction point
+float getCosPA(const std::array<float, 3>& xyz, const std::array<float, 3>& pxyz)
+{
+  float r2 = xyz[0] * xyz[0] + xyz[1] * xyz[1] + xyz[2] * xyz[2];
+  float p2 = pxyz[0] * pxyz[0] + pxyz[1] * pxyz[1] + pxyz[2] * pxyz[2];
+  if (r2 <= 0.f || p2 <= 0.f) {
+    return -1.f;
+  }
+  return (xyz[0] * pxyz[0] + xyz[1] * pxyz[1] + xyz[2] * pxyz[2]) / std::sqrt(r2 * p2);
+}
+
+///< absolute difference of 2 angles in [0, 2pi)
+float getDeltaPhi(float phi0, float phi1)
+{
+  float dphi = std::abs(phi0 - phi1);
+  return dphi > o2::constants::math::PI ? o2::constants::math::TwoPI - dphi : dphi;
+}
+} // namespace
+
+//__________________________________________________________________
+void SVertexer::Statistics::add(const Statistics& other)
+{
+  nPairsAll += other.nPairsAll;
+  nPairsTime += other.nPairsTime;
+  nPairsAngular += other.nPairsAngular;
+  nPairsFitted += other.nPairsFitted;
+  nV0s += other.nV0s;
+  nTriplets += other.nTriplets;
+  nTripletsFitted += other.nTripletsFitted;
+  n3Prongs += other.n3Prongs;
+}
+
+//__________________________________________________________________
+void SVertexer::Statistics::print() const
+{
+  auto percent = [](size_t n, size_t tot) { return tot ? 100. * n / tot : 0.; };
+  LOG(INFO) << "SVertexer: " << nPairsAll << " opposite sign pairs, " << nPairsTime << " (" << percent(nPairsTime, nPairsAll)
+            << "%) in compatible bins and time brackets, " << nPairsAngular << " (" << percent(nPairsAngular, nPairsAll)
+            << "%) fitted after the angular cuts, " << nPairsFitted << " converged, " << nV0s << " V0 candidates";
+  if (nTriplets) {
+    LOG(INFO) << "SVertexer: " << nTriplets << " V0 + track combinations fitted, " << nTripletsFitted << " converged, "
+              << n3Prongs << " 3-prong candidates";
+  }
+}
+
+//__________________________________________________________________
+void SVertexer::init()
+{
+  mParams = &SVertexerParams::Instance();
+  mMinR2 = mParams->minRDecay * mParams->minRDecay;
+  mMaxR2 = mParams->maxRDecay * mParams->maxRDecay;
+
+  // the bins are at least as wide as the max allowed differences of the prongs,
+  // so that the compatible tracks are always in the neighbouring bins
+  mNPhiBins = std::max(1, int(o2::constants::math::TwoPI / mParams->maxDPhi));
+  mPhiBinWInv = mNPhiBins / o2::constants::math::TwoPI;
+  mNTglBins = std::max(1, int(2.f * mParams->maxTgl / mParams->maxDTgl));
+  mTglBinWInv = mNTglBins / (2.f * mParams->maxTgl);
+  LOG(INFO) << "SVertexer: tracks binned in " << mNPhiBins << " phi x " << mNTglBins << " tgl bins";
+}
+
+//__________________________________________________________________
+int SVertexer::getThreadsNumber() const
+{
+  int nThreads = mNThreads;
+#ifdef WITH_OPENMP
+  if (nThreads < 1) {
+    nThreads = omp_get_max_threads();
+  }
+#else
+  nThreads = 1;
+#endif
+  return std::max(1, nThreads);
+}
+
+//__________________________________________________________________
+void SVertexer::configureFitters(int nThreads)
+{
+  if (int(mThreads.size()) < nThreads) {
+    mThreads.resize(nThreads);
+  }
+  auto configure = [this](auto& fitter) {
+    fitter.setBz(mBz);
+    fitter.setUseAbsDCA(mParams->useAbsDCA);
+    fitter.setPropagateToPCA(true); // the momenta of the candidates are taken at the PCA
+    fitter.setMaxR(mParams->maxRDecay);
+    fitter.setMaxDZIni(mParams->maxDZIni);
+    fitter.setMaxChi2(mParams->maxChi2);
+    fitter.setMinParamChange(mParams->minParamChange);
+    fitter.setMinRelChi2Change(mParams->minRelChi2Change);
+  };
+  for (auto& thread : mThreads) {
+    configure(thread.fitter2);
+    configure(thread.fitter3);
+  }
+}
+
+//__________________________________________________________________
+int SVertexer::getCell(float phi, float tgl) const
+{
+  // phi must be in [0, 2pi), tracks with |tgl| > maxTgl go to the edge bins
+  int iphi = std::min(mNPhiBins - 1, std::max(0, int(phi * mPhiBinWInv)));
+  int itgl = std::min(mNTglBins - 1, std::max(0, int((tgl + mParams->maxTgl) * mTglBinWInv)));
+  return iphi * mNTglBins + itgl;
+}
+
+//__________________________________________________________________
+int SVertexer::getNeighbourCells(int cell, std::array<int, 9>& cells) const
+{
+  // fill the cell itself and its neighbours (phi being periodic), return their number
+  int iphi = cell / mNTglBins, itgl = cell % mNTglBins, n = 0;
+  int dphiMin = mNPhiBins > 2 ? -1 : 0, dphiMax = mNPhiBins > 1 ? 1 : 0;
+  for (int dphi = dphiMin; dphi <= dphiMax; dphi++) {
+    int jphi = (iphi + dphi + mNPhiBins) % mNPhiBins;
+    for (int jtgl = std::max(0, itgl - 1); jtgl <= std::min(mNTglBins - 1, itgl + 1); jtgl++) {
+      cells[n++] = jphi * mNTglBins + jtgl;
+    }
+  }
+  return n;
+}
+
+//__________________________________________________________________
+void SVertexer::buildCellTable(const gsl::span<const TrackTPCITS> tracks, bool positive, CellTable& table)
+{
+  int nCells = mNPhiBins * mNTglBins;
+  table.trackIDs.clear();
+  table.cellStart.assign(nCells + 1, 0);
+  table.cellMaxWidth.assign(nCells, 0.f);
+  for (int i = 0; i < int(tracks.size()); i++) {
+    if ((tracks[i].getSign() > 0) != positive) {
+      continue;
+    }
+    const auto& aux = mTrackAux[i];
+    table.trackIDs.push_back(i);
+    table.cellStart[aux.cell + 1]++;
+    table.cellMaxWidth[aux.cell] = std::max(table.cellMaxWidth[aux.cell], aux.tMax - aux.tMin);
+  }
+  for (int ic = 0; ic < nCells; ic++) {
+    table.cellStart[ic + 1] += table.cellStart[ic];
+  }
+  std::sort(table.trackIDs.begin(), table.trackIDs.end(), [this](int a, int b) {
+    const auto &auxA = mTrackAux[a], &auxB = mTrackAux[b];
+    if (auxA.cell != auxB.cell) {
+      return auxA.cell < auxB.cell;
+    }
+    return auxA.tMin < auxB.tMin || (auxA.tMin == auxB.tMin && a < b);
+  });
+}
+
+//__________________________________________________________________
+void SVertexer::process(const gsl::span<const TrackTPCITS> tracks, std::vector<V0>& v0s, std::vector<DecayVertex3Prong>& vertices3Prong)
+{
+  if (!mParams) {
+    LOG(FATAL) << "init() was not done yet";
+  }
+  v0s.clear();
+  vertices3Prong.clear();
+  mStat = Statistics();
+
+  mTrackAux.resize(tracks.size());
+  for (int i = 0; i < int(tracks.size()); i++) {
+    const auto& trc = tracks[i];
+    auto& aux = mTrackAux[i];
+    float dt = mParams->nSigmaTime * trc.getTimeMUS().getTimeStampError();
+    aux.tMin = trc.getTimeMUS().getTimeStamp() - dt;
+    aux.tMax = trc.getTimeMUS().getTimeStamp() + dt;
+    aux.phi = trc.getPhi();
+    o2::utils::BringTo02Pi(aux.phi);
+    aux.tgl = trc.getTgl();
+    aux.cell = getCell(aux.phi, aux.tgl);
+  }
+  buildCellTable(tracks, true, mCellTables[0]);
+  buildCellTable(tracks, false, mCellTables[1]);
+  int nPos = mCellTables[0].trackIDs.size();
+  mStat.nPairsAll = size_t(nPos) * mCellTables[1].trackIDs.size();
+
+  int nThreads = getThreadsNumber();
+  configureFitters(nThreads);
+
+  // the positive tracks (and then the V0s) are split in contiguous chunks whose candidates
+  // are concatenated in order, so that the output does not depend on the number of threads
+  int nChunks = std::min(nPos, 4 * nThreads);
+  std::vector<std::vector<V0>> chunkV0s(nChunks);
+  std::vector<Statistics> chunkStat(nChunks);
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(nThreads)
+#endif
+  for (int ich = 0; ich < nChunks; ich++) {
+    int ith = 0;
+#ifdef WITH_OPENMP
+    ith = omp_get_thread_num();
+#endif
+    findV0s(tracks, ich * nPos / nChunks, (ich + 1) * nPos / nChunks, mThreads[ith], chunkV0s[ich], chunkStat[ich]);
+  }
+  for (int ich = 0; ich < nChunks; ich++) {
+    v0s.insert(v0s.end(), chunkV0s[ich].begin(), chunkV0s[ich].end());
+    mStat.add(chunkStat[ich]);
+  }
+
+  if (mParams->find3Prongs && !v0s.empty()) {
+    int nV0s = v0s.size();
+    nChunks = std::min(nV0s, 4 * nThreads);
+    std::vector<std::vector<DecayVertex3Prong>> chunk3Prongs(nChunks);
+    chunkStat.assign(nChunks, Statistics());
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(nThreads)
+#endif
+    for (int ich = 0; ich < nChunks; ich++) {
+      int ith = 0;
+#ifdef WITH_OPENMP
+      ith = omp_get_thread_num();
+#endif
+      int first = ich * nV0s / nChunks, last = (ich + 1) * nV0s / nChunks;
+      find3Prongs(tracks, gsl::span<const V0>(&v0s[first], last - first), mThreads[ith], chunk3Prongs[ich], chunkStat[ich]);
+    }
+    for (int ich = 0; ich < nChunks; ich++) {
+      vertices3Prong.insert(vertices3Prong.end(), chunk3Prongs[ich].begin(), chunk3Prongs[ich].end());
+      mStat.add(chunkStat[ich]);
+    }
+  }
+}
+
+//__________________________________________________________________
+void SVertexer::findV0s(const gsl::span<const TrackTPCITS> tracks, int first, int last, ThreadData& thread, std::vector<V0>& v0s, Statistics& stat) const
+{
+  // pair the positive tracks [first, last) of the cell table with the compatible negative tracks
+  const auto& posTable = mCellTables[0];
+  const auto& negTable = mCellTables[1];
+  auto& fitter = thread.fitter2;
+  std::array<int, 9> cells;
+  std::array<float, 3> pPos, pNeg;
+  for (int ip = first; ip < last; ip++) {
+    int idPos = posTable.trackIDs[ip];
+    const auto& auxPos = mTrackAux[idPos];
+    int nCells = getNeighbourCells(auxPos.cell, cells);
+    for (int ic = 0; ic < nCells; ic++) {
+      int cell = cells[ic];
+      auto beg = negTable.trackIDs.begin() + negTable.cellStart[cell], end = negTable.trackIDs.begin() + negTable.cellStart[cell + 1];
+      // the tracks of the cell are sorted in tMin: skip those whose time bracket ends before the one of the positive track
+      float tMinCut = auxPos.tMin - negTable.cellMaxWidth[cell];
+      auto it = std::lower_bound(beg, end, tMinCut, [this](int id, float t) { return mTrackAux[id].tMin < t; });
+      for (; it != end; ++it) {
+        int idNeg = *it;
+        const auto& auxNeg = mTrackAux[idNeg];
+        if (auxNeg.tMin > auxPos.tMax) {
+          break;
+        }
+        if (auxNeg.tMax < auxPos.tMin) {
+          continue;
+        }
+        stat.nPairsTime++;
+        if (getDeltaPhi(auxPos.phi, auxNeg.phi) > mParams->maxDPhi || std::abs(auxPos.tgl - auxNeg.tgl) > mParams->maxDTgl) {
+          continue;
+        }
+        stat.nPairsAngular++;
+        int nCand = 0;
+        try {
+          nCand = fitter.process(static_cast<const o2::track::TrackParCov&>(tracks[idPos]), static_cast<const o2::track::TrackParCov&>(tracks[idNeg]));
+        } catch (const std::runtime_error&) { // invalid track covariance
+          continue;
+        }
+        if (!nCand) {
+          continue;
+        }
+        stat.nPairsFitted++;
+        const auto& pca = fitter.getPCACandidate();
+        float r2 = pca[0] * pca[0] + pca[1] * pca[1];
+        if (r2 < mMinR2 || r2 > mMaxR2) {
+          continue;
+        }
+        fitter.getTrack(0).getPxPyPzGlo(pPos);
+        fitter.getTrack(1).getPxPyPzGlo(pNeg);
+        std::array<float, 3> xyz = {float(pca[0]), float(pca[1]), float(pca[2])};
+        std::array<float, 3> pxyz = {pPos[0] + pNeg[0], pPos[1] + pNeg[1], pPos[2] + pNeg[2]};
+        float cosPA = getCosPA(xyz, pxyz);
+        if (cosPA < mParams->minCosPAV0) {
+          continue;
+        }
+        float time = 0.5f * (tracks[idPos].getTimeMUS().getTimeStamp() + tracks[idNeg].getTimeMUS().getTimeStamp());
+        v0s.emplace_back(xyz, pxyz, std::array<int, 2>{idPos, idNeg}, fitter.getChi2AtPCACandidate(), cosPA, time);
+        stat.nV0s++;
+      }
+    }
+  }
+}
+
+//__________________________________________________________________
+void SVertexer::find3Prongs(const gsl::span<const TrackTPCITS> tracks, const gsl::span<const V0> v0s, ThreadData& thread, std::vector<DecayVertex3Prong>& vertices3Prong, Statistics& stat) const
+{
+  // combine the V0 candidates with the tracks (of any charge) compatible with the V0 direction and time
+  auto& fitter = thread.fitter3;
+  std::array<int, 9> cells;
+  std::array<float, 3> p;
+  for (const auto& v0 : v0s) {
+    int idPos = v0.getProngID(0), idNeg = v0.getProngID(1);
+    float tMin = std::max(mTrackAux[idPos].tMin, mTrackAux[idNeg].tMin);
+    float tMax = std::min(mTrackAux[idPos].tMax, mTrackAux[idNeg].tMax);
+    float pt = std::sqrt(v0.getPx() * v0.getPx() + v0.getPy() * v0.getPy());
+    if (pt <= 0.f) {
+      continue;
+    }
+    float phi = std::atan2(v0.getPy(), v0.getPx()), tgl = v0.getPz() / pt;
+    o2::utils::BringTo02Pi(phi);
+    int nCells = getNeighbourCells(getCell(phi, tgl), cells);
+    for (const auto& table : mCellTables) {
+      for (int ic = 0; ic < nCells; ic++) {
+        int cell = cells[ic];
+        auto beg = table.trackIDs.begin() + table.cellStart[cell], end = table.trackIDs.begin() + table.cellStart[cell + 1];
+        float tMinCut = tMin - table.cellMaxWidth[cell];
+        auto it = std::lower_bound(beg, end, tMinCut, [this](int id, float t) { return mTrackAux[id].tMin < t; });
+        for (; it != end; ++it) {
+          int id = *it;
+          const auto& aux = mTrackAux[id];
+          if (aux.tMin > tMax) {
+            break;
+          }
+          if (aux.tMax < tMin || id == idPos || id == idNeg) {
+            continue;
+          }
+          if (getDeltaPhi(phi, aux.phi) > mParams->maxDPhi || std::abs(tgl - aux.tgl) > mParams->maxDTgl) {
+            continue;
+          }
+          stat.nTriplets++;
+          int nCand = 0;
+          try {
+            nCand = fitter.process(static_cast<const o2::track::TrackParCov&>(tracks[idPos]), static_cast<const o2::track::TrackParCov&>(tracks[idNeg]),
+                                   static_cast<const o2::track::TrackParCov&>(tracks[id]));
+          } catch (const std::runtime_error&) { // invalid track covariance
+            continue;
+          }
+          if (!nCand) {
+            continue;
+          }
+          stat.nTripletsFitted++;
+          const auto& pca = fitter.getPCACandidate();
+          float r2 = pca[0] * pca[0] + pca[1] * pca[1];
+          if (r2 < mMinR2 || r2 > mMaxR2) {
+            continue;
+          }
+          std::array<float, 3> xyz = {float(pca[0]), float(pca[1]), float(pca[2])}, pxyz = {0.f, 0.f, 0.f};
+          for (int i = 0; i < 3; i++) {
+            fitter.getTrack(i).getPxPyPzGlo(p);
+            pxyz[0] += p[0];
+            pxyz[1] += p[1];
+            pxyz[2] += p[2];
+          }
+          float cosPA = getCosPA(xyz, pxyz);
+          if (cosPA < mParams->minCosPA3Prong) {
+            continue;
+          }
+          float time = (tracks[idPos].getTimeMUS().getTimeStamp() + tracks[idNeg].getTimeMUS().getTimeStamp() + tracks[id].getTimeMUS().getTimeStamp()) / 3.f;
+          vertices3Prong.emplace_back(xyz, pxyz, std::array<int, 3>{idPos, idNeg, id}, fitter.getChi2AtPCACandidate(), cosPA, time);
+          stat.n3Prongs++;
+        }
+      }
+    }
+  }
+}
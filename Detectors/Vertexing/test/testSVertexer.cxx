@@ -0,0 +1,136 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test SVertexer class
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "DetectorsVertexing/SVertexer.h"
+#include "DetectorsVertexing/SVertexerParams.h"
+#include "MathUtils/Utils.h"
+#include "FairLogger.h"
+#include <TRandom.h>
+#include <TGenPhaseSpace.h>
+#include <TLorentzVector.h>
+#include <TStopwatch.h>
+#include <array>
+
+namespace o2
+{
+namespace vertexing
+{
+
+// generate the decay of a V0 at 10 cm from the origin into a positive and a negative track (in this order)
+void generateV0(std::vector<o2::dataformats::TrackTPCITS>& tracks, float time, float bz, TGenPhaseSpace& genPHS)
+{
+  const double parMass = 0.497614, dtMass[2] = {0.139570, 0.139570};
+  const float errYZ = 1e-2, errSlp = 1e-3, errQPT = 2e-2, errTime = 0.5;
+  std::array<float, 15> covm = {
+    errYZ * errYZ,
+    0., errYZ * errYZ,
+    0, 0., errSlp * errSlp,
+    0., 0., 0., errSlp * errSlp,
+    0., 0., 0., 0., errQPT * errQPT};
+  TLorentzVector parent;
+  bool accept = true;
+  do {
+    accept = true;
+    double y = gRandom->Rndm() - 0.5;
+    double pt = 0.5 + gRandom->Rndm() * 3;
+    double mt = TMath::Sqrt(parMass * parMass + pt * pt);
+    double pz = mt * TMath::SinH(y);
+    double phi = gRandom->Rndm() * TMath::Pi() * 2;
+    double rdec = 10.;
+    double vtx[3] = {rdec * TMath::Cos(phi), rdec * TMath::Sin(phi), rdec * pz / pt};
+    parent.SetPxPyPzE(pt * TMath::Cos(phi), pt * TMath::Sin(phi), pz, mt * TMath::CosH(y));
+    genPHS.SetDecay(parent, 2, dtMass);
+    genPHS.Generate();
+    for (int i = 0; i < 2; i++) {
+      if (genPHS.GetDecay(i)->Pt() < 0.1) {
+        accept = false;
+      }
+    }
+    if (!accept) {
+      continue;
+    }
+    for (int i = 0; i < 2; i++) {
+      auto* dt = genPHS.GetDecay(i);
+      float s, c, x;
+      std::array<float, 5> params;
+      o2::utils::sincosf(dt->Phi(), s, c);
+      o2::utils::rotateZInv(vtx[0], vtx[1], x, params[0], s, c);
+      params[1] = vtx[2];
+      params[2] = 0.; // since alpha = phi
+      params[3] = 1. / TMath::Tan(dt->Theta());
+      params[4] = (i ? -1. : 1.) / dt->Pt();
+      covm[14] = errQPT * errQPT * params[4] * params[4];
+      float r1, r2;
+      gRandom->Rannor(r1, r2);
+      params[0] += r1 * errYZ;
+      params[1] += r2 * errYZ;
+      o2::track::TrackParCov trc(x, dt->Phi(), params, covm);
+      trc.propagateTo(trc.getX() + gRandom->Rndm() * 5., bz);
+      auto& trcTPCITS = tracks.emplace_back(trc);
+      trcTPCITS.setTimeMUS(time + gRandom->Gaus(0., errTime), errTime);
+    }
+  } while (!accept);
+}
+
+BOOST_AUTO_TEST_CASE(SVertexerV0s)
+{
+  constexpr int NTest = 2000;
+  const float bz = 5.0;
+  TGenPhaseSpace genPHS;
+  std::vector<o2::dataformats::TrackTPCITS> tracks;
+  // V0s separated by 20 \mus, i.e. much more than the time resolution of their prongs
+  for (int iev = 0; iev < NTest; iev++) {
+    generateV0(tracks, iev * 20.f, bz, genPHS);
+  }
+
+  SVertexer vertexer;
+  vertexer.setBz(bz);
+  vertexer.init();
+  std::vector<o2::dataformats::V0> v0s, v0sMT;
+  std::vector<o2::dataformats::DecayVertex3Prong> vertices3Prong;
+  TStopwatch swST;
+  vertexer.process(tracks, v0s, vertices3Prong);
+  swST.Stop();
+  vertexer.getStatistics().print();
+  const auto& stat = vertexer.getStatistics();
+  // the time brackets and the binning must reject the vast majority of the combinatorics
+  BOOST_CHECK(stat.nPairsAll == size_t(NTest) * NTest);
+  BOOST_CHECK(stat.nPairsTime < size_t(NTest) * 10);
+
+  int nGood = 0;
+  for (const auto& v0 : v0s) {
+    BOOST_CHECK(v0.getProngID(0) / 2 == v0.getProngID(1) / 2); // only the prongs of the same V0 are compatible in time
+    float r = std::sqrt(v0.getX() * v0.getX() + v0.getY() * v0.getY());
+    nGood += std::abs(r - 10.f) < 0.5f;
+  }
+  LOG(INFO) << "Found " << v0s.size() << " V0s out of " << NTest << ", " << nGood << " within 0.5 cm from the true vertex";
+  BOOST_CHECK(v0s.size() > 0.9 * NTest);
+  BOOST_CHECK(nGood > 0.9 * v0s.size());
+
+  // the output must not depend on the number of threads
+  vertexer.setNThreads(4);
+  TStopwatch swMT;
+  vertexer.process(tracks, v0sMT, vertices3Prong);
+  swMT.Stop();
+  LOG(INFO) << "Timing: 1 thread: " << swST.RealTime() << " s, 4 threads: " << swMT.RealTime() << " s";
+  BOOST_CHECK(v0sMT.size() == v0s.size());
+  for (size_t i = 0; i < std::min(v0s.size(), v0sMT.size()); i++) {
+    BOOST_CHECK(v0s[i].getProngIDs() == v0sMT[i].getProngIDs());
+    BOOST_CHECK(v0s[i].getXYZ() == v0sMT[i].getXYZ());
+  }
+}
+
+} // namespace vertexing
+} // namespace o2
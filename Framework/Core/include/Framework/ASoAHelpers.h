@@ -18,6 +18,7 @@
 
 #include <arrow/compute/context.h>
 
+#include <deque>
 #include <iterator>
 #include <tuple>
 #include <utility>
@@ -869,6 +870,59 @@ struct CombinationsBlockFullSameIndexPolicy : public CombinationsBlockSameIndexP
   uint64_t mBeginIndex;
 };
 
+/// Pairs of a row of the current event with a row of a past event, going
+/// through all the given past events one after the other. The past events
+/// must outlive the iteration.
+template <typename T1, typename T2>
+struct CombinationsMixedEventsIndexPolicy : public CombinationsIndexPolicyBase<T1, T2> {
+  using CombinationType = typename CombinationsIndexPolicyBase<T1, T2>::CombinationType;
+
+  /// @a emptyEvent is only used to initialise the iterators, so that
+  /// an empty list of past events can be handled.
+  CombinationsMixedEventsIndexPolicy(const T1& current, const T2& emptyEvent, const std::deque<T2>& pastEvents) : CombinationsIndexPolicyBase<T1, T2>(current, emptyEvent), mPastEvents(&pastEvents)
+  {
+    this->mIsEnd = current.size() == 0 || !setPastEvent(0);
+  }
+
+  // Move the second iterator to the first non empty past event, starting from @a index
+  bool setPastEvent(uint64_t index)
+  {
+    for (; index < mPastEvents->size(); index++) {
+      auto const& event = (*mPastEvents)[index];
+      if (event.size() > 0) {
+        // copy assignment, so that the column iterators are bound again
+        auto begin = event.begin();
+        std::get<1>(this->mCurrent) = begin;
+        std::get<1>(this->mMaxOffset) = event.end().index;
+        mPastEventIndex = index;
+        return true;
+      }
+    }
+    mPastEventIndex = mPastEvents->size();
+    return false;
+  }
+
+  void addOne()
+  {
+    auto& current = std::get<0>(this->mCurrent);
+    auto& past = std::get<1>(this->mCurrent);
+    past++;
+    if (*std::get<1>(past.getIndices()) != std::get<1>(this->mMaxOffset)) {
+      return;
+    }
+    past.setCursor(0);
+    current++;
+    if (*std::get<1>(current.getIndices()) != std::get<0>(this->mMaxOffset)) {
+      return;
+    }
+    current.setCursor(0);
+    this->mIsEnd = !setPastEvent(mPastEventIndex + 1);
+  }
+
+  std::deque<T2> const* mPastEvents;
+  uint64_t mPastEventIndex = 0;
+};
+
 /// @return next combination of rows of tables.
 /// FIXME: move to coroutines once we have C++20
 template <typename P>
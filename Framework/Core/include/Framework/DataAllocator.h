@@ -259,7 +259,7 @@ class DataAllocator
     auto serializationType = o2::header::gSerializationMethodNone;
     if constexpr (is_messageable<T>::value == true) {
       // Serialize a snapshot of a trivially copyable, non-polymorphic object,
-      payloadMessage = proxy.createMessage(sizeof(T));
+      payloadMessage = createPayloadMessage(spec, sizeof(T));
       memcpy(payloadMessage->GetData(), &object, sizeof(T));
 
       serializationType = o2::header::gSerializationMethodNone;
@@ -272,7 +272,7 @@ class DataAllocator
         // reference object
         constexpr auto elementSizeInBytes = sizeof(ElementType);
         auto sizeInBytes = elementSizeInBytes * object.size();
-        payloadMessage = proxy.createMessage(sizeInBytes);
+        payloadMessage = createPayloadMessage(spec, sizeInBytes);
 
         if constexpr (std::is_pointer<typename T::value_type>::value == false) {
           // vector of elements
@@ -436,6 +436,8 @@ class DataAllocator
                                            size_t payloadSize);                                 //
 
   Output getOutputByBind(OutputRef&& ref);
+  /// Payload message of @a size bytes for @a spec, taken from the output arena if enabled
+  FairMQMessagePtr createPayloadMessage(const Output& spec, size_t size);
   void addPartToContext(FairMQMessagePtr&& payload,
                         const Output& spec,
                         o2::header::SerializationMethod serializationMethod);
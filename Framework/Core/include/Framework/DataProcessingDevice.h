@@ -26,11 +26,16 @@
 #include "Framework/InputRoute.h"
 #include "Framework/ForwardRoute.h"
 #include "Framework/TimingInfo.h"
+#include "Framework/TimesliceWorkerPool.h"
+#include "Framework/MessageSet.h"
 
 #include <fairmq/FairMQDevice.h>
 #include <fairmq/FairMQParts.h>
+#include <fairmq/FairMQPoller.h>
 
+#include <exception>
 #include <memory>
+#include <vector>
 
 namespace o2::framework
 {
@@ -38,6 +43,25 @@ namespace o2::framework
 struct InputChannelInfo;
 struct DeviceState;
 
+/// Everything needed to process a timeslice independently from the others,
+/// so that a device with a re-entrant process callback can work on several
+/// of them at the same time. Outputs are only created by the worker, they
+/// are sent by the device itself.
+struct TimesliceWorker {
+  TimesliceWorker(FairMQDevice* device, std::vector<OutputRoute> const& outputs);
+  TimingInfo timingInfo;
+  MessageContext messageContext;
+  StringContext stringContext;
+  ArrowContext arrowContext;
+  RawBufferContext rawBufferContext;
+  ContextRegistry contextRegistry;
+  DataAllocator allocator;
+  /// The inputs of the timeslice being processed
+  std::vector<MessageSet> inputs;
+  /// What the process callback threw, if anything
+  std::exception_ptr error;
+};
+
 /// A device actually carrying out all the DPL
 /// Data Processing needs.
 class DataProcessingDevice : public FairMQDevice
@@ -54,6 +78,7 @@ class DataProcessingDevice : public FairMQDevice
  protected:
   bool handleData(FairMQParts&, InputChannelInfo&);
   bool tryDispatchComputation();
+  bool pollInputs();
   void error(const char* msg);
 
  private:
@@ -84,6 +109,13 @@ class DataProcessingDevice : public FairMQDevice
   uint64_t mBeginIterationTimestamp = 0;     /// The timestamp of when the current ConditionalRun was started
   DataProcessingStats mStats;                /// Stats about the actual data processing.
   int mCurrentBackoff = 0;                   /// The current exponential backoff value.
+  bool mEventDrivenPolling = false;          /// Wait for input readiness instead of using the backoff
+  FairMQPollerPtr mInputPoller;              /// The poller for all the running input channels
+  std::vector<size_t> mPolledChannels;       /// The input channels in mInputPoller
+  /// One for each timeslice which can be processed concurrently, empty if
+  /// timeslices are processed one after the other.
+  std::vector<std::unique_ptr<TimesliceWorker>> mWorkers;
+  std::unique_ptr<TimesliceWorkerPool> mWorkerPool;
 };
 
 } // namespace o2::framework
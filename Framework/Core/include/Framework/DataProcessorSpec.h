@@ -61,6 +61,11 @@ struct DataProcessorSpec {
   /// put, but this is actually to be handled in the actual DeviceSpec.
   size_t inputTimeSliceId = 0;
   size_t maxInputTimeslices = 1;
+  /// How many timeslices the device may process at the same time, each on
+  /// its own thread and with its own DataAllocator. Only to be used when the
+  /// process callback is re-entrant, i.e. it does not modify any state
+  /// shared between invocations. Outputs are still sent in timeslice order.
+  size_t maxConcurrentTimeslices = 1;
 };
 
 } // namespace o2::framework
@@ -16,6 +16,7 @@
 #include "Framework/DeviceState.h"
 
 #include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
 // For pid_t
@@ -27,6 +28,8 @@ namespace o2
 namespace framework
 {
 
+class DeviceMetricsRing;
+
 struct DeviceInfo {
   /// The pid of the device associated to this device
   pid_t pid;
@@ -62,6 +65,8 @@ struct DeviceInfo {
   Metric2DViewIndex variablesViewIndex;
   /// Index for the queries of each input route.
   Metric2DViewIndex queriesViewIndex;
+  /// The shared memory ring the device sends its metrics to, if any.
+  std::shared_ptr<DeviceMetricsRing> metricsRing;
 };
 
 } // namespace framework
@@ -0,0 +1,108 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_DEVICEMETRICSRING_H_
+#define O2_FRAMEWORK_DEVICEMETRICSRING_H_
+
+#include "Framework/DeviceMetricsInfo.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace o2
+{
+namespace framework
+{
+
+/// A metric as stored in the shared memory ring. Fixed size, so that no
+/// allocation or parsing is needed on either side. Keys and string values
+/// are truncated to what DeviceMetricsInfo can store anyway. Integers are
+/// kept with 64 bits, so that only the driver decides how to store them.
+struct MetricRecord {
+  static constexpr size_t MAX_KEY_SIZE = MetricLabelIndex::MAX_METRIC_LABEL_SIZE;
+  uint64_t timestamp;
+  MetricType type;
+  int64_t intValue;
+  float floatValue;
+  uint16_t keySize;
+  uint16_t stringSize;
+  char key[MAX_KEY_SIZE];
+  char stringValue[StringMetric::MAX_SIZE];
+};
+
+/// Lock-free single producer / single consumer ring buffer of metrics living
+/// in a POSIX shared memory segment. The driver creates one for each device it
+/// spawns, the device pushes its metrics in binary form and the driver drains
+/// them directly into the DeviceMetricsInfo, without going through stdout.
+///
+/// Only one thread at the time is allowed to push and only one thread at the
+/// time is allowed to drain. When the ring is full new metrics are dropped and
+/// counted, so that a slow driver never blocks a device.
+class DeviceMetricsRing
+{
+ public:
+  /// Create the ring in a new shared memory segment called @a name, able to
+  /// hold at least @a capacity metrics. The segment is removed when the
+  /// returned object is destroyed. Throws std::runtime_error on failure.
+  static std::unique_ptr<DeviceMetricsRing> create(std::string const& name, size_t capacity);
+  /// Attach to the ring in the shared memory segment called @a name. The
+  /// name is removed immediately, so that the segment goes away together
+  /// with the last process using it. Throws std::runtime_error on failure.
+  static std::unique_ptr<DeviceMetricsRing> attach(std::string const& name);
+
+  DeviceMetricsRing(DeviceMetricsRing const&) = delete;
+  DeviceMetricsRing& operator=(DeviceMetricsRing const&) = delete;
+  ~DeviceMetricsRing();
+
+  /// Push a metric into the ring.
+  /// @return false if the ring was full and the metric was dropped.
+  bool push(std::string_view key, int value, size_t timestamp);
+  bool push(std::string_view key, uint64_t value, size_t timestamp);
+  bool push(std::string_view key, float value, size_t timestamp);
+  bool push(std::string_view key, std::string_view value, size_t timestamp);
+
+  /// Move all the pending metrics into @a info, invoking @a newMetricCallback
+  /// like DeviceMetricsHelper::processMetric does. Integers which do not fit
+  /// an int are saturated. Whenever more metrics were dropped since the last
+  /// drain, their total is added as the DROPPED_METRIC metric.
+  /// @return the number of metrics which were processed.
+  size_t drain(DeviceMetricsInfo& info, DeviceMetricsHelper::NewMetricCallback newMetricCallback = nullptr);
+
+  /// @return the number of metrics dropped because the ring was full.
+  size_t dropped() const;
+  /// @return the number of metrics the ring can hold.
+  size_t capacity() const;
+  std::string const& name() const { return mName; }
+
+  /// Name of the metric reporting dropped().
+  static constexpr char const* DROPPED_METRIC = "dropped_metrics";
+
+ private:
+  struct Header;
+  DeviceMetricsRing(std::string const& name, void* address, size_t size, bool owner);
+  MetricRecord* claim(std::string_view key, MetricType type, size_t timestamp);
+  void publish();
+
+  std::string mName;
+  void* mAddress;
+  size_t mSize;
+  bool mOwner;
+  Header* mHeader;
+  MetricRecord* mRecords;
+  /// What was last reported as DROPPED_METRIC by drain.
+  size_t mReportedDropped = 0;
+};
+
+} // namespace framework
+} // namespace o2
+
+#endif // O2_FRAMEWORK_DEVICEMETRICSRING_H_
@@ -55,6 +55,8 @@ struct DeviceSpec {
   size_t inputTimesliceId;
   /// The maximum number of time pipelining for this device.
   size_t maxInputTimeslices;
+  /// How many timeslices this device can process concurrently.
+  size_t maxConcurrentTimeslices = 1;
   /// The completion policy to use for this device.
   CompletionPolicy completionPolicy;
   DispatchPolicy dispatchPolicy;
@@ -34,12 +34,16 @@ struct ExpirationHandler {
   using Creator = std::function<TimesliceSlot(TimesliceIndex&)>;
   using Checker = std::function<bool(uint64_t timestamp)>;
   using Handler = std::function<void(ServiceRegistry&, PartRef& expiredInput, uint64_t timestamp)>;
+  /// Time, in microseconds since epoch, at which the creator expects to
+  /// create the next timeslice. Empty for handlers which only react to data.
+  using Deadline = std::function<uint64_t()>;
 
   RouteIndex routeIndex;
   Lifetime lifetime;
   Creator creator;
   Checker checker;
   Handler handler;
+  Deadline deadline = nullptr;
 };
 
 } // namespace framework
@@ -25,8 +25,14 @@
 #include "THn.h"
 #include "THnSparse.h"
 
+#include <gsl/span>
+
+#include <array>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <variant>
+#include <vector>
 namespace o2
 {
 
@@ -86,6 +92,8 @@ struct HistogramSpec {
   HistogramConfigSpec config;
 };
 
+class HistogramShadow;
+
 /// Histogram registry for an analysis task that allows to define needed histograms
 /// and serves as the container/wrapper to fill them
 class HistogramRegistry
@@ -105,19 +113,13 @@ class HistogramRegistry
 
   auto& get(char const* const name) const
   {
-    const uint32_t id = compile_time_hash(name);
-    const uint32_t i = imask(id);
-    if (O2_BUILTIN_LIKELY(id == mRegistryKey[i])) {
-      return mRegistryValue[i];
-    }
-    for (auto j = 1u; j < MAX_REGISTRY_SIZE; ++j) {
-      if (id == mRegistryKey[imask(j + i)]) {
-        return mRegistryValue[imask(j + i)];
-      }
-    }
-    throw std::runtime_error("No match found!");
+    return mRegistryValue[find(name)];
   }
 
+  /// Add the contents of @a shadow to the histograms and reset it.
+  /// Can be called concurrently for different shadows.
+  void merge(HistogramShadow& shadow);
+
   // @return the associated OutputSpec
   OutputSpec const spec()
   {
@@ -135,6 +137,23 @@ class HistogramRegistry
   mutable uint32_t lookup = 0;
 
  private:
+  friend class HistogramShadow;
+
+  uint32_t find(char const* const name) const
+  {
+    const uint32_t id = compile_time_hash(name);
+    const uint32_t i = imask(id);
+    if (O2_BUILTIN_LIKELY(id == mRegistryKey[i])) {
+      return i;
+    }
+    for (auto j = 1u; j < MAX_REGISTRY_SIZE; ++j) {
+      if (id == mRegistryKey[imask(j + i)]) {
+        return imask(j + i);
+      }
+    }
+    throw std::runtime_error("No match found!");
+  }
+
   void insert(HistogramSpec& spec)
   {
     uint32_t i = imask(spec.id);
@@ -162,8 +181,152 @@ class HistogramRegistry
   static constexpr uint32_t MAX_REGISTRY_SIZE = mask + 1;
   std::array<uint32_t, MAX_REGISTRY_SIZE> mRegistryKey;
   std::array<std::unique_ptr<TH1>, MAX_REGISTRY_SIZE> mRegistryValue;
+  std::unique_ptr<std::mutex> mMergeMutex = std::make_unique<std::mutex>();
+};
+
+/// Private copy of the contents of the histograms of a registry, so that
+/// they can be filled from several threads: each thread fills its own
+/// shadow, which is a plain array update without locks or virtual calls,
+/// and the shadows are then merged into the registry, e.g. at the end of
+/// each dataframe. Bins and statistics are the same as the ones TH1::Fill
+/// would give. The registry must outlive the shadow.
+class HistogramShadow
+{
+ public:
+  explicit HistogramShadow(HistogramRegistry const& registry)
+    : mRegistry(registry),
+      mHistograms(HistogramRegistry::MAX_REGISTRY_SIZE)
+  {
+    for (auto i = 0u; i < HistogramRegistry::MAX_REGISTRY_SIZE; ++i) {
+      auto& histogram = registry.mRegistryValue[i];
+      if (histogram.get() == nullptr) {
+        continue;
+      }
+      auto axis = histogram->GetXaxis();
+      auto& shadow = mHistograms[i];
+      shadow.nBins = axis->GetNbins();
+      shadow.xmin = axis->GetXmin();
+      shadow.xmax = axis->GetXmax();
+      shadow.sumw.resize(shadow.nBins + 2, 0.);
+      shadow.sumw2.resize(shadow.nBins + 2, 0.);
+    }
+  }
+
+  void fill(char const* const name, double x, double weight = 1.)
+  {
+    fill(mHistograms[mRegistry.find(name)], x, weight);
+  }
+
+  /// Fill all of @a xs, looking up the histogram only once
+  template <typename T>
+  void fill(char const* const name, gsl::span<T const> xs)
+  {
+    auto& histogram = mHistograms[mRegistry.find(name)];
+    for (auto x : xs) {
+      fill(histogram, x, 1.);
+    }
+  }
+
+  template <typename T>
+  void fill(char const* const name, gsl::span<T const> xs, gsl::span<T const> weights)
+  {
+    auto& histogram = mHistograms[mRegistry.find(name)];
+    for (size_t i = 0; i < xs.size(); ++i) {
+      fill(histogram, xs[i], weights[i]);
+    }
+  }
+
+  void reset()
+  {
+    for (auto& histogram : mHistograms) {
+      std::fill(histogram.sumw.begin(), histogram.sumw.end(), 0.);
+      std::fill(histogram.sumw2.begin(), histogram.sumw2.end(), 0.);
+      histogram.entries = histogram.tsumw = histogram.tsumw2 = histogram.tsumwx = histogram.tsumwx2 = 0.;
+      histogram.weighted = false;
+    }
+  }
+
+ private:
+  friend class HistogramRegistry;
+
+  struct Histogram {
+    int nBins = 0;
+    double xmin = 0.;
+    double xmax = 0.;
+    std::vector<double> sumw; // including underflow and overflow
+    std::vector<double> sumw2;
+    double entries = 0.;
+    double tsumw = 0.;
+    double tsumw2 = 0.;
+    double tsumwx = 0.;
+    double tsumwx2 = 0.;
+    bool weighted = false; // TH1::Fill starts keeping the sum of squares of weights then
+  };
+
+  static void fill(Histogram& histogram, double x, double weight)
+  {
+    int bin;
+    if (x < histogram.xmin) {
+      bin = 0;
+    } else if (!(x < histogram.xmax)) {
+      bin = histogram.nBins + 1;
+    } else {
+      // same expression as TAxis::FindBin, so that values on the bin edges end up in the same bin
+      bin = 1 + int(histogram.nBins * (x - histogram.xmin) / (histogram.xmax - histogram.xmin));
+    }
+    if (bin > 0 && bin <= histogram.nBins) {
+      histogram.tsumw += weight;
+      histogram.tsumw2 += weight * weight;
+      histogram.tsumwx += weight * x;
+      histogram.tsumwx2 += weight * x * x;
+    }
+    histogram.entries++;
+    histogram.weighted |= weight != 1.;
+    histogram.sumw[bin] += weight;
+    histogram.sumw2[bin] += weight * weight;
+  }
+
+  HistogramRegistry const& mRegistry;
+  std::vector<Histogram> mHistograms;
 };
 
+inline void HistogramRegistry::merge(HistogramShadow& shadow)
+{
+  std::lock_guard<std::mutex> lock(*mMergeMutex);
+  for (auto i = 0u; i < MAX_REGISTRY_SIZE; ++i) {
+    auto& from = shadow.mHistograms[i];
+    auto& to = mRegistryValue[i];
+    if (to.get() == nullptr || from.entries == 0) {
+      continue;
+    }
+    // the statistics are taken before touching the bins, since they are
+    // recomputed from the bins in some cases
+    double stats[4];
+    to->GetStats(stats);
+    if (from.weighted && to->GetSumw2N() == 0) {
+      to->Sumw2();
+    }
+    for (auto bin = 0; bin < from.nBins + 2; ++bin) {
+      if (from.sumw[bin] != 0.) {
+        to->AddBinContent(bin, from.sumw[bin]);
+      }
+    }
+    if (to->GetSumw2N() > 0) {
+      auto sumw2 = to->GetSumw2();
+      for (auto bin = 0; bin < from.nBins + 2; ++bin) {
+        sumw2->fArray[bin] += from.sumw2[bin];
+      }
+    }
+    stats[0] += from.tsumw;
+    stats[1] += from.tsumw2;
+    stats[2] += from.tsumwx;
+    stats[3] += from.tsumwx2;
+    to->PutStats(stats);
+    to->SetEntries(to->GetEntries() + from.entries);
+  }
+  shadow.reset();
+}
+
 } // namespace framework
 
 } // namespace o2
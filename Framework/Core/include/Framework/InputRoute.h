@@ -30,10 +30,12 @@ struct RouteConfigurator {
   using CreationConfigurator = std::function<ExpirationHandler::Creator(ConfigParamRegistry const&)>;
   using DanglingConfigurator = std::function<ExpirationHandler::Checker(ConfigParamRegistry const&)>;
   using ExpirationConfigurator = std::function<ExpirationHandler::Handler(ConfigParamRegistry const&)>;
+  using DeadlineConfigurator = std::function<ExpirationHandler::Deadline(ConfigParamRegistry const&)>;
 
   CreationConfigurator creatorConfigurator = nullptr;
   DanglingConfigurator danglingConfigurator = nullptr;
   ExpirationConfigurator expirationConfigurator = nullptr;
+  DeadlineConfigurator deadlineConfigurator = nullptr;
 };
 
 /// This uniquely identifies a route to from which data matching @a matcher
@@ -15,7 +15,9 @@
 
 #include <chrono>
 #include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace o2
 {
@@ -37,6 +39,16 @@ struct LifetimeHelpers {
   /// expires and there is not a compatible datadriven callback
   /// available.
   static ExpirationHandler::Creator timeDrivenCreation(std::chrono::microseconds period);
+  /// Same as above, but the time of the last creation is stored in @a last,
+  /// so that it can be shared with timeDrivenDeadline.
+  static ExpirationHandler::Creator timeDrivenCreation(std::chrono::microseconds period, std::shared_ptr<uint64_t> last);
+  /// Deadline of a timeDrivenCreation sharing @a last, i.e. the time at
+  /// which it will create the next timeslice.
+  static ExpirationHandler::Deadline timeDrivenDeadline(std::chrono::microseconds period, std::shared_ptr<uint64_t const> last);
+  /// Milliseconds until the nearest deadline of @a handlers, rounded up and
+  /// clamped to [0, @a maxTimeout]. Handlers without a deadline do not
+  /// shorten the timeout.
+  static int pollTimeout(std::vector<ExpirationHandler> const& handlers, int maxTimeout);
   /// Callback which never expires records. To be used with, e.g.
   /// Lifetime::Timeframe.
   static ExpirationHandler::Checker expireNever();
@@ -0,0 +1,82 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_MESSAGEARENA_H_
+#define O2_FRAMEWORK_MESSAGEARENA_H_
+
+#include <fairmq/FairMQMessage.h>
+#include <fairmq/FairMQUnmanagedRegion.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+class FairMQTransportFactory;
+
+namespace o2
+{
+namespace framework
+{
+
+/// Carves output messages out of one large unmanaged region of a transport,
+/// rather than creating a new message for each of them. With the shared
+/// memory transport receivers then view each output in place.
+///
+/// The region is split in slabs. Messages are taken one after the other from
+/// the current slab, which is only reused once all the messages carved out
+/// of it have been released by their receivers. When no slab is free, or a
+/// message does not fit in a slab, newMessage returns nullptr and the caller
+/// is expected to fall back to a normal message.
+///
+/// Messages have to be created from a single thread, they can be released
+/// from any thread.
+class MessageArena
+{
+ public:
+  /// Alignment of the address of each message
+  static constexpr size_t Alignment = 64;
+
+  MessageArena(FairMQTransportFactory* transport, size_t size, size_t nSlabs = 8);
+  MessageArena(MessageArena const&) = delete;
+  MessageArena& operator=(MessageArena const&) = delete;
+  ~MessageArena();
+
+  /// @return a message of @a size bytes in the region, nullptr if there is no room
+  FairMQMessagePtr newMessage(size_t size);
+
+  /// Number of messages created from the region so far
+  size_t messages() const { return mMessages; }
+  /// Number of messages which had to fall back to normal messages
+  size_t fallbacks() const { return mFallbacks; }
+  /// Number of messages still used somewhere
+  size_t outstanding() const;
+  size_t slabSize() const { return mSlabSize; }
+
+ private:
+  bool nextSlab();
+
+  FairMQTransportFactory* mTransport;
+  size_t mSlabSize = 0;
+  size_t mNSlabs;
+  /// Messages of each slab which were not released yet
+  std::unique_ptr<std::atomic<size_t>[]> mOutstanding;
+  /// Declared last, so that its callback goes away first
+  FairMQUnmanagedRegionPtr mRegion;
+  /// Start of the first slab, aligned in the region
+  char* mBase = nullptr;
+  size_t mCurrentSlab = 0;
+  size_t mOffset = 0;
+  size_t mMessages = 0;
+  size_t mFallbacks = 0;
+};
+
+} // namespace framework
+} // namespace o2
+
+#endif // O2_FRAMEWORK_MESSAGEARENA_H_
@@ -10,6 +10,7 @@
 #ifndef FRAMEWORK_MESSAGECONTEXT_H
 #define FRAMEWORK_MESSAGECONTEXT_H
 
+#include "Framework/DataChunk.h"
 #include "Framework/DispatchControl.h"
 #include "Framework/FairMQDeviceProxy.h"
 #include "Framework/TMessageSerializer.h"
@@ -22,6 +23,7 @@
 
 #include <cassert>
 #include <functional>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
@@ -35,6 +37,8 @@ namespace o2
 namespace framework
 {
 
+class MessageArena;
+
 class MessageContext
 {
  public:
@@ -51,6 +55,8 @@ class MessageContext
   {
   }
 
+  ~MessageContext();
+
   void init(DispatchControl&& dispatcher)
   {
     mDispatchControl = dispatcher;
@@ -215,6 +221,41 @@ class MessageContext
     buffer_type mData;                              /// the data buffer
   };
 
+  /// ArenaChunkObject holds a DataChunk over an already allocated payload
+  /// message, e.g. one carved out of a MessageArena. If the chunk grows
+  /// beyond the size of the message, it moves to a normal message.
+  class ArenaChunkObject : public ContextObject
+  {
+   public:
+    ArenaChunkObject() = delete;
+    template <typename ContextType>
+    ArenaChunkObject(ContextType* context, FairMQMessagePtr&& headerMsg, const std::string& bindingChannel, FairMQMessagePtr&& payloadMsg)
+      : ContextObject(std::forward<FairMQMessagePtr>(headerMsg), context->getChannelRef(bindingChannel)),
+        mSize{payloadMsg->GetSize()},
+        mResource{std::move(payloadMsg)},
+        mData{mSize, pmr::polymorphic_allocator<char>(&mResource)}
+    {
+    }
+    ~ArenaChunkObject() override = default;
+
+    FairMQParts finalize() final
+    {
+      assert(mParts.Size() == 1);
+      mParts.AddPart(o2::pmr::getMessage(std::move(mData)));
+      return ContextObject::finalize();
+    }
+
+    DataChunk& get()
+    {
+      return mData;
+    }
+
+   private:
+    size_t mSize;
+    pmr::MessageResource mResource;
+    DataChunk mData;
+  };
+
   /// VectorObject handles a message object holding std::vector with polymorphic_allocator
   /// can not adopt an existing message, because the polymorphic_allocator will call the element constructor,
   /// so this works only with new messages
@@ -474,16 +515,35 @@ class MessageContext
   /// call the proxy to create a message of the specified size
   /// we don't implement in the header to avoid including the FairMQDevice header here
   /// that's why the different versions need to be implemented as individual functions
+  /// If the output arena is enabled, the message is taken from it when possible.
   // FIXME: can that be const?
   FairMQMessagePtr createMessage(const std::string& channel, int index, size_t size);
   FairMQMessagePtr createMessage(const std::string& channel, int index, void* data, size_t size, fairmq_free_fn* ffn, void* hint);
 
+  /// Carve fixed size outputs out of one region of @a size bytes for each
+  /// shared memory transport, see MessageArena. Disabled if @a size is 0.
+  void enableArena(size_t size)
+  {
+    mArenaSize = size;
+  }
+
+  /// @return a message from the arena of the transport of @a channel, or
+  /// nullptr if the arena is disabled or full
+  FairMQMessagePtr createArenaMessage(const std::string& channel, int index, size_t size);
+
+  /// Drop the arenas, needs to happen before the transports go away. The
+  /// region of an arena whose messages are not all released in time is
+  /// leaked rather than destroyed.
+  void releaseArenas();
+
  private:
   FairMQDeviceProxy mProxy;
   Messages mMessages;
   Messages mScheduledMessages;
   DispatchControl mDispatchControl;
   std::unordered_map<std::string, std::unique_ptr<std::string>> mChannelRefs;
+  size_t mArenaSize = 0;
+  std::unordered_map<FairMQTransportFactory*, std::unique_ptr<MessageArena>> mArenas;
 };
 } // namespace framework
 } // namespace o2
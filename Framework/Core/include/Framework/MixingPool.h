@@ -0,0 +1,164 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef O2_FRAMEWORK_MIXINGPOOL_H_
+#define O2_FRAMEWORK_MIXINGPOOL_H_
+
+#include "Framework/ASoA.h"
+#include "Framework/ASoAHelpers.h"
+#include "Framework/ArrowCompatibility.h"
+#include "Framework/TableBuilder.h"
+
+#include <arrow/table.h>
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace o2::soa
+{
+
+/// Keeps the last events seen for each category (e.g. a bin in z vertex and
+/// multiplicity), so that an event can be mixed with events of the same
+/// category from previous dataframes. For each category at most depth
+/// events are kept, the oldest one being dropped first.
+///
+/// Only the persistent columns of the events are available from the pool,
+/// index columns pointing to other tables can not be followed.
+///
+/// Usage:
+///
+///   MixingPool<aod::Tracks> pool{5};
+///   ...
+///   for (auto& [track, mixed] : pool.combinations(category, tracks)) {
+///     ...
+///   }
+///   pool.add(category, tracks);
+template <typename T>
+class MixingPool
+{
+ public:
+  using event_t = typename T::table_t;
+
+  explicit MixingPool(size_t depth) : mDepth(depth), mEmptyEvent(emptyTable())
+  {
+  }
+
+  /// Keep a compact copy of the rows of @a event. This is the only safe choice
+  /// for tables coming from the inputs, whose buffers are released at the end
+  /// of the dataframe.
+  void add(uint64_t category, T const& event)
+  {
+    add(category, event, 0, event.size());
+  }
+
+  /// Keep a compact copy of @a count rows of @a table, starting from @a first.
+  void add(uint64_t category, T const& table, uint64_t first, uint64_t count)
+  {
+    push(category, event_t{copyRows(table, first, count, typename event_t::persistent_columns_t{})});
+  }
+
+  /// Keep @a event without copying it: the pool holds a reference to the
+  /// arrow buffers of the table. Only valid if those buffers are owned by
+  /// arrow, e.g. for tables built by the task itself.
+  void addReference(uint64_t category, T const& event)
+  {
+    push(category, event_t{event.asArrowTable()});
+  }
+
+  /// Same as above, for @a count rows of @a table starting from @a first.
+  /// Slicing the table does not copy anything either.
+  void addReference(uint64_t category, T const& table, uint64_t first, uint64_t count)
+  {
+    auto arrowTable = table.asArrowTable();
+    std::vector<std::shared_ptr<framework::BackendColumnType>> slicedColumns;
+    slicedColumns.reserve(arrowTable->num_columns());
+    for (auto ci = 0; ci < arrowTable->num_columns(); ++ci) {
+      slicedColumns.emplace_back(arrowTable->column(ci)->Slice(first, count));
+    }
+    push(category, event_t{arrow::Table::Make(arrowTable->schema(), slicedColumns)});
+  }
+
+  /// The events kept for @a category, from the oldest to the newest.
+  std::deque<event_t> const& events(uint64_t category) const
+  {
+    auto it = mEvents.find(category);
+    return it != mEvents.end() ? it->second : mNoEvents;
+  }
+
+  /// All the pairs of a row of @a current with a row of one of the events kept
+  /// for @a category. The pool must not be modified during the iteration.
+  template <typename T1>
+  auto combinations(uint64_t category, T1 const& current) const
+  {
+    using Policy = CombinationsMixedEventsIndexPolicy<T1, event_t>;
+    return CombinationsGenerator<Policy>(Policy(current, mEmptyEvent, events(category)));
+  }
+
+  /// Number of events kept for @a category.
+  size_t size(uint64_t category) const
+  {
+    return events(category).size();
+  }
+
+  size_t depth() const
+  {
+    return mDepth;
+  }
+
+  void clear()
+  {
+    mEvents.clear();
+  }
+
+ private:
+  void push(uint64_t category, event_t&& event)
+  {
+    if (mDepth == 0) {
+      return;
+    }
+    auto& events = mEvents[category];
+    if (events.size() == mDepth) {
+      events.pop_front();
+    }
+    events.emplace_back(std::move(event));
+  }
+
+  template <typename... PC>
+  static std::shared_ptr<arrow::Table> copyRows(T const& table, uint64_t first, uint64_t count, framework::pack<PC...>)
+  {
+    framework::TableBuilder builder;
+    auto writer = builder.cursor<event_t>();
+    auto row = table.begin();
+    for (auto i = first; i < first + count; ++i) {
+      row.setCursor(i);
+      writer(0, *static_cast<PC const&>(row).mColumnIterator...);
+    }
+    return builder.finalize();
+  }
+
+  static std::shared_ptr<arrow::Table> emptyTable()
+  {
+    std::vector<std::shared_ptr<arrow::Field>> fields{};
+    std::vector<std::shared_ptr<framework::BackendColumnType>> columns{};
+    return arrow::Table::Make(std::make_shared<arrow::Schema>(fields), columns);
+  }
+
+  size_t mDepth;
+  event_t mEmptyEvent;
+  std::deque<event_t> mNoEvents;
+  std::unordered_map<uint64_t, std::deque<event_t>> mEvents;
+};
+
+} // namespace o2::soa
+
+#endif // O2_FRAMEWORK_MIXINGPOOL_H_
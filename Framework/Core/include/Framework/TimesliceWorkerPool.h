@@ -0,0 +1,70 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_TIMESLICEWORKERPOOL_H_
+#define O2_FRAMEWORK_TIMESLICEWORKERPOOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace o2::framework
+{
+
+/// Fixed set of threads used by a DataProcessingDevice to process several
+/// timeslices at the same time. The threads are started once and then wait
+/// for work, so that dispatching a batch of timeslices does not pay for
+/// thread creation.
+class TimesliceWorkerPool
+{
+ public:
+  using Job = std::function<void(size_t)>;
+
+  /// @a concurrency is the number of jobs which can run at the same time,
+  /// including the one run by the thread invoking run().
+  explicit TimesliceWorkerPool(size_t concurrency);
+  TimesliceWorkerPool(TimesliceWorkerPool const&) = delete;
+  TimesliceWorkerPool& operator=(TimesliceWorkerPool const&) = delete;
+  ~TimesliceWorkerPool();
+
+  /// Invoke @a job for each index in [0, @a n) and wait for all of them
+  /// to be done. The calling thread takes part in the work. If some of the
+  /// jobs throw, the others still run and the exception of the lowest index
+  /// is rethrown by run(), on the calling thread.
+  void run(size_t n, Job const& job);
+
+  size_t concurrency() const { return mThreads.size() + 1; }
+
+ private:
+  void work();
+  /// Take the next index of the current job, if any. Requires mMutex.
+  bool next(size_t& index);
+  /// Invoke @a job for @a index, keeping what it throws, and mark it done.
+  void execute(Job const& job, size_t index);
+
+  std::mutex mMutex;
+  std::condition_variable mWakeUp;
+  std::condition_variable mAllDone;
+  Job const* mJob = nullptr;
+  size_t mNext = 0;
+  size_t mSize = 0;
+  size_t mPending = 0;
+  std::exception_ptr mError;
+  size_t mErrorIndex = 0;
+  bool mStop = false;
+  std::vector<std::thread> mThreads;
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_TIMESLICEWORKERPOOL_H_
@@ -69,6 +69,9 @@ DataChunk& DataAllocator::newChunk(const Output& spec, size_t size)
                                                            o2::header::gSerializationMethodNone, //
                                                            size                                  //
   );
+  if (auto payloadMessage = context->createArenaMessage(channel, 0, size)) {
+    return context->add<MessageContext::ArenaChunkObject>(std::move(headerMessage), channel, std::move(payloadMessage)).get();
+  }
   auto& co = context->add<MessageContext::ContainerRefObject<DataChunk>>(std::move(headerMessage), channel, 0, size);
   return co;
 }
@@ -201,11 +204,16 @@ void DataAllocator::adopt(const Output& spec, TreeToTable* t2t)
   context->addBuffer(std::move(header), buffer, std::move(finalizer), channel);
 }
 
+FairMQMessagePtr DataAllocator::createPayloadMessage(const Output& spec, size_t size)
+{
+  std::string const& channel = matchDataHeader(spec, mTimingInfo->timeslice);
+  return mContextRegistry->get<MessageContext>()->createMessage(channel, 0, size);
+}
+
 void DataAllocator::snapshot(const Output& spec, const char* payload, size_t payloadSize,
                              o2::header::SerializationMethod serializationMethod)
 {
-  auto proxy = mContextRegistry->get<MessageContext>()->proxy();
-  FairMQMessagePtr payloadMessage(proxy.createMessage(payloadSize));
+  FairMQMessagePtr payloadMessage(createPayloadMessage(spec, payloadSize));
   memcpy(payloadMessage->GetData(), payload, payloadSize);
 
   addPartToContext(std::move(payloadMessage), spec, serializationMethod);
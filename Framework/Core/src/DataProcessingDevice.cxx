@@ -22,6 +22,7 @@
 #include "Framework/CallbackService.h"
 #include "Framework/TMessageSerializer.h"
 #include "Framework/InputRecord.h"
+#include "Framework/LifetimeHelpers.h"
 #include "Framework/Signpost.h"
 #include "Framework/SourceInfoHeader.h"
 #include "Framework/Logger.h"
@@ -59,10 +60,24 @@ constexpr unsigned int MIN_RATE_LOGGING = 60;
 constexpr int MAX_BACKOFF = 6;
 constexpr int MIN_BACKOFF_DELAY = 100;
 constexpr int BACKOFF_DELAY_STEP = 100;
+// When waiting for inputs with a poller, we still wake up regularly to send
+// metrics and react to state changes, or earlier if an expiration handler
+// (e.g. a timer) has a closer deadline. In ms.
+constexpr int POLL_IDLE_TIMEOUT = 100;
 
 namespace o2::framework
 {
 
+TimesliceWorker::TimesliceWorker(FairMQDevice* device, std::vector<OutputRoute> const& outputs)
+  : messageContext{FairMQDeviceProxy{device}},
+    stringContext{FairMQDeviceProxy{device}},
+    arrowContext{FairMQDeviceProxy{device}},
+    rawBufferContext{FairMQDeviceProxy{device}},
+    contextRegistry{&messageContext, &stringContext, &arrowContext, &rawBufferContext},
+    allocator{&timingInfo, &contextRegistry, outputs}
+{
+}
+
 DataProcessingDevice::DataProcessingDevice(DeviceSpec const& spec, ServiceRegistry& registry, DeviceState& state)
   : mSpec{spec},
     mState{state},
@@ -99,6 +114,15 @@ DataProcessingDevice::DataProcessingDevice(DeviceSpec const& spec, ServiceRegist
   if (spec.dispatchPolicy.action == DispatchPolicy::DispatchOp::WhenReady) {
     mFairMQContext.init(DispatchControl{dispatcher, matcher});
   }
+
+  // Workers never dispatch outputs themselves, even with the WhenReady
+  // policy, since the channels must only be used from the device thread.
+  if (spec.maxConcurrentTimeslices > 1) {
+    for (size_t wi = 0; wi < spec.maxConcurrentTimeslices; ++wi) {
+      mWorkers.emplace_back(std::make_unique<TimesliceWorker>(this, spec.outputs));
+    }
+    mWorkerPool = std::make_unique<TimesliceWorkerPool>(spec.maxConcurrentTimeslices);
+  }
 }
 
 /// This  takes care  of initialising  the device  from its  specification. In
@@ -119,6 +143,12 @@ void DataProcessingDevice::Init()
       }
     }
   }
+  mEventDrivenPolling = GetConfig()->GetPropertyAsString("input-polling", "backoff") == "event";
+  auto arenaSize = std::stoul(GetConfig()->GetPropertyAsString("output-arena-size", "0")) << 20;
+  mFairMQContext.enableArena(arenaSize);
+  for (auto& worker : mWorkers) {
+    worker->messageContext.enableArena(arenaSize);
+  }
   auto optionsRetriever(std::make_unique<FairOptionsRetriever>(mSpec.options, GetConfig()));
   mConfigRegistry = std::move(std::make_unique<ConfigParamRegistry>(std::move(optionsRetriever)));
 
@@ -138,6 +168,9 @@ void DataProcessingDevice::Init()
       route.configurator->creatorConfigurator(*mConfigRegistry),
       route.configurator->danglingConfigurator(*mConfigRegistry),
       route.configurator->expirationConfigurator(*mConfigRegistry)};
+    if (route.configurator->deadlineConfigurator) {
+      handler.deadline = route.configurator->deadlineConfigurator(*mConfigRegistry);
+    }
     mExpirationHandlers.emplace_back(std::move(handler));
   }
 
@@ -272,10 +305,21 @@ bool DataProcessingDevice::ConditionalRun()
     if (info.state != InputChannelState::Running) {
       continue;
     }
-    FairMQParts parts;
-    auto result = this->Receive(parts, channel.name, 0, 0);
-    if (result > 0) {
+    // Re-entrant processors take up to one message per worker before
+    // dispatching, so that the timeslices already waiting in the channel
+    // are processed together.
+    bool received = false;
+    for (size_t ri = 0; ri < std::max<size_t>(1, mWorkers.size()) && info.state == InputChannelState::Running; ++ri) {
+      FairMQParts parts;
+      auto result = this->Receive(parts, channel.name, 0, 0);
+      if (result <= 0) {
+        break;
+      }
+      O2_SIGNPOST(O2_PROBE_RECEIVE, ci, parts.Size(), result, 0);
       this->handleData(parts, info);
+      received = true;
+    }
+    if (received) {
       active |= this->tryDispatchComputation();
     }
   }
@@ -320,10 +364,23 @@ bool DataProcessingDevice::ConditionalRun()
     }
     // This is needed because the transport is deleted before the device.
     mRelayer.clear();
+    mFairMQContext.releaseArenas();
+    for (auto& worker : mWorkers) {
+      worker->messageContext.releaseArenas();
+    }
     switchState(StreamingState::Idle);
     mCurrentBackoff = 10;
     return true;
   }
+  // Wait for any input to be ready rather than sleeping for a guessed
+  // amount of time. If we did something we simply check again, since
+  // more data might be pending. Without any running input channel (e.g.
+  // for sources) we fall back to the backoff.
+  if (mEventDrivenPolling && (active || pollInputs())) {
+    mCurrentBackoff = 0;
+    return true;
+  }
+
   // Update the backoff factor
   //
   // In principle we should use 1/rate for MIN_BACKOFF_DELAY and (1/maxRate -
@@ -347,6 +404,43 @@ bool DataProcessingDevice::ConditionalRun()
 void DataProcessingDevice::ResetTask()
 {
   mRelayer.clear();
+  mFairMQContext.releaseArenas();
+  for (auto& worker : mWorkers) {
+    worker->messageContext.releaseArenas();
+  }
+  mInputPoller.reset();
+  mPolledChannels.clear();
+}
+
+/// Block until any of the running input channels has data or the polling
+/// timeout expires. A single poller is used for all the running channels,
+/// it is recreated whenever the set of running channels changes.
+/// @return false if there is no running input channel to wait for.
+bool DataProcessingDevice::pollInputs()
+{
+  std::vector<size_t> running;
+  for (size_t ci = 0; ci < mSpec.inputChannels.size(); ++ci) {
+    if (mState.inputChannelInfos[ci].state == InputChannelState::Running) {
+      running.push_back(ci);
+    }
+  }
+  if (running.empty()) {
+    mInputPoller.reset();
+    mPolledChannels.clear();
+    return false;
+  }
+  if (!mInputPoller || running != mPolledChannels) {
+    std::vector<FairMQChannel*> channels;
+    for (auto ci : running) {
+      channels.push_back(&fChannels.at(mSpec.inputChannels[ci].name).at(0));
+    }
+    mInputPoller = NewPoller(channels);
+    mPolledChannels = std::move(running);
+  }
+  // Wake up in time for the nearest timer, but never later than the
+  // idle timeout, so that the loop stays responsive to state changes.
+  mInputPoller->Poll(LifetimeHelpers::pollTimeout(mExpirationHandlers, POLL_IDLE_TIMEOUT));
+  return true;
 }
 
 /// This is the inner loop of our framework. The actual implementation
@@ -461,7 +555,18 @@ bool DataProcessingDevice::handleData(FairMQParts& parts, InputChannelInfo& info
     reportError("Parts should come in couples. Dropping it.");
     return true;
   }
+  // Key the relay interval by the timeslice, like the other phases. The
+  // timeslice of a part is the startTime of its DataProcessingHeader.
+  uint64_t timeslice = 0;
+  for (size_t pi = 0; pi < inputTypes->size(); ++pi) {
+    if ((*inputTypes)[pi] == InputType::Data) {
+      timeslice = o2::header::get<DataProcessingHeader*>(parts.At(2 * pi)->GetData())->startTime;
+      break;
+    }
+  }
+  O2_SIGNPOST_START(O2_PROBE_RELAY, timeslice, parts.Size(), 0, 0);
   handleValidMessages(*inputTypes);
+  O2_SIGNPOST_END(O2_PROBE_RELAY, timeslice, parts.Size(), 0, 0);
   return true;
 }
 
@@ -528,20 +633,20 @@ bool DataProcessingDevice::tryDispatchComputation()
   // This is needed to convert from a pair of pointers to an actual DataRef
   // and to make sure the ownership is moved from the cache in the relayer to
   // the execution.
-  auto fillInputs = [&relayer, &inputsSchema, &currentSetOfInputs](TimesliceSlot slot) -> InputRecord {
-    currentSetOfInputs = std::move(relayer.getInputsForTimeslice(slot));
-    auto getter = [&currentSetOfInputs](size_t i, size_t partindex) -> DataRef {
-      if (currentSetOfInputs[i].size() > partindex) {
+  auto fillInputs = [&relayer, &inputsSchema](TimesliceSlot slot, std::vector<MessageSet>& inputs) -> InputRecord {
+    inputs = std::move(relayer.getInputsForTimeslice(slot));
+    auto getter = [&inputs](size_t i, size_t partindex) -> DataRef {
+      if (inputs[i].size() > partindex) {
         return DataRef{nullptr,
-                       static_cast<char const*>(currentSetOfInputs[i].at(partindex).header->GetData()),
-                       static_cast<char const*>(currentSetOfInputs[i].at(partindex).payload->GetData())};
+                       static_cast<char const*>(inputs[i].at(partindex).header->GetData()),
+                       static_cast<char const*>(inputs[i].at(partindex).payload->GetData())};
       }
       return DataRef{nullptr, nullptr, nullptr};
     };
-    auto nofPartsGetter = [&currentSetOfInputs](size_t i) -> size_t {
-      return currentSetOfInputs[i].size();
+    auto nofPartsGetter = [&inputs](size_t i) -> size_t {
+      return inputs[i].size();
     };
-    InputSpan span{getter, nofPartsGetter, currentSetOfInputs.size()};
+    InputSpan span{getter, nofPartsGetter, inputs.size()};
     return InputRecord{inputsSchema, std::move(span)};
   };
 
@@ -549,8 +654,9 @@ bool DataProcessingDevice::tryDispatchComputation()
   // why we do the stateful processing before the stateless one.
   // PROCESSING:{START,END} is done so that we can trigger on begin / end of processing
   // in the GUI.
-  auto dispatchProcessing = [&processingCount, &allocator, &statefulProcess, &statelessProcess, &monitoringService,
+  auto dispatchProcessing = [&processingCount, &timingInfo, &allocator, &statefulProcess, &statelessProcess, &monitoringService,
                              &context, &stringContext, &rdfContext, &rawContext, &serviceRegistry, &device](TimesliceSlot slot, InputRecord& record) {
+    O2_SIGNPOST_START(O2_PROBE_PROCESS, timingInfo.timeslice, 0, 0, 0);
     if (statefulProcess) {
       ProcessingContext processContext{record, serviceRegistry, allocator};
       StateMonitoring<DataProcessingStatus>::moveTo(DataProcessingStatus::IN_DPL_USER_CALLBACK);
@@ -565,11 +671,43 @@ bool DataProcessingDevice::tryDispatchComputation()
       StateMonitoring<DataProcessingStatus>::moveTo(DataProcessingStatus::IN_DPL_OVERHEAD);
       processingCount++;
     }
+    O2_SIGNPOST_END(O2_PROBE_PROCESS, timingInfo.timeslice, 0, 0, 0);
 
+    O2_SIGNPOST_START(O2_PROBE_SEND, timingInfo.timeslice, 0, 0, 0);
     DataProcessor::doSend(device, context);
     DataProcessor::doSend(device, stringContext);
     DataProcessor::doSend(device, rdfContext);
     DataProcessor::doSend(device, rawContext);
+    O2_SIGNPOST_END(O2_PROBE_SEND, timingInfo.timeslice, 0, 0, 0);
+  };
+
+  // The same, for a timeslice processed by one of the workers. The state
+  // monitoring and the processing count are updated by the caller, which is
+  // the only one allowed to send the outputs too.
+  auto workerProcessing = [&statefulProcess, &statelessProcess, &serviceRegistry](TimesliceWorker& worker, InputRecord& record) {
+    O2_SIGNPOST_START(O2_PROBE_PROCESS, worker.timingInfo.timeslice, 0, 0, 0);
+    try {
+      if (statefulProcess) {
+        ProcessingContext processContext{record, serviceRegistry, worker.allocator};
+        statefulProcess(processContext);
+      }
+      if (statelessProcess) {
+        ProcessingContext processContext{record, serviceRegistry, worker.allocator};
+        statelessProcess(processContext);
+      }
+    } catch (...) {
+      worker.error = std::current_exception();
+    }
+    O2_SIGNPOST_END(O2_PROBE_PROCESS, worker.timingInfo.timeslice, 0, 0, 0);
+  };
+
+  auto workerSend = [&device](TimesliceWorker& worker) {
+    O2_SIGNPOST_START(O2_PROBE_SEND, worker.timingInfo.timeslice, 0, 0, 0);
+    DataProcessor::doSend(device, worker.messageContext);
+    DataProcessor::doSend(device, worker.stringContext);
+    DataProcessor::doSend(device, worker.arrowContext);
+    DataProcessor::doSend(device, worker.rawBufferContext);
+    O2_SIGNPOST_END(O2_PROBE_SEND, worker.timingInfo.timeslice, 0, 0, 0);
   };
 
   // Error handling means printing the error and updating the metric
@@ -601,8 +739,8 @@ bool DataProcessingDevice::tryDispatchComputation()
   // to avoid double counting them.
   // This was actually the easiest solution we could find for
   // O2-646.
-  auto cleanTimers = [&currentSetOfInputs](TimesliceSlot slot, InputRecord& record) {
-    assert(record.size() == currentSetOfInputs.size());
+  auto cleanTimers = [](TimesliceSlot slot, InputRecord& record, std::vector<MessageSet>& inputs) {
+    assert(record.size() == inputs.size());
     for (size_t ii = 0, ie = record.size(); ii < ie; ++ii) {
       DataRef input = record.getByPos(ii);
       if (input.spec->lifetime != Lifetime::Timer) {
@@ -612,7 +750,7 @@ bool DataProcessingDevice::tryDispatchComputation()
         continue;
       }
       // This will hopefully delete the message.
-      currentSetOfInputs[ii].clear();
+      inputs[ii].clear();
     }
   };
 
@@ -620,8 +758,8 @@ bool DataProcessingDevice::tryDispatchComputation()
   // the inputs which are shared between this device and others
   // to the next one in the daisy chain.
   // FIXME: do it in a smarter way than O(N^2)
-  auto forwardInputs = [&reportError, &forwards, &device, &currentSetOfInputs](TimesliceSlot slot, InputRecord& record) {
-    assert(record.size() == currentSetOfInputs.size());
+  auto forwardInputs = [&reportError, &forwards, &device](TimesliceSlot slot, InputRecord& record, std::vector<MessageSet>& inputs) {
+    assert(record.size() == inputs.size());
     // we collect all messages per forward in a map and send them together
     // because the forwards are stable during this function, we use the pointer
     // to channel string as key to avoid string allocation in the map
@@ -652,7 +790,7 @@ bool DataProcessingDevice::tryDispatchComputation()
         continue;
       }
 
-      for (auto& part : currentSetOfInputs[ii]) {
+      for (auto& part : inputs[ii]) {
         for (auto const& forward : forwards) {
           if (DataSpecUtils::match(forward.matcher, dh->dataOrigin, dh->dataDescription, dh->subSpecification) == false || (dph->startTime % forward.maxTimeslices) != forward.timeslice) {
             continue;
@@ -731,26 +869,58 @@ bool DataProcessingDevice::tryDispatchComputation()
     return false;
   }
 
+  auto updateRelayerState = [&stats = mStats](TimesliceSlot slot, InputRecord& record, int validState) {
+    for (size_t ai = 0; ai != record.size(); ai++) {
+      auto cacheId = slot.index * record.size() + ai;
+      auto state = record.isValid(ai) ? validState : 0;
+      stats.relayerState.resize(std::max(cacheId + 1, stats.relayerState.size()), 0);
+      stats.relayerState[cacheId] = state;
+    }
+  };
+
+  // Statistics and what happens to the inputs once they have been processed.
+  auto completeAction = [&stats = mStats, &forwards, &updateRelayerState, &forwardInputs, &cleanTimers,
+                         &calculateTotalInputRecordSize, &calculateInputRecordLatency](DataRelayer::RecordAction const& action, InputRecord& record,
+                                                                                       std::vector<MessageSet>& inputs, auto tStart, auto tEnd) {
+    updateRelayerState(action.slot, record, 3);
+    stats.lastElapsedTimeMs = std::chrono::duration<double, std::milli>(tEnd - tStart).count();
+    stats.lastTotalProcessedSize = calculateTotalInputRecordSize(record);
+    stats.lastLatency = calculateInputRecordLatency(record, tStart);
+    // We forward inputs only when we consume them. If we simply Process them,
+    // we keep them for next message arriving.
+    if (action.op == CompletionPolicy::CompletionOp::Consume) {
+      if (forwards.empty() == false) {
+        forwardInputs(action.slot, record, inputs);
+      }
+    } else if (action.op == CompletionPolicy::CompletionOp::Process) {
+      cleanTimers(action.slot, record, inputs);
+    }
+  };
+
+  // Timeslices to be handed to the workers, if any.
+  std::vector<DataRelayer::RecordAction> concurrentActions;
+
   for (auto action : getReadyActions()) {
     if (action.op == CompletionPolicy::CompletionOp::Wait) {
       continue;
     }
+    if (mWorkers.empty() == false && (action.op != CompletionPolicy::CompletionOp::Discard || forwards.empty())) {
+      concurrentActions.push_back(action);
+      continue;
+    }
 
+    O2_SIGNPOST_START(O2_PROBE_DISPATCH, timesliceIndex.getTimesliceForSlot(action.slot).value, action.slot.index, 0, 0);
     prepareAllocatorForCurrentTimeSlice(TimesliceSlot{action.slot});
-    InputRecord record = fillInputs(action.slot);
+    InputRecord record = fillInputs(action.slot, currentSetOfInputs);
+    O2_SIGNPOST_END(O2_PROBE_DISPATCH, timingInfo.timeslice, action.slot.index, 0, 0);
     if (action.op == CompletionPolicy::CompletionOp::Discard) {
       if (forwards.empty() == false) {
-        forwardInputs(action.slot, record);
+        forwardInputs(action.slot, record, currentSetOfInputs);
         continue;
       }
     }
     auto tStart = std::chrono::high_resolution_clock::now();
-    for (size_t ai = 0; ai != record.size(); ai++) {
-      auto cacheId = action.slot.index * record.size() + ai;
-      auto state = record.isValid(ai) ? 2 : 0;
-      mStats.relayerState.resize(std::max(cacheId + 1, mStats.relayerState.size()), 0);
-      mStats.relayerState[cacheId] = state;
-    }
+    updateRelayerState(action.slot, record, 2);
     try {
       if (mState.quitRequested == false) {
         dispatchProcessing(action.slot, record);
@@ -758,24 +928,62 @@ bool DataProcessingDevice::tryDispatchComputation()
     } catch (std::exception& e) {
       errorHandling(e, record);
     }
-    for (size_t ai = 0; ai != record.size(); ai++) {
-      auto cacheId = action.slot.index * record.size() + ai;
-      auto state = record.isValid(ai) ? 3 : 0;
-      mStats.relayerState.resize(std::max(cacheId + 1, mStats.relayerState.size()), 0);
-      mStats.relayerState[cacheId] = state;
+    auto tEnd = std::chrono::high_resolution_clock::now();
+    completeAction(action, record, currentSetOfInputs, tStart, tEnd);
+  }
+
+  // Re-entrant processors get their timeslices processed in batches, one
+  // timeslice per worker. The relayer and the channels are only accessed
+  // from this thread, before and after each batch, and outputs are sent in
+  // timeslice order, so that downstream sees the same sequence as with a
+  // single worker.
+  std::sort(concurrentActions.begin(), concurrentActions.end(), [&timesliceIndex](auto const& a, auto const& b) {
+    return timesliceIndex.getTimesliceForSlot(a.slot).value < timesliceIndex.getTimesliceForSlot(b.slot).value;
+  });
+  std::vector<InputRecord> records;
+  records.reserve(mWorkers.size());
+  for (size_t bi = 0; bi < concurrentActions.size(); bi += mWorkers.size()) {
+    auto batchSize = std::min(mWorkers.size(), concurrentActions.size() - bi);
+    records.clear();
+    for (size_t wi = 0; wi < batchSize; ++wi) {
+      auto& worker = *mWorkers[wi];
+      auto slot = concurrentActions[bi + wi].slot;
+      O2_SIGNPOST_START(O2_PROBE_DISPATCH, timesliceIndex.getTimesliceForSlot(slot).value, slot.index, 0, 0);
+      worker.timingInfo.timeslice = timesliceIndex.getTimesliceForSlot(slot).value;
+      worker.messageContext.clear();
+      worker.stringContext.clear();
+      worker.arrowContext.clear();
+      worker.rawBufferContext.clear();
+      worker.error = nullptr;
+      records.emplace_back(fillInputs(slot, worker.inputs));
+      updateRelayerState(slot, records.back(), 2);
+      O2_SIGNPOST_END(O2_PROBE_DISPATCH, worker.timingInfo.timeslice, slot.index, 0, 0);
+    }
+    auto tStart = std::chrono::high_resolution_clock::now();
+    auto quitRequested = mState.quitRequested;
+    if (quitRequested == false) {
+      StateMonitoring<DataProcessingStatus>::moveTo(DataProcessingStatus::IN_DPL_USER_CALLBACK);
+      mWorkerPool->run(batchSize, [this, &records, &workerProcessing](size_t wi) {
+        workerProcessing(*mWorkers[wi], records[wi]);
+      });
+      StateMonitoring<DataProcessingStatus>::moveTo(DataProcessingStatus::IN_DPL_OVERHEAD);
     }
     auto tEnd = std::chrono::high_resolution_clock::now();
-    mStats.lastElapsedTimeMs = std::chrono::duration<double, std::milli>(tEnd - tStart).count();
-    mStats.lastTotalProcessedSize = calculateTotalInputRecordSize(record);
-    mStats.lastLatency = calculateInputRecordLatency(record, tStart);
-    // We forward inputs only when we consume them. If we simply Process them,
-    // we keep them for next message arriving.
-    if (action.op == CompletionPolicy::CompletionOp::Consume) {
-      if (forwards.empty() == false) {
-        forwardInputs(action.slot, record);
+    for (size_t wi = 0; wi < batchSize; ++wi) {
+      auto& worker = *mWorkers[wi];
+      auto& record = records[wi];
+      if (worker.error) {
+        try {
+          std::rethrow_exception(worker.error);
+        } catch (std::exception& e) {
+          errorHandling(e, record);
+        }
+      } else if (quitRequested == false) {
+        processingCount += (statefulProcess ? 1 : 0) + (statelessProcess ? 1 : 0);
+        workerSend(worker);
       }
-    } else if (action.op == CompletionPolicy::CompletionOp::Process) {
-      cleanTimers(action.slot, record);
+      // The elapsed time is the one of the whole batch.
+      completeAction(concurrentActions[bi + wi], record, worker.inputs, tStart, tEnd);
     }
   }
   // We now broadcast the end of stream if it was requested
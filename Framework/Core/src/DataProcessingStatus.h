@@ -15,6 +15,13 @@
 
 /// probes to be used by the DPL
 #define O2_PROBE_DATARELAYER 3
+/// phases of the processing of a timeslice. Their interval id is the
+/// timeslice, when known.
+#define O2_PROBE_RECEIVE 4
+#define O2_PROBE_RELAY 5
+#define O2_PROBE_DISPATCH 6
+#define O2_PROBE_PROCESS 7
+#define O2_PROBE_SEND 8
 
 namespace o2
 {
@@ -0,0 +1,251 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/DeviceMetricsRing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace o2
+{
+namespace framework
+{
+
+// The head is only ever modified by the device, the tail only by the driver.
+// They sit on different cache lines so that the two sides do not keep
+// invalidating each other. The records follow the header.
+struct alignas(64) DeviceMetricsRing::Header {
+  static constexpr uint64_t MAGIC = 0x325254454d4c5044; // "DPLMETR2"
+  uint64_t magic;
+  uint64_t capacity;
+  alignas(64) std::atomic<uint64_t> head;
+  alignas(64) std::atomic<uint64_t> tail;
+  std::atomic<uint64_t> dropped;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory ring requires lock free atomics");
+static_assert(std::is_trivially_copyable<MetricRecord>::value, "metric records are shared between processes");
+
+namespace
+{
+std::string errorMessage(char const* what, std::string const& name)
+{
+  return std::string(what) + " " + name + ": " + strerror(errno);
+}
+} // namespace
+
+std::unique_ptr<DeviceMetricsRing> DeviceMetricsRing::create(std::string const& name, size_t capacity)
+{
+  // Round up to a power of two, so that the slot is a simple mask.
+  size_t roundedCapacity = 1;
+  while (roundedCapacity < std::max<size_t>(capacity, 1)) {
+    roundedCapacity <<= 1;
+  }
+  size_t size = sizeof(Header) + roundedCapacity * sizeof(MetricRecord);
+
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+  if (fd == -1) {
+    throw std::runtime_error(errorMessage("Unable to create metrics ring", name));
+  }
+  if (ftruncate(fd, size) == -1) {
+    close(fd);
+    shm_unlink(name.c_str());
+    throw std::runtime_error(errorMessage("Unable to resize metrics ring", name));
+  }
+  void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    throw std::runtime_error(errorMessage("Unable to map metrics ring", name));
+  }
+  auto header = new (address) Header;
+  header->capacity = roundedCapacity;
+  header->head.store(0, std::memory_order_relaxed);
+  header->tail.store(0, std::memory_order_relaxed);
+  header->dropped.store(0, std::memory_order_relaxed);
+  // Publish the magic last, a device never attaches before this is done
+  // anyway, since it gets spawned afterwards.
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = Header::MAGIC;
+  return std::unique_ptr<DeviceMetricsRing>(new DeviceMetricsRing(name, address, size, true));
+}
+
+std::unique_ptr<DeviceMetricsRing> DeviceMetricsRing::attach(std::string const& name)
+{
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd == -1) {
+    throw std::runtime_error(errorMessage("Unable to open metrics ring", name));
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1 || st.st_size < (off_t)sizeof(Header)) {
+    close(fd);
+    throw std::runtime_error("Metrics ring " + name + " is truncated");
+  }
+  size_t size = st.st_size;
+  void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    throw std::runtime_error(errorMessage("Unable to map metrics ring", name));
+  }
+  auto header = reinterpret_cast<Header*>(address);
+  if (header->magic != Header::MAGIC || sizeof(Header) + header->capacity * sizeof(MetricRecord) > size) {
+    munmap(address, size);
+    throw std::runtime_error("Metrics ring " + name + " has an unexpected layout");
+  }
+  // The mapping keeps the segment alive, no need to keep the name around.
+  shm_unlink(name.c_str());
+  return std::unique_ptr<DeviceMetricsRing>(new DeviceMetricsRing(name, address, size, false));
+}
+
+DeviceMetricsRing::DeviceMetricsRing(std::string const& name, void* address, size_t size, bool owner)
+  : mName{name},
+    mAddress{address},
+    mSize{size},
+    mOwner{owner},
+    mHeader{reinterpret_cast<Header*>(address)},
+    mRecords{reinterpret_cast<MetricRecord*>(reinterpret_cast<char*>(address) + sizeof(Header))}
+{
+}
+
+DeviceMetricsRing::~DeviceMetricsRing()
+{
+  munmap(mAddress, mSize);
+  // The device removes the name as soon as it attaches, this is only
+  // needed in case it never did.
+  if (mOwner) {
+    shm_unlink(mName.c_str());
+  }
+}
+
+MetricRecord* DeviceMetricsRing::claim(std::string_view key, MetricType type, size_t timestamp)
+{
+  auto head = mHeader->head.load(std::memory_order_relaxed);
+  if (head - mHeader->tail.load(std::memory_order_acquire) >= mHeader->capacity) {
+    mHeader->dropped.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  auto& record = mRecords[head & (mHeader->capacity - 1)];
+  record.timestamp = timestamp;
+  record.type = type;
+  record.keySize = std::min(key.size(), MetricRecord::MAX_KEY_SIZE - 1);
+  memcpy(record.key, key.data(), record.keySize);
+  record.key[record.keySize] = '\0';
+  record.stringSize = 0;
+  return &record;
+}
+
+void DeviceMetricsRing::publish()
+{
+  mHeader->head.fetch_add(1, std::memory_order_release);
+}
+
+bool DeviceMetricsRing::push(std::string_view key, int value, size_t timestamp)
+{
+  auto record = claim(key, MetricType::Int, timestamp);
+  if (record == nullptr) {
+    return false;
+  }
+  record->intValue = value;
+  publish();
+  return true;
+}
+
+bool DeviceMetricsRing::push(std::string_view key, uint64_t value, size_t timestamp)
+{
+  auto record = claim(key, MetricType::Int, timestamp);
+  if (record == nullptr) {
+    return false;
+  }
+  record->intValue = std::min<uint64_t>(value, std::numeric_limits<int64_t>::max());
+  publish();
+  return true;
+}
+
+bool DeviceMetricsRing::push(std::string_view key, float value, size_t timestamp)
+{
+  auto record = claim(key, MetricType::Float, timestamp);
+  if (record == nullptr) {
+    return false;
+  }
+  record->floatValue = value;
+  publish();
+  return true;
+}
+
+bool DeviceMetricsRing::push(std::string_view key, std::string_view value, size_t timestamp)
+{
+  auto record = claim(key, MetricType::String, timestamp);
+  if (record == nullptr) {
+    return false;
+  }
+  record->stringSize = std::min<size_t>(value.size(), StringMetric::MAX_SIZE - 1);
+  memcpy(record->stringValue, value.data(), record->stringSize);
+  record->stringValue[record->stringSize] = '\0';
+  publish();
+  return true;
+}
+
+size_t DeviceMetricsRing::drain(DeviceMetricsInfo& info, DeviceMetricsHelper::NewMetricCallback newMetricCallback)
+{
+  auto tail = mHeader->tail.load(std::memory_order_relaxed);
+  auto head = mHeader->head.load(std::memory_order_acquire);
+  ParsedMetricMatch match;
+  for (auto i = tail; i != head; ++i) {
+    auto const& record = mRecords[i & (mHeader->capacity - 1)];
+    match.beginKey = record.key;
+    match.endKey = record.key + record.keySize;
+    match.timestamp = record.timestamp;
+    match.type = record.type;
+    match.intValue = std::clamp<int64_t>(record.intValue, std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+    match.floatValue = record.floatValue;
+    match.beginStringValue = record.stringValue;
+    match.endStringValue = record.stringValue + record.stringSize;
+    DeviceMetricsHelper::processMetric(match, info, newMetricCallback);
+  }
+  // Only now the producer is allowed to reuse the slots.
+  mHeader->tail.store(head, std::memory_order_release);
+
+  auto droppedMetrics = dropped();
+  if (droppedMetrics != mReportedDropped) {
+    mReportedDropped = droppedMetrics;
+    match.beginKey = DROPPED_METRIC;
+    match.endKey = DROPPED_METRIC + strlen(DROPPED_METRIC);
+    match.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    match.type = MetricType::Int;
+    match.intValue = std::min<size_t>(droppedMetrics, std::numeric_limits<int>::max());
+    DeviceMetricsHelper::processMetric(match, info, newMetricCallback);
+  }
+  return head - tail;
+}
+
+size_t DeviceMetricsRing::dropped() const
+{
+  return mHeader->dropped.load(std::memory_order_relaxed);
+}
+
+size_t DeviceMetricsRing::capacity() const
+{
+  return mHeader->capacity;
+}
+
+} // namespace framework
+} // namespace o2
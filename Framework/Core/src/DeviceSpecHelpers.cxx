@@ -47,12 +47,21 @@ struct ExpirationHandlerHelpers {
     return [](ConfigParamRegistry const&) { return LifetimeHelpers::dataDrivenCreation(); };
   }
 
-  static RouteConfigurator::CreationConfigurator timeDrivenConfigurator(InputSpec const& matcher)
+  static RouteConfigurator::CreationConfigurator timeDrivenConfigurator(InputSpec const& matcher, std::shared_ptr<uint64_t> last)
   {
-    return [matcher](ConfigParamRegistry const& options) {
+    return [matcher, last](ConfigParamRegistry const& options) {
+      std::string rateName = std::string{"period-"} + matcher.binding;
+      auto period = options.get<int>(rateName.c_str());
+      return LifetimeHelpers::timeDrivenCreation(std::chrono::microseconds(period), last);
+    };
+  }
+
+  static RouteConfigurator::DeadlineConfigurator timeDrivenDeadlineConfigurator(InputSpec const& matcher, std::shared_ptr<uint64_t> last)
+  {
+    return [matcher, last](ConfigParamRegistry const& options) {
       std::string rateName = std::string{"period-"} + matcher.binding;
       auto period = options.get<int>(rateName.c_str());
-      return LifetimeHelpers::timeDrivenCreation(std::chrono::microseconds(period));
+      return LifetimeHelpers::timeDrivenDeadline(std::chrono::microseconds(period), last);
     };
   }
 
@@ -253,6 +262,7 @@ void DeviceSpecHelpers::processOutEdgeActions(std::vector<DeviceSpec>& devices,
     device.nSlots = processor.nSlots;
     device.inputTimesliceId = edge.producerTimeIndex;
     device.maxInputTimeslices = processor.maxInputTimeslices;
+    device.maxConcurrentTimeslices = processor.maxConcurrentTimeslices;
     device.resource = {acceptedOffer};
     devices.push_back(device);
     return devices.size() - 1;
@@ -553,12 +563,15 @@ void DeviceSpecHelpers::processInEdgeActions(std::vector<DeviceSpec>& devices,
           ExpirationHandlerHelpers::danglingQAConfigurator(),
           ExpirationHandlerHelpers::expiringQAConfigurator()};
         break;
-      case Lifetime::Timer:
+      case Lifetime::Timer: {
+        // The creator and the deadline share the time of the last creation.
+        auto last = std::make_shared<uint64_t>(0);
         route.configurator = {
-          ExpirationHandlerHelpers::timeDrivenConfigurator(inputSpec),
+          ExpirationHandlerHelpers::timeDrivenConfigurator(inputSpec, last),
           ExpirationHandlerHelpers::danglingTimerConfigurator(inputSpec),
-          ExpirationHandlerHelpers::expiringTimerConfigurator(inputSpec, sourceChannel)};
-        break;
+          ExpirationHandlerHelpers::expiringTimerConfigurator(inputSpec, sourceChannel),
+          ExpirationHandlerHelpers::timeDrivenDeadlineConfigurator(inputSpec, last)};
+      } break;
       case Lifetime::Enumeration:
         route.configurator = {
           ExpirationHandlerHelpers::enumDrivenConfigurator(inputSpec, consumerDevice.inputTimesliceId, consumerDevice.maxInputTimeslices),
@@ -954,6 +967,9 @@ boost::program_options::options_description DeviceSpecHelpers::getForwardedDevic
     ("monitoring-backend", bpo::value<std::string>(), "monitoring connection string")                           //
     ("infologger-mode", bpo::value<std::string>(), "INFOLOGGER_MODE override")                                  //
     ("infologger-severity", bpo::value<std::string>(), "minimun FairLogger severity which goes to info logger") //
+    ("input-polling", bpo::value<std::string>(), "wait for inputs with 'backoff' sleeps or 'event' driven")      //
+    ("output-arena-size", bpo::value<std::string>(), "size in MB of the region fixed size outputs are carved from (0: disabled)") //
+    ("signposts-trace", bpo::value<std::string>(), "record signposts and write them as Chrome trace to the file") //
     ("child-driver", bpo::value<std::string>(), "external driver to start childs with (e.g. valgrind)");        //
 
   return forwardedDeviceOptions;
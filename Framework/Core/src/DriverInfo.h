@@ -144,6 +144,11 @@ struct DriverInfo {
   float frameLatency;
   /// The unique id used for ipc communications
   std::string uniqueWorkflowId = "";
+  /// The number of metrics each device can buffer in its shared memory ring
+  /// before the driver drains them. 0 means metrics go through stdout.
+  size_t metricsRingSize = 0;
+  /// Where to write the signposts recorded by all the devices, if not empty.
+  std::string signpostsTrace;
 };
 
 } // namespace framework
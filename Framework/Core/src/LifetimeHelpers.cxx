@@ -23,6 +23,7 @@
 
 #include <fairmq/FairMQDevice.h>
 
+#include <algorithm>
 #include <cstdlib>
 
 using namespace o2::header;
@@ -72,8 +73,12 @@ ExpirationHandler::Creator LifetimeHelpers::enumDrivenCreation(size_t start, siz
 
 ExpirationHandler::Creator LifetimeHelpers::timeDrivenCreation(std::chrono::microseconds period)
 {
-  auto start = getCurrentTime();
-  auto last = std::make_shared<decltype(start)>(start);
+  return timeDrivenCreation(period, std::make_shared<uint64_t>(0));
+}
+
+ExpirationHandler::Creator LifetimeHelpers::timeDrivenCreation(std::chrono::microseconds period, std::shared_ptr<uint64_t> last)
+{
+  *last = getCurrentTime();
   // FIXME: should create timeslices when period expires....
   return [last, period](TimesliceIndex& index) -> TimesliceSlot {
     // Nothing to do if the time has not expired yet.
@@ -114,6 +119,31 @@ ExpirationHandler::Creator LifetimeHelpers::timeDrivenCreation(std::chrono::micr
   };
 }
 
+ExpirationHandler::Deadline LifetimeHelpers::timeDrivenDeadline(std::chrono::microseconds period, std::shared_ptr<uint64_t const> last)
+{
+  return [last, period]() -> uint64_t {
+    return *last + period.count();
+  };
+}
+
+int LifetimeHelpers::pollTimeout(std::vector<ExpirationHandler> const& handlers, int maxTimeout)
+{
+  auto current = getCurrentTime();
+  uint64_t timeout = static_cast<uint64_t>(maxTimeout) * 1000;
+  for (auto& handler : handlers) {
+    if (!handler.deadline) {
+      continue;
+    }
+    auto deadline = handler.deadline();
+    if (deadline <= current) {
+      return 0;
+    }
+    timeout = std::min<uint64_t>(timeout, deadline - current);
+  }
+  // Round up, so that we do not wake up just before the deadline.
+  return static_cast<int>((timeout + 999) / 1000);
+}
+
 ExpirationHandler::Checker LifetimeHelpers::expireNever()
 {
   return [](int64_t) -> bool { return false; };
@@ -0,0 +1,88 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/MessageArena.h"
+
+#include <fairmq/FairMQTransportFactory.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+namespace o2
+{
+namespace framework
+{
+
+MessageArena::MessageArena(FairMQTransportFactory* transport, size_t size, size_t nSlabs)
+  : mTransport{transport},
+    mNSlabs{std::max<size_t>(nSlabs, 1)},
+    mOutstanding{new std::atomic<size_t>[std::max<size_t>(nSlabs, 1)]}
+{
+  mSlabSize = (size / mNSlabs) & ~(Alignment - 1);
+  if (mSlabSize == 0) {
+    throw std::runtime_error("Message arena of " + std::to_string(size) + " bytes is too small");
+  }
+  for (size_t i = 0; i < mNSlabs; ++i) {
+    mOutstanding[i].store(0, std::memory_order_relaxed);
+  }
+  // The hint of each message is the slab it belongs to. The region is
+  // padded, so that the first slab can start at an aligned address.
+  mRegion = mTransport->CreateUnmanagedRegion(mSlabSize * mNSlabs + Alignment - 1, [this](void*, size_t, void* hint) {
+    mOutstanding[reinterpret_cast<uintptr_t>(hint)].fetch_sub(1, std::memory_order_release);
+  });
+  if (mRegion.get() == nullptr) {
+    throw std::runtime_error("Unable to create the region for the message arena");
+  }
+  auto base = reinterpret_cast<uintptr_t>(mRegion->GetData());
+  mBase = static_cast<char*>(mRegion->GetData()) + ((Alignment - base % Alignment) % Alignment);
+}
+
+MessageArena::~MessageArena() = default;
+
+size_t MessageArena::outstanding() const
+{
+  size_t result = 0;
+  for (size_t i = 0; i < mNSlabs; ++i) {
+    result += mOutstanding[i].load(std::memory_order_acquire);
+  }
+  return result;
+}
+
+bool MessageArena::nextSlab()
+{
+  // The current slab can simply be rewound if everything in it was released.
+  for (size_t i = 0; i < mNSlabs; ++i) {
+    auto slab = (mCurrentSlab + i) % mNSlabs;
+    if (mOutstanding[slab].load(std::memory_order_acquire) == 0) {
+      mCurrentSlab = slab;
+      mOffset = 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+FairMQMessagePtr MessageArena::newMessage(size_t size)
+{
+  auto alignedSize = std::max<size_t>((size + Alignment - 1) & ~(Alignment - 1), Alignment);
+  if (alignedSize > mSlabSize || (mOffset + alignedSize > mSlabSize && nextSlab() == false)) {
+    mFallbacks++;
+    return nullptr;
+  }
+  auto data = mBase + mCurrentSlab * mSlabSize + mOffset;
+  mOffset += alignedSize;
+  mOutstanding[mCurrentSlab].fetch_add(1, std::memory_order_relaxed);
+  mMessages++;
+  return mTransport->CreateMessage(mRegion, data, size, reinterpret_cast<void*>(static_cast<uintptr_t>(mCurrentSlab)));
+}
+
+} // namespace framework
+} // namespace o2
@@ -9,15 +9,28 @@
 // or submit itself to any jurisdiction.
 
 #include "Framework/MessageContext.h"
+#include "Framework/MessageArena.h"
+#include "Framework/Logger.h"
 #include "fairmq/FairMQDevice.h"
 
+#include <chrono>
+#include <thread>
+
 namespace o2
 {
 namespace framework
 {
 
+MessageContext::~MessageContext()
+{
+  releaseArenas();
+}
+
 FairMQMessagePtr MessageContext::createMessage(const std::string& channel, int index, size_t size)
 {
+  if (auto message = createArenaMessage(channel, index, size)) {
+    return message;
+  }
   return proxy().getDevice()->NewMessageFor(channel, 0, size);
 }
 
@@ -26,5 +39,43 @@ FairMQMessagePtr MessageContext::createMessage(const std::string& channel, int i
   return proxy().getDevice()->NewMessageFor(channel, 0, data, size, ffn, hint);
 }
 
+FairMQMessagePtr MessageContext::createArenaMessage(const std::string& channel, int index, size_t size)
+{
+  if (mArenaSize == 0 || size == 0) {
+    return nullptr;
+  }
+  auto transport = proxy().getTransport(channel, 0);
+  // Other transports copy the messages of a region, an arena would only add a copy.
+  if (transport->GetType() != fair::mq::Transport::SHM) {
+    return nullptr;
+  }
+  auto& arena = mArenas[transport];
+  if (arena.get() == nullptr) {
+    arena = std::make_unique<MessageArena>(transport, mArenaSize);
+    LOG(INFO) << "Created output arena of " << mArenaSize << " bytes for channel " << channel;
+  }
+  return arena->newMessage(size);
+}
+
+void MessageContext::releaseArenas()
+{
+  for (auto it = mArenas.begin(); it != mArenas.end();) {
+    auto& arena = it->second;
+    LOG(INFO) << "Output arena: " << arena->messages() << " messages, "
+              << arena->fallbacks() << " fallbacks to normal messages";
+    // The messages still in flight point into the region, give their
+    // receivers some time to release them.
+    for (int i = 0; i < 100 && arena->outstanding() > 0; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (arena->outstanding() > 0) {
+      // Better to leak the region than to unmap it under the receivers.
+      LOG(ERROR) << "Output arena: " << arena->outstanding() << " messages still in flight, not releasing its region";
+      arena.release();
+    }
+    it = mArenas.erase(it);
+  }
+}
+
 } // namespace framework
 } // namespace o2
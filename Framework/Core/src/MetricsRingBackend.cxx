@@ -0,0 +1,75 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "MetricsRingBackend.h"
+
+#include <chrono>
+
+using o2::monitoring::Metric;
+
+namespace o2
+{
+namespace framework
+{
+
+MetricsRingBackend::MetricsRingBackend(std::unique_ptr<DeviceMetricsRing> ring)
+  : mRing{std::move(ring)}
+{
+}
+
+void MetricsRingBackend::push(std::string_view name, Metric const& metric)
+{
+  // Same units the InfoLogger backend prints, i.e. what the driver expects.
+  size_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(metric.getTimestamp().time_since_epoch()).count();
+  auto value = metric.getValue();
+  // The order of the types is the one of the variant held by the metric.
+  switch (metric.getType()) {
+    case 0:
+      mRing->push(name, boost::get<int>(value), timestamp);
+      break;
+    case 1:
+      mRing->push(name, std::string_view{boost::get<std::string>(value)}, timestamp);
+      break;
+    case 2:
+      mRing->push(name, static_cast<float>(boost::get<double>(value)), timestamp);
+      break;
+    case 3:
+      mRing->push(name, boost::get<uint64_t>(value), timestamp);
+      break;
+    default:
+      break;
+  }
+}
+
+void MetricsRingBackend::send(Metric const& metric)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  push(metric.getName(), metric);
+}
+
+void MetricsRingBackend::send(std::vector<Metric>&& metrics)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  for (auto& metric : metrics) {
+    push(metric.getName(), metric);
+  }
+}
+
+void MetricsRingBackend::sendMultiple(std::string measurement, std::vector<Metric>&& metrics)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  for (auto& metric : metrics) {
+    mName = measurement + "/" + metric.getName();
+    push(mName, metric);
+  }
+}
+
+} // namespace framework
+} // namespace o2
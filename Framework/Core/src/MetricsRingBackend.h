@@ -0,0 +1,57 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef FRAMEWORK_METRICSRINGBACKEND_H
+#define FRAMEWORK_METRICSRINGBACKEND_H
+
+#include "Framework/DeviceMetricsRing.h"
+
+#include <Monitoring/Backend.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace o2
+{
+namespace framework
+{
+
+/// A monitoring backend which pushes metrics in binary form to the shared
+/// memory ring the driver is draining, rather than printing them as
+/// [METRIC] lines on stdout.
+class MetricsRingBackend : public o2::monitoring::Backend
+{
+ public:
+  MetricsRingBackend(std::unique_ptr<DeviceMetricsRing> ring);
+  ~MetricsRingBackend() override = default;
+
+  void send(o2::monitoring::Metric const& metric) override;
+  void send(std::vector<o2::monitoring::Metric>&& metrics) override;
+  void sendMultiple(std::string measurement, std::vector<o2::monitoring::Metric>&& metrics) override;
+  /// Tags are not used by the driver.
+  void addGlobalTag(std::string_view name, std::string_view value) override {}
+
+ private:
+  void push(std::string_view name, o2::monitoring::Metric const& metric);
+
+  std::unique_ptr<DeviceMetricsRing> mRing;
+  /// The monitoring can be used from more than one thread, the ring
+  /// supports a single producer.
+  std::mutex mMutex;
+  /// Used to compose the names of metrics from sendMultiple.
+  std::string mName;
+};
+
+} // namespace framework
+} // namespace o2
+
+#endif // FRAMEWORK_METRICSRINGBACKEND_H
@@ -0,0 +1,111 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/TimesliceWorkerPool.h"
+
+#include <utility>
+
+namespace o2::framework
+{
+
+TimesliceWorkerPool::TimesliceWorkerPool(size_t concurrency)
+{
+  for (size_t i = 1; i < concurrency; ++i) {
+    mThreads.emplace_back([this]() { work(); });
+  }
+}
+
+TimesliceWorkerPool::~TimesliceWorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mWakeUp.notify_all();
+  for (auto& thread : mThreads) {
+    thread.join();
+  }
+}
+
+bool TimesliceWorkerPool::next(size_t& index)
+{
+  if (mJob == nullptr || mNext == mSize) {
+    return false;
+  }
+  index = mNext++;
+  return true;
+}
+
+void TimesliceWorkerPool::execute(Job const& job, size_t index)
+{
+  std::exception_ptr error;
+  try {
+    job(index);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (error && (mError == nullptr || index < mErrorIndex)) {
+    mError = error;
+    mErrorIndex = index;
+  }
+  if (--mPending == 0) {
+    mAllDone.notify_all();
+  }
+}
+
+void TimesliceWorkerPool::run(size_t n, Job const& job)
+{
+  if (n == 0) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(mMutex);
+  mJob = &job;
+  mNext = 0;
+  mSize = n;
+  mPending = n;
+  lock.unlock();
+  mWakeUp.notify_all();
+
+  while (true) {
+    size_t index;
+    lock.lock();
+    if (next(index) == false) {
+      break;
+    }
+    lock.unlock();
+    execute(job, index);
+  }
+  mAllDone.wait(lock, [this]() { return mPending == 0; });
+  mJob = nullptr;
+  auto error = std::exchange(mError, nullptr);
+  lock.unlock();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void TimesliceWorkerPool::work()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  while (true) {
+    size_t index;
+    mWakeUp.wait(lock, [this, &index]() { return mStop || next(index); });
+    if (mStop) {
+      return;
+    }
+    auto job = mJob;
+    lock.unlock();
+    execute(*job, index);
+    lock.lock();
+  }
+}
+
+} // namespace o2::framework
@@ -41,6 +41,7 @@ struct WorkflowImporter : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
     IN_DATAPROCESSOR_N_SLOTS,
     IN_DATAPROCESSOR_TIMESLICE_ID,
     IN_DATAPROCESSOR_MAX_TIMESLICES,
+    IN_DATAPROCESSOR_CONCURRENT_TIMESLICES,
     IN_INPUTS,
     IN_OUTPUTS,
     IN_OPTIONS,
@@ -103,6 +104,9 @@ struct WorkflowImporter : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
       case State::IN_DATAPROCESSOR_MAX_TIMESLICES:
         s << "IN_DATAPROCESSOR_MAX_TIMESLICES";
         break;
+      case State::IN_DATAPROCESSOR_CONCURRENT_TIMESLICES:
+        s << "IN_DATAPROCESSOR_CONCURRENT_TIMESLICES";
+        break;
       case State::IN_INPUTS:
         s << "IN_INPUTS";
         break;
@@ -356,6 +360,8 @@ struct WorkflowImporter : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
       push(State::IN_DATAPROCESSOR_TIMESLICE_ID);
     } else if (in(State::IN_DATAPROCESSOR) && strncmp(str, "maxInputTimeslices", length) == 0) {
       push(State::IN_DATAPROCESSOR_MAX_TIMESLICES);
+    } else if (in(State::IN_DATAPROCESSOR) && strncmp(str, "maxConcurrentTimeslices", length) == 0) {
+      push(State::IN_DATAPROCESSOR_CONCURRENT_TIMESLICES);
     } else if (in(State::IN_DATAPROCESSOR) && strncmp(str, "inputs", length) == 0) {
       push(State::IN_INPUTS);
     } else if (in(State::IN_DATAPROCESSOR) && strncmp(str, "outputs", length) == 0) {
@@ -449,6 +455,8 @@ struct WorkflowImporter : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
       output.back().inputTimeSliceId = i;
     } else if (in(State::IN_DATAPROCESSOR_MAX_TIMESLICES)) {
       output.back().maxInputTimeslices = i;
+    } else if (in(State::IN_DATAPROCESSOR_CONCURRENT_TIMESLICES)) {
+      output.back().maxConcurrentTimeslices = i;
     }
     pop();
     return true;
@@ -657,6 +665,8 @@ void WorkflowSerializationHelpers::dump(std::ostream& out,
     w.Int(processor.inputTimeSliceId);
     w.Key("maxInputTimeslices");
     w.Int(processor.maxInputTimeslices);
+    w.Key("maxConcurrentTimeslices");
+    w.Int(processor.maxConcurrentTimeslices);
 
     w.EndObject();
   }
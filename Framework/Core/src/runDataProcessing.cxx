@@ -27,6 +27,7 @@
 #include "Framework/DeviceExecution.h"
 #include "Framework/DeviceInfo.h"
 #include "Framework/DeviceMetricsInfo.h"
+#include "Framework/DeviceMetricsRing.h"
 #include "Framework/DeviceSpec.h"
 #include "Framework/DeviceState.h"
 #include "Framework/FrameworkGUIDebugger.h"
@@ -49,6 +50,7 @@
 #include "DeviceSpecHelpers.h"
 #include "DriverControl.h"
 #include "DriverInfo.h"
+#include "MetricsRingBackend.h"
 #include "DataProcessorInfo.h"
 #include "GraphvizHelpers.h"
 #include "SimpleResourceManager.h"
@@ -71,6 +73,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <csignal>
+#include <fstream>
 #include <iostream>
 #include <map>
 #include <regex>
@@ -308,7 +311,8 @@ void spawnDevice(std::string const& forwardedStdin,
                  DeviceControl& control,
                  DeviceExecution& execution,
                  std::vector<DeviceInfo>& deviceInfos,
-                 int& maxFd, fd_set& childFdset)
+                 int& maxFd, fd_set& childFdset,
+                 size_t metricsRingSize)
 {
   int childstdin[2];
   int childstdout[2];
@@ -318,6 +322,18 @@ void spawnDevice(std::string const& forwardedStdin,
   maxFd = createPipes(maxFd, childstdout);
   maxFd = createPipes(maxFd, childstderr);
 
+  // The ring needs to be there before the child starts. If we cannot get
+  // one, the device will simply send its metrics via stdout.
+  std::shared_ptr<DeviceMetricsRing> metricsRing;
+  if (metricsRingSize) {
+    auto ringName = fmt::format("/dpl-metrics-{}-{}", getpid(), deviceInfos.size());
+    try {
+      metricsRing = DeviceMetricsRing::create(ringName, metricsRingSize);
+    } catch (std::runtime_error const& e) {
+      LOG(ERROR) << e.what() << ". Metrics of " << spec.id << " will go via stdout.";
+    }
+  }
+
   // If we have a framework id, it means we have already been respawned
   // and that we are in a child. If not, we need to fork and re-exec, adding
   // the framework-id as one of the options.
@@ -342,6 +358,10 @@ void spawnDevice(std::string const& forwardedStdin,
     dup2(childstdin[0], STDIN_FILENO);
     dup2(childstdout[1], STDOUT_FILENO);
     dup2(childstderr[1], STDERR_FILENO);
+    if (metricsRing) {
+      // args is null terminated.
+      execution.args.insert(execution.args.end() - 1, {strdup("--metrics-ring"), strdup(metricsRing->name().c_str())});
+    }
     execvp(execution.args[0], execution.args.data());
   }
 
@@ -368,6 +388,7 @@ void spawnDevice(std::string const& forwardedStdin,
   info.dataRelayerViewIndex = Metric2DViewIndex{"data_relayer", 0, 0, {}};
   info.variablesViewIndex = Metric2DViewIndex{"matcher_variables", 0, 0, {}};
   info.queriesViewIndex = Metric2DViewIndex{"data_queries", 0, 0, {}};
+  info.metricsRing = metricsRing;
 
   socket2DeviceInfo.insert(std::make_pair(childstdout[0], deviceInfos.size()));
   socket2DeviceInfo.insert(std::make_pair(childstderr[0], deviceInfos.size()));
@@ -412,9 +433,37 @@ void updateMetricsNames(DriverInfo& state, std::vector<DeviceMetricsInfo> const&
   state.availableMetrics.swap(result);
 }
 
+/// Move the metrics the devices have sent via their shared memory ring
+/// to the store. No parsing needed, they are already in binary form.
+void processChildrenMetrics(DriverInfo& driverInfo, DeviceInfos& infos, std::vector<DeviceMetricsInfo>& metricsInfos)
+{
+  bool hasNewMetric = false;
+  for (size_t di = 0, de = infos.size(); di < de; ++di) {
+    DeviceInfo& info = infos[di];
+    if (!info.metricsRing) {
+      continue;
+    }
+    auto updateMetricsViews =
+      Metric2DViewIndex::getUpdater({&info.dataRelayerViewIndex,
+                                     &info.variablesViewIndex,
+                                     &info.queriesViewIndex});
+
+    auto newMetricCallback = [&updateMetricsViews, &hasNewMetric](std::string const& name, MetricInfo const& metric, int value, size_t metricIndex) {
+      updateMetricsViews(name, metric, value, metricIndex);
+      hasNewMetric = true;
+    };
+    info.metricsRing->drain(metricsInfos[di], newMetricCallback);
+  }
+  if (hasNewMetric) {
+    updateMetricsNames(driverInfo, metricsInfos);
+  }
+}
+
 void processChildrenOutput(DriverInfo& driverInfo, DeviceInfos& infos, DeviceSpecs const& specs,
                            DeviceControls& controls, std::vector<DeviceMetricsInfo>& metricsInfos)
 {
+  processChildrenMetrics(driverInfo, infos, metricsInfos);
+
   // Wait for children to say something. When they do
   // print it.
   fd_set fdset;
@@ -635,6 +684,41 @@ auto createInfoLoggerSinkHelper(std::unique_ptr<InfoLogger>& logger, std::unique
   };
 };
 
+/// The file where the device with the given @a pid writes its own part of
+/// the signposts trace.
+std::string signpostsTracePart(std::string const& trace, pid_t pid)
+{
+  return trace + "." + std::to_string(pid);
+}
+
+/// Merge the parts written by each device, plus what the driver itself
+/// recorded, in a single trace, so that all the devices end up on the same
+/// timeline. They all use the steady clock, so timestamps are comparable.
+void mergeSignpostsTrace(std::string const& trace, DeviceInfos const& infos)
+{
+  std::ofstream out(trace);
+  if (!out) {
+    LOGP(ERROR, "Unable to write signposts trace {}", trace);
+    return;
+  }
+  out << "[\n";
+  SignpostRecorder::writeChromeTraceEvents(out, getpid(), "driver");
+  for (auto& info : infos) {
+    auto part = signpostsTracePart(trace, info.pid);
+    std::ifstream in(part);
+    if (!in) {
+      continue;
+    }
+    out << in.rdbuf();
+    in.close();
+    unlink(part.c_str());
+  }
+  // Every event is followed by a comma, so we need a last one without.
+  out << R"({"name":"process_sort_index","ph":"M","pid":)" << getpid() << R"(,"args":{"sort_index":-1}})"
+      << "\n]\n";
+  LOG(INFO) << "Signposts trace written to " << trace;
+}
+
 int doChild(int argc, char** argv, const o2::framework::DeviceSpec& spec)
 {
   fair::Logger::SetConsoleColor(false);
@@ -650,7 +734,11 @@ int doChild(int argc, char** argv, const o2::framework::DeviceSpec& spec)
       ConfigParamsHelper::populateBoostProgramOptions(optsDesc, spec.options, gHiddenDeviceOptions);
       optsDesc.add_options()("monitoring-backend", bpo::value<std::string>()->default_value("infologger://"), "monitoring backend info") //
         ("infologger-severity", bpo::value<std::string>()->default_value(""), "minimum FairLogger severity to send to InfoLogger")       //
-        ("infologger-mode", bpo::value<std::string>()->default_value(""), "INFOLOGGER_MODE override");
+        ("infologger-mode", bpo::value<std::string>()->default_value(""), "INFOLOGGER_MODE override")                                   //
+        ("input-polling", bpo::value<std::string>()->default_value("backoff"), "wait for inputs with 'backoff' sleeps or 'event' driven") //
+        ("metrics-ring", bpo::value<std::string>()->default_value(""), "shared memory ring where to send metrics for the driver") //
+        ("output-arena-size", bpo::value<std::string>()->default_value("0"), "size in MB of the region fixed size outputs are carved from (0: disabled)") //
+        ("signposts-trace", bpo::value<std::string>()->default_value(""), "record signposts and write them as Chrome trace to the file");
       r.fConfig.AddToCmdLineOptions(optsDesc, true);
     });
 
@@ -670,8 +758,10 @@ int doChild(int argc, char** argv, const o2::framework::DeviceSpec& spec)
     std::unique_ptr<InfoLoggerContext> infoLoggerContext;
     std::unique_ptr<TimesliceIndex> timesliceIndex;
     std::unique_ptr<DeviceState> deviceState;
+    std::string signpostsTrace;
 
     auto afterConfigParsingCallback = [&localRootFileService,
+                                       &signpostsTrace,
                                        &textControlService,
                                        &parallelContext,
                                        &simpleRawDeviceService,
@@ -683,13 +773,34 @@ int doChild(int argc, char** argv, const o2::framework::DeviceSpec& spec)
                                        &infoLoggerContext,
                                        &deviceState,
                                        &timesliceIndex](fair::mq::DeviceRunner& r) {
+      signpostsTrace = r.fConfig.GetStringValue("signposts-trace");
+      if (signpostsTrace.empty() == false) {
+        SignpostRecorder::enable();
+      }
       localRootFileService = std::make_unique<LocalRootFileService>();
       deviceState = std::make_unique<DeviceState>();
       textControlService = std::make_unique<TextControlService>(serviceRegistry, *deviceState.get());
       parallelContext = std::make_unique<ParallelContext>(spec.rank, spec.nSlots);
       simpleRawDeviceService = std::make_unique<SimpleRawDeviceService>(nullptr, spec);
       callbackService = std::make_unique<CallbackService>();
-      monitoringService = MonitoringFactory::Get(r.fConfig.GetStringValue("monitoring-backend"));
+      auto monitoringBackend = r.fConfig.GetStringValue("monitoring-backend");
+      auto metricsRing = r.fConfig.GetStringValue("metrics-ring");
+      std::unique_ptr<DeviceMetricsRing> ring;
+      if (!metricsRing.empty()) {
+        try {
+          ring = DeviceMetricsRing::attach(metricsRing);
+        } catch (std::runtime_error const& e) {
+          LOG(WARN) << e.what() << ". Sending metrics via stdout.";
+        }
+      }
+      if (!ring) {
+        monitoringService = MonitoringFactory::Get(monitoringBackend);
+      } else {
+        // The default backend only prints the metrics for the driver, which
+        // now gets them from the ring. Any other backend is kept.
+        monitoringService = monitoringBackend == "infologger://" ? std::make_unique<Monitoring>() : MonitoringFactory::Get(monitoringBackend);
+        monitoringService->addBackend(std::make_unique<MetricsRingBackend>(std::move(ring)));
+      }
       auto infoLoggerMode = r.fConfig.GetStringValue("infologger-mode");
       if (infoLoggerMode != "") {
         setenv("INFOLOGGER_MODE", r.fConfig.GetStringValue("infologger-mode").c_str(), 1);
@@ -724,7 +835,12 @@ int doChild(int argc, char** argv, const o2::framework::DeviceSpec& spec)
     };
 
     runner.AddHook<fair::mq::hooks::InstantiateDevice>(afterConfigParsingCallback);
-    return runner.Run();
+    auto result = runner.Run();
+    if (signpostsTrace.empty() == false) {
+      std::ofstream out(signpostsTracePart(signpostsTrace, getpid()));
+      SignpostRecorder::writeChromeTraceEvents(out, getpid(), spec.id);
+    }
+    return result;
   } catch (std::exception& e) {
     LOG(ERROR) << "Unhandled exception reached the top of main: " << e.what() << ", device shutting down.";
     return 1;
@@ -958,7 +1074,7 @@ int runStateMachine(DataProcessorSpecs const& workflow,
           } else {
             spawnDevice(forwardedStdin.str(),
                         deviceSpecs[di], driverInfo.socket2DeviceInfo, controls[di], deviceExecutions[di], infos,
-                        driverInfo.maxFd, driverInfo.childFdset);
+                        driverInfo.maxFd, driverInfo.childFdset, driverInfo.metricsRingSize);
           }
         }
         driverInfo.maxFd += 1;
@@ -1058,6 +1174,9 @@ int runStateMachine(DataProcessorSpecs const& workflow,
         }
         break;
       case DriverState::EXIT:
+        if (driverInfo.signpostsTrace.empty() == false) {
+          mergeSignpostsTrace(driverInfo.signpostsTrace, infos);
+        }
         return calculateExitCode(infos);
       case DriverState::PERFORM_CALLBACKS:
         for (auto& callback : driverControl.callbacks) {
@@ -1379,6 +1498,8 @@ int doMain(int argc, char** argv, o2::framework::WorkflowSpec const& workflow,
     ("dds,D", bpo::value<bool>()->zero_tokens()->default_value(false), "create DDS configuration")          //
     ("dump-workflow", bpo::value<bool>()->zero_tokens()->default_value(false), "dump workflow as JSON")     //
     ("run", bpo::value<bool>()->zero_tokens()->default_value(false), "run workflow merged so far")          //
+    ("metrics-ring-size", bpo::value<size_t>()->default_value(2048),                                        //
+     "metrics each device can buffer in shared memory for the driver, 0 to send them via stdout")           //
     ("o2-control,o2", bpo::value<bool>()->zero_tokens()->default_value(false), "create O2 Control configuration");
   // some of the options must be forwarded by default to the device
   executorOptions.add(DeviceSpecHelpers::getForwardedDeviceOptions());
@@ -1387,6 +1508,7 @@ int doMain(int argc, char** argv, o2::framework::WorkflowSpec const& workflow,
     ("id,i", bpo::value<std::string>(), "device id for child spawning")                 //
     ("channel-config", bpo::value<std::vector<std::string>>(), "channel configuration") //
     ("control", "control plugin")                                                       //
+    ("metrics-ring", bpo::value<std::string>(), "metrics ring for child spawning")      //
     ("log-color", "logging color scheme")("color", "logging color scheme");
 
   bpo::options_description visibleOptions;
@@ -1574,6 +1696,7 @@ int doMain(int argc, char** argv, o2::framework::WorkflowSpec const& workflow,
   driverInfo.timeout = varmap["timeout"].as<double>();
   driverInfo.deployHostname = varmap["hostname"].as<std::string>();
   driverInfo.resources = varmap["resources"].as<std::string>();
+  driverInfo.metricsRingSize = varmap["metrics-ring-size"].as<size_t>();
 
   // FIXME: should use the whole dataProcessorInfos, actually...
   driverInfo.processorInfo = dataProcessorInfos;
@@ -1587,6 +1710,10 @@ int doMain(int argc, char** argv, o2::framework::WorkflowSpec const& workflow,
     driverInfo.uniqueWorkflowId = fmt::format("{}", getppid());
   } else {
     driverInfo.uniqueWorkflowId = fmt::format("{}", getpid());
+    if (varmap.count("signposts-trace")) {
+      driverInfo.signpostsTrace = varmap["signposts-trace"].as<std::string>();
+      SignpostRecorder::enable();
+    }
   }
   return runStateMachine(physicalWorkflow,
                          currentWorkflow,
@@ -0,0 +1,95 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "Framework/DeviceMetricsInfo.h"
+#include "Framework/DeviceMetricsRing.h"
+
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace o2::framework;
+
+static std::string ringName()
+{
+  static int count = 0;
+  return "/dpl-metrics-bench-" + std::to_string(getpid()) + "-" + std::to_string(count++);
+}
+
+// What the driver does for each metric printed on stdout: parse and store.
+static void BM_TextMetrics(benchmark::State& state)
+{
+  std::vector<std::string> metrics;
+  for (int i = 0; i < 1000; ++i) {
+    metrics.push_back("[METRIC] key" + std::to_string(i % 32) + ",0 " + std::to_string(i) + " 1789372894 hostname=test.cern.ch");
+  }
+  ParsedMetricMatch match;
+  DeviceMetricsInfo info;
+  for (auto _ : state) {
+    for (auto& s : metrics) {
+      DeviceMetricsHelper::parseMetric(s, match);
+      DeviceMetricsHelper::processMetric(match, info);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * metrics.size());
+}
+
+BENCHMARK(BM_TextMetrics);
+
+// The same metrics going through the ring, both sides in the same thread.
+static void BM_RingMetrics(benchmark::State& state)
+{
+  std::vector<std::string> keys;
+  for (int i = 0; i < 32; ++i) {
+    keys.push_back("key" + std::to_string(i));
+  }
+  auto ring = DeviceMetricsRing::create(ringName(), 1024);
+  DeviceMetricsInfo info;
+  for (auto _ : state) {
+    for (int i = 0; i < 1000; ++i) {
+      ring->push(keys[i % 32], i, 1789372894);
+    }
+    ring->drain(info);
+  }
+  state.SetItemsProcessed(state.iterations() * 1000);
+}
+
+BENCHMARK(BM_RingMetrics);
+
+// A device pushing as fast as it can while the driver drains at the rate
+// given by the argument (in us between two drains, like the driver loop).
+// Reports the metrics/s which are sustained and how many were dropped.
+static void BM_RingSustained(benchmark::State& state)
+{
+  auto ring = DeviceMetricsRing::create(ringName(), state.range(0));
+  auto device = DeviceMetricsRing::attach(ring->name());
+  std::atomic<bool> running{true};
+  std::thread producer([&device, &running]() {
+    int i = 0;
+    while (running.load(std::memory_order_relaxed)) {
+      device->push("inputs/relayed/total", i++, 1789372894);
+    }
+  });
+  DeviceMetricsInfo info;
+  size_t drained = 0;
+  for (auto _ : state) {
+    std::this_thread::sleep_for(std::chrono::microseconds(state.range(1)));
+    drained += ring->drain(info);
+  }
+  running = false;
+  producer.join();
+  state.SetItemsProcessed(drained);
+  state.counters["dropped"] = benchmark::Counter(ring->dropped(), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_RingSustained)->Args({1024, 1000})->Args({4096, 1000})->Args({4096, 16000})->UseRealTime();
+
+BENCHMARK_MAIN();
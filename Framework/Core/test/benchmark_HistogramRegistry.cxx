@@ -61,7 +61,61 @@ static void BM_StandardNameLookup(benchmark::State& state)
     }
   }
 }
+
+/// Number of values filled per iteration, i.e. per dataframe
+const int nFills = 100000;
+
+std::vector<float> fillValues()
+{
+  std::vector<float> values(nFills);
+  for (auto i = 0; i < nFills; ++i) {
+    values[i] = (i * 7919 % nFills) / (float)nFills;
+  }
+  return values;
+}
+
+/// Fill a registry histogram directly, one value at the time
+static void BM_DirectFill(benchmark::State& state)
+{
+  HistogramRegistry registry{"registry", true, {{"histo", "Histo", {"TH1F", 100, 0, 1}}}};
+  auto values = fillValues();
+  for (auto _ : state) {
+    for (auto x : values) {
+      registry.get("histo")->Fill(x);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * nFills);
+}
+
+/// Fill per thread shadows, merged into a shared registry after each batch
+static HistogramRegistry* sharedRegistry = nullptr;
+
+static void BM_ShadowFill(benchmark::State& state)
+{
+  if (state.thread_index == 0) {
+    sharedRegistry = new HistogramRegistry{"registry", true, {{"histo", "Histo", {"TH1F", 100, 0, 1}}}};
+  }
+  auto values = fillValues();
+  for (auto _ : state) {
+    HistogramShadow shadow{*sharedRegistry};
+    if (state.range(0)) {
+      shadow.fill("histo", gsl::span<float const>(values));
+    } else {
+      for (auto x : values) {
+        shadow.fill("histo", x);
+      }
+    }
+    sharedRegistry->merge(shadow);
+  }
+  state.SetItemsProcessed(state.iterations() * nFills);
+  if (state.thread_index == 0) {
+    delete sharedRegistry;
+  }
+}
+
 BENCHMARK(BM_HashedNameLookup)->Arg(4)->Arg(8)->Arg(16)->Arg(64)->Arg(128)->Arg(256)->Arg(512);
 BENCHMARK(BM_StandardNameLookup)->Arg(4)->Arg(8)->Arg(16)->Arg(64)->Arg(128)->Arg(256)->Arg(512);
+BENCHMARK(BM_DirectFill);
+BENCHMARK(BM_ShadowFill)->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
 
 BENCHMARK_MAIN();
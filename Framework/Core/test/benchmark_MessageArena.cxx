@@ -0,0 +1,67 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "Framework/MessageArena.h"
+
+#include <benchmark/benchmark.h>
+#include <fairmq/FairMQTransportFactory.h>
+#include <fairmq/ProgOptions.h>
+#include <fairmq/Tools.h>
+#include <vector>
+
+using namespace o2::framework;
+
+// The arena is only used with the shared memory transport, which does not
+// copy the messages of a region.
+static std::shared_ptr<FairMQTransportFactory> createTransport()
+{
+  fair::mq::ProgOptions config;
+  config.SetProperty<std::string>("session", std::to_string(fair::mq::tools::UuidHash()));
+  return FairMQTransportFactory::CreateTransportFactory("shmem", fair::mq::tools::Uuid(), &config);
+}
+
+// Many small outputs per timeslice, e.g. one per link or per chip, all of
+// them released once the timeslice has been sent.
+static constexpr int OutputsPerTimeslice = 1000;
+
+static void BM_NewMessage(benchmark::State& state)
+{
+  auto transport = createTransport();
+  std::vector<FairMQMessagePtr> outputs(OutputsPerTimeslice);
+  for (auto _ : state) {
+    for (auto& output : outputs) {
+      output = transport->CreateMessage(state.range(0));
+    }
+    outputs.assign(OutputsPerTimeslice, nullptr);
+  }
+  state.SetItemsProcessed(state.iterations() * OutputsPerTimeslice);
+}
+
+static void BM_ArenaMessage(benchmark::State& state)
+{
+  auto transport = createTransport();
+  MessageArena arena{transport.get(), 64 << 20};
+  std::vector<FairMQMessagePtr> outputs(OutputsPerTimeslice);
+  for (auto _ : state) {
+    for (auto& output : outputs) {
+      output = arena.newMessage(state.range(0));
+      if (output.get() == nullptr) {
+        output = transport->CreateMessage(state.range(0));
+      }
+    }
+    outputs.assign(OutputsPerTimeslice, nullptr);
+  }
+  state.SetItemsProcessed(state.iterations() * OutputsPerTimeslice);
+  state.counters["fallbacks"] = arena.fallbacks();
+}
+
+BENCHMARK(BM_NewMessage)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK(BM_ArenaMessage)->Arg(64)->Arg(1024)->Arg(16384);
+
+BENCHMARK_MAIN();
@@ -14,6 +14,7 @@
 
 #include "Framework/ArrowCompatibility.h"
 #include "Framework/ASoAHelpers.h"
+#include "Framework/MixingPool.h"
 #include "Framework/TableBuilder.h"
 #include "Framework/AnalysisDataModel.h"
 #include <boost/test/unit_test.hpp>
@@ -1075,3 +1076,68 @@ BOOST_AUTO_TEST_CASE(BlockCombinations)
   }
   BOOST_CHECK_EQUAL(count, expectedUpperFives.size());
 }
+
+BOOST_AUTO_TEST_CASE(MixingPoolCombinations)
+{
+  using Test = o2::soa::Table<test::X, test::Y>;
+  auto makeTable = [](std::vector<int32_t> const& xs) {
+    TableBuilder builder;
+    auto rowWriter = builder.persist<int32_t, int32_t>({"x", "y"});
+    for (auto x : xs) {
+      rowWriter(0, x, 2 * x);
+    }
+    return builder.finalize();
+  };
+
+  MixingPool<Test> pool{2};
+  BOOST_CHECK_EQUAL(pool.depth(), 2);
+  {
+    Test eventA{makeTable({0, 1})};
+    Test eventsBC{makeTable({5, 10, 20, 21})};
+    pool.add(1, eventA);
+    pool.add(1, eventsBC, 1, 1);
+    pool.add(1, eventsBC, 2, 2);
+    pool.addReference(2, eventsBC, 0, 1);
+  }
+  // the oldest event of category 1 was dropped, the copies outlive the original tables
+  BOOST_REQUIRE_EQUAL(pool.size(1), 2);
+  BOOST_CHECK_EQUAL(pool.size(2), 1);
+  BOOST_CHECK_EQUAL(pool.size(3), 0);
+  BOOST_CHECK_EQUAL(pool.events(1)[0].size(), 1);
+  BOOST_CHECK_EQUAL(pool.events(1)[1].size(), 2);
+
+  Test current{makeTable({100, 101})};
+  std::vector<std::tuple<int32_t, int32_t>> expectedPairs{
+    {100, 10}, {101, 10}, {100, 20}, {100, 21}, {101, 20}, {101, 21}};
+  int count = 0;
+  for (auto& [c0, c1] : pool.combinations(1, current)) {
+    BOOST_CHECK_EQUAL(c0.x(), std::get<0>(expectedPairs[count]));
+    BOOST_CHECK_EQUAL(c1.x(), std::get<1>(expectedPairs[count]));
+    BOOST_CHECK_EQUAL(c1.y(), 2 * c1.x());
+    count++;
+  }
+  BOOST_CHECK_EQUAL(count, expectedPairs.size());
+
+  count = 0;
+  for (auto& [c0, c1] : pool.combinations(2, current)) {
+    BOOST_CHECK_EQUAL(c1.x(), 5);
+    count++;
+  }
+  BOOST_CHECK_EQUAL(count, 2);
+
+  count = 0;
+  for (auto& [c0, c1] : pool.combinations(3, current)) {
+    count++;
+  }
+  BOOST_CHECK_EQUAL(count, 0);
+
+  Test empty{makeTable({})};
+  count = 0;
+  for (auto& [c0, c1] : pool.combinations(1, empty)) {
+    count++;
+  }
+  BOOST_CHECK_EQUAL(count, 0);
+
+  pool.clear();
+  BOOST_CHECK_EQUAL(pool.size(1), 0);
+}
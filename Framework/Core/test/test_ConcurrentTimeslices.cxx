@@ -0,0 +1,119 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "Framework/CompletionPolicyHelpers.h"
+#include "Framework/ControlService.h"
+#include "Framework/CallbackService.h"
+#include "Framework/EndOfStreamContext.h"
+#include "Framework/DeviceSpec.h"
+#include "Framework/Logger.h"
+
+#include <vector>
+
+using namespace o2::framework;
+
+// The sink gets the outputs of the concurrent processor and the inputs it
+// forwards separately, as they come.
+void customize(std::vector<CompletionPolicy>& policies)
+{
+  policies.push_back(CompletionPolicyHelpers::defineByName("sink", CompletionPolicy::CompletionOp::Consume));
+}
+
+#include "Framework/runDataProcessing.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#define ASSERT_ERROR(condition)                                   \
+  if ((condition) == false) {                                     \
+    LOG(ERROR) << R"(Test condition ")" #condition R"(" failed)"; \
+  }
+
+constexpr int nTimeslices = 64;
+
+// A processor handling up to 4 timeslices at the same time, the later ones
+// of a batch being done first. Downstream must still see the outputs, and
+// the inputs forwarded to the sink, in timeslice order.
+std::vector<DataProcessorSpec> defineDataProcessing(ConfigContext const&)
+{
+  DataProcessorSpec source{
+    "source",
+    Inputs{},
+    {OutputSpec{{"a"}, "TST", "A1"}},
+    AlgorithmSpec{[](InitContext&) {
+      auto counter = std::make_shared<int>(0);
+      return [counter](ProcessingContext& ctx) {
+        if (*counter == nTimeslices) {
+          return;
+        }
+        auto& out = ctx.outputs().make<int>(OutputRef{"a"});
+        out = (*counter)++;
+        if (*counter == nTimeslices) {
+          ctx.services().get<ControlService>().endOfStream();
+          ctx.services().get<ControlService>().readyToQuit(QuitRequest::Me);
+        }
+      };
+    }}};
+
+  DataProcessorSpec concurrent{
+    "concurrent",
+    {InputSpec{"a", "TST", "A1"}},
+    {OutputSpec{{"b"}, "TST", "B1"}},
+    AlgorithmSpec{[](InitContext& ic) {
+      auto inFlight = std::make_shared<std::atomic<int>>(0);
+      auto maxInFlight = std::make_shared<std::atomic<int>>(0);
+      ic.services().get<CallbackService>().set(CallbackService::Id::EndOfStream, [maxInFlight](EndOfStreamContext&) {
+        LOG(INFO) << "At most " << maxInFlight->load() << " timeslices processed at the same time";
+        ASSERT_ERROR(maxInFlight->load() > 1);
+      });
+      return [inFlight, maxInFlight](ProcessingContext& ctx) {
+        auto value = ctx.inputs().get<int>("a");
+        auto current = ++(*inFlight);
+        auto previous = maxInFlight->load();
+        while (previous < current && maxInFlight->compare_exchange_weak(previous, current) == false) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5 * (4 - value % 4)));
+        --(*inFlight);
+        auto& out = ctx.outputs().make<int>(OutputRef{"b"});
+        out = value;
+      };
+    }}};
+  concurrent.maxConcurrentTimeslices = 4;
+
+  DataProcessorSpec sink{
+    "sink",
+    {InputSpec{"a", "TST", "A1"},
+     InputSpec{"b", "TST", "B1"}},
+    {},
+    AlgorithmSpec{[](InitContext& ic) {
+      auto lastA = std::make_shared<int>(-1);
+      auto lastB = std::make_shared<int>(-1);
+      ic.services().get<CallbackService>().set(CallbackService::Id::EndOfStream, [lastA, lastB](EndOfStreamContext& ctx) {
+        ASSERT_ERROR(*lastA == nTimeslices - 1);
+        ASSERT_ERROR(*lastB == nTimeslices - 1);
+        ctx.services().get<ControlService>().readyToQuit(QuitRequest::All);
+      });
+      return [lastA, lastB](ProcessingContext& ctx) {
+        if (ctx.inputs().isValid("a")) {
+          auto value = ctx.inputs().get<int>("a");
+          ASSERT_ERROR(value == *lastA + 1);
+          *lastA = value;
+        }
+        if (ctx.inputs().isValid("b")) {
+          auto value = ctx.inputs().get<int>("b");
+          ASSERT_ERROR(value == *lastB + 1);
+          *lastB = value;
+        }
+      };
+    }}};
+
+  return {source, concurrent, sink};
+}
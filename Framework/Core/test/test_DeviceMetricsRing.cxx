@@ -0,0 +1,105 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test Framework DeviceMetricsRing
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include "Framework/DeviceMetricsRing.h"
+#include <boost/test/unit_test.hpp>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <unistd.h>
+
+using namespace o2::framework;
+
+BOOST_AUTO_TEST_CASE(TestDeviceMetricsRing)
+{
+  auto name = "/dpl-metrics-test-" + std::to_string(getpid());
+  auto driverRing = DeviceMetricsRing::create(name, 3);
+  BOOST_CHECK_EQUAL(driverRing->capacity(), 4);
+  // Attaching uses a different mapping, like the device would do.
+  auto deviceRing = DeviceMetricsRing::attach(name);
+  BOOST_CHECK_THROW(DeviceMetricsRing::attach(name), std::runtime_error);
+
+  DeviceMetricsInfo info;
+  BOOST_CHECK_EQUAL(driverRing->drain(info), 0);
+  BOOST_CHECK(deviceRing->push("bkey", 12, 1789372894));
+  BOOST_CHECK(deviceRing->push("key3", 16.f, 1789372895));
+  BOOST_CHECK(deviceRing->push("key4", std::string_view{"some_string"}, 1789372896));
+  BOOST_CHECK(deviceRing->push("bkey", 13, 1789372897));
+  // Full, this is dropped
+  BOOST_CHECK_EQUAL(deviceRing->push("bkey", 14, 1789372898), false);
+  BOOST_CHECK_EQUAL(driverRing->dropped(), 1);
+
+  size_t newMetrics = 0;
+  auto callback = [&newMetrics](std::string const&, MetricInfo const&, int, size_t) { newMetrics++; };
+  BOOST_CHECK_EQUAL(driverRing->drain(info, callback), 4);
+  // The dropped metric is reported as well.
+  BOOST_CHECK_EQUAL(newMetrics, 4);
+  BOOST_REQUIRE_EQUAL(info.metrics.size(), 4);
+  BOOST_CHECK_EQUAL(info.metrics[0].type, MetricType::Int);
+  BOOST_CHECK_EQUAL(info.metrics[0].pos, 2);
+  BOOST_CHECK_EQUAL(info.intMetrics[0][0], 12);
+  BOOST_CHECK_EQUAL(info.intMetrics[0][1], 13);
+  BOOST_CHECK_EQUAL(info.timestamps[0][1], 1789372897);
+  BOOST_CHECK_EQUAL(info.metrics[1].type, MetricType::Float);
+  BOOST_CHECK_EQUAL(info.floatMetrics[0][0], 16.f);
+  BOOST_CHECK_EQUAL(info.metrics[2].type, MetricType::String);
+  BOOST_CHECK_EQUAL(std::string(info.stringMetrics[0][0].data), "some_string");
+  BOOST_CHECK_EQUAL(std::string(info.metricLabelsIdx[0].label), "bkey");
+  BOOST_CHECK_EQUAL(std::string(info.metricLabelsIdx[1].label), DeviceMetricsRing::DROPPED_METRIC);
+  BOOST_CHECK_EQUAL(std::string(info.metricLabelsIdx[2].label), "key3");
+  BOOST_CHECK_EQUAL(std::string(info.metricLabelsIdx[3].label), "key4");
+  BOOST_CHECK_EQUAL(info.metrics[3].type, MetricType::Int);
+  BOOST_CHECK_EQUAL(info.intMetrics[1][0], 1);
+
+  // The slots are free again after draining, also wrapping around.
+  for (int i = 0; i < 4; ++i) {
+    BOOST_CHECK(deviceRing->push("bkey", 20 + i, 1789372900 + i));
+  }
+  BOOST_CHECK_EQUAL(driverRing->drain(info), 4);
+  BOOST_CHECK_EQUAL(info.intMetrics[0][5], 23);
+  BOOST_CHECK_EQUAL(info.metrics[0].pos, 6);
+  // Nothing new was dropped, so nothing new is reported.
+  BOOST_CHECK_EQUAL(info.metrics[3].pos, 1);
+
+  // Keys and strings which are too long are truncated.
+  std::string longKey(1000, 'k');
+  std::string longValue(1000, 'v');
+  BOOST_CHECK(deviceRing->push(longKey, std::string_view{longValue}, 1789372910));
+  BOOST_CHECK_EQUAL(driverRing->drain(info), 1);
+  BOOST_REQUIRE_EQUAL(info.metrics.size(), 5);
+  BOOST_CHECK_EQUAL(strlen(info.stringMetrics[1][0].data), StringMetric::MAX_SIZE - 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestDeviceMetricsRingUnsigned)
+{
+  auto name = "/dpl-metrics-test-unsigned-" + std::to_string(getpid());
+  auto driverRing = DeviceMetricsRing::create(name, 4);
+  auto deviceRing = DeviceMetricsRing::attach(name);
+
+  DeviceMetricsInfo info;
+  BOOST_CHECK(deviceRing->push("bytes", uint64_t{42}, 1789372894));
+  BOOST_CHECK(deviceRing->push("bytes", uint64_t{1} << 40, 1789372895));
+  BOOST_CHECK(deviceRing->push("bytes", std::numeric_limits<uint64_t>::max(), 1789372896));
+  BOOST_CHECK_EQUAL(driverRing->drain(info), 3);
+  BOOST_REQUIRE_EQUAL(info.metrics.size(), 1);
+  BOOST_CHECK_EQUAL(info.metrics[0].type, MetricType::Int);
+  BOOST_CHECK_EQUAL(info.intMetrics[0][0], 42);
+  // Values the driver cannot store as int saturate rather than wrap around.
+  BOOST_CHECK_EQUAL(info.intMetrics[0][1], std::numeric_limits<int>::max());
+  BOOST_CHECK_EQUAL(info.intMetrics[0][2], std::numeric_limits<int>::max());
+}
+
+BOOST_AUTO_TEST_CASE(TestDeviceMetricsRingMissing)
+{
+  BOOST_CHECK_THROW(DeviceMetricsRing::attach("/dpl-metrics-test-missing"), std::runtime_error);
+}
@@ -13,6 +13,7 @@
 
 #include "Framework/HistogramRegistry.h"
 #include <boost/test/unit_test.hpp>
+#include <thread>
 
 using namespace o2;
 using namespace o2::framework;
@@ -41,3 +42,47 @@ BOOST_AUTO_TEST_CASE(HistogramRegistryLookup)
   auto histo2 = r.get("histo").get();
   BOOST_REQUIRE_EQUAL(histo2->GetNbinsX(), 100);
 }
+
+BOOST_AUTO_TEST_CASE(HistogramRegistryShadowFill)
+{
+  HistogramRegistry direct{"direct", true, {{"eta", "#Eta", {"TH1F", 100, -2.0, 2.0}}, {"pt", "p_{T}", {"TH1F", 50, 0., 10.}}}};
+  HistogramRegistry merged{"merged", true, {{"eta", "#Eta", {"TH1F", 100, -2.0, 2.0}}, {"pt", "p_{T}", {"TH1F", 50, 0., 10.}}}};
+
+  // values on the bin edges, outside the range and in between
+  std::vector<float> etas;
+  std::vector<float> pts;
+  for (int i = 0; i < 1000; ++i) {
+    etas.push_back(-2.5f + i * 0.005f);
+    pts.push_back(i * 0.0123f);
+  }
+  for (size_t i = 0; i < etas.size(); ++i) {
+    direct.get("eta")->Fill(etas[i]);
+    direct.get("pt")->Fill(pts[i], 0.5);
+  }
+
+  // fill half of the values from each of two threads
+  auto half = etas.size() / 2;
+  auto fillShadow = [&merged, &etas, &pts](size_t first, size_t last) {
+    HistogramShadow shadow{merged};
+    shadow.fill("eta", gsl::span<float const>(etas.data() + first, last - first));
+    for (auto i = first; i < last; ++i) {
+      shadow.fill("pt", pts[i], 0.5);
+    }
+    merged.merge(shadow);
+  };
+  std::thread first(fillShadow, 0, half);
+  std::thread second(fillShadow, half, etas.size());
+  first.join();
+  second.join();
+
+  for (auto name : {"eta", "pt"}) {
+    auto& expected = direct.get(name);
+    auto& result = merged.get(name);
+    BOOST_CHECK_EQUAL(result->GetEntries(), expected->GetEntries());
+    for (int bin = 0; bin <= expected->GetNbinsX() + 1; ++bin) {
+      BOOST_CHECK_CLOSE(result->GetBinContent(bin), expected->GetBinContent(bin), 1e-4);
+    }
+    BOOST_CHECK_CLOSE(result->GetMean(), expected->GetMean(), 1e-4);
+    BOOST_CHECK_CLOSE(result->GetStdDev(), expected->GetStdDev(), 1e-4);
+  }
+}
@@ -0,0 +1,52 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "Framework/AlgorithmSpec.h"
+#include "Framework/CallbackService.h"
+#include "Framework/ControlService.h"
+#include "Framework/Logger.h"
+#include "Framework/runDataProcessing.h"
+
+#include <memory>
+
+using namespace o2::framework;
+
+// A device whose only input is a 1 s timer is idle most of the time. When
+// waiting for its inputs with --input-polling event, it should only wake up
+// for the idle timeout (100 ms) and the timer itself, not spin every ms.
+std::vector<DataProcessorSpec> defineDataProcessing(ConfigContext const&)
+{
+  return {
+    DataProcessorSpec{
+      "idle",
+      Inputs{
+        InputSpec{"timer", "TST", "TIMER", 0, Lifetime::Timer}},
+      {},
+      AlgorithmSpec{
+        [](InitContext& ic) {
+          auto idleLoops = std::make_shared<int>(0);
+          auto ticks = std::make_shared<int>(0);
+          ic.services().get<CallbackService>().set(CallbackService::Id::Idle, [idleLoops]() {
+            (*idleLoops)++;
+          });
+          return [idleLoops, ticks](ProcessingContext& ctx) {
+            if (++(*ticks) < 3) {
+              return;
+            }
+            // About 2 s have passed, i.e. ~20 idle timeouts. Polling every
+            // ms would give ~2000.
+            LOG(INFO) << "Idle loops after " << *ticks << " timer ticks: " << *idleLoops;
+            if (*idleLoops > 200) {
+              LOG(ERROR) << "Device is spinning while idle: " << *idleLoops << " idle loops";
+            }
+            ctx.services().get<ControlService>().readyToQuit(QuitRequest::All);
+          };
+        }},
+      {ConfigParamSpec{"period-timer", VariantType::Int, 1000000, {"period of the timer in us"}}}}};
+}
@@ -0,0 +1,89 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test Framework LifetimeHelpers
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include "Framework/LifetimeHelpers.h"
+#include "Framework/TimesliceIndex.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace o2::framework;
+
+namespace
+{
+ExpirationHandler makeTimer(std::chrono::microseconds period, std::shared_ptr<uint64_t> last)
+{
+  return ExpirationHandler{
+    RouteIndex{0},
+    Lifetime::Timer,
+    LifetimeHelpers::timeDrivenCreation(period, last),
+    LifetimeHelpers::expireAlways(),
+    LifetimeHelpers::doNothing(),
+    LifetimeHelpers::timeDrivenDeadline(period, last)};
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestPollTimeoutWithoutDeadlines)
+{
+  std::vector<ExpirationHandler> handlers;
+  BOOST_CHECK_EQUAL(LifetimeHelpers::pollTimeout(handlers, 100), 100);
+  handlers.push_back(ExpirationHandler{RouteIndex{0}, Lifetime::Timeframe,
+                                       LifetimeHelpers::dataDrivenCreation(),
+                                       LifetimeHelpers::expireNever(),
+                                       LifetimeHelpers::doNothing()});
+  BOOST_CHECK_EQUAL(LifetimeHelpers::pollTimeout(handlers, 100), 100);
+}
+
+// An idle device with a 1 s timer must sleep for the full idle timeout,
+// rather than waking up every millisecond.
+BOOST_AUTO_TEST_CASE(TestPollTimeoutSlowTimer)
+{
+  std::vector<ExpirationHandler> handlers;
+  handlers.push_back(makeTimer(std::chrono::seconds(1), std::make_shared<uint64_t>(0)));
+  BOOST_CHECK_EQUAL(LifetimeHelpers::pollTimeout(handlers, 100), 100);
+}
+
+BOOST_AUTO_TEST_CASE(TestPollTimeoutNearestDeadline)
+{
+  std::vector<ExpirationHandler> handlers;
+  handlers.push_back(makeTimer(std::chrono::seconds(1), std::make_shared<uint64_t>(0)));
+  handlers.push_back(makeTimer(std::chrono::milliseconds(50), std::make_shared<uint64_t>(0)));
+  auto timeout = LifetimeHelpers::pollTimeout(handlers, 100);
+  BOOST_CHECK_GT(timeout, 0);
+  BOOST_CHECK_LE(timeout, 50);
+}
+
+BOOST_AUTO_TEST_CASE(TestPollTimeoutFollowsCreation)
+{
+  auto last = std::make_shared<uint64_t>(0);
+  std::vector<ExpirationHandler> handlers;
+  handlers.push_back(makeTimer(std::chrono::milliseconds(20), last));
+  auto created = *last;
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(25));
+  // The deadline has passed, so we must not wait at all.
+  BOOST_CHECK_EQUAL(LifetimeHelpers::pollTimeout(handlers, 100), 0);
+
+  // Once the timeslice is created, the next deadline is one period away.
+  TimesliceIndex index;
+  index.resize(1);
+  handlers[0].creator(index);
+  BOOST_CHECK_GT(*last, created);
+  auto timeout = LifetimeHelpers::pollTimeout(handlers, 100);
+  BOOST_CHECK_GT(timeout, 0);
+  BOOST_CHECK_LE(timeout, 20);
+}
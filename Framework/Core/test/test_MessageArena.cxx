@@ -0,0 +1,95 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test Framework MessageArena
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include "Framework/MessageArena.h"
+#include <fairmq/FairMQTransportFactory.h>
+#include <fairmq/ProgOptions.h>
+#include <fairmq/Tools.h>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace o2::framework;
+
+// Only the shared memory transport does not copy the messages of a region.
+std::shared_ptr<FairMQTransportFactory> createTransport()
+{
+  fair::mq::ProgOptions config;
+  config.SetProperty<std::string>("session", std::to_string(fair::mq::tools::UuidHash()));
+  return FairMQTransportFactory::CreateTransportFactory("shmem", fair::mq::tools::Uuid(), &config);
+}
+
+// The region callbacks of the shared memory transport come from another thread.
+bool waitOutstanding(MessageArena const& arena, size_t expected)
+{
+  for (int i = 0; i < 500 && arena.outstanding() != expected; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return arena.outstanding() == expected;
+}
+
+BOOST_AUTO_TEST_CASE(TestCarving)
+{
+  auto transport = createTransport();
+  MessageArena arena{transport.get(), 4 * 1024, 4};
+  BOOST_REQUIRE_EQUAL(arena.slabSize(), 1024);
+
+  auto first = arena.newMessage(10);
+  auto second = arena.newMessage(100);
+  BOOST_REQUIRE(first.get() != nullptr);
+  BOOST_REQUIRE(second.get() != nullptr);
+  BOOST_CHECK_EQUAL(first->GetSize(), 10);
+  BOOST_CHECK_EQUAL(second->GetSize(), 100);
+  // Consecutive in the same slab, each one aligned.
+  auto firstData = reinterpret_cast<uintptr_t>(first->GetData());
+  auto secondData = reinterpret_cast<uintptr_t>(second->GetData());
+  BOOST_CHECK_EQUAL(firstData % MessageArena::Alignment, 0);
+  BOOST_CHECK_EQUAL(secondData - firstData, MessageArena::Alignment);
+  BOOST_CHECK_EQUAL(arena.messages(), 2);
+  BOOST_CHECK_EQUAL(arena.outstanding(), 2);
+
+  first.reset();
+  second.reset();
+  BOOST_CHECK(waitOutstanding(arena, 0));
+}
+
+BOOST_AUTO_TEST_CASE(TestFallback)
+{
+  auto transport = createTransport();
+  MessageArena arena{transport.get(), 4 * 1024, 4};
+
+  // Larger than a slab
+  BOOST_CHECK(arena.newMessage(2048).get() == nullptr);
+  BOOST_CHECK_EQUAL(arena.fallbacks(), 1);
+
+  // Fill all the slabs, keeping the messages alive
+  std::vector<FairMQMessagePtr> messages;
+  for (int i = 0; i < 4; ++i) {
+    messages.emplace_back(arena.newMessage(1024));
+    BOOST_REQUIRE(messages.back().get() != nullptr);
+  }
+  BOOST_CHECK(arena.newMessage(1).get() == nullptr);
+  BOOST_CHECK_EQUAL(arena.fallbacks(), 2);
+
+  // Releasing one slab makes room again, at the start of that slab.
+  auto released = messages[2]->GetData();
+  messages[2].reset();
+  BOOST_REQUIRE(waitOutstanding(arena, 3));
+  auto message = arena.newMessage(512);
+  BOOST_REQUIRE(message.get() != nullptr);
+  BOOST_CHECK_EQUAL(message->GetData(), released);
+  BOOST_CHECK_EQUAL(arena.outstanding(), 4);
+}
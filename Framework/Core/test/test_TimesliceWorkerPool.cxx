@@ -0,0 +1,109 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test Framework TimesliceWorkerPool
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include "Framework/TimesliceWorkerPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace o2::framework;
+
+BOOST_AUTO_TEST_CASE(TestEachIndexOnce)
+{
+  TimesliceWorkerPool pool{4};
+  BOOST_CHECK_EQUAL(pool.concurrency(), 4);
+  for (size_t n : {0, 1, 3, 4, 7, 100}) {
+    std::vector<std::atomic<int>> calls(n);
+    pool.run(n, [&calls](size_t i) { calls[i]++; });
+    for (auto& c : calls) {
+      BOOST_CHECK_EQUAL(c.load(), 1);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestConcurrency)
+{
+  // All the jobs wait for each other, so this only completes if they
+  // really run at the same time.
+  TimesliceWorkerPool pool{3};
+  std::atomic<int> started{0};
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  pool.run(3, [&](size_t) {
+    started++;
+    while (started.load() < 3) {
+      std::this_thread::sleep_for(std::chrono::microseconds(10));
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    threads.insert(std::this_thread::get_id());
+  });
+  BOOST_CHECK_EQUAL(threads.size(), 3);
+  BOOST_CHECK(threads.count(std::this_thread::get_id()) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestSingleThread)
+{
+  TimesliceWorkerPool pool{1};
+  std::vector<size_t> order;
+  pool.run(5, [&order](size_t i) { order.push_back(i); });
+  BOOST_CHECK((order == std::vector<size_t>{0, 1, 2, 3, 4}));
+}
+
+BOOST_AUTO_TEST_CASE(TestExceptionOnCallingThread)
+{
+  // All the jobs wait for each other, so each runs on its own thread. The
+  // ones not running on the calling thread throw.
+  TimesliceWorkerPool pool{4};
+  std::atomic<int> calls{0};
+  std::atomic<int> started{0};
+  std::thread::id caller = std::this_thread::get_id();
+  std::mutex mutex;
+  std::set<size_t> thrown;
+  auto job = [&](size_t i) {
+    calls++;
+    started++;
+    while (started.load() < 4) {
+      std::this_thread::sleep_for(std::chrono::microseconds(10));
+    }
+    if (std::this_thread::get_id() != caller) {
+      std::lock_guard<std::mutex> lock(mutex);
+      thrown.insert(i);
+      throw std::runtime_error("job " + std::to_string(i));
+    }
+  };
+  std::string what;
+  try {
+    pool.run(4, job);
+  } catch (std::runtime_error& e) {
+    what = e.what();
+  }
+  // All the jobs ran, the exception of the lowest index is rethrown here
+  BOOST_CHECK_EQUAL(calls.load(), 4);
+  BOOST_REQUIRE_EQUAL(thrown.size(), 3);
+  BOOST_CHECK_EQUAL(what, "job " + std::to_string(*thrown.begin()));
+
+  // The pool is still usable and does not report the same error twice
+  std::vector<std::atomic<int>> again(8);
+  BOOST_CHECK_NO_THROW(pool.run(8, [&again](size_t i) { again[i]++; }));
+  for (auto& c : again) {
+    BOOST_CHECK_EQUAL(c.load(), 1);
+  }
+}
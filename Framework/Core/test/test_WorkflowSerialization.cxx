@@ -54,6 +54,7 @@ BOOST_AUTO_TEST_CASE(TestVerifyWorkflow)
   };
 
   std::vector<DataProcessorInfo> metadataIn{};
+  w0[1].maxConcurrentTimeslices = 4;
 
   std::ostringstream firstDump;
   WorkflowSerializationHelpers::dump(firstDump, w0, metadataOut);
@@ -68,4 +69,5 @@ BOOST_AUTO_TEST_CASE(TestVerifyWorkflow)
   BOOST_REQUIRE_EQUAL(w0.size(), 4);
   BOOST_REQUIRE_EQUAL(w0.size(), w1.size());
   BOOST_CHECK_EQUAL(firstDump.str(), secondDump.str());
+  BOOST_CHECK_EQUAL(w1[1].maxConcurrentTimeslices, 4);
 }
@@ -10,6 +10,7 @@
 #ifndef O2_FRAMEWORK_SIGNPOST_H_
 #define O2_FRAMEWORK_SIGNPOST_H_
 
+#include "Framework/SignpostRecorder.h"
 #include <cstdint>
 
 /// Signpost API implemented using different techonologies:
@@ -17,11 +18,27 @@
 /// * macOS 10.15 onwards os_signpost
 /// * macOS 10.14 and below (either kdebug_signpost or kdebug)
 /// * linux SystemTap
+/// * linux in-process recorder, see SignpostRecorder.h
 ///
 /// Supported systems will have O2_SIGNPOST_API_AVAILABLE defined.
 ///
 /// In order to use it, one must define O2_SIGNPOST_DEFINE_CONTEXT in at least one cxx file,
 /// include "Framework/Signpost.h" and invoke O2_SIGNPOST_INIT().
+#ifdef O2_SIGNPOST_DEFINE_CONTEXT
+o2::framework::SignpostRecorderContext gDPLSignpostRecorder;
+#endif
+
+/// Record the signpost in the in-process recorder, if enabled. @a name is
+/// the already stringized code: the signpost macros must stringize it
+/// themselves, before it gets expanded to its numeric value.
+#define O2_SIGNPOST_RECORD(phase, name, arg1, arg2, arg3, arg4)                                                    \
+  do {                                                                                                            \
+    if (o2::framework::SignpostRecorder::enabled()) {                                                             \
+      o2::framework::SignpostRecorder::record(phase, name, (uint64_t)(arg1), (uint64_t)(arg2), (uint64_t)(arg3), \
+                                              (uint64_t)(arg4));                                                  \
+    }                                                                                                             \
+  } while (0)
+
 #if defined(__APPLE__) && __has_include(<os/signpost.h>) && (__MAC_OS_X_VERSION_MAX_ALLOWED >= __MAC_10_15)
 #include <os/signpost.h>
 #include <os/log.h>
@@ -62,15 +79,28 @@ static os_log_t gDPLLog;
 #elif (!defined(__APPLE__)) && __has_include(<sys/sdt.h>) // Dtrace support is being dropped by Apple
 #include <sys/sdt.h>
 #define O2_SIGNPOST_INIT()
-#define O2_SIGNPOST(code, arg1, arg2, arg3, arg4) STAP_PROBE4(dpl, probe##code, arg1, arg2, arg3, arg4)
-#define O2_SIGNPOST_START(code, arg1, arg2, arg3, arg4) STAP_PROBE4(dpl, start_probe##code, arg1, arg2, arg3, arg4)
-#define O2_SIGNPOST_END(code, arg1, arg2, arg3, arg4) STAP_PROBE4(dpl, stop_probe##code, arg1, arg2, arg3, arg4)
+#define O2_SIGNPOST(code, arg1, arg2, arg3, arg4)           \
+  do {                                                      \
+    STAP_PROBE4(dpl, probe##code, arg1, arg2, arg3, arg4);  \
+    O2_SIGNPOST_RECORD('i', #code, arg1, arg2, arg3, arg4); \
+  } while (0)
+#define O2_SIGNPOST_START(code, arg1, arg2, arg3, arg4)          \
+  do {                                                           \
+    STAP_PROBE4(dpl, start_probe##code, arg1, arg2, arg3, arg4); \
+    O2_SIGNPOST_RECORD('b', #code, arg1, arg2, arg3, arg4);      \
+  } while (0)
+#define O2_SIGNPOST_END(code, arg1, arg2, arg3, arg4)           \
+  do {                                                          \
+    STAP_PROBE4(dpl, stop_probe##code, arg1, arg2, arg3, arg4); \
+    O2_SIGNPOST_RECORD('e', #code, arg1, arg2, arg3, arg4);     \
+  } while (0)
 #define O2_SIGNPOST_API_AVAILABLE
-#else // by default we do not do anything
+#else // by default we only have the in-process recorder
 #define O2_SIGNPOST_INIT()
-#define O2_SIGNPOST(code, arg1, arg2, arg3, arg4)
-#define O2_SIGNPOST_START(code, arg1, arg2, arg3, arg4)
-#define O2_SIGNPOST_END(code, arg1, arg2, arg3, arg4)
+#define O2_SIGNPOST(code, arg1, arg2, arg3, arg4) O2_SIGNPOST_RECORD('i', #code, arg1, arg2, arg3, arg4)
+#define O2_SIGNPOST_START(code, arg1, arg2, arg3, arg4) O2_SIGNPOST_RECORD('b', #code, arg1, arg2, arg3, arg4)
+#define O2_SIGNPOST_END(code, arg1, arg2, arg3, arg4) O2_SIGNPOST_RECORD('e', #code, arg1, arg2, arg3, arg4)
+#define O2_SIGNPOST_API_AVAILABLE
 #endif
 
 /// Colors for the signpost while shown in instruments.
@@ -0,0 +1,167 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_SIGNPOSTRECORDER_H_
+#define O2_FRAMEWORK_SIGNPOSTRECORDER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace o2::framework
+{
+
+/// A signpost as kept in memory by the SignpostRecorder.
+struct SignpostEvent {
+  /// The signpost code, as written in the source. Has static storage.
+  char const* name;
+  /// In ns, from the steady clock, so that it can be compared between
+  /// processes running on the same node.
+  uint64_t timestamp;
+  /// The interval id for begin / end, the first argument otherwise.
+  uint64_t id;
+  uint64_t args[3];
+  /// 'i' for a single point in time, 'b' / 'e' for the begin / end of an interval.
+  char phase;
+};
+
+/// The last events recorded by a given thread. Only the thread itself writes
+/// to it, so no locking is needed.
+struct SignpostThreadBuffer {
+  SignpostThreadBuffer(size_t size, uint64_t tid_) : events(size), tid{tid_} {}
+  std::vector<SignpostEvent> events;
+  /// Total number of events ever recorded. The buffer is circular.
+  std::atomic<uint64_t> count{0};
+  uint64_t tid;
+};
+
+/// The process wide state of the recorder. Buffers of threads which are gone
+/// are kept, so that their events can still be written out.
+struct SignpostRecorderContext {
+  std::atomic<bool> enabled{false};
+  size_t eventsPerThread = 1 << 16;
+  std::mutex mutex;
+  std::vector<std::unique_ptr<SignpostThreadBuffer>> buffers;
+};
+
+} // namespace o2::framework
+
+/// Defined together with the rest of the signpost context, see Signpost.h.
+extern o2::framework::SignpostRecorderContext gDPLSignpostRecorder;
+
+namespace o2::framework
+{
+
+/// In-process recorder for the O2_SIGNPOST_* macros, so that they can be
+/// used without any external tool. When disabled the cost of a signpost is
+/// a single relaxed load. When enabled each thread writes to its own
+/// circular buffer, which keeps the last events it has seen. The result can
+/// then be written as Chrome trace events, to be looked at with
+/// chrome://tracing or https://ui.perfetto.dev.
+struct SignpostRecorder {
+  /// Start recording, keeping the last @a eventsPerThread signposts (rounded
+  /// up to a power of two) for each thread. Only affects threads which did
+  /// not record anything yet.
+  static void enable(size_t eventsPerThread = 1 << 16)
+  {
+    std::lock_guard<std::mutex> lock(gDPLSignpostRecorder.mutex);
+    size_t size = 1;
+    while (size < eventsPerThread) {
+      size <<= 1;
+    }
+    gDPLSignpostRecorder.eventsPerThread = size;
+    gDPLSignpostRecorder.enabled.store(true, std::memory_order_relaxed);
+  }
+
+  static void disable()
+  {
+    gDPLSignpostRecorder.enabled.store(false, std::memory_order_relaxed);
+  }
+
+  static bool enabled()
+  {
+    return gDPLSignpostRecorder.enabled.load(std::memory_order_relaxed);
+  }
+
+  static void record(char phase, char const* name, uint64_t id, uint64_t arg1, uint64_t arg2, uint64_t arg3)
+  {
+    auto buffer = threadBuffer();
+    auto count = buffer->count.load(std::memory_order_relaxed);
+    auto& event = buffer->events[count & (buffer->events.size() - 1)];
+    event.name = name;
+    event.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    event.id = id;
+    event.args[0] = arg1;
+    event.args[1] = arg2;
+    event.args[2] = arg3;
+    event.phase = phase;
+    buffer->count.store(count + 1, std::memory_order_release);
+  }
+
+  /// Write all the recorded events as Chrome trace events, in the JSON array
+  /// format, each of them followed by a comma. Together with a
+  /// process_name entry for @a processName. Events recorded while writing
+  /// might be garbled, so this is best done once the work is over.
+  static void writeChromeTraceEvents(std::ostream& out, uint64_t pid, std::string const& processName)
+  {
+    std::string escapedName;
+    for (auto c : processName) {
+      if (c == '"' || c == '\\') {
+        escapedName += '\\';
+      }
+      escapedName += c;
+    }
+    out << R"({"name":"process_name","ph":"M","pid":)" << pid << R"(,"args":{"name":")" << escapedName << "\"}},\n";
+
+    std::lock_guard<std::mutex> lock(gDPLSignpostRecorder.mutex);
+    char line[512];
+    for (auto& buffer : gDPLSignpostRecorder.buffers) {
+      auto count = buffer->count.load(std::memory_order_acquire);
+      auto size = buffer->events.size();
+      for (auto i = count > size ? count - size : 0; i < count; ++i) {
+        auto const& event = buffer->events[i & (size - 1)];
+        int n = snprintf(line, sizeof(line),
+                         R"({"name":"%s","cat":"dpl","ph":"%c","ts":%.3f,"pid":%)" PRIu64 R"(,"tid":%)" PRIu64,
+                         event.name, event.phase, event.timestamp / 1000., pid, buffer->tid);
+        if (event.phase == 'i') {
+          n += snprintf(line + n, sizeof(line) - n, R"(,"s":"t","args":{"arg0":%)" PRIu64 ",", event.id);
+        } else {
+          n += snprintf(line + n, sizeof(line) - n, R"(,"id":"0x%)" PRIx64 R"(","args":{)", event.id);
+        }
+        snprintf(line + n, sizeof(line) - n, R"("arg1":%)" PRIu64 R"(,"arg2":%)" PRIu64 R"(,"arg3":%)" PRIu64 "}},\n",
+                 event.args[0], event.args[1], event.args[2]);
+        out << line;
+      }
+    }
+  }
+
+ private:
+  static SignpostThreadBuffer* threadBuffer()
+  {
+    static thread_local SignpostThreadBuffer* buffer = nullptr;
+    if (buffer == nullptr) {
+      std::lock_guard<std::mutex> lock(gDPLSignpostRecorder.mutex);
+      auto& buffers = gDPLSignpostRecorder.buffers;
+      buffers.emplace_back(std::make_unique<SignpostThreadBuffer>(gDPLSignpostRecorder.eventsPerThread, buffers.size()));
+      buffer = buffers.back().get();
+    }
+    return buffer;
+  }
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_SIGNPOSTRECORDER_H_
@@ -0,0 +1,108 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test Framework SignpostRecorder
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#define O2_SIGNPOST_DEFINE_CONTEXT
+#include "Framework/Signpost.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace o2::framework;
+
+namespace
+{
+size_t countOf(std::string const& s, std::string const& what)
+{
+  size_t count = 0;
+  for (auto pos = s.find(what); pos != std::string::npos; pos = s.find(what, pos + 1)) {
+    ++count;
+  }
+  return count;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestSignpostRecorder)
+{
+  // Nothing is kept while disabled
+  BOOST_CHECK(SignpostRecorder::enabled() == false);
+  O2_SIGNPOST(disabled, 1, 2, 3, 4);
+
+  SignpostRecorder::enable(3);
+  BOOST_CHECK(SignpostRecorder::enabled());
+  SignpostRecorder::record('b', "interval", 7, 1, 2, 3);
+  SignpostRecorder::record('e', "interval", 7, 1, 2, 3);
+  std::thread other([]() {
+    // Only the last 4 are kept
+    for (int i = 0; i < 10; ++i) {
+      SignpostRecorder::record('i', "point", i, 0, 0, 0);
+    }
+  });
+  other.join();
+  SignpostRecorder::disable();
+
+  std::ostringstream out;
+  SignpostRecorder::writeChromeTraceEvents(out, 42, "a \"device\"");
+  auto trace = out.str();
+  BOOST_CHECK_EQUAL(countOf(trace, "\n"), 1 + 2 + 4);
+  BOOST_CHECK_EQUAL(countOf(trace, R"("args":{"name":"a \"device\""})"), 1);
+  BOOST_CHECK_EQUAL(countOf(trace, R"("name":"interval","cat":"dpl","ph":"b")"), 1);
+  BOOST_CHECK_EQUAL(countOf(trace, R"("name":"interval","cat":"dpl","ph":"e")"), 1);
+  BOOST_CHECK_EQUAL(countOf(trace, R"("id":"0x7","args":{"arg1":1,"arg2":2,"arg3":3})"), 2);
+  BOOST_CHECK_EQUAL(countOf(trace, R"("name":"point")"), 4);
+  BOOST_CHECK_EQUAL(countOf(trace, R"("tid":1)"), 4);
+  BOOST_CHECK_EQUAL(countOf(trace, R"("arg0":5,)"), 0);
+  BOOST_CHECK_EQUAL(countOf(trace, R"("arg0":6,)"), 1);
+  BOOST_CHECK_EQUAL(countOf(trace, R"("arg0":9,)"), 1);
+  BOOST_CHECK_EQUAL(countOf(trace, "disabled"), 0);
+}
+
+#if !defined(__APPLE__)
+BOOST_AUTO_TEST_CASE(TestSignpostMacros)
+{
+  SignpostRecorder::enable();
+  O2_SIGNPOST(O2_TEST_POINT, 1, 2, 3, 4);
+  O2_SIGNPOST_START(O2_TEST_INTERVAL, 5, 6, 7, O2_SIGNPOST_GREEN);
+  O2_SIGNPOST_END(O2_TEST_INTERVAL, 5, 6, 7, O2_SIGNPOST_GREEN);
+  SignpostRecorder::disable();
+
+  std::ostringstream out;
+  SignpostRecorder::writeChromeTraceEvents(out, 42, "device");
+  auto trace = out.str();
+  BOOST_CHECK_EQUAL(countOf(trace, R"("name":"O2_TEST_POINT","cat":"dpl","ph":"i")"), 1);
+  BOOST_CHECK_EQUAL(countOf(trace, R"("args":{"arg0":1,"arg1":2,"arg2":3,"arg3":4})"), 1);
+  BOOST_CHECK_EQUAL(countOf(trace, R"("name":"O2_TEST_INTERVAL")"), 2);
+  BOOST_CHECK_EQUAL(countOf(trace, R"("id":"0x5","args":{"arg1":6,"arg2":7,"arg3":1})"), 2);
+}
+
+// Probes are usually #defined to a number, like O2_PROBE_RELAY. The name
+// must be the one of the probe, not its value.
+#define O2_TEST_DEFINED_PROBE 42
+BOOST_AUTO_TEST_CASE(TestSignpostDefinedProbe)
+{
+  SignpostRecorder::enable();
+  O2_SIGNPOST(O2_TEST_DEFINED_PROBE, 1, 2, 3, 4);
+  O2_SIGNPOST_START(O2_TEST_DEFINED_PROBE, 5, 6, 7, O2_SIGNPOST_GREEN);
+  O2_SIGNPOST_END(O2_TEST_DEFINED_PROBE, 5, 6, 7, O2_SIGNPOST_GREEN);
+  SignpostRecorder::disable();
+
+  std::ostringstream out;
+  SignpostRecorder::writeChromeTraceEvents(out, 42, "device");
+  auto trace = out.str();
+  BOOST_CHECK_EQUAL(countOf(trace, R"("name":"O2_TEST_DEFINED_PROBE","cat":"dpl","ph":"i")"), 1);
+  BOOST_CHECK_EQUAL(countOf(trace, R"("name":"O2_TEST_DEFINED_PROBE","cat":"dpl","ph":"b")"), 1);
+  BOOST_CHECK_EQUAL(countOf(trace, R"("name":"O2_TEST_DEFINED_PROBE","cat":"dpl","ph":"e")"), 1);
+  BOOST_CHECK_EQUAL(countOf(trace, R"("name":"42")"), 0);
+}
+#endif
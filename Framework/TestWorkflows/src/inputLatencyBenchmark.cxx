@@ -0,0 +1,124 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// A chain of pass-through devices to measure the end-to-end latency of
+/// a low rate stream. Compare the input polling strategies with e.g.
+///
+///   o2-testworkflows-input-latency-benchmark --input-polling backoff
+///   o2-testworkflows-input-latency-benchmark --input-polling event
+
+#include "Framework/ConfigParamSpec.h"
+
+#include <vector>
+
+using namespace o2::framework;
+
+// we need to add workflow options before including Framework/runDataProcessing
+void customize(std::vector<ConfigParamSpec>& workflowOptions)
+{
+  workflowOptions.push_back(ConfigParamSpec{"chain-length", VariantType::Int, 5, {"number of pass-through devices"}});
+  workflowOptions.push_back(ConfigParamSpec{"messages", VariantType::Int, 1000, {"number of messages to send"}});
+  workflowOptions.push_back(ConfigParamSpec{"period-us", VariantType::Int, 10000, {"time between two messages (in us)"}});
+}
+
+#include "Framework/ControlService.h"
+#include "Framework/Logger.h"
+#include "Framework/runDataProcessing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace o2::framework;
+using SubSpec = o2::header::DataHeader::SubSpecificationType;
+
+namespace
+{
+int64_t nowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+} // namespace
+
+// clang-format off
+WorkflowSpec defineDataProcessing(ConfigContext const& config)
+{
+  int chainLength = config.options().get<int>("chain-length");
+  int messages = config.options().get<int>("messages");
+  auto period = std::chrono::microseconds(config.options().get<int>("period-us"));
+
+  WorkflowSpec specs;
+
+  specs.push_back(DataProcessorSpec{
+    "latencySource",
+    Inputs{},
+    Outputs{OutputSpec{"TST", "TIMESTAMP", 0}},
+    AlgorithmSpec{
+      (AlgorithmSpec::InitCallback)[=](InitContext&) {
+        auto sent = std::make_shared<int>(0);
+        return (AlgorithmSpec::ProcessCallback)[=](ProcessingContext& pctx) {
+          if (*sent >= messages) {
+            return;
+          }
+          std::this_thread::sleep_for(period);
+          pctx.outputs().snapshot(Output{"TST", "TIMESTAMP", 0}, nowNs());
+          if (++(*sent) == messages) {
+            pctx.services().get<ControlService>().endOfStream();
+            pctx.services().get<ControlService>().readyToQuit(QuitRequest::Me);
+          }
+        };
+      }}});
+
+  for (int i = 0; i < chainLength; i++) {
+    specs.push_back(DataProcessorSpec{
+      "latencyRelay" + std::to_string(i),
+      Inputs{InputSpec{"in", "TST", "TIMESTAMP", static_cast<SubSpec>(i)}},
+      Outputs{OutputSpec{"TST", "TIMESTAMP", static_cast<SubSpec>(i + 1)}},
+      AlgorithmSpec{
+        [i](ProcessingContext& pctx) {
+          auto timestamp = pctx.inputs().get<int64_t>("in");
+          pctx.outputs().snapshot(Output{"TST", "TIMESTAMP", static_cast<SubSpec>(i + 1)}, timestamp);
+        }}});
+  }
+
+  specs.push_back(DataProcessorSpec{
+    "latencySink",
+    Inputs{InputSpec{"in", "TST", "TIMESTAMP", static_cast<SubSpec>(chainLength)}},
+    Outputs{},
+    AlgorithmSpec{
+      (AlgorithmSpec::InitCallback)[=](InitContext&) {
+        auto latencies = std::make_shared<std::vector<int64_t>>();
+        latencies->reserve(messages);
+        return (AlgorithmSpec::ProcessCallback)[=](ProcessingContext& pctx) {
+          latencies->push_back(nowNs() - pctx.inputs().get<int64_t>("in"));
+          if (latencies->size() != static_cast<size_t>(messages)) {
+            return;
+          }
+          std::sort(latencies->begin(), latencies->end());
+          double mean = 0.;
+          for (auto l : *latencies) {
+            mean += l;
+          }
+          mean /= latencies->size();
+          auto percentile = [&latencies](double p) {
+            return (*latencies)[static_cast<size_t>(p * (latencies->size() - 1))] / 1000.;
+          };
+          LOG(INFO) << "Latency over " << latencies->size() << " messages and " << chainLength
+                    << " hops (us): mean " << mean / 1000. << ", median " << percentile(0.5)
+                    << ", 99% " << percentile(0.99) << ", max " << latencies->back() / 1000.;
+          pctx.services().get<ControlService>().readyToQuit(QuitRequest::All);
+        };
+      }}});
+
+  return specs;
+}
+// clang-format on
@@ -21,6 +21,7 @@
 #include "Framework/DataProcessorSpec.h"
 #include "Framework/CallbackService.h"
 #include "Framework/ControlService.h"
+#include <Monitoring/Monitoring.h>
 #include <algorithm>
 #include <vector>
 #include <string>
@@ -65,6 +66,15 @@ namespace framework
 ///     --treename
 ///     --nevents
 ///     --terminate
+///     --async-queue      (max number of entries queued for the I/O thread, 0: synchronous writing)
+///     --implicit-mt      (ROOT implicit MT threads for the compression in asynchronous mode,
+///                         enabled for the whole process)
+///     --compression      (ROOT compression settings 100 * algorithm + level, -1: default)
+///     --basket-size      (basket size of the branches, 0: default)
+///
+/// \par
+/// The writer sends the metrics \c writer/queue_depth and \c writer/rate_MBs (rate of
+/// the data written to the file).
 ///
 /// \par
 /// In addition to that, a custom option can be added for every branch to configure the
@@ -327,6 +337,16 @@ class MakeRootTreeWriterSpec
         processAttributes->writer->setBranchName(branchIndex, branchName.c_str());
       }
       processAttributes->writer->init(filename.c_str(), treename.c_str());
+      processAttributes->writer->setCompression(ic.options().get<int>("compression"));
+      processAttributes->writer->setBasketSize(ic.options().get<int>("basket-size"));
+      auto queueDepth = ic.options().get<int>("async-queue");
+      auto nIMTThreads = ic.options().get<int>("implicit-mt");
+      if (queueDepth > 0 && nIMTThreads != 0) {
+        // explicitly requested, note that this applies to all ROOT operations of the process
+        LOG(INFO) << "enabling ROOT implicit MT for the whole process";
+        ROOT::EnableImplicitMT(nIMTThreads > 0 ? nIMTThreads : 0);
+      }
+      processAttributes->writer->setAsync(queueDepth > 0 ? queueDepth : 0, nIMTThreads != 0);
 
       // the callback to be set as hook at stop of processing for the framework
       auto finishWriting = [processAttributes]() {
@@ -388,6 +408,10 @@ class MakeRootTreeWriterSpec
         if (checkProcessing(pc.inputs())) {
           (*writer)(pc.inputs());
           counter = counter + 1;
+          auto statistics = writer->getStatistics();
+          auto& monitoring = pc.services().get<o2::monitoring::Monitoring>();
+          monitoring.send({(int)statistics.queueDepth, "writer/queue_depth"});
+          monitoring.send({statistics.rateMBs(), "writer/rate_MBs"});
         }
 
         if ((nEvents >= 0 && counter == nEvents) || checkReady(pc.inputs())) {
@@ -405,6 +429,10 @@ class MakeRootTreeWriterSpec
       {"treename", VariantType::String, mDefaultTreeName.c_str(), {"Name of tree"}},
       {"nevents", VariantType::Int, mDefaultNofEvents, {"Number of events to execute"}},
       {"terminate", VariantType::String, mDefaultTerminationPolicy.c_str(), {"Terminate the 'process' or 'workflow'"}},
+      {"async-queue", VariantType::Int, 0, {"Max number of entries queued for the I/O thread, 0: synchronous writing"}},
+      {"implicit-mt", VariantType::Int, 0, {"Number of ROOT implicit MT threads (process wide) for asynchronous writing, 0: off, -1: ROOT default"}},
+      {"compression", VariantType::Int, -1, {"ROOT compression settings (100 * algorithm + level), -1: default"}},
+      {"basket-size", VariantType::Int, 0, {"Basket size of the branches, 0: default"}},
     };
     for (size_t branchIndex = 0; branchIndex < mBranchNameOptions.size(); branchIndex++) {
       // adding option definitions for those ones defined in the branch definition
@@ -18,10 +18,12 @@
 #include "Framework/RootSerializationSupport.h"
 #include "Framework/InputRecord.h"
 #include "Framework/DataRef.h"
+#include "Headers/DataHeader.h"
 #include <TFile.h>
 #include <TTree.h>
 #include <TBranch.h>
 #include <TClass.h>
+#include <TROOT.h>
 #include <vector>
 #include <functional>
 #include <string>
@@ -32,6 +34,12 @@
 #include <functional> // std::function
 #include <utility>    // std::forward
 #include <algorithm>  // std::generate
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 namespace o2
 {
@@ -81,6 +89,17 @@ namespace framework
 /// as a \c std::vector<char>, this ensures separation on event basis as well as having binary
 /// data in parallel to ROOT objects in the same file, e.g. a binary data format from the
 /// reconstruction in parallel to MC labels.
+///
+/// \par Asynchronous writing:
+/// By default, the branches are filled directly in the processing call. With
+/// \ref setAsync, the objects extracted from the inputs are handed over to a dedicated
+/// I/O thread which fills the branches, i.e. does the compression and the disk writes,
+/// while the processing continues. The queue between the two is bounded, the processing
+/// call blocks if the I/O thread falls behind by more than the configured number of entries.
+/// Compression settings and basket size can be configured independently of the mode, the
+/// queue depth and the write rate can be retrieved with \ref getStatistics.
+/// The writer does not change the ROOT implicit multithreading, which is process wide: it
+/// can only make use of it if enabled by the caller.
 class RootTreeWriter
 {
  public:
@@ -91,6 +110,27 @@ class RootTreeWriter
   using IndexExtractor = std::function<size_t(o2::framework::DataRef const&)>;
   // mapper between branch name and base/index
   using BranchNameMapper = std::function<std::string(std::string, size_t)>;
+  // a deferred branch fill, returns the number of bytes filled
+  using FillFunction = std::function<int()>;
+  // all branch fills of one processing call
+  using FillEntry = std::vector<FillFunction>;
+
+  /// statistics of the written data
+  struct Statistics {
+    /// number of processed entries
+    size_t entries = 0;
+    /// number of filled bytes (uncompressed)
+    size_t bytes = 0;
+    /// number of bytes written to the file (compressed baskets)
+    size_t bytesWritten = 0;
+    /// time spent in filling the branches and writing the baskets, in seconds
+    double fillTime = 0.;
+    /// number of entries waiting in the queue of the I/O thread
+    size_t queueDepth = 0;
+
+    /// rate of the writing to the file in MB/s
+    double rateMBs() const { return fillTime > 0. ? bytesWritten / fillTime / 1.e6 : 0.; }
+  };
 
   /// DefaultKeyExtractor maps a data type used as key in the branch definition
   /// to the default internal key type std::string
@@ -190,6 +230,11 @@ class RootTreeWriter
     }
   }
 
+  ~RootTreeWriter()
+  {
+    stopIOThread();
+  }
+
   /// Init the output file and tree.
   /// @param filename output file
   /// @param treename output tree
@@ -201,6 +246,47 @@ class RootTreeWriter
     mFile = std::make_unique<TFile>(filename, "RECREATE");
     mTree = std::make_unique<TTree>(treename, treename);
     mTreeStructure->setup(mBranchSpecs, mTree.get());
+    applyOutputSettings();
+  }
+
+  /// Enable the asynchronous mode with an I/O thread filling the branches
+  /// @param queueDepth    max number of entries waiting for the I/O thread, 0 disables the
+  ///                      asynchronous mode, 2 corresponds to double buffering
+  /// @param useImplicitMT compress the baskets of different branches in parallel with the
+  ///                      ROOT implicit multithreading, which must have been enabled by the
+  ///                      caller with ROOT::EnableImplicitMT, ignored otherwise
+  /// Must be called before the first processing call.
+  void setAsync(size_t queueDepth, bool useImplicitMT = false)
+  {
+    if (mStatistics.entries > 0) {
+      throw std::runtime_error("asynchronous mode must be set before processing");
+    }
+    mQueueDepth = queueDepth;
+    mUseImplicitMT = useImplicitMT;
+  }
+
+  /// Set the compression settings of the output file in the ROOT convention,
+  /// i.e. 100 * algorithm + level, a negative value keeps the default
+  void setCompression(int settings)
+  {
+    mCompressionSettings = settings;
+    applyOutputSettings();
+  }
+
+  /// Set the basket size of all branches, 0 keeps the default
+  void setBasketSize(int size)
+  {
+    mBasketSize = size;
+    applyOutputSettings();
+  }
+
+  /// Get statistics about the written data, can be called at any time from the processing thread
+  Statistics getStatistics() const
+  {
+    std::lock_guard<std::mutex> lock(mIOMutex);
+    Statistics statistics = mStatistics;
+    statistics.queueDepth = mIOQueue.size();
+    return statistics;
   }
 
   /// Set the branch name for a branch definition from the constructor argument list
@@ -232,8 +318,22 @@ class RootTreeWriter
     if (!mTree || !mFile || mFile->IsZombie()) {
       throw std::runtime_error("Writer is invalid state, probably closed previously");
     }
-    // execute tree structure handlers and fill the individual branches
-    mTreeStructure->exec(std::forward<ContextType>(context), mBranchSpecs);
+    if (mQueueDepth == 0) {
+      // execute tree structure handlers and fill the individual branches
+      auto start = std::chrono::steady_clock::now();
+      auto written = mFile->GetBytesWritten();
+      size_t bytes = mTreeStructure->exec(std::forward<ContextType>(context), mBranchSpecs, nullptr);
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      mStatistics.entries++;
+      mStatistics.bytes += bytes;
+      mStatistics.bytesWritten += mFile->GetBytesWritten() - written;
+      mStatistics.fillTime += elapsed.count();
+    } else {
+      // extract the objects and pass the filling to the I/O thread
+      FillEntry entry;
+      mTreeStructure->exec(std::forward<ContextType>(context), mBranchSpecs, &entry);
+      enqueue(std::move(entry));
+    }
     // Note: number of entries will be set when closing the writer
   }
 
@@ -242,17 +342,30 @@ class RootTreeWriter
   void close()
   {
     mIsClosed = true;
+    // all pending entries are filled before the tree is written
+    stopIOThread();
     if (!mFile) {
       return;
     }
     // set the number of elements according to branch content and write tree
+    auto start = std::chrono::steady_clock::now();
+    auto written = mFile->GetBytesWritten();
     mTree->SetEntries();
     mTree->Write();
     mFile->Close();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    {
+      std::lock_guard<std::mutex> lock(mIOMutex);
+      mStatistics.bytesWritten += mFile->GetBytesWritten() - written;
+      mStatistics.fillTime += elapsed.count();
+    }
     // this is a feature of ROOT, the tree belongs to the file and will be deleted
     // automatically
     mTree.release();
     mFile.reset(nullptr);
+    if (mIOException) {
+      std::rethrow_exception(std::exchange(mIOException, nullptr));
+    }
   }
 
   bool isClosed() const
@@ -294,7 +407,10 @@ class RootTreeWriter
     /// enters at the outermost element and recurses to the base elements
     /// Read the configured inputs from the input context, select the output branch
     /// and write the object
-    virtual void exec(InputContext&, std::vector<BranchSpec>&) {}
+    /// If a FillEntry is provided, the filling of the branches is deferred and the
+    /// fill functions are added to the entry, otherwise the branches are filled directly
+    /// and the number of filled bytes is returned
+    virtual size_t exec(InputContext&, std::vector<BranchSpec>&, FillEntry*) { return 0; }
     /// get the size of the branch structure, i.e. the number of registered branch
     /// definitions
     virtual size_t size() const { return STAGE; }
@@ -302,7 +418,7 @@ class RootTreeWriter
     // a dummy method called in the recursive processing
     void setupInstance(std::vector<BranchSpec>&, TTree*) {}
     // a dummy method called in the recursive processing
-    void process(InputContext&, std::vector<BranchSpec>&) {}
+    size_t process(InputContext&, std::vector<BranchSpec>&, FillEntry*) { return 0; }
   };
 
   template <typename T = char>
@@ -395,9 +511,9 @@ class RootTreeWriter
 
     // this is the polymorphic entry point for processing of branch specs
     // recursive processing starting from the highest instance
-    void exec(InputContext& context, std::vector<BranchSpec>& specs) override
+    size_t exec(InputContext& context, std::vector<BranchSpec>& specs, FillEntry* deferred) override
     {
-      process(context, specs);
+      return process(context, specs, deferred);
     }
     size_t size() const override { return STAGE; }
 
@@ -458,14 +574,43 @@ class RootTreeWriter
       }
     }
 
+    // Note on the fill functions: all objects are owned by the returned function, so that
+    // the filling can be deferred to the I/O thread in asynchronous mode. All accesses to the
+    // store variables happen in the fill function, i.e. from only one thread at a time.
+
+    // check if the object has been deserialized from the message, in that case the InputRecord
+    // returns an owning pointer, otherwise it points to the message payload
+    static bool isROOTSerialized(DataRef const& ref)
+    {
+      auto header = o2::header::get<const o2::header::DataHeader*>(ref.header);
+      return header->payloadSerializationMethod == o2::header::gSerializationMethodROOT;
+    }
+
+    // take ownership of the extracted object, a copy is needed for the deferred filling
+    // if the object points to the message payload
+    template <typename PtrT>
+    static std::shared_ptr<value_type const> makeOwning(PtrT&& data, DataRef const& ref, bool deferred)
+    {
+      if (!deferred || isROOTSerialized(ref)) {
+        return std::shared_ptr<value_type const>(std::move(data));
+      }
+      if constexpr (std::is_copy_constructible<value_type>::value) {
+        return std::make_shared<value_type>(*data);
+      } else {
+        throw std::runtime_error(std::string("asynchronous writing requires copyable type for unserialized ") + typeid(value_type).name());
+      }
+    }
+
     // specialization for trivial structs or serialized objects without a TClass interface
     // the extracted object is copied to store variable
     template <typename S, typename std::enable_if_t<std::is_same<S, MessageableTypeSpecialization>::value, int> = 0>
-    void fillData(InputContext& context, DataRef const& ref, TBranch* branch, size_t branchIdx)
+    FillFunction fillData(InputContext& context, DataRef const& ref, TBranch* branch, size_t branchIdx, bool /*deferred*/)
     {
       auto data = context.get<value_type>(ref);
-      mStore[branchIdx] = data;
-      branch->Fill();
+      return [this, data, branch, branchIdx]() {
+        mStore[branchIdx] = data;
+        return branch->Fill();
+      };
     }
 
     // specialization for non-messageable types with ROOT dictionary
@@ -473,62 +618,68 @@ class RootTreeWriter
     // in order to directly use the pointer to extracted object
     // store is a pointer to object
     template <typename S, typename std::enable_if_t<std::is_same<S, ROOTTypeSpecialization>::value, int> = 0>
-    void fillData(InputContext& context, DataRef const& ref, TBranch* branch, size_t branchIdx)
+    FillFunction fillData(InputContext& context, DataRef const& ref, TBranch* branch, size_t branchIdx, bool deferred)
     {
-      auto data = context.get<typename std::add_pointer<value_type>::type>(ref);
-      // this is ugly but necessary because of the TTree API does not allow a const
-      // object as input. Have to rely on that ROOT treats the object as const
-      mStore[branchIdx] = const_cast<value_type*>(data.get());
-      branch->Fill();
+      auto data = makeOwning(context.get<typename std::add_pointer<value_type>::type>(ref), ref, deferred);
+      return [this, data, branch, branchIdx]() {
+        // this is ugly but necessary because of the TTree API does not allow a const
+        // object as input. Have to rely on that ROOT treats the object as const
+        mStore[branchIdx] = const_cast<value_type*>(data.get());
+        return branch->Fill();
+      };
     }
 
     // specialization for binary buffers using const char*
     // this writes both the data branch and a size branch
     template <typename S, typename std::enable_if_t<std::is_same<S, BinaryBranchSpecialization>::value, int> = 0>
-    void fillData(InputContext& context, DataRef const& ref, TBranch* branch, size_t branchIdx)
+    FillFunction fillData(InputContext& context, DataRef const& ref, TBranch* branch, size_t branchIdx, bool /*deferred*/)
     {
       auto data = context.get<gsl::span<char>>(ref);
-      std::get<2>(mStore.at(branchIdx)) = data.size();
-      std::get<1>(mStore.at(branchIdx))->Fill();
-      std::get<0>(mStore.at(branchIdx)).resize(data.size());
-      memcpy(std::get<0>(mStore.at(branchIdx)).data(), data.data(), data.size());
-      branch->Fill();
+      std::vector<char> buffer(data.begin(), data.end());
+      return [this, buffer = std::move(buffer), branch, branchIdx]() mutable {
+        auto& store = mStore.at(branchIdx);
+        std::get<2>(store) = buffer.size();
+        int nBytes = std::get<1>(store)->Fill();
+        std::get<0>(store).swap(buffer);
+        return nBytes + branch->Fill();
+      };
     }
 
     // specialization for vectors of messageable types
     template <typename S, typename std::enable_if_t<std::is_same<S, MessageableVectorSpecialization>::value, int> = 0>
-    void fillData(InputContext& context, DataRef const& ref, TBranch* branch, size_t branchIdx)
+    FillFunction fillData(InputContext& context, DataRef const& ref, TBranch* branch, size_t branchIdx, bool deferred)
     {
       using ValueType = typename value_type::value_type;
       static_assert(is_messageable<ValueType>::value, "logical error: should be correctly selected by StructureElementTypeTrait");
+      std::shared_ptr<value_type const> data;
       // if the value type is messagable and has a ROOT dictionary, two serialization methods are possible
       // for the moment, the InputRecord API can not handle both with the same call
       try {
         // try extracting from message with serialization method NONE, throw runtime error
         // if message is serialized
-        auto data = context.get<gsl::span<ValueType>>(ref);
-        value_type clone(data.begin(), data.end());
-        mStore[branchIdx] = &clone;
-        branch->Fill();
+        auto span = context.get<gsl::span<ValueType>>(ref);
+        data = std::make_shared<value_type>(span.begin(), span.end());
       } catch (const std::runtime_error& e) {
         if constexpr (has_root_dictionary<value_type>::value == true) {
           // try extracting from message with serialization method ROOT
-          auto data = context.get<typename std::add_pointer<value_type>::type>(ref);
-          mStore[branchIdx] = const_cast<value_type*>(data.get());
-          branch->Fill();
+          data = makeOwning(context.get<typename std::add_pointer<value_type>::type>(ref), ref, deferred);
         } else {
           // the type has no ROOT dictionary, re-throw exception
           throw e;
         }
       }
+      return [this, data, branch, branchIdx]() {
+        mStore[branchIdx] = const_cast<value_type*>(data.get());
+        return branch->Fill();
+      };
     }
 
     // process previous stage and this stage
-    void process(InputContext& context, std::vector<BranchSpec>& specs)
+    size_t process(InputContext& context, std::vector<BranchSpec>& specs, FillEntry* deferred)
     {
       // recursing through the tree structure by simply using method of the previous type,
       // i.e. the base class method.
-      PrevT::process(context, specs);
+      size_t bytes = PrevT::process(context, specs, deferred);
       constexpr size_t SpecIndex = STAGE - 1;
       BranchSpec const& spec = specs[SpecIndex];
       // loop over all defined inputs
@@ -545,9 +696,15 @@ class RootTreeWriter
               continue;
             }
           }
-          fillData<specialization_id>(context, dataref, spec.branches.at(branchIdx), branchIdx);
+          auto fill = fillData<specialization_id>(context, dataref, spec.branches.at(branchIdx), branchIdx, deferred != nullptr);
+          if (deferred) {
+            deferred->emplace_back(std::move(fill));
+          } else {
+            bytes += fill();
+          }
         }
       }
+      return bytes;
     }
 
    private:
@@ -601,6 +758,119 @@ class RootTreeWriter
     return std::move(ret);
   }
 
+  /// apply compression and basket size to file and branches
+  void applyOutputSettings()
+  {
+    if (!mFile || !mTree) {
+      return;
+    }
+    if (mCompressionSettings >= 0) {
+      mFile->SetCompressionSettings(mCompressionSettings);
+      // the branches take the settings of the file at creation
+      TIter next(mTree->GetListOfBranches());
+      while (auto* branch = static_cast<TBranch*>(next())) {
+        branch->SetCompressionSettings(mCompressionSettings);
+      }
+    }
+    if (mBasketSize > 0) {
+      mTree->SetBasketSize("*", mBasketSize);
+    }
+  }
+
+  /// add an entry to the queue of the I/O thread, blocks if the queue is full
+  void enqueue(FillEntry&& entry)
+  {
+    if (!mIOThread.joinable()) {
+      startIOThread();
+    }
+    std::unique_lock<std::mutex> lock(mIOMutex);
+    mIOCondition.wait(lock, [this]() { return mIOQueue.size() < mQueueDepth || mIOException; });
+    if (mIOException) {
+      lock.unlock();
+      stopIOThread();
+      std::rethrow_exception(std::exchange(mIOException, nullptr));
+    }
+    mIOQueue.emplace_back(std::move(entry));
+    mIOCondition.notify_all();
+  }
+
+  void startIOThread()
+  {
+    // objects are deserialized in the processing thread while the I/O thread is
+    // streaming to the tree
+    ROOT::EnableThreadSafety();
+    if (mUseImplicitMT && ROOT::IsImplicitMTEnabled()) {
+      mTree->SetImplicitMT(true);
+      // the baskets are flushed (and compressed in parallel) before they are full,
+      // otherwise they are compressed one by one in the branch fill
+      mIMTFlushBytes = mTree->GetListOfBranches()->GetEntries() * (mBasketSize > 0 ? mBasketSize : 32000) / 2;
+    }
+    mIOStop = false;
+    mIOThread = std::thread([this]() { runIOThread(); });
+  }
+
+  /// let the I/O thread process all pending entries and terminate
+  void stopIOThread()
+  {
+    if (!mIOThread.joinable()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mIOMutex);
+      mIOStop = true;
+    }
+    mIOCondition.notify_all();
+    mIOThread.join();
+  }
+
+  void runIOThread()
+  {
+    std::unique_lock<std::mutex> lock(mIOMutex);
+    while (true) {
+      mIOCondition.wait(lock, [this]() { return !mIOQueue.empty() || mIOStop; });
+      if (mIOQueue.empty()) {
+        // stop has been requested and all entries are processed
+        break;
+      }
+      // the entry stays in the queue until processed, so the queue depth
+      // includes the entry being filled
+      FillEntry& entry = mIOQueue.front();
+      lock.unlock();
+      size_t bytes = 0;
+      std::exception_ptr exception;
+      auto start = std::chrono::steady_clock::now();
+      auto written = mFile->GetBytesWritten();
+      try {
+        for (auto& fill : entry) {
+          bytes += fill();
+        }
+      } catch (...) {
+        exception = std::current_exception();
+      }
+      mIMTUnflushedBytes += bytes;
+      if (mIMTFlushBytes > 0 && mIMTUnflushedBytes >= mIMTFlushBytes && !exception) {
+        mTree->FlushBaskets();
+        mIMTUnflushedBytes = 0;
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      written = mFile->GetBytesWritten() - written;
+      lock.lock();
+      mIOQueue.pop_front();
+      mStatistics.entries++;
+      mStatistics.bytes += bytes;
+      mStatistics.bytesWritten += written;
+      mStatistics.fillTime += elapsed.count();
+      mIOCondition.notify_all();
+      if (exception) {
+        // the processing thread rethrows, the remaining entries are dropped
+        mIOException = exception;
+        mIOQueue.clear();
+        mIOCondition.notify_all();
+        break;
+      }
+    }
+  }
+
   /// the output file
   std::unique_ptr<TFile> mFile;
   /// the output tree
@@ -611,6 +881,26 @@ class RootTreeWriter
   std::unique_ptr<TreeStructureInterface> mTreeStructure;
   /// indicate that the writer has been closed
   bool mIsClosed = false;
+  /// compression settings, 100 * algorithm + level
+  int mCompressionSettings = -1;
+  /// basket size of all branches
+  int mBasketSize = 0;
+  /// max number of entries in the queue of the I/O thread, 0 for synchronous mode
+  size_t mQueueDepth = 0;
+  /// use the ROOT implicit MT, if enabled, in asynchronous mode
+  bool mUseImplicitMT = false;
+  /// with implicit MT, the baskets are flushed after this number of filled bytes
+  size_t mIMTFlushBytes = 0;
+  size_t mIMTUnflushedBytes = 0;
+  /// statistics, updated by the I/O thread in asynchronous mode
+  Statistics mStatistics;
+  /// the I/O thread and its queue of entries to fill
+  std::thread mIOThread;
+  std::deque<FillEntry> mIOQueue;
+  mutable std::mutex mIOMutex;
+  std::condition_variable mIOCondition;
+  bool mIOStop = false;
+  std::exception_ptr mIOException;
 };
 
 } // namespace framework
@@ -221,6 +221,114 @@ BOOST_AUTO_TEST_CASE(test_RootTreeWriter)
             BranchContent<decltype(trivvec)>{"srlzdvecbranch", trivvec});
 }
 
+BOOST_AUTO_TEST_CASE(test_RootTreeWriterAsync)
+{
+  std::string filename = "test_RootTreeWriterAsync.root";
+  const char* treename = "testtree";
+
+  using Container = std::vector<o2::test::Polymorphic>;
+  RootTreeWriter writer(nullptr, nullptr,
+                        RootTreeWriter::BranchDef<unsigned>{"input1", "intbranch"},
+                        RootTreeWriter::BranchDef<Container>{"input2", "containerbranch"},
+                        RootTreeWriter::BranchDef<const char*>{"input3", "binarybranch"},
+                        RootTreeWriter::BranchDef<std::vector<o2::test::TriviallyCopyable>>{"input4", "trivvecbranch"});
+  // double buffering, the output settings are applied to the already created branches
+  // implicit MT is requested but has not been enabled by the caller, the writer must not enable it
+  writer.setAsync(2, true);
+  writer.init(filename.c_str(), treename);
+  writer.setCompression(505);
+  writer.setBasketSize(64000);
+
+  auto transport = FairMQTransportFactory::CreateTransportFactory("zeromq");
+  std::vector<FairMQMessagePtr> store;
+
+  auto createMessage = [&transport, &store](DataHeader&& dh, const void* data, size_t size) {
+    dh.payloadSize = size;
+    dh.payloadSerializationMethod = o2::header::gSerializationMethodNone;
+    DataProcessingHeader dph{0, 1};
+    o2::header::Stack stack{dh, dph};
+    FairMQMessagePtr header = transport->CreateMessage(stack.size());
+    FairMQMessagePtr payload = transport->CreateMessage(size);
+    memcpy(header->GetData(), stack.data(), stack.size());
+    memcpy(payload->GetData(), data, size);
+    store.emplace_back(std::move(header));
+    store.emplace_back(std::move(payload));
+  };
+
+  auto createSerializedMessage = [&transport, &store](DataHeader&& dh, auto& data) {
+    FairMQMessagePtr payload = transport->CreateMessage();
+    auto* cl = TClass::GetClass(typeid(decltype(data)));
+    TMessageSerializer().Serialize(*payload, &data, cl);
+    dh.payloadSize = payload->GetSize();
+    dh.payloadSerializationMethod = o2::header::gSerializationMethodROOT;
+    DataProcessingHeader dph{0, 1};
+    o2::header::Stack stack{dh, dph};
+    FairMQMessagePtr header = transport->CreateMessage(stack.size());
+    memcpy(header->GetData(), stack.data(), stack.size());
+    store.emplace_back(std::move(header));
+    store.emplace_back(std::move(payload));
+  };
+
+  std::vector<InputRoute> schema = {
+    {InputSpec{"input1", "TST", "INT"}, 0, "input1", 0},       //
+    {InputSpec{"input2", "TST", "CONTAINER"}, 1, "input2", 0}, //
+    {InputSpec{"input3", "TST", "BINARY"}, 2, "input3", 0},    //
+    {InputSpec{"input4", "TST", "TRIV_VEC"}, 3, "input4", 0},  //
+  };
+
+  // every processing call gets new messages which are released right after the call,
+  // the writer must not refer to the message content when filling in the I/O thread
+  const unsigned nEntries = 10;
+  for (unsigned entry = 0; entry < nEntries; entry++) {
+    store.clear();
+    Container container{{entry}};
+    std::vector<o2::test::TriviallyCopyable> trivvec{{entry, 21, 42}, {1, 2, 3}};
+    createMessage(o2::header::DataHeader{"INT", "TST", 0}, &entry, sizeof(entry));
+    createSerializedMessage(o2::header::DataHeader{"CONTAINER", "TST", 0}, container);
+    createMessage(o2::header::DataHeader{"BINARY", "TST", 0}, &entry, sizeof(entry));
+    createMessage(o2::header::DataHeader{"TRIV_VEC", "TST", 0}, trivvec.data(), trivvec.size() * sizeof(o2::test::TriviallyCopyable));
+    auto getter = [&store](size_t i) -> DataRef {
+      return DataRef{nullptr, static_cast<char const*>(store[2 * i]->GetData()), static_cast<char const*>(store[2 * i + 1]->GetData())};
+    };
+    InputRecord inputs{schema, InputSpan{getter, store.size() / 2}};
+    writer(inputs);
+    BOOST_CHECK(writer.getStatistics().queueDepth <= 2);
+    // overwrite the released message memory to provoke errors if it is used by the writer
+    for (auto& msg : store) {
+      memset(msg->GetData(), 0xff, msg->GetSize());
+    }
+  }
+  writer.close();
+  BOOST_CHECK_EQUAL(writer.getStatistics().entries, nEntries);
+  BOOST_CHECK_EQUAL(writer.getStatistics().queueDepth, 0);
+  BOOST_CHECK(!ROOT::IsImplicitMTEnabled());
+  // the rate is given for the data which reached the file
+  BOOST_CHECK(writer.getStatistics().bytesWritten > 0);
+
+  std::unique_ptr<TFile> file(TFile::Open(filename.c_str()));
+  BOOST_REQUIRE(file != nullptr);
+  TTree* tree = reinterpret_cast<TTree*>(file->GetObjectChecked(treename, "TTree"));
+  BOOST_REQUIRE(tree != nullptr);
+  BOOST_REQUIRE_EQUAL(tree->GetEntries(), nEntries);
+  BOOST_CHECK_EQUAL(tree->GetBranch("intbranch")->GetCompressionSettings(), 505);
+  unsigned intValue = 0;
+  Container* container = nullptr;
+  std::vector<char>* binary = nullptr;
+  std::vector<o2::test::TriviallyCopyable>* trivvec = nullptr;
+  tree->SetBranchAddress("intbranch", &intValue);
+  tree->SetBranchAddress("containerbranch", &container);
+  tree->SetBranchAddress("binarybranch", &binary);
+  tree->SetBranchAddress("trivvecbranch", &trivvec);
+  for (unsigned entry = 0; entry < nEntries; entry++) {
+    tree->GetEntry(entry);
+    BOOST_CHECK_EQUAL(intValue, entry);
+    BOOST_CHECK(*container == Container{{entry}});
+    BOOST_REQUIRE_EQUAL(binary->size(), sizeof(unsigned));
+    BOOST_CHECK_EQUAL(*reinterpret_cast<unsigned*>(binary->data()), entry);
+    BOOST_CHECK(*trivvec == (std::vector<o2::test::TriviallyCopyable>{{entry, 21, 42}, {1, 2, 3}}));
+  }
+}
+
 template <typename T>
 using BranchDefinition = MakeRootTreeWriterSpec::BranchDefinition<T>;
 
@@ -11,6 +11,8 @@
 #include "SimulationDataFormat/DigitizationContext.h"
 #include "SimulationDataFormat/MCTrack.h"
 #include "SimulationDataFormat/MCCompLabel.h"
+#include <list>
+#include <utility>
 #include <vector>
 
 class TChain;
@@ -20,6 +22,11 @@ namespace o2
 namespace steer
 {
 
+// The kinematics is read event by event, on first access to an event. By default the
+// loaded events are kept in memory; with setMaxCachedEvents(n) at most n events are kept,
+// the least recently used one being dropped when a new event is loaded. In this case the
+// pointers/references returned by getTrack(s) stay valid only until an event is loaded
+// again (e.g. by the next getTrack call for an event which is not in memory).
 class MCKinematicsReader
 {
  public:
@@ -28,6 +35,20 @@ class MCKinematicsReader
     kMCKine
   };
 
+  /// counters of the event cache
+  struct CacheStatistics {
+    size_t nRequests = 0;      ///< number of getTrack(s) calls
+    size_t nEventsLoaded = 0;  ///< number of events read from the input
+    size_t nEventsDropped = 0; ///< number of events removed from the cache
+    size_t nPrefetched = 0;    ///< number of events read via prefetch
+    size_t nCachedEvents = 0;  ///< number of events currently in memory
+    size_t memory = 0;         ///< memory currently used by the cached tracks (bytes)
+    size_t memoryPeak = 0;     ///< max memory used by the cached tracks (bytes)
+    double loadTime = 0.;      ///< total time spent reading the events (s)
+
+    void print() const;
+  };
+
   /// default constructor
   MCKinematicsReader() = default;
 
@@ -71,6 +92,20 @@ class MCKinematicsReader
   /// variant returning all tracks for source and event at once
   std::vector<MCTrack> const& getTracks(int event) const;
 
+  /// hint that the events of the given labels will be requested soon: the events which
+  /// are not in memory are read in one go, in increasing order of their entries.
+  /// With a bounded cache only the first setMaxCachedEvents() of them are read.
+  void prefetch(std::vector<o2::MCCompLabel> const& labels) const;
+
+  /// set the max number of events kept in memory (0 = no limit, the default)
+  void setMaxCachedEvents(size_t n);
+  size_t getMaxCachedEvents() const { return mMaxCachedEvents; }
+
+  /// drop all events from memory
+  void clearCache() const;
+
+  CacheStatistics const& getCacheStatistics() const { return mCacheStat; }
+
   /// get all primaries for a certain event
 
   /// get all secondaries of the given label
@@ -78,19 +113,53 @@ class MCKinematicsReader
   /// get all mothers/daughters of the given label
 
  private:
-  void loadTracksForSource(int source) const;
+  using EventKey = std::pair<int, int>; // source, event
+
+  /// tracks of a single event, with its position in the LRU list if loaded
+  struct CachedEvent {
+    std::vector<o2::MCTrack> tracks;
+    std::list<EventKey>::iterator lruPos;
+    bool loaded = false;
+  };
+
+  /// tracks of the event, loading it if needed
+  std::vector<MCTrack> const& getEventTracks(int source, int event) const;
+  void initSource(int source) const;
+  void loadEvent(int source, int event) const;
+  void dropEvent(int source, int event) const;
 
   DigitizationContext const* mDigitizationContext = nullptr;
 
   // chains for each source
   std::vector<TChain*> mInputChains;
 
-  // a vector of tracks foreach source and each collision
-  mutable std::vector<std::vector<std::vector<o2::MCTrack>>> mTracks; // the in-memory track container
+  // branch buffers of each chain
+  mutable std::vector<std::vector<o2::MCTrack>*> mBranchBuffers; //!
+
+  // the in-memory track container, for each source and each collision
+  mutable std::vector<std::vector<CachedEvent>> mEvents; //!
+
+  // loaded events, most recently used first
+  mutable std::list<EventKey> mLRU; //!
+
+  size_t mMaxCachedEvents = 0;        // max number of events kept in memory, 0 = no limit
+  mutable CacheStatistics mCacheStat; //!
 
   bool mInitialized = false; // whether initialized
 };
 
+inline std::vector<MCTrack> const& MCKinematicsReader::getEventTracks(int source, int event) const
+{
+  mCacheStat.nRequests++;
+  auto& ev = mEvents[source][event];
+  if (!ev.loaded) {
+    loadEvent(source, event);
+  } else if (mMaxCachedEvents) {
+    mLRU.splice(mLRU.begin(), mLRU, ev.lruPos); // move to the front, iterators stay valid
+  }
+  return ev.tracks;
+}
+
 inline MCTrack const* MCKinematicsReader::getTrack(o2::MCCompLabel const& label) const
 {
   const auto source = label.getSourceID();
@@ -101,10 +170,10 @@ inline MCTrack const* MCKinematicsReader::getTrack(o2::MCCompLabel const& label)
 
 inline MCTrack const* MCKinematicsReader::getTrack(int source, int event, int track) const
 {
-  if (mTracks[source].size() == 0) {
-    loadTracksForSource(source);
+  if (mEvents[source].size() == 0) {
+    initSource(source);
   }
-  return &mTracks[source][event][track];
+  return &getEventTracks(source, event)[track];
 }
 
 inline MCTrack const* MCKinematicsReader::getTrack(int event, int track) const
@@ -114,10 +183,10 @@ inline MCTrack const* MCKinematicsReader::getTrack(int event, int track) const
 
 inline std::vector<MCTrack> const& MCKinematicsReader::getTracks(int source, int event) const
 {
-  if (mTracks[source].size() == 0) {
-    loadTracksForSource(source);
+  if (mEvents[source].size() == 0) {
+    initSource(source);
   }
-  return mTracks[source][event];
+  return getEventTracks(source, event);
 }
 
 inline std::vector<MCTrack> const& MCKinematicsReader::getTracks(int event) const
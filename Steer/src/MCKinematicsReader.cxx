@@ -11,30 +11,120 @@
 #include "DetectorsCommonDataFormats/NameConf.h"
 #include "Steer/MCKinematicsReader.h"
 #include <TChain.h>
+#include <algorithm>
+#include <chrono>
 #include <vector>
 #include "FairLogger.h"
 
 using namespace o2::steer;
 
-void MCKinematicsReader::loadTracksForSource(int source) const
+void MCKinematicsReader::initSource(int source) const
 {
   auto chain = mInputChains[source];
   if (chain) {
     // todo: get name from NameConfig
-    auto br = chain->GetBranch("MCTrack");
-    if (br) {
-      std::vector<MCTrack>* loadtracks = nullptr;
-      br->SetAddress(&loadtracks);
-      // load all kinematics
-      mTracks[source].resize(br->GetEntries());
-      for (int event = 0; event < br->GetEntries(); ++event) {
-        br->GetEntry(event);
-        mTracks[source][event] = *loadtracks;
-      }
+    if (!chain->GetBranch("MCTrack")) {
+      LOG(ERROR) << "No MCTrack branch for source " << source;
+      return;
     }
+    // only the tracks are read
+    chain->SetBranchStatus("*", 0);
+    chain->SetBranchStatus("MCTrack*", 1);
+    chain->SetBranchAddress("MCTrack", &mBranchBuffers[source]);
+    mEvents[source].resize(chain->GetEntries());
   }
 }
 
+void MCKinematicsReader::loadEvent(int source, int event) const
+{
+  // make room for the new event
+  if (mMaxCachedEvents) {
+    while (mLRU.size() >= mMaxCachedEvents) {
+      auto key = mLRU.back();
+      dropEvent(key.first, key.second);
+    }
+  }
+  auto tStart = std::chrono::steady_clock::now();
+  mInputChains[source]->GetEntry(event);
+  auto& ev = mEvents[source][event];
+  ev.tracks = std::move(*mBranchBuffers[source]);
+  mBranchBuffers[source]->clear(); // moved-from vector, make sure it is in a defined state
+  ev.loaded = true;
+  mLRU.push_front({source, event});
+  ev.lruPos = mLRU.begin();
+
+  mCacheStat.loadTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+  mCacheStat.nEventsLoaded++;
+  mCacheStat.nCachedEvents++;
+  mCacheStat.memory += ev.tracks.capacity() * sizeof(MCTrack);
+  mCacheStat.memoryPeak = std::max(mCacheStat.memoryPeak, mCacheStat.memory);
+}
+
+void MCKinematicsReader::dropEvent(int source, int event) const
+{
+  auto& ev = mEvents[source][event];
+  if (!ev.loaded) {
+    return;
+  }
+  mCacheStat.memory -= ev.tracks.capacity() * sizeof(MCTrack);
+  mCacheStat.nCachedEvents--;
+  mCacheStat.nEventsDropped++;
+  std::vector<MCTrack>().swap(ev.tracks); // release the memory
+  mLRU.erase(ev.lruPos);
+  ev.loaded = false;
+}
+
+void MCKinematicsReader::prefetch(std::vector<o2::MCCompLabel> const& labels) const
+{
+  std::vector<EventKey> toLoad;
+  for (const auto& label : labels) {
+    if (!label.isValid()) {
+      continue;
+    }
+    int source = label.getSourceID(), event = label.getEventID();
+    if (mEvents[source].size() == 0) {
+      initSource(source);
+    }
+    if (event < int(mEvents[source].size()) && !mEvents[source][event].loaded) {
+      toLoad.emplace_back(source, event);
+    }
+  }
+  // read each source sequentially, every event once
+  std::sort(toLoad.begin(), toLoad.end());
+  toLoad.erase(std::unique(toLoad.begin(), toLoad.end()), toLoad.end());
+  if (mMaxCachedEvents && toLoad.size() > mMaxCachedEvents) {
+    toLoad.resize(mMaxCachedEvents);
+  }
+  for (const auto& key : toLoad) {
+    loadEvent(key.first, key.second);
+  }
+  mCacheStat.nPrefetched += toLoad.size();
+}
+
+void MCKinematicsReader::setMaxCachedEvents(size_t n)
+{
+  mMaxCachedEvents = n;
+  while (mMaxCachedEvents && mLRU.size() > mMaxCachedEvents) {
+    auto key = mLRU.back();
+    dropEvent(key.first, key.second);
+  }
+}
+
+void MCKinematicsReader::clearCache() const
+{
+  while (!mLRU.empty()) {
+    auto key = mLRU.back();
+    dropEvent(key.first, key.second);
+  }
+}
+
+void MCKinematicsReader::CacheStatistics::print() const
+{
+  LOG(INFO) << "MCKinematicsReader: " << nRequests << " requests, " << nEventsLoaded << " events read (" << nPrefetched
+            << " prefetched) in " << loadTime << " s, " << nEventsDropped << " dropped, " << nCachedEvents
+            << " in memory using " << memory / 1024 << " kB (peak: " << memoryPeak / 1024 << " kB)";
+}
+
 bool MCKinematicsReader::initFromDigitContext(std::string_view name)
 {
   if (mInitialized) {
@@ -53,10 +143,11 @@ bool MCKinematicsReader::initFromDigitContext(std::string_view name)
   mDigitizationContext->initSimKinematicsChains(mInputChains);
 
   // load the kinematics information
-  mTracks.resize(mInputChains.size());
+  mEvents.resize(mInputChains.size());
+  mBranchBuffers.resize(mInputChains.size(), nullptr);
 
   // actual loading will be done only if someone asks
-  // the first time for a particular source ...
+  // the first time for a particular event ...
 
   return true;
 }
@@ -69,7 +160,8 @@ bool MCKinematicsReader::initFromKinematics(std::string_view name)
   }
   mInputChains.emplace_back(new TChain("o2sim"));
   mInputChains.back()->AddFile(o2::base::NameConf::getMCKinematicsFileName(name.data()).c_str());
-  mTracks.resize(1);
+  mEvents.resize(1);
+  mBranchBuffers.resize(1, nullptr);
   mInitialized = true;
 
   return true;
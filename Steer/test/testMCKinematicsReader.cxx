@@ -0,0 +1,76 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test MCKinematicsReader class
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "Steer/MCKinematicsReader.h"
+#include "DetectorsCommonDataFormats/NameConf.h"
+#include <TFile.h>
+#include <TTree.h>
+#include <vector>
+
+namespace o2
+{
+namespace steer
+{
+
+BOOST_AUTO_TEST_CASE(MCKinematicsReaderCache)
+{
+  // mockup kinematics: event i has i+1 tracks, the pdg code encoding event and track
+  const int nEvents = 20;
+  {
+    TFile file(o2::base::NameConf::getMCKinematicsFileName("kinetest").c_str(), "RECREATE");
+    TTree tree("o2sim", "");
+    std::vector<o2::MCTrack> tracks, *tracksPtr = &tracks;
+    tree.Branch("MCTrack", &tracksPtr);
+    for (int iev = 0; iev < nEvents; iev++) {
+      tracks.clear();
+      for (int it = 0; it <= iev; it++) {
+        tracks.emplace_back(iev * 100 + it, -1, 0., 0., 1., 0., 0., 0., 0., 0);
+      }
+      tree.Fill();
+    }
+    tree.Write();
+    file.Close();
+  }
+
+  MCKinematicsReader reader("kinetest", MCKinematicsReader::Mode::kMCKine);
+  BOOST_CHECK(reader.isInitialized());
+  reader.setMaxCachedEvents(4);
+
+  // random access
+  for (int iev : {3, 7, 3, 15, 0, 19, 7, 3}) {
+    BOOST_CHECK(reader.getTracks(iev).size() == size_t(iev + 1));
+    BOOST_CHECK(reader.getTrack(iev, iev)->GetPdgCode() == iev * 101);
+  }
+  const auto& stat = reader.getCacheStatistics();
+  BOOST_CHECK(stat.nCachedEvents == 4);
+  BOOST_CHECK(stat.nEventsLoaded == 7); // 3, 7, 15, 0, 19, then 7 and 3 again after being dropped
+  BOOST_CHECK(stat.nEventsDropped == 3);
+  BOOST_CHECK(stat.memory > 0 && stat.memory <= stat.memoryPeak);
+
+  // prefetch reads each missing event once, and they are then served from memory
+  reader.clearCache();
+  BOOST_CHECK(stat.nCachedEvents == 0 && stat.memory == 0);
+  std::vector<o2::MCCompLabel> labels{{1, 12, 0, false}, {0, 5, 0, false}, {2, 12, 0, false}, {0, 9, 0, false}};
+  reader.prefetch(labels);
+  BOOST_CHECK(stat.nPrefetched == 3);
+  auto nLoaded = stat.nEventsLoaded;
+  for (const auto& lbl : labels) {
+    BOOST_CHECK(reader.getTrack(lbl)->GetPdgCode() == lbl.getEventID() * 100 + lbl.getTrackID());
+  }
+  BOOST_CHECK(stat.nEventsLoaded == nLoaded);
+  stat.print();
+}
+
+} // namespace steer
+} // namespace o2
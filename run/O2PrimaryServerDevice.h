@@ -27,9 +27,18 @@
 #include <SimConfig/SimConfig.h>
 #include <CommonUtils/ConfigurableParam.h>
 #include <CommonUtils/RngHelper.h>
+#include <CommonUtils/ThreadLocalRandom.h>
 #include <typeinfo>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <limits>
 #include <TROOT.h>
+#include <TRandom3.h>
 #include <TStopwatch.h>
 
 namespace o2
@@ -41,49 +50,123 @@ class O2PrimaryServerDevice : public FairMQDevice
 {
  public:
   /// Default constructor
-  O2PrimaryServerDevice()
-  {
-    mStack.setExternalMode(true);
-  }
+  O2PrimaryServerDevice() = default;
 
   /// Default destructor
   ~O2PrimaryServerDevice() final
   {
-    if (mGeneratorThread.joinable()) {
-      mGeneratorThread.join();
+    {
+      std::lock_guard<std::mutex> lock(mQueueMutex);
+      mStopGenerators = true;
+    }
+    mQueueCondition.notify_all();
+    for (auto& instance : mGenerators) {
+      if (instance->thread.joinable()) {
+        instance->thread.join();
+      }
+    }
+    if (mThreadRandom && gRandom == mThreadRandom.get()) {
+      gRandom = mThreadRandom->getFallback();
     }
   }
 
  protected:
-  void initGenerator()
+  /// One particle generator together with the stack it fills. Each instance
+  /// lives in its own thread, where gRandom draws from its own rng.
+  struct GeneratorInstance {
+    o2::eventgen::PrimaryGenerator primGen;
+    o2::dataformats::MCEventHeader eventHeader;
+    o2::data::Stack stack;
+    TRandom3 rng;
+    std::thread thread;
+  };
+
+  /// An event waiting in the queue to be served.
+  struct GeneratedEvent {
+    std::vector<TParticle> primaries;
+    o2::dataformats::MCEventHeader eventHeader;
+  };
+
+  /// What we know about a given sim worker.
+  struct WorkerStats {
+    std::chrono::steady_clock::time_point lastSend;
+    int lastChunkSize = 0;
+    double throughput = 0.; // primaries per second (moving average)
+    double idleTime = 0.;   // seconds spent waiting for the generators
+    int chunks = 0;
+  };
+
+  void initGenerator(GeneratorInstance& instance)
   {
     TStopwatch timer;
     timer.Start();
     auto& conf = o2::conf::SimConfig::Instance();
-    o2::conf::ConfigurableParam::updateFromString(conf.getKeyValueString());
-    o2::eventgen::GeneratorFactory::setPrimaryGenerator(conf, &mPrimGen);
-    mPrimGen.SetEvent(&mEventHeader);
-
-    auto embedinto_filename = conf.getEmbedIntoFileName();
-    if (!embedinto_filename.empty()) {
-      mPrimGen.embedInto(embedinto_filename);
+    {
+      // the generator setup touches global ROOT and configuration state
+      std::lock_guard<std::mutex> lock(mInitMutex);
+      std::call_once(mParamsInitialized, [&conf]() { o2::conf::ConfigurableParam::updateFromString(conf.getKeyValueString()); });
+      o2::eventgen::GeneratorFactory::setPrimaryGenerator(conf, &instance.primGen);
+      instance.primGen.SetEvent(&instance.eventHeader);
+
+      auto embedinto_filename = conf.getEmbedIntoFileName();
+      if (!embedinto_filename.empty()) {
+        instance.primGen.embedInto(embedinto_filename);
+      }
+      instance.primGen.Init();
     }
-    mPrimGen.Init();
+    instance.stack.setExternalMode(true);
     LOG(INFO) << "Generator initialization took " << timer.CpuTime() << "s";
-    generateEvent(); // generate a first event
   }
 
   // function generating one event
-  void generateEvent()
+  void generateEvent(GeneratorInstance& instance)
   {
     TStopwatch timer;
     timer.Start();
-    mStack.Reset();
-    mPrimGen.GenerateEvent(&mStack);
+    instance.stack.Reset();
+    instance.primGen.GenerateEvent(&instance.stack);
     timer.Stop();
     LOG(INFO) << "Event generation took " << timer.CpuTime() << "s";
   }
 
+  // seed of the generator random numbers for the event (or generator instance) with the given index;
+  // taken after the seeds sent to the sim workers (mInitialSeed + eventID), so that the sequences differ
+  unsigned int generatorSeed(int index) const
+  {
+    unsigned int seed = static_cast<unsigned int>(mInitialSeed) + mMaxEvents + 1 + index;
+    return seed == 0 ? 1 : seed; // 0 would mean a random seed for TRandom3
+  }
+
+  // body of a generator thread: instance i produces the events i, i + N, ...
+  // so that the order in which events are served does not depend on timing.
+  // gRandom is reseeded for each event, so the events do not depend on the number of
+  // generator threads (except for generators keeping their own random state)
+  void runGenerator(GeneratorInstance& instance, int firstEvent)
+  {
+    o2::utils::ThreadLocalRandom::setThreadGenerator(&instance.rng);
+    instance.rng.SetSeed(generatorSeed(mMaxEvents + firstEvent));
+    initGenerator(instance);
+    for (int event = firstEvent; event < mMaxEvents; event += mGenerators.size()) {
+      {
+        // do not run ahead more than the queue size
+        std::unique_lock<std::mutex> lock(mQueueMutex);
+        mQueueCondition.wait(lock, [this, event]() { return mStopGenerators || event < mNextEventToServe + mQueueSize; });
+        if (mStopGenerators) {
+          return;
+        }
+      }
+      instance.rng.SetSeed(generatorSeed(event));
+      generateEvent(instance);
+      {
+        std::lock_guard<std::mutex> lock(mQueueMutex);
+        auto& generated = mEventQueue[event];
+        generated.primaries = instance.stack.getPrimaries();
+        generated.eventHeader = instance.eventHeader;
+      }
+      mQueueCondition.notify_all();
+    }
+  }
+
   void InitTask() final
   {
     LOG(INFO) << "Init Server device ";
@@ -101,6 +184,11 @@ class O2PrimaryServerDevice : public FairMQDevice
     // CHUNK SIZE
     mChunkGranularity = vm["chunkSize"].as<unsigned int>();
     LOG(INFO) << "CHUNK SIZE SET TO " << mChunkGranularity;
+    mChunkTargetTime = conf.getChunkTargetTime();
+    if (mChunkTargetTime > 0) {
+      LOG(INFO) << "ADAPTIVE CHUNKS TARGETING " << mChunkTargetTime << "s OF WORK";
+    }
+    mNumberOfWorkers = std::max(1, conf.getNSimWorkers());
 
     // initial initial seed --> we should store this somewhere
     mInitialSeed = vm["seed"].as<int>();
@@ -108,14 +196,25 @@ class O2PrimaryServerDevice : public FairMQDevice
     LOG(INFO) << "RNG INITIAL SEED " << mInitialSeed;
 
     mMaxEvents = conf.getNEvents();
+    mQueueSize = conf.getGeneratorQueueSize();
 
     // need to make ROOT thread-safe since we use ROOT services in all places
     ROOT::EnableThreadSafety();
+    // each generator thread draws from its own generator through gRandom
+    mThreadRandom = std::make_unique<o2::utils::ThreadLocalRandom>(gRandom);
+    gRandom = mThreadRandom.get();
 
-    // lunch initialization of particle generator asynchronously
+    // launch the particle generators asynchronously
     // so that we reach the RUNNING state of the server quickly
     // and do not block here
-    mGeneratorThread = std::thread(&O2PrimaryServerDevice::initGenerator, this);
+    int ngenerators = std::min(conf.getNGeneratorThreads(), std::max(1, mMaxEvents));
+    LOG(INFO) << "USING " << ngenerators << " GENERATOR THREADS AND A QUEUE OF " << mQueueSize << " EVENTS";
+    for (int i = 0; i < ngenerators; ++i) {
+      mGenerators.emplace_back(std::make_unique<GeneratorInstance>());
+    }
+    for (int i = 0; i < ngenerators; ++i) {
+      mGenerators[i]->thread = std::thread(&O2PrimaryServerDevice::runGenerator, this, std::ref(*mGenerators[i]), i);
+    }
 
     // init pipe
     auto pipeenv = getenv("ALICE_O2SIMSERVERTODRIVER_PIPE");
@@ -163,6 +262,85 @@ class O2PrimaryServerDevice : public FairMQDevice
     return HandleRequest(request, 0);
   }
 
+  // mean throughput of the workers we already heard back from (0 if none)
+  double meanWorkerThroughput() const
+  {
+    double sum = 0.;
+    int n = 0;
+    for (auto& [id, stats] : mWorkerStats) {
+      if (stats.throughput > 0.) {
+        sum += stats.throughput;
+        n++;
+      }
+    }
+    return n > 0 ? sum / n : 0.;
+  }
+
+  // split the current event into chunks; the number of parts has to be known
+  // when the first chunk is sent, so the chunk size is decided once per event
+  void preparePartition(bool lastEvent)
+  {
+    int nprims = mCurrentPrimaries.size();
+    int chunkSize = mChunkGranularity;
+    if (mChunkTargetTime > 0) {
+      auto throughput = meanWorkerThroughput();
+      if (throughput > 0.) {
+        chunkSize = std::min<double>(throughput * mChunkTargetTime, mChunkGranularity);
+      }
+      chunkSize = std::clamp(chunkSize, std::max(1, mChunkGranularity / 8), mChunkGranularity);
+      if (lastEvent) {
+        // nothing comes after, make sure all workers get a share
+        chunkSize = std::min(chunkSize, std::max(1, (int)std::ceil(nprims / (1. * mNumberOfWorkers))));
+      }
+    }
+    // SubEventInfo::nparts is 16 bit
+    chunkSize = std::max(chunkSize, (int)std::ceil(nprims / (1. * std::numeric_limits<uint16_t>::max())));
+    chunkSize = std::max(chunkSize, 1);
+
+    mChunkSizes.clear();
+    for (int remaining = nprims; remaining > 0; remaining -= chunkSize) {
+      mChunkSizes.push_back(std::min(chunkSize, remaining));
+    }
+    // number of parts should be at least 1 (even if empty)
+    if (mChunkSizes.empty()) {
+      mChunkSizes.push_back(0);
+    }
+  }
+
+  // take the next event from the queue, waiting for it if needed
+  // @return the time spent waiting in seconds
+  double fetchNextEvent()
+  {
+    auto start = std::chrono::steady_clock::now();
+    {
+      std::unique_lock<std::mutex> lock(mQueueMutex);
+      mQueueCondition.wait(lock, [this]() { return mEventQueue.count(mNextEventToServe) > 0; });
+      auto iter = mEventQueue.find(mNextEventToServe);
+      mCurrentPrimaries = std::move(iter->second.primaries);
+      mCurrentHeader = iter->second.eventHeader;
+      mEventQueue.erase(iter);
+      LOG(INFO) << "Serving event " << mNextEventToServe << ", " << mEventQueue.size() << " more events ready in the queue";
+      mNextEventToServe++;
+    }
+    // make room for the generators
+    mQueueCondition.notify_all();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  void printWorkerSummary() const
+  {
+    if (mWorkerStats.empty()) {
+      return;
+    }
+    double totalIdle = 0.;
+    for (auto& [id, stats] : mWorkerStats) {
+      totalIdle += stats.idleTime;
+      LOG(INFO) << "Worker " << id << ": " << stats.chunks << " chunks, " << stats.throughput
+                << " primaries/s, waited " << stats.idleTime << "s for events";
+    }
+    LOG(INFO) << "Workers waited " << totalIdle << "s in total for event generation";
+  }
+
   /// Overloads the ConditionalRun() method of FairMQDevice
   bool HandleRequest(FairMQMessagePtr& request, int /*index*/)
   {
@@ -173,72 +351,86 @@ class O2PrimaryServerDevice : public FairMQDevice
       return HandleConfigRequest(request);
     }
 
-    else if (requeststring.compare("primrequest") != 0) {
+    else if (requeststring.compare(0, 11, "primrequest") != 0) {
       LOG(INFO) << "unknown request\n";
       return true;
     }
 
-    static int counter = 0;
-    if (counter >= mMaxEvents && mNeedNewEvent) {
+    // workers identify themselves with "primrequest:<id>"
+    std::string workerid = requeststring.size() > 12 ? requeststring.substr(12) : "";
+
+    if (mEventCounter >= mMaxEvents && mNeedNewEvent) {
+      printWorkerSummary();
       return false;
     }
 
     LOG(INFO) << "Received request for work ";
+    auto now = std::chrono::steady_clock::now();
+    auto& worker = mWorkerStats[workerid];
+    if (worker.chunks > 0 && worker.lastChunkSize > 0) {
+      // a new request means the previous chunk is done
+      auto elapsed = std::chrono::duration<double>(now - worker.lastSend).count();
+      if (elapsed > 0.) {
+        auto throughput = worker.lastChunkSize / elapsed;
+        worker.throughput = worker.throughput > 0. ? (1. - mThroughputSmoothing) * worker.throughput + mThroughputSmoothing * throughput : throughput;
+      }
+    }
+
     if (mNeedNewEvent) {
       // we need a newly generated event now
-      if (mGeneratorThread.joinable()) {
-        mGeneratorThread.join();
+      auto idle = fetchNextEvent();
+      worker.idleTime += idle;
+      if (idle > 0.01) {
+        LOG(INFO) << "Worker " << workerid << " waited " << idle << "s for event generation";
       }
       mNeedNewEvent = false;
       mPartCounter = 0;
-      counter++;
+      mServedPrimaries = 0;
+      mEventCounter++;
+      preparePartition(mEventCounter == mMaxEvents);
     }
 
-    auto& prims = mStack.getPrimaries();
-    auto numberofparts = (int)std::ceil(prims.size() / (1. * mChunkGranularity));
-    // number of parts should be at least 1 (even if empty)
-    numberofparts = std::max(1, numberofparts);
+    auto& prims = mCurrentPrimaries;
+    int numberofparts = mChunkSizes.size();
 
     o2::data::PrimaryChunk m;
     o2::data::SubEventInfo i;
-    i.eventID = counter;
+    i.eventID = mEventCounter;
     i.maxEvents = mMaxEvents;
     i.part = mPartCounter + 1;
     i.nparts = numberofparts;
-    i.seed = counter + mInitialSeed;
+    i.seed = mEventCounter + mInitialSeed;
     i.index = m.mParticles.size();
-    i.mMCEventHeader = mEventHeader;
+    i.mMCEventHeader = mCurrentHeader;
     m.mSubEventInfo = i;
 
-    int endindex = prims.size() - mPartCounter * mChunkGranularity;
-    int startindex = prims.size() - (mPartCounter + 1) * mChunkGranularity;
-    if (startindex < 0) {
-      startindex = 0;
-    }
-    if (endindex < 0) {
-      endindex = 0;
-    }
+    // chunks are served from the end of the primary list
+    int endindex = prims.size() - mServedPrimaries;
+    int startindex = endindex - mChunkSizes[mPartCounter];
+    mServedPrimaries += mChunkSizes[mPartCounter];
 
     for (int index = startindex; index < endindex; ++index) {
       m.mParticles.emplace_back(prims[index]);
     }
 
     LOG(INFO) << "Sending " << m.mParticles.size() << " particles";
-    LOG(INFO) << "treating ev " << counter << " part " << i.part << " out of " << i.nparts;
+    LOG(INFO) << "treating ev " << mEventCounter << " part " << i.part << " out of " << i.nparts;
 
     // feedback to driver if new event started
     if (mPipeToDriver != -1 && i.part == 1) {
-      if (write(mPipeToDriver, &counter, sizeof(counter))) {
+      if (write(mPipeToDriver, &mEventCounter, sizeof(mEventCounter))) {
       }
     }
 
     mPartCounter++;
     if (mPartCounter == numberofparts) {
       mNeedNewEvent = true;
-      // start generation of a new event
-      mGeneratorThread = std::thread(&O2PrimaryServerDevice::generateEvent, this);
     }
 
+    worker.lastSend = now;
+    worker.lastChunkSize = m.mParticles.size();
+    worker.chunks++;
+
     TMessage* tmsg = new TMessage(kMESS_OBJECT);
     tmsg->WriteObjectAny((void*)&m, TClass::GetClass("o2::data::PrimaryChunk"));
 
@@ -264,19 +456,33 @@ class O2PrimaryServerDevice : public FairMQDevice
 
  private:
   std::string mOutChannelName = "";
-  o2::eventgen::PrimaryGenerator mPrimGen;
-  o2::dataformats::MCEventHeader mEventHeader;
-  o2::data::Stack mStack;      // the stack which is filled
-  int mChunkGranularity = 500; // how many primaries to send to a worker
-  int mLastPosition = 0;       // last position in stack vector
+  int mChunkGranularity = 500;  // how many primaries to send to a worker (at most)
+  float mChunkTargetTime = 0.;  // if > 0, adapt chunks to be done in this time by a worker
+  int mNumberOfWorkers = 1;     // number of sim workers pulling from us
   int mPartCounter = 0;
+  int mServedPrimaries = 0;     // primaries of the current event already sent
+  std::vector<int> mChunkSizes; // partition of the current event
   bool mNeedNewEvent = true;
+  int mEventCounter = 0; // events started so far
   int mMaxEvents = 2;
   int mInitialSeed = -1;
   int mPipeToDriver = -1; // handle for direct piper to driver (to communicate meta info)
-
-  std::thread mGeneratorThread; //! a thread used to concurrently init the particle generator
-                                //  or to generate events
+  static constexpr double mThroughputSmoothing = 0.3;
+
+  std::vector<TParticle> mCurrentPrimaries;     // the event being served
+  o2::dataformats::MCEventHeader mCurrentHeader;
+  std::map<std::string, WorkerStats> mWorkerStats;
+
+  std::vector<std::unique_ptr<GeneratorInstance>> mGenerators; //! the generators, each with its own thread
+  std::unique_ptr<o2::utils::ThreadLocalRandom> mThreadRandom;  //! gRandom while the generators run
+  std::mutex mInitMutex;
+  std::once_flag mParamsInitialized;
+  std::mutex mQueueMutex; // protects the members below
+  std::condition_variable mQueueCondition;
+  std::map<int, GeneratedEvent> mEventQueue; // events ready to be served, by sequence number
+  int mNextEventToServe = 0;
+  int mQueueSize = 2;
+  bool mStopGenerators = false;
 };
 
 } // namespace devices
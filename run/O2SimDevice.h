@@ -25,6 +25,7 @@
 #include <TRandom.h>
 #include <SimConfig/SimConfig.h>
 #include <cstring>
+#include <unistd.h>
 
 namespace o2
 {
@@ -144,7 +145,8 @@ class O2SimDevice : public FairMQDevice
 
   bool Kernel(FairMQChannel& requestchannel, FairMQChannel& dataoutchannel)
   {
-    auto text = new std::string("primrequest");
+    // the pid identifies the worker, so that the server can follow its throughput
+    auto text = new std::string("primrequest:" + std::to_string(getpid()));
 
     // create message object with a pointer to the data buffer,
     // its size,